@@ -351,5 +351,6 @@ protected:
     int3 mSparsePageRes = int3(0);
 
     friend class Device;
+    friend class TextureCache;
 };
 } // namespace Falcor
@@ -84,8 +84,8 @@ bool MemoryMappedFile::open(const std::filesystem::path& path, size_t mappedSize
         break;
     }
 
-    // Open file.
-    mFile = ::CreateFile(mPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+    // Open file. Sharing delete access allows the file to be renamed while it is mapped.
+    mFile = ::CreateFile(mPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, flags, NULL);
     if (!mFile)
         return false;
 
@@ -39,6 +39,7 @@ namespace Falcor
 
 /**
  * Utility class for reading memory-mapped files.
+ * An open file can be renamed, but on Windows it cannot be deleted or replaced until it is closed.
  */
 class FALCOR_API MemoryMappedFile
 {
@@ -523,6 +523,14 @@ void RenderGraph::update(const ref<RenderGraph>& pGraph)
     }
 }
 
+void RenderGraph::setResourceAliasingEnabled(bool enabled)
+{
+    if (mCompilerDeps.resourceAliasingEnabled == enabled)
+        return;
+    mCompilerDeps.resourceAliasingEnabled = enabled;
+    mRecompile = true;
+}
+
 void RenderGraph::setInput(const std::string& name, const ref<Resource>& pResource)
 {
     str_pair strPair;
@@ -734,6 +742,7 @@ FALCOR_SCRIPT_BINDING(RenderGraph)
     // RenderGraph
     pybind11::class_<RenderGraph, ref<RenderGraph>> renderGraph(m, "RenderGraph");
     renderGraph.def_property("name", &RenderGraph::getName, &RenderGraph::setName);
+    renderGraph.def_property("resource_aliasing", &RenderGraph::isResourceAliasingEnabled, &RenderGraph::setResourceAliasingEnabled);
 
     renderGraph.def(
         "create_pass",
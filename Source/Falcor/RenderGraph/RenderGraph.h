@@ -301,6 +301,17 @@ public:
      */
     void setName(const std::string& name) { mName = name; }
 
+    /**
+     * Enable/disable memory aliasing of transient resources between passes. Disabled by default.
+     * Changing the setting triggers a recompilation of the graph.
+     */
+    void setResourceAliasingEnabled(bool enabled);
+
+    /**
+     * Check if memory aliasing of transient resources is enabled.
+     */
+    bool isResourceAliasingEnabled() const { return mCompilerDeps.resourceAliasingEnabled; }
+
     /**
      * Compile the graph.
      */
@@ -56,6 +56,7 @@ std::unique_ptr<RenderGraphExe> RenderGraphCompiler::compile(
 
     // Register the external resources
     auto pResourcesCache = std::make_unique<ResourceCache>();
+    pResourcesCache->setAliasingEnabled(dependencies.resourceAliasingEnabled);
     for (const auto& [name, pRes] : dependencies.externalResources)
         pResourcesCache->registerExternalResource(name, pRes);
 
@@ -263,13 +264,6 @@ bool RenderGraphCompiler::insertAutoPasses()
 
 void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache)
 {
-    // Build list to look up execution order index from the pass
-    std::unordered_map<RenderPass*, uint32_t> passToIndex;
-    for (size_t i = 0; i < mExecutionList.size(); i++)
-    {
-        passToIndex.emplace(mExecutionList[i].pPass.get(), uint32_t(i));
-    }
-
     for (size_t i = 0; i < mExecutionList.size(); i++)
     {
         uint32_t nodeIndex = mExecutionList[i].index;
@@ -332,13 +326,10 @@ void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache*
             const auto& dstField = *passReflection.getField(edgeData.dstField);
             FALCOR_ASSERT(dstField.isValid() && is_set(dstField.getVisibility(), RenderPassReflection::Field::Visibility::Input));
 
-            // Merge dst/input field into same resource data
+            // Merge dst/input field into same resource data, extending its lifetime to this pass
             std::string srcFieldName = mGraph.mNodeData[pEdge->getSourceNode()].name + '.' + edgeData.srcField;
             std::string dstFieldName = mGraph.mNodeData[nodeIndex].name + '.' + dstField.getName();
-
-            const auto& pSrcPass = mGraph.mNodeData[pEdge->getSourceNode()].pPass.get();
-            const auto& srcReflection = mExecutionList[passToIndex.at(pSrcPass)].reflector;
-            pResourceCache->registerField(dstFieldName, dstField, passToIndex[pSrcPass], srcFieldName);
+            pResourceCache->registerField(dstFieldName, dstField, uint32_t(i), srcFieldName);
         }
     }
 
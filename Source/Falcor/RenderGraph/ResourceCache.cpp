@@ -30,6 +30,11 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <queue>
 
 namespace Falcor
 {
@@ -119,27 +124,52 @@ void ResourceCache::registerField(
     }
 }
 
-inline ref<Resource> createResourceForPass(
+namespace
+{
+/**
+ * Fully resolved description of a resource to create.
+ */
+struct ResourceDesc
+{
+    RenderPassReflection::Field::Type type;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t sampleCount;
+    uint32_t arraySize;
+    uint32_t mipLevels;
+    ResourceFormat format;
+    ResourceBindFlags bindFlags;
+
+    bool operator==(const ResourceDesc& other) const
+    {
+        return type == other.type && width == other.width && height == other.height && depth == other.depth &&
+               sampleCount == other.sampleCount && arraySize == other.arraySize && mipLevels == other.mipLevels && format == other.format &&
+               bindFlags == other.bindFlags;
+    }
+};
+
+ResourceDesc getResourceDesc(
     ref<Device> pDevice,
     const ResourceCache::DefaultProperties& params,
     const RenderPassReflection::Field& field,
-    bool resolveBindFlags,
-    const std::string& resourceName
+    bool resolveBindFlags
 )
 {
-    uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-    uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-    uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-    uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-    auto bindFlags = field.getBindFlags();
-    auto arraySize = field.getArraySize();
-    auto mipLevels = field.getMipCount();
-
-    ResourceFormat format = ResourceFormat::Unknown;
+    ResourceDesc desc;
+    desc.type = field.getType();
+    desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+    desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+    desc.depth = field.getDepth() ? field.getDepth() : 1;
+    desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+    desc.arraySize = field.getArraySize();
+    desc.mipLevels = field.getMipCount();
+    desc.format = ResourceFormat::Unknown;
+    desc.bindFlags = field.getBindFlags();
 
     if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
     {
-        format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
         if (resolveBindFlags)
         {
             ResourceBindFlags mask = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
@@ -147,41 +177,91 @@ inline ref<Resource> createResourceForPass(
             bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
             if (isOutput || isInternal)
                 mask |= ResourceBindFlags::DepthStencil | ResourceBindFlags::RenderTarget;
-            auto supported = pDevice->getFormatBindFlags(format);
+            auto supported = pDevice->getFormatBindFlags(desc.format);
             mask &= supported;
-            bindFlags |= mask;
+            desc.bindFlags |= mask;
         }
     }
     else // RawBuffer
     {
         if (resolveBindFlags)
-            bindFlags = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
+            desc.bindFlags = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
     }
+
+    // Clear properties that are not used by the resource type so that equivalent resources compare equal.
+    using Type = RenderPassReflection::Field::Type;
+    if (desc.type == Type::RawBuffer)
+        desc.arraySize = desc.mipLevels = 1;
+    if (desc.type == Type::RawBuffer || desc.type == Type::Texture1D)
+        desc.height = 1;
+    if (desc.type == Type::Texture3D)
+        desc.arraySize = 1;
+    if (desc.type != Type::Texture3D)
+        desc.depth = 1;
+    if (desc.type != Type::Texture2D)
+        desc.sampleCount = 1;
+    if (desc.sampleCount > 1)
+        desc.mipLevels = 1;
+
+    return desc;
+}
+
+/**
+ * Estimate the memory footprint of a resource, ignoring alignment and padding.
+ */
+uint64_t estimateResourceSize(const ResourceDesc& desc)
+{
+    if (desc.type == RenderPassReflection::Field::Type::RawBuffer)
+        return desc.width;
+
+    uint32_t bytesPerBlock = getFormatBytesPerBlock(desc.format);
+    uint32_t widthRatio = getFormatWidthCompressionRatio(desc.format);
+    uint32_t heightRatio = getFormatHeightCompressionRatio(desc.format);
+
+    uint64_t size = 0;
+    uint32_t width = desc.width, height = desc.height, depth = desc.depth;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip)
+    {
+        size += uint64_t(div_round_up(width, widthRatio)) * div_round_up(height, heightRatio) * depth * bytesPerBlock;
+        if (width == 1 && height == 1 && depth == 1)
+            break;
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        depth = std::max(depth / 2, 1u);
+    }
+
+    uint32_t faceCount = desc.type == RenderPassReflection::Field::Type::TextureCube ? 6 : 1;
+    return size * desc.arraySize * faceCount * desc.sampleCount;
+}
+
+ref<Resource> createResource(ref<Device> pDevice, const ResourceDesc& desc, const std::string& resourceName)
+{
     ref<Resource> pResource;
 
-    switch (field.getType())
+    switch (desc.type)
     {
     case RenderPassReflection::Field::Type::RawBuffer:
-        pResource = pDevice->createBuffer(width, bindFlags, MemoryType::DeviceLocal);
+        pResource = pDevice->createBuffer(desc.width, desc.bindFlags, MemoryType::DeviceLocal);
         break;
     case RenderPassReflection::Field::Type::Texture1D:
-        pResource = pDevice->createTexture1D(width, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = pDevice->createTexture1D(desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::Texture2D:
-        if (sampleCount > 1)
+        if (desc.sampleCount > 1)
         {
-            pResource = pDevice->createTexture2DMS(width, height, format, sampleCount, arraySize, bindFlags);
+            pResource = pDevice->createTexture2DMS(desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
         }
         else
         {
-            pResource = pDevice->createTexture2D(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+            pResource =
+                pDevice->createTexture2D(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
         }
         break;
     case RenderPassReflection::Field::Type::Texture3D:
-        pResource = pDevice->createTexture3D(width, height, depth, format, mipLevels, nullptr, bindFlags);
+        pResource = pDevice->createTexture3D(desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::TextureCube:
-        pResource = pDevice->createTextureCube(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = pDevice->createTextureCube(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     default:
         FALCOR_UNREACHABLE();
@@ -190,15 +270,139 @@ inline ref<Resource> createResourceForPass(
     pResource->setName(resourceName);
     return pResource;
 }
+} // namespace
+
+ResourceCache::AliasingPlan ResourceCache::planAliasing(const std::vector<TransientResource>& resources)
+{
+    AliasingPlan plan;
+    plan.backingIndex.resize(resources.size());
+
+    // Process resources in order of start time. Ties are broken by index to make the plan deterministic.
+    std::vector<uint32_t> order(resources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(
+        order.begin(),
+        order.end(),
+        [&](uint32_t a, uint32_t b)
+        { return std::make_pair(resources[a].lifetime.first, a) < std::make_pair(resources[b].lifetime.first, b); }
+    );
+
+    // Backing resources that are in use, ordered by the end of their current lifetime.
+    using ActiveBacking = std::pair<uint32_t, uint32_t>; // (lifetime end, backing index)
+    std::priority_queue<ActiveBacking, std::vector<ActiveBacking>, std::greater<ActiveBacking>> active;
+    // Backing resources that are free again, per description index.
+    std::map<uint32_t, std::vector<uint32_t>> freeBackings;
+    std::vector<uint32_t> backingDesc;
+    uint64_t liveSize = 0;
+    std::vector<uint64_t> backingSize;
+
+    for (uint32_t i : order)
+    {
+        const auto& resource = resources[i];
+        FALCOR_ASSERT(resource.lifetime.first <= resource.lifetime.second);
+
+        // Release backing resources whose lifetime ended before this resource is first used.
+        while (!active.empty() && active.top().first < resource.lifetime.first)
+        {
+            uint32_t backing = active.top().second;
+            active.pop();
+            freeBackings[backingDesc[backing]].push_back(backing);
+            liveSize -= backingSize[backing];
+        }
+
+        auto& candidates = freeBackings[resource.descIndex];
+        uint32_t backing;
+        if (candidates.empty())
+        {
+            backing = plan.backingCount++;
+            backingDesc.push_back(resource.descIndex);
+            backingSize.push_back(resource.size);
+            plan.aliasedSize += resource.size;
+        }
+        else
+        {
+            // Reuse the most recently released backing resource.
+            backing = candidates.back();
+            candidates.pop_back();
+            FALCOR_ASSERT(backingSize[backing] == resource.size);
+        }
+
+        plan.backingIndex[i] = backing;
+        plan.naiveSize += resource.size;
+        active.emplace(resource.lifetime.second, backing);
+        liveSize += resource.size;
+        plan.peakSize = std::max(plan.peakSize, liveSize);
+    }
+
+    return plan;
+}
 
 void ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params)
 {
+    // Resources that are only used within a range of the execution order and whose contents do not need to be
+    // preserved between executions can share memory with other resources that are used at different times.
+    // Internal resources are excluded as passes may rely on their contents persisting between frames.
+    auto isTransient = [this](const ResourceData& data)
+    {
+        return mAliasingEnabled && data.lifetime.second != uint32_t(-1) &&
+               !is_set(data.field.getVisibility(), RenderPassReflection::Field::Visibility::Internal) &&
+               !is_set(data.field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
+    };
+
+    std::vector<ResourceDesc> descs;
+    std::vector<TransientResource> transientResources;
+    std::vector<ResourceData*> transientData;
+
     for (auto& data : mResourceData)
     {
         if ((data.pResource == nullptr) && (data.field.isValid()))
         {
-            data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+            ResourceDesc desc = getResourceDesc(pDevice, params, data.field, data.resolveBindFlags);
+            if (!isTransient(data))
+            {
+                data.pResource = createResource(pDevice, desc, data.name);
+                continue;
+            }
+
+            auto it = std::find(descs.begin(), descs.end(), desc);
+            uint32_t descIndex = uint32_t(it - descs.begin());
+            if (it == descs.end())
+                descs.push_back(desc);
+
+            transientResources.push_back({descIndex, data.lifetime, estimateResourceSize(desc)});
+            transientData.push_back(&data);
         }
     }
+
+    if (transientResources.empty())
+        return;
+
+    AliasingPlan plan = planAliasing(transientResources);
+
+    // Create backing resources, named after all the fields sharing them.
+    std::vector<std::string> backingNames(plan.backingCount);
+    for (size_t i = 0; i < transientResources.size(); i++)
+    {
+        auto& name = backingNames[plan.backingIndex[i]];
+        name += (name.empty() ? "" : ", ") + transientData[i]->name;
+    }
+
+    std::vector<ref<Resource>> backings(plan.backingCount);
+    for (size_t i = 0; i < transientResources.size(); i++)
+    {
+        uint32_t backing = plan.backingIndex[i];
+        if (!backings[backing])
+            backings[backing] = createResource(pDevice, descs[transientResources[i].descIndex], backingNames[backing]);
+        transientData[i]->pResource = backings[backing];
+    }
+
+    logInfo(
+        "ResourceCache: Allocated {} transient resources using {} resources ({:.1f} MB instead of {:.1f} MB, peak {:.1f} MB).",
+        transientResources.size(),
+        plan.backingCount,
+        plan.aliasedSize / (1024.0 * 1024.0),
+        plan.naiveSize / (1024.0 * 1024.0),
+        plan.peakSize / (1024.0 * 1024.0)
+    );
 }
 } // namespace Falcor
@@ -83,6 +83,20 @@ public:
      */
     const RenderPassReflection::Field& getResourceReflection(const std::string& name) const;
 
+    /**
+     * Enable/disable memory aliasing of transient resources. Disabled by default.
+     * When enabled, resources that are only used within a range of the execution order share backing resources with
+     * other resources used at different times. Passes must then not rely on the contents of such resources persisting
+     * between frames unless they mark them as persistent.
+     * Takes effect on the next call to allocateResources().
+     */
+    void setAliasingEnabled(bool enabled) { mAliasingEnabled = enabled; }
+
+    /**
+     * Check if memory aliasing of transient resources is enabled.
+     */
+    bool isAliasingEnabled() const { return mAliasingEnabled; }
+
     /**
      * Allocate all resources that need to be created/updated.
      * This includes new resources, resources whose properties have been updated since last allocation call.
@@ -94,6 +108,38 @@ public:
      */
     void reset();
 
+    /**
+     * Description of a transient resource used for planning memory aliasing.
+     */
+    struct TransientResource
+    {
+        uint32_t descIndex = 0;                 ///< Resources with equal description index are compatible and can share a backing resource.
+        std::pair<uint32_t, uint32_t> lifetime; ///< Time range where the resource is used (inclusive).
+        uint64_t size = 0;                      ///< Size of the resource in bytes.
+    };
+
+    /**
+     * Result of planning memory aliasing for transient resources.
+     */
+    struct AliasingPlan
+    {
+        std::vector<uint32_t> backingIndex; ///< Index of the backing resource for each transient resource.
+        uint32_t backingCount = 0;          ///< Number of backing resources.
+        uint64_t naiveSize = 0;             ///< Memory in bytes required without aliasing.
+        uint64_t aliasedSize = 0;           ///< Memory in bytes required for the backing resources.
+        uint64_t peakSize = 0;              ///< Peak memory in bytes of resources alive at the same time (lower bound for any aliasing).
+    };
+
+    /**
+     * Assign transient resources to shared backing resources.
+     * Resources are only assigned to the same backing resource if they are compatible and their lifetimes are disjoint.
+     * Each set of compatible resources is assigned greedily in order of start time, which uses the minimum number of
+     * backing resources (interval graph coloring).
+     * @param[in] resources List of transient resources.
+     * @return The aliasing plan.
+     */
+    static AliasingPlan planAliasing(const std::vector<TransientResource>& resources);
+
 private:
     struct ResourceData
     {
@@ -110,6 +156,8 @@ private:
 
     // References to output resources not to be allocated by the render graph
     ResourcesMap mExternalResources;
+
+    bool mAliasingEnabled = false;
 };
 
 } // namespace Falcor
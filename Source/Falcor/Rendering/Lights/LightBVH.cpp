@@ -29,6 +29,9 @@
 #include "Core/Error.h"
 #include "Core/API/RenderContext.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -45,41 +48,118 @@ namespace Falcor
         mInternalUpdater = ComputePass::create(mpDevice, kShaderFile, "updateInternalNodes");
     }
 
-    // TODO: Only update the ones that moved.
     void LightBVH::refit(RenderContext* pRenderContext)
     {
         FALCOR_PROFILE(pRenderContext, "LightBVH::refit()");
 
         FALCOR_ASSERT(mIsValid);
+        refitNodes(pRenderContext, mpNodeIndicesBuffer, mPerDepthRefitEntryInfo);
+        mBVHStats.refitNodeCount = (uint32_t)mNodeIndices.size();
+    }
+
+    void LightBVH::refitIncremental(RenderContext* pRenderContext, const std::vector<uint32_t>& updatedLights)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVH::refitIncremental()");
+
+        FALCOR_ASSERT(mIsValid);
+
+        // Collect the leaf nodes holding triangles of the updated lights. Culled triangles are not stored in any leaf.
+        // The triangles of a mesh light are mostly stored in the same leaves, so consecutive duplicates are skipped.
+        const auto& meshLights = mpLightCollection->getMeshLights();
+        std::vector<uint32_t> leafIndices;
+        for (uint32_t lightIdx : updatedLights)
+        {
+            FALCOR_ASSERT(lightIdx < meshLights.size());
+            const MeshLightData& meshLight = meshLights[lightIdx];
+            for (uint32_t i = 0; i < meshLight.triangleCount; ++i)
+            {
+                const uint32_t leafIndex = mTriangleLeafIndices[meshLight.triangleOffset + i];
+                if (leafIndex != kInvalidNode && (leafIndices.empty() || leafIndices.back() != leafIndex)) leafIndices.push_back(leafIndex);
+            }
+        }
+
+        refitPaths(pRenderContext, leafIndices);
+    }
 
-        // Update all leaf nodes.
+    void LightBVH::refitPaths(RenderContext* pRenderContext, const std::vector<uint32_t>& nodeIndices)
+    {
+        // Collect the nodes and their ancestors. Each walk up the tree stops at the first node already queued by another path.
+        mDirtyNodesPerDepth.resize(mBVHStats.treeHeight);
+        for (auto& nodes : mDirtyNodesPerDepth) nodes.clear();
+        mDirtyLeaves.clear();
+
+        for (uint32_t nodeIndex : nodeIndices)
+        {
+            for (uint32_t index = nodeIndex; index != kInvalidNode && !(mNodeFlags[index] & kNodeQueued); index = mParentIndices[index])
+            {
+                mNodeFlags[index] |= kNodeQueued | kNodeTouched;
+                if (mNodes[index].isLeaf()) mDirtyLeaves.push_back(index);
+                else mDirtyNodesPerDepth[mNodeDepths[index]].push_back(index);
+            }
+        }
+
+        // Lay out the node indices like 'mNodeIndices': internal nodes sorted by depth, followed by all leaf nodes.
+        mDirtyNodeIndices.clear();
+        mDirtyRefitEntryInfo.resize(mDirtyNodesPerDepth.size() + 1);
+        for (size_t depth = 0; depth < mDirtyRefitEntryInfo.size(); ++depth)
+        {
+            const auto& nodes = depth < mDirtyNodesPerDepth.size() ? mDirtyNodesPerDepth[depth] : mDirtyLeaves;
+            mDirtyRefitEntryInfo[depth].offset = (uint32_t)mDirtyNodeIndices.size();
+            mDirtyRefitEntryInfo[depth].count = (uint32_t)nodes.size();
+            mDirtyNodeIndices.insert(mDirtyNodeIndices.end(), nodes.begin(), nodes.end());
+        }
+        for (uint32_t index : mDirtyNodeIndices) mNodeFlags[index] &= (uint8_t)~kNodeQueued;
+
+        // When most of the tree is affected, the full refit is cheaper as it doesn't need an upload.
+        if (2 * mDirtyNodeIndices.size() > mNodeIndices.size())
+        {
+            refit(pRenderContext);
+            return;
+        }
+
+        mBVHStats.refitNodeCount = (uint32_t)mDirtyNodeIndices.size();
+        if (mDirtyNodeIndices.empty()) return;
+
+        if (!mpDirtyNodeIndicesBuffer || mpDirtyNodeIndicesBuffer->getElementCount() < mDirtyNodeIndices.size())
+        {
+            mpDirtyNodeIndicesBuffer = mpDevice->createStructuredBuffer(sizeof(uint32_t), (uint32_t)mNodeIndices.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            mpDirtyNodeIndicesBuffer->setName("LightBVH::mpDirtyNodeIndicesBuffer");
+        }
+        mpDirtyNodeIndicesBuffer->setBlob(mDirtyNodeIndices.data(), 0, mDirtyNodeIndices.size() * sizeof(uint32_t));
+
+        refitNodes(pRenderContext, mpDirtyNodeIndicesBuffer, mDirtyRefitEntryInfo);
+    }
+
+    void LightBVH::refitNodes(RenderContext* pRenderContext, const ref<Buffer>& pNodeIndices, const std::vector<RefitEntryInfo>& perDepthInfo)
+    {
+        FALCOR_ASSERT(!perDepthInfo.empty());
+
+        // Update the leaf nodes.
+        if (const uint32_t nodeCount = perDepthInfo.back().count; nodeCount > 0)
         {
             auto var = mLeafUpdater->getRootVar()["CB"];
             mpLightCollection->bindShaderData(var["gLights"]);
             bindShaderData(var["gLightBVH"]);
-            var["gNodeIndices"] = mpNodeIndicesBuffer;
-
-            const uint32_t nodeCount = mPerDepthRefitEntryInfo.back().count;
-            FALCOR_ASSERT(nodeCount > 0);
-            var["gFirstNodeOffset"] = mPerDepthRefitEntryInfo.back().offset;
+            var["gNodeIndices"] = pNodeIndices;
+            var["gFirstNodeOffset"] = perDepthInfo.back().offset;
             var["gNodeCount"] = nodeCount;
 
             mLeafUpdater->execute(pRenderContext, nodeCount, 1, 1);
         }
 
-        // Update all internal nodes.
+        // Update the internal nodes, one level at a time from the bottom up.
         {
             auto var = mInternalUpdater->getRootVar()["CB"];
             mpLightCollection->bindShaderData(var["gLights"]);
             bindShaderData(var["gLightBVH"]);
-            var["gNodeIndices"] = mpNodeIndicesBuffer;
+            var["gNodeIndices"] = pNodeIndices;
 
-            // Note that mBVHStats.treeHeight may be 0, in which case there is a single leaf and no internal nodes.
-            for (int depth = (int)mBVHStats.treeHeight - 1; depth >= 0; --depth)
+            // Note that there may be a single leaf and no internal nodes.
+            for (int depth = (int)perDepthInfo.size() - 2; depth >= 0; --depth)
             {
-                const uint32_t nodeCount = mPerDepthRefitEntryInfo[depth].count;
-                FALCOR_ASSERT(nodeCount > 0);
-                var["gFirstNodeOffset"] = mPerDepthRefitEntryInfo[depth].offset;
+                const uint32_t nodeCount = perDepthInfo[depth].count;
+                if (nodeCount == 0) continue;
+                var["gFirstNodeOffset"] = perDepthInfo[depth].offset;
                 var["gNodeCount"] = nodeCount;
 
                 mInternalUpdater->execute(pRenderContext, nodeCount, 1, 1);
@@ -106,6 +186,20 @@ namespace Falcor
             "  Triangle count:      " + std::to_string(stats.triangleCount) + "\n";
         widget.text(statsStr);
 
+        if (auto qualityGroup = widget.group("Quality and update cost"))
+        {
+            const std::string qualityStr =
+                "  SAOH cost:               " + std::to_string(stats.saohCost) + "\n" +
+                "  SAOH cost at build:      " + std::to_string(stats.saohCostAtBuild) + "\n" +
+                "  Garbage node count:      " + std::to_string(stats.garbageNodeCount) + "\n" +
+                "  Last refit node count:   " + std::to_string(stats.refitNodeCount) + "\n" +
+                "  Incremental refits:      " + std::to_string(stats.incrementalRefitCount) + "\n" +
+                "  Subtree rebuilds:        " + std::to_string(stats.subtreeRebuildCount) + "\n" +
+                "  Rebuilt triangle count:  " + std::to_string(stats.subtreeRebuildTriangleCount) + "\n" +
+                "  Incremental update time: " + std::to_string(stats.incrementalUpdateTime) + " ms";
+            qualityGroup.text(qualityStr);
+        }
+
         if (auto nodeGroup = widget.group("Node count per level"))
         {
             std::string countStr;
@@ -136,6 +230,14 @@ namespace Falcor
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0;
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
+        mTriangleLeafIndices.clear();
+        mParentIndices.clear();
+        mNodeDepths.clear();
+        mNodeFlags.clear();
+        mSubtreeCostsAtBuild.clear();
+        mRefitsSinceQualityCheck = 0;
         mBVHStats = BVHStats();
         mIsValid = false;
         mIsCpuDataValid = false;
@@ -170,11 +272,14 @@ namespace Falcor
         // This function is called after BVH build has finished.
         computeStats();
         updateNodeIndices();
+        updateNodeLinks();
     }
 
     void LightBVH::computeStats()
     {
         FALCOR_ASSERT(isValid());
+        syncDataToCPU();
+
         mBVHStats.nodeCountPerLevel.clear();
         mBVHStats.nodeCountPerLevel.reserve(32);
 
@@ -187,6 +292,7 @@ namespace Falcor
         mBVHStats.internalNodeCount = 0;
         mBVHStats.leafNodeCount = 0;
         mBVHStats.triangleCount = 0;
+        float internalNodeCost = 0.f;
 
         auto evalInternal = [&](const NodeLocation& location)
         {
@@ -194,6 +300,7 @@ namespace Falcor
             else ++mBVHStats.nodeCountPerLevel[location.depth];
 
             ++mBVHStats.internalNodeCount;
+            internalNodeCost += evalNodeCost(mNodes[location.nodeIndex]);
             return true;
         };
         auto evalLeaf = [&](const NodeLocation& location)
@@ -214,6 +321,47 @@ namespace Falcor
         traverseBVH(evalInternal, evalLeaf);
 
         mBVHStats.byteSize = (uint32_t)(mNodes.size() * sizeof(mNodes[0]));
+
+        const float rootCost = evalNodeCost(mNodes[0]);
+        mBVHStats.saohCost = rootCost > 0.f ? internalNodeCost / rootCost : 0.f;
+    }
+
+    void LightBVH::computeSubtreeCosts(std::vector<float>& costs) const
+    {
+        FALCOR_ASSERT(isValid() && mIsCpuDataValid);
+
+        // 'mNodeIndices' is sorted by depth with the leaf nodes last, so iterating it backwards visits children before their parents.
+        std::vector<float> absoluteCosts(mNodes.size(), 0.f);
+        costs.assign(mNodes.size(), 0.f);
+        for (auto it = mNodeIndices.rbegin(); it != mNodeIndices.rend(); ++it)
+        {
+            const uint32_t nodeIndex = *it;
+            if (mNodes[nodeIndex].isLeaf()) continue;
+
+            const uint32_t rightIndex = mNodes[nodeIndex].getInternalNode().rightChildIdx;
+            const float nodeCost = evalNodeCost(mNodes[nodeIndex]);
+            absoluteCosts[nodeIndex] = nodeCost + absoluteCosts[nodeIndex + 1] + absoluteCosts[rightIndex];
+            costs[nodeIndex] = nodeCost > 0.f ? absoluteCosts[nodeIndex] / nodeCost : 0.f;
+        }
+    }
+
+    float LightBVH::evalNodeCost(const PackedNode& node)
+    {
+        // SAOH cost with flux, surface area and lighting cone, see evalSAOH() in LightBVHBuilder.cpp.
+        const SharedNodeAttributes attribs = node.getNodeAttributes();
+        const float3 size = 2.f * attribs.extent;
+        const float area = 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        const float theta = attribs.cosConeAngle != kInvalidCosConeAngle ? std::acos(std::clamp(attribs.cosConeAngle, -1.f, 1.f)) : float(M_PI);
+        return attribs.flux * area * computeOrientationCost(theta);
+    }
+
+    float LightBVH::computeOrientationCost(float theta_o)
+    {
+        // We're assuming flat diffuse emitters (theta_e = pi/2).
+        float theta_w = std::min(theta_o + float(M_PI_2), float(M_PI));
+        float sin_theta_o = std::sin(theta_o);
+        float cos_theta_o = std::cos(theta_o);
+        return float(M_2PI) * (1.0f - cos_theta_o) + float(M_PI_2) * (2.0f * theta_w * sin_theta_o - std::cos(theta_o - 2.0f * theta_w) - 2.0f * theta_o * sin_theta_o + cos_theta_o);
     }
 
     void LightBVH::updateNodeIndices()
@@ -269,7 +417,34 @@ namespace Falcor
         mpNodeIndicesBuffer->setBlob(mNodeIndices.data(), 0, mNodeIndices.size() * sizeof(uint32_t));
     }
 
-    void LightBVH::uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks)
+    void LightBVH::updateNodeLinks()
+    {
+        // Record the parent and depth of each node and the leaf of each triangle, so that incremental refits can find the affected nodes.
+        mParentIndices.assign(mNodes.size(), kInvalidNode);
+        mNodeDepths.assign(mNodes.size(), 0);
+        mNodeFlags.assign(mNodes.size(), 0);
+        mTriangleLeafIndices.assign(mTriangleBitmasks.size(), kInvalidNode);
+
+        traverseBVH(
+            [&](const NodeLocation& location)
+            {
+                const uint32_t rightIndex = mNodes[location.nodeIndex].getInternalNode().rightChildIdx;
+                mNodeDepths[location.nodeIndex] = location.depth;
+                mParentIndices[location.nodeIndex + 1] = location.nodeIndex;
+                mParentIndices[rightIndex] = location.nodeIndex;
+                return true;
+            },
+            [&](const NodeLocation& location)
+            {
+                const auto node = mNodes[location.nodeIndex].getLeafNode();
+                mNodeDepths[location.nodeIndex] = location.depth;
+                for (uint32_t i = 0; i < node.triangleCount; ++i) mTriangleLeafIndices[mTriangleIndices[node.triangleOffset + i]] = location.nodeIndex;
+                return true;
+            }
+        );
+    }
+
+    void LightBVH::uploadCPUBuffers()
     {
         // Reallocate buffers if size requirements have changed.
         auto var = mLeafUpdater->getRootVar()["CB"]["gLightBVH"];
@@ -278,14 +453,14 @@ namespace Falcor
             mpBVHNodesBuffer = mpDevice->createStructuredBuffer(var["nodes"], (uint32_t)mNodes.size(), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false);
             mpBVHNodesBuffer->setName("LightBVH::mpBVHNodesBuffer");
         }
-        if (!mpTriangleIndicesBuffer || mpTriangleIndicesBuffer->getElementCount() < triangleIndices.size())
+        if (!mpTriangleIndicesBuffer || mpTriangleIndicesBuffer->getElementCount() < mTriangleIndices.size())
         {
-            mpTriangleIndicesBuffer = mpDevice->createStructuredBuffer(var["triangleIndices"], (uint32_t)triangleIndices.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            mpTriangleIndicesBuffer = mpDevice->createStructuredBuffer(var["triangleIndices"], (uint32_t)mTriangleIndices.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
             mpTriangleIndicesBuffer->setName("LightBVH::mpTriangleIndicesBuffer");
         }
-        if (!mpTriangleBitmasksBuffer || mpTriangleBitmasksBuffer->getElementCount() < triangleBitmasks.size())
+        if (!mpTriangleBitmasksBuffer || mpTriangleBitmasksBuffer->getElementCount() < mTriangleBitmasks.size())
         {
-            mpTriangleBitmasksBuffer = mpDevice->createStructuredBuffer(var["triangleBitmasks"], (uint32_t)triangleBitmasks.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            mpTriangleBitmasksBuffer = mpDevice->createStructuredBuffer(var["triangleBitmasks"], (uint32_t)mTriangleBitmasks.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
             mpTriangleBitmasksBuffer->setName("LightBVH::mpTriangleBitmasksBuffer");
         }
 
@@ -294,11 +469,11 @@ namespace Falcor
         FALCOR_ASSERT(mpBVHNodesBuffer->getStructSize() == sizeof(mNodes[0]));
         mpBVHNodesBuffer->setBlob(mNodes.data(), 0, mNodes.size() * sizeof(mNodes[0]));
 
-        FALCOR_ASSERT(mpTriangleIndicesBuffer->getSize() >= triangleIndices.size() * sizeof(triangleIndices[0]));
-        mpTriangleIndicesBuffer->setBlob(triangleIndices.data(), 0, triangleIndices.size() * sizeof(triangleIndices[0]));
+        FALCOR_ASSERT(mpTriangleIndicesBuffer->getSize() >= mTriangleIndices.size() * sizeof(mTriangleIndices[0]));
+        mpTriangleIndicesBuffer->setBlob(mTriangleIndices.data(), 0, mTriangleIndices.size() * sizeof(mTriangleIndices[0]));
 
-        FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
-        mpTriangleBitmasksBuffer->setBlob(triangleBitmasks.data(), 0, triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
+        FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= mTriangleBitmasks.size() * sizeof(mTriangleBitmasks[0]));
+        mpTriangleBitmasksBuffer->setBlob(mTriangleBitmasks.data(), 0, mTriangleBitmasks.size() * sizeof(mTriangleBitmasks[0]));
 
         mIsCpuDataValid = true;
     }
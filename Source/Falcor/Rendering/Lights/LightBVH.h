@@ -34,6 +34,7 @@
 #include "Utils/Math/Vector.h"
 #include "Utils/UI/Gui.h"
 #include <functional>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -47,6 +48,8 @@ namespace Falcor
         "Importance Sampling of Many Lights on the GPU", Ray Tracing Gems, Ch. 18, 2019.
 
         Before being used, the BVH needs to have been built using LightBVHBuilder::build().
+        When only some lights move, LightBVHBuilder::updateIncremental() refits the affected nodes only
+        and rebuilds the subtrees whose quality degraded too much.
         The data can be both used on the CPU (using traverseBVH() or on the GPU by:
           1. import LightBVH;
           2. Declare a variable of type LightBVH in your shader.
@@ -88,6 +91,14 @@ namespace Falcor
         */
         void refit(RenderContext* pRenderContext);
 
+        /** Refit the BVH nodes affected by a set of mesh lights, without changing the hierarchy.
+            Only the leaf nodes containing triangles of the updated lights and their ancestors are refitted.
+            The BVH needs to have been built before trying to refit it.
+            \param[in] pRenderContext The render context.
+            \param[in] updatedLights Indices of the mesh lights whose triangles have changed.
+        */
+        void refitIncremental(RenderContext* pRenderContext, const std::vector<uint32_t>& updatedLights);
+
         /** Perform a depth-first traversal of the BVH and run a function on each node.
             \param[in] evalInternal Function called on each internal node.
             \param[in] evalLeaf Function called on each leaf node.
@@ -106,6 +117,18 @@ namespace Falcor
             uint32_t internalNodeCount = 0;                  ///< Number of internal nodes inside the BVH.
             uint32_t leafNodeCount = 0;                      ///< Number of leaf nodes inside the BVH.
             uint32_t triangleCount = 0;                      ///< Number of triangles inside the BVH.
+
+            // Quality metrics.
+            float saohCost = 0.f;                            ///< SAOH cost of all internal nodes relative to the cost of the root node. Lower is better.
+            float saohCostAtBuild = 0.f;                     ///< SAOH cost right after the last full build.
+            uint32_t garbageNodeCount = 0;                   ///< Number of nodes left unreferenced by local subtree rebuilds.
+
+            // Update cost metrics, reset by each full build.
+            uint32_t refitNodeCount = 0;                     ///< Number of nodes updated by the last refit.
+            uint32_t incrementalRefitCount = 0;              ///< Number of incremental refits since the last full build.
+            uint32_t subtreeRebuildCount = 0;                ///< Number of local subtree rebuilds since the last full build.
+            uint32_t subtreeRebuildTriangleCount = 0;        ///< Number of triangles in the subtrees rebuilt since the last full build.
+            double incrementalUpdateTime = 0.0;              ///< Total CPU time in ms spent in incremental updates since the last full build.
         };
 
         /** Returns stats.
@@ -126,25 +149,62 @@ namespace Falcor
         */
         void bindShaderData(const ShaderVar& var) const;
 
+        /** Compute the orientation cost of a bounding cone, according to Equation 1
+            in Conty & Kulla, "Importance Sampling of Many Lights with Adaptive Tree Splitting", 2018.
+            \param[in] theta_o Normal bounding cone angle.
+            \return Orientation cost, between pi (flat emitter) and 4pi (full sphere).
+        */
+        static float computeOrientationCost(float theta_o);
+
     protected:
+        struct RefitEntryInfo
+        {
+            uint32_t offset = 0;    ///< Offset into the 'mpNodeIndicesBuffer' buffer.
+            uint32_t count = 0;     ///< The number of nodes at each level.
+        };
+
+        static constexpr uint32_t kInvalidNode = std::numeric_limits<uint32_t>::max();
+
+        enum NodeFlags : uint8_t
+        {
+            kNodeQueued = 0x1,      ///< Node is queued for the current incremental refit.
+            kNodeTouched = 0x2,     ///< Node was refitted since the last quality check.
+        };
+
         void finalize();
         void computeStats();
         void updateNodeIndices();
+        void updateNodeLinks();
         void renderStats(Gui::Widgets& widget, const BVHStats& stats) const;
 
-        void uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks);
+        /** Refit nodes with the refit passes.
+            \param[in] pNodeIndices Buffer of node indices sorted by tree depth.
+            \param[in] perDepthInfo Offset and count of internal nodes per depth into 'pNodeIndices'; the last entry refers to the leaf nodes.
+        */
+        void refitNodes(RenderContext* pRenderContext, const ref<Buffer>& pNodeIndices, const std::vector<RefitEntryInfo>& perDepthInfo);
+
+        /** Refit a set of nodes and all their ancestors.
+            \param[in] nodeIndices Indices of the nodes to refit.
+        */
+        void refitPaths(RenderContext* pRenderContext, const std::vector<uint32_t>& nodeIndices);
+
+        /** Compute the SAOH cost of each subtree relative to the cost of its root node.
+            The CPU-side nodes need to be in sync with the GPU.
+            \param[out] costs Relative cost per node index. Leaf nodes and unreferenced nodes have zero cost.
+        */
+        void computeSubtreeCosts(std::vector<float>& costs) const;
+
+        /** Evaluate the SAOH cost of a single node.
+        */
+        static float evalNodeCost(const PackedNode& node);
+
+        void uploadCPUBuffers();
         void syncDataToCPU() const;
 
         /** Invalidate the BVH.
         */
         void clear();
 
-        struct RefitEntryInfo
-        {
-            uint32_t offset = 0;    ///< Offset into the 'mpNodeIndicesBuffer' buffer.
-            uint32_t count = 0;     ///< The number of nodes at each level.
-        };
-
         // Internal state
         ref<Device>                           mpDevice;
         ref<const ILightCollection>           mpLightCollection;
@@ -161,11 +221,26 @@ namespace Falcor
         bool                                  mIsValid = false;         ///< True when the BVH has been built.
         mutable bool                          mIsCpuDataValid = false;  ///< Indicates whether the CPU-side data matches the GPU buffers.
 
+        // CPU resources for incremental updates
+        std::vector<uint32_t>                 mTriangleIndices;         ///< CPU-side copy of the triangle indices sorted by leaf node.
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU-side copy of the per triangle bit patterns.
+        std::vector<uint32_t>                 mTriangleLeafIndices;     ///< Leaf node index per global triangle index, or kInvalidNode if the triangle was culled.
+        std::vector<uint32_t>                 mParentIndices;           ///< Parent node index per node, or kInvalidNode for the root and unreferenced nodes.
+        std::vector<uint32_t>                 mNodeDepths;              ///< Depth per node.
+        std::vector<uint8_t>                  mNodeFlags;               ///< NodeFlags per node.
+        std::vector<float>                    mSubtreeCostsAtBuild;     ///< Relative subtree SAOH cost per node when the subtree was built. See computeSubtreeCosts().
+        std::vector<std::vector<uint32_t>>    mDirtyNodesPerDepth;      ///< Scratch list of the internal nodes to refit per depth.
+        std::vector<uint32_t>                 mDirtyLeaves;             ///< Scratch list of the leaf nodes to refit.
+        std::vector<uint32_t>                 mDirtyNodeIndices;        ///< Node indices to refit sorted by tree depth, laid out like 'mNodeIndices'.
+        std::vector<RefitEntryInfo>           mDirtyRefitEntryInfo;     ///< Refit entry info for 'mDirtyNodeIndices'.
+        uint32_t                              mRefitsSinceQualityCheck = 0; ///< Number of incremental refits since the subtree quality was last checked.
+
         // GPU resources
         ref<Buffer>                           mpBVHNodesBuffer;         ///< Buffer holding all BVH nodes.
         ref<Buffer>                           mpTriangleIndicesBuffer;  ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
         ref<Buffer>                           mpTriangleBitmasksBuffer; ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child.
         ref<Buffer>                           mpNodeIndicesBuffer;      ///< Buffer holding all node indices sorted by tree depth. This is used for BVH refit.
+        ref<Buffer>                           mpDirtyNodeIndicesBuffer; ///< Buffer holding the node indices to refit sorted by tree depth. This is used for incremental BVH refit.
 
         friend LightBVHBuilder;
     };
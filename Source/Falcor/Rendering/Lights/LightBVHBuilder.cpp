@@ -28,9 +28,12 @@
 #include "LightBVHBuilder.h"
 #include "Core/Error.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
+#include <array>
 
 namespace
 {
@@ -44,6 +47,12 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Triangle count above which the children of a node are built in parallel.
+    const uint32_t kParallelSubtreeThreshold = 4096;
+
+    // Triangle count above which the split axes of a node are binned in parallel.
+    const uint32_t kParallelBinningThreshold = 65536;
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -215,12 +224,109 @@ namespace
         const float3 dims = max(float3(epsilon), bb.extent());
         return dims.x * dims.y * dims.z;
     }
+
+    /** Calls a function for each axis to evaluate splits along, in parallel if requested.
+    */
+    template<typename Func>
+    void forEachSplitAxis(bool splitAlongLargest, uint32_t largestDimension, bool parallel, const Func& func)
+    {
+        if (splitAlongLargest)
+        {
+            func(largestDimension);
+        }
+        else if (parallel)
+        {
+            Threading::parallelFor(0, 3, 1, [&](size_t begin, size_t end) { for (size_t dimension = begin; dimension < end; ++dimension) func((uint32_t)dimension); });
+        }
+        else
+        {
+            for (uint32_t dimension = 0; dimension < 3; ++dimension) func(dimension);
+        }
+    }
+
+    /** Computes the bin index of each triangle of a node, in parallel if requested.
+    */
+    template<typename Func>
+    void computeBinIds(std::vector<uint32_t>& binIds, uint32_t triangleCount, bool parallel, const Func& getBinId)
+    {
+        binIds.resize(triangleCount);
+        auto compute = [&](size_t begin, size_t end) { for (size_t i = begin; i < end; ++i) binIds[i] = getBinId((uint32_t)i); };
+        if (parallel) Threading::parallelFor(0, triangleCount, 0, compute);
+        else compute(0, triangleCount);
+    }
+
+    /** Offset the child index of an internal node or the triangle offset of a leaf node.
+        The packed value is offset directly, as unpacking and repacking the node attributes is lossy.
+    */
+    void offsetNode(PackedNode& node, uint32_t nodeOffset, uint32_t triangleOffset)
+    {
+        if (node.isLeaf())
+        {
+            FALCOR_ASSERT(node.getLeafNode().triangleOffset + triangleOffset < kMaxLeafTriangleOffset);
+            node.data[0].x += triangleOffset;
+        }
+        else
+        {
+            node.data[0].x += nodeOffset;
+        }
+    }
 }
 
 namespace Falcor
 {
     static_assert(sizeof(PackedNode) % 16 == 0, "PackedNode size should be a multiple of 16");
 
+    struct LightBVHBuilder::BuildScratch
+    {
+        struct SAHBin
+        {
+            AABB bounds;
+            uint32_t triangleCount = 0;
+
+            SAHBin() = default;
+            SAHBin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1) {}
+            SAHBin& operator|= (const SAHBin& rhs)
+            {
+                bounds |= rhs.bounds;
+                triangleCount += rhs.triangleCount;
+                return *this;
+            }
+        };
+
+        struct SAOHBin
+        {
+            AABB bounds;
+            uint32_t triangleCount = 0;
+            float flux = 0.0f;
+            float3 coneDirection = float3(0.0f);
+            float cosConeAngle = 1.0f;
+
+            SAOHBin() = default;
+            SAOHBin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1), flux(tri.flux), coneDirection(tri.coneDirection), cosConeAngle(tri.cosConeAngle) {}
+            SAOHBin& operator|= (const SAOHBin& rhs)
+            {
+                bounds |= rhs.bounds;
+                triangleCount += rhs.triangleCount;
+                flux += rhs.flux;
+                coneDirection += rhs.coneDirection;
+                // Note: cosConeAngle should be computed separately after the final cone direction is known
+                return *this;
+            }
+        };
+
+        /** Scratch memory for evaluating splits along one axis. Each axis has its own so the axes can be binned in parallel.
+        */
+        struct Axis
+        {
+            std::vector<uint32_t> binIds;       ///< Bin index of each triangle of the node.
+            std::vector<SAHBin> sahBins;
+            std::vector<SAOHBin> saohBins;
+            std::vector<float> costs;
+        };
+
+        std::array<Axis, 3> axes;
+    };
+
     LightBVHBuilder::LightBVHBuilder(const Options& options) : mOptions(options)
     {
     }
@@ -246,18 +352,7 @@ namespace Falcor
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                data.trianglesData.push_back(createTriangleSortData(triangles[i], static_cast<uint32_t>(i)));
             }
         }
 
@@ -278,16 +373,19 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
-        data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
+        Subtree tree;
+        tree.nodes.reserve(2 * data.trianglesData.size());
+        tree.triangleIndices.reserve(data.trianglesData.size());
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        BuildScratch scratch;
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, tree, scratch);
+        data.nodes = std::move(tree.nodes);
+        data.triangleIndices = std::move(tree.triangleIndices);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
@@ -302,10 +400,232 @@ namespace Falcor
         // The BVH is ready, mark it as valid and upload the data.
         bvh.mIsValid = true;
         bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+        bvh.uploadCPUBuffers();
 
         // Computate metadata.
         bvh.finalize();
+
+        // Record the quality of the fresh BVH, against which incremental updates are measured.
+        bvh.computeSubtreeCosts(bvh.mSubtreeCostsAtBuild);
+        bvh.mBVHStats.saohCostAtBuild = bvh.mBVHStats.saohCost;
+    }
+
+    void LightBVHBuilder::updateIncremental(RenderContext* pRenderContext, LightBVH& bvh, const std::vector<uint32_t>& updatedLights)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::updateIncremental()");
+
+        if (!bvh.isValid()) return;
+        const auto startTime = CpuTimer::getCurrentTimePoint();
+
+        bvh.refitIncremental(pRenderContext, updatedLights);
+
+        // Checking the quality needs the nodes on the CPU, so it is only done periodically.
+        if (++bvh.mRefitsSinceQualityCheck >= std::max(mOptions.qualityCheckInterval, 1u))
+        {
+            bvh.mRefitsSinceQualityCheck = 0;
+            if (!rebuildDegradedSubtrees(pRenderContext, bvh))
+            {
+                build(pRenderContext, bvh);
+                return;
+            }
+        }
+
+        ++bvh.mBVHStats.incrementalRefitCount;
+        bvh.mBVHStats.incrementalUpdateTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    bool LightBVHBuilder::rebuildDegradedSubtrees(RenderContext* pRenderContext, LightBVH& bvh)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::rebuildDegradedSubtrees()");
+
+        // The leaf size is baked into the BVH stats, so a changed leaf size needs a full rebuild.
+        // So do too many nodes left unreferenced by earlier rebuilds.
+        if (bvh.mMaxTriangleCountPerLeaf != mOptions.maxTriangleCountPerLeaf) return false;
+        if (2 * bvh.mBVHStats.garbageNodeCount > bvh.mNodes.size()) return false;
+
+        bvh.syncDataToCPU();
+        bvh.computeStats();
+        std::vector<float> subtreeCosts;
+        bvh.computeSubtreeCosts(subtreeCosts);
+
+        // Select the topmost touched subtrees whose relative cost degraded past the threshold.
+        // 'mNodeIndices' is sorted by depth, so ancestors are visited before their descendants.
+        std::vector<uint32_t> degradedNodes;
+        std::vector<uint8_t> isDegraded(bvh.mNodes.size(), 0);
+        for (uint32_t nodeIndex : bvh.mNodeIndices)
+        {
+            if (bvh.mNodes[nodeIndex].isLeaf() || !(bvh.mNodeFlags[nodeIndex] & LightBVH::kNodeTouched)) continue;
+            if (subtreeCosts[nodeIndex] <= mOptions.rebuildThreshold * bvh.mSubtreeCostsAtBuild[nodeIndex]) continue;
+
+            bool hasDegradedAncestor = false;
+            for (uint32_t parentIndex = bvh.mParentIndices[nodeIndex]; parentIndex != LightBVH::kInvalidNode && !hasDegradedAncestor; parentIndex = bvh.mParentIndices[parentIndex])
+            {
+                hasDegradedAncestor = isDegraded[parentIndex];
+            }
+            if (hasDegradedAncestor) continue;
+
+            isDegraded[nodeIndex] = 1;
+            degradedNodes.push_back(nodeIndex);
+        }
+        for (uint8_t& flags : bvh.mNodeFlags) flags &= (uint8_t)~LightBVH::kNodeTouched;
+
+        if (degradedNodes.empty()) return true;
+
+        // Rebuilding the root or most of the triangles is better done by a full rebuild.
+        if (isDegraded[0]) return false;
+        uint32_t degradedTriangleCount = 0;
+        for (uint32_t nodeIndex : degradedNodes)
+        {
+            bvh.traverseBVH(
+                [](const LightBVH::NodeLocation& location) { return true; },
+                [&](const LightBVH::NodeLocation& location) { degradedTriangleCount += bvh.mNodes[location.nodeIndex].getLeafNode().triangleCount; return true; },
+                nodeIndex
+            );
+        }
+        if (2 * degradedTriangleCount > bvh.mBVHStats.triangleCount) return false;
+
+        std::vector<uint32_t> rebuiltNodes;
+        rebuiltNodes.reserve(degradedNodes.size());
+        for (uint32_t nodeIndex : degradedNodes)
+        {
+            uint32_t newNodeIndex;
+            if (!rebuildSubtree(pRenderContext, bvh, nodeIndex, newNodeIndex)) return false;
+            rebuiltNodes.push_back(newNodeIndex);
+        }
+
+        // Upload the rebuilt subtrees and recompute the metadata.
+        bvh.uploadCPUBuffers();
+        bvh.finalize();
+
+        // Reset the reference cost of the rebuilt subtrees.
+        bvh.computeSubtreeCosts(subtreeCosts);
+        bvh.mSubtreeCostsAtBuild.resize(bvh.mNodes.size(), 0.f);
+        for (uint32_t nodeIndex : rebuiltNodes)
+        {
+            bvh.traverseBVH(
+                [&](const LightBVH::NodeLocation& location) { bvh.mSubtreeCostsAtBuild[location.nodeIndex] = subtreeCosts[location.nodeIndex]; return true; },
+                [](const LightBVH::NodeLocation& location) { return true; },
+                nodeIndex
+            );
+        }
+
+        // The bounds and flux of the ancestors are unchanged, but their lighting cones are refitted to the rebuilt subtrees.
+        bvh.refitPaths(pRenderContext, rebuiltNodes);
+
+        return true;
+    }
+
+    bool LightBVHBuilder::rebuildSubtree(RenderContext* pRenderContext, LightBVH& bvh, uint32_t nodeIndex, uint32_t& newNodeIndex)
+    {
+        // Find the nodes and the triangles of the subtree. The triangles of a subtree are stored contiguously.
+        uint32_t nodeCount = 0;
+        uint32_t lastNodeIndex = nodeIndex;
+        uint32_t triangleOffset = std::numeric_limits<uint32_t>::max();
+        uint32_t triangleCount = 0;
+        bvh.traverseBVH(
+            [&](const LightBVH::NodeLocation& location)
+            {
+                ++nodeCount;
+                lastNodeIndex = std::max(lastNodeIndex, location.nodeIndex);
+                return true;
+            },
+            [&](const LightBVH::NodeLocation& location)
+            {
+                const auto node = bvh.mNodes[location.nodeIndex].getLeafNode();
+                ++nodeCount;
+                lastNodeIndex = std::max(lastNodeIndex, location.nodeIndex);
+                triangleOffset = std::min(triangleOffset, node.triangleOffset);
+                triangleCount += node.triangleCount;
+                return true;
+            },
+            nodeIndex
+        );
+        FALCOR_ASSERT(triangleCount > 0);
+
+        // Prepare the triangles with their current positions.
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
+        Subtree subtree;
+        BuildingData data(subtree.nodes);
+        data.trianglesData.reserve(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            const uint32_t triangleIndex = bvh.mTriangleIndices[triangleOffset + i];
+            data.trianglesData.push_back(createTriangleSortData(triangles[triangleIndex], triangleIndex));
+        }
+
+        // Build the subtree below the path to its root node.
+        // The bitmasks are indexed by global triangle index, so the whole array is moved in and out.
+        const uint32_t depth = bvh.mNodeDepths[nodeIndex];
+        FALCOR_ASSERT(depth > 0 && depth < kMaxBVHDepth);
+        const uint64_t bitmask = bvh.mTriangleBitmasks[data.trianglesData[0].triangleIndex] & ((1ull << depth) - 1);
+
+        data.triangleBitmasks = std::move(bvh.mTriangleBitmasks);
+        try
+        {
+            SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+            BuildScratch scratch;
+            buildInternal(mOptions, splitFunc, bitmask, depth, Range(0, triangleCount), data, subtree, scratch);
+        }
+        catch (...)
+        {
+            bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+            throw;
+        }
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+
+        float cosConeAngle;
+        computeLightingConesInternal(0, data, cosConeAngle);
+
+        // Place the subtree over the old one if that is contiguous and large enough. Otherwise move it to the end of the
+        // node list, which is only possible for right children as left children are stored right after their parent.
+        const uint32_t newNodeCount = (uint32_t)subtree.nodes.size();
+        const uint32_t parentIndex = bvh.mParentIndices[nodeIndex];
+        FALCOR_ASSERT(parentIndex != LightBVH::kInvalidNode);
+        if (lastNodeIndex - nodeIndex + 1 == nodeCount && newNodeCount <= nodeCount)
+        {
+            newNodeIndex = nodeIndex;
+            bvh.mBVHStats.garbageNodeCount += nodeCount - newNodeCount;
+        }
+        else if (nodeIndex != parentIndex + 1)
+        {
+            newNodeIndex = (uint32_t)bvh.mNodes.size();
+            bvh.mNodes.resize(bvh.mNodes.size() + newNodeCount);
+            bvh.mNodes[parentIndex].data[0].x = newNodeIndex;
+            bvh.mBVHStats.garbageNodeCount += nodeCount;
+        }
+        else
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < newNodeCount; ++i)
+        {
+            PackedNode node = subtree.nodes[i];
+            offsetNode(node, newNodeIndex, triangleOffset);
+            bvh.mNodes[newNodeIndex + i] = node;
+        }
+        std::copy(subtree.triangleIndices.begin(), subtree.triangleIndices.end(), bvh.mTriangleIndices.begin() + triangleOffset);
+
+        ++bvh.mBVHStats.subtreeRebuildCount;
+        bvh.mBVHStats.subtreeRebuildTriangleCount += triangleCount;
+        return true;
+    }
+
+    LightBVHBuilder::TriangleSortData LightBVHBuilder::createTriangleSortData(const ILightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex)
+    {
+        TriangleSortData tri;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            tri.bounds |= triangle.vtx[j].pos;
+        }
+        tri.center = triangle.getCenter();
+        tri.coneDirection = triangle.normal;
+        tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        tri.flux = triangle.flux;
+        tri.triangleIndex = triangleIndex;
+        return tri;
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -319,7 +639,18 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.checkbox("Allow incremental updates", options.allowIncrementalUpdates);
+            widget.tooltip("Only refit the nodes affected by the updated lights, and rebuild the subtrees whose SAOH cost degraded too much.");
+            if (options.allowIncrementalUpdates)
+            {
+                optionsChanged |= widget.var("Rebuild threshold", options.rebuildThreshold, 1.f, 100.f, 0.1f);
+                optionsChanged |= widget.var("Quality check interval", options.qualityCheckInterval, 1u, 1024u);
+            }
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
+        optionsChanged |= widget.checkbox("Use parallel build", options.useParallelBuild);
         optionsChanged |= widget.dropdown("Split heuristic", options.splitHeuristicSelection);
 
         if (auto splitGroup = widget.group("Split Options", true))
@@ -349,7 +680,7 @@ namespace Falcor
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree, BuildScratch& scratch)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
@@ -363,10 +694,8 @@ namespace Falcor
         }
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options, scratch) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -378,9 +707,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -394,13 +723,42 @@ namespace Falcor
                 FALCOR_THROW("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex, rightIndex;
+            if (options.useParallelBuild && triangleRange.length() >= kParallelSubtreeThreshold)
+            {
+                // Build the right subtree in a separate task into its own output, and append it once the left subtree is done.
+                // This places all nodes and triangle indices exactly where the serial build would.
+                Subtree rightSubtree;
+                Threading::Task rightTask = Threading::dispatchTask([&]()
+                {
+                    BuildScratch rightScratch;
+                    buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightSubtree, rightScratch);
+                });
+                try
+                {
+                    leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, subtree, scratch);
+                }
+                catch (...)
+                {
+                    // The right task references this stack frame, wait for it before propagating the error.
+                    try { rightTask.finish(); } catch (...) {}
+                    throw;
+                }
+                rightTask.finish();
+                rightIndex = appendSubtree(subtree, rightSubtree);
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, subtree, scratch);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, subtree, scratch);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            subtree.nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -408,9 +766,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,23 +778,40 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)subtree.triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                subtree.triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(subtree.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            subtree.nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
+    uint32_t LightBVHBuilder::appendSubtree(Subtree& subtree, const Subtree& other)
+    {
+        FALCOR_ASSERT(subtree.nodes.size() + other.nodes.size() < std::numeric_limits<uint32_t>::max());
+        const uint32_t nodeOffset = (uint32_t)subtree.nodes.size();
+        const uint32_t triangleOffset = (uint32_t)subtree.triangleIndices.size();
+
+        subtree.nodes.reserve(subtree.nodes.size() + other.nodes.size());
+        for (PackedNode node : other.nodes)
+        {
+            offsetNode(node, nodeOffset, triangleOffset);
+            subtree.nodes.push_back(node);
+        }
+        subtree.triangleIndices.insert(subtree.triangleIndices.end(), other.triangleIndices.begin(), other.triangleIndices.end());
+
+        return nodeOffset;
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
@@ -497,7 +872,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/, BuildScratch& /*scratch*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -524,55 +899,54 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
 
-        struct Bin
-        {
-            AABB bounds;
-            uint32_t triangleCount = 0;
-
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1) {}
-            Bin& operator|= (const Bin& rhs)
-            {
-                bounds |= rhs.bounds;
-                triangleCount += rhs.triangleCount;
-                return *this;
-            }
-        };
+        // Find the largest dimension.
+        float3 dimensions = nodeBounds.extent();
+        uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
+            2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
 
+        using Bin = BuildScratch::SAHBin;
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const bool parallel = parameters.useParallelBuild && triangleRange.length() >= kParallelBinningThreshold;
+
+        // Best split per dimension. Dimensions that are not evaluated keep an invalid split.
+        std::array<std::pair<float, SplitResult>, 3> axisBestSplits;
+        axisBestSplits.fill(std::make_pair(std::numeric_limits<float>::infinity(), SplitResult()));
 
         /** Helper function that computes the best split along the given dimension using the SAH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
             Then the cost metric is evaluated for each of the n-1 potential splits.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto binAlongDimension = [&](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
+            auto& bins = scratch.axes[dimension].sahBins;
+            auto& costs = scratch.axes[dimension].costs;
+            auto& binIds = scratch.axes[dimension].binIds;
+
+            // Compute the bin id for each triangle.
+            computeBinIds(binIds, triangleRange.length(), parallel, [&](uint32_t i)
             {
+                const auto& td = data.trianglesData[triangleRange.begin + i];
                 float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
                 FALCOR_ASSERT(bmin < bmax);
                 float scale = (float)parameters.binCount / (bmax - bmin);
                 float p = td.bounds.center()[dimension];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
+            });
 
             // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
+            bins.assign(parameters.binCount, Bin());
+            costs.resize(parameters.binCount - 1);
 
             // Fill the bins with all triangles.
             for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
             {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                bins[binIds[i - triangleRange.begin]] |= data.trianglesData[i];
             }
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
@@ -604,32 +978,24 @@ namespace Falcor
             }
             FALCOR_ASSERT(triangleRange.begin <= axisBestSplit.second.triangleIndex && axisBestSplit.second.triangleIndex <= triangleRange.end);
 
-            // Early out if all lights fall on either side of the split.
+            axisBestSplits[dimension] = axisBestSplit;
+        };
+
+        // Compute the best split per dimension, then pick the best one in dimension order.
+        forEachSplitAxis(parameters.splitAlongLargest, largestDimension, parallel, binAlongDimension);
+        for (const auto& axisBestSplit : axisBestSplits)
+        {
+            if (!axisBestSplit.second.isValid()) continue;
+
+            // Skip if all lights fall on either side of the split.
             if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
+                axisBestSplit.second.triangleIndex == triangleRange.end) continue;
 
             if (axisBestSplit.first < overallBestSplit.first)
             {
                 overallBestSplit = axisBestSplit;
                 FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
             }
-        };
-
-        if (parameters.splitAlongLargest)
-        {
-            // Find the largest dimension.
-            float3 dimensions = nodeBounds.extent();
-            uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
-                2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
-
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -637,7 +1003,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters, scratch);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -651,19 +1017,6 @@ namespace Falcor
         return overallBestSplit.second;
     }
 
-    /** Utility function that implements the orientation cost heuristic according to Equation 1
-        in Conty & Kulla, "Importance Sampling of Many Lights with Adaptive Tree Splitting", 2018.
-        We're assuming flat diffuse emitters (theta_e = pi/2). For this case the orientation cost
-        varies smoothly between pi (flat emitter) to 4pi (full sphere).
-    */
-    static float computeOrientationCost(const float theta_o)
-    {
-        float theta_w = std::min(theta_o + float(M_PI_2), float(M_PI));
-        float sin_theta_o = std::sin(theta_o);
-        float cos_theta_o = std::cos(theta_o);
-        return float(M_2PI) * (1.0f - cos_theta_o) + float(M_PI_2) * (2.0f * theta_w * sin_theta_o - std::cos(theta_o - 2.0f * theta_w) - 2.0f * theta_o * sin_theta_o + cos_theta_o);
-    };
-
     /** Evaluates the SAOH cost metric for a node.
         If the node is empty (invalid bounds), the cost evaluates to zero.
         See Eqn 16 in Moreau and Clarberg, "Importance Sampling of Many Lights on the GPU", Ray Tracing Gems, Ch. 18, 2019.
@@ -673,13 +1026,13 @@ namespace Falcor
         float fluxCost = parameters.usePreintegration ? flux : 1.0f;
         float aabbCost = bounds.valid() ? (parameters.useVolumeOverSA ? aabbVolume(bounds, parameters.volumeEpsilon) : bounds.area()) : 0.f;
         float theta = cosTheta != kInvalidCosConeAngle ? safeACos(cosTheta) : float(M_PI);
-        float orientationCost = parameters.useLightingCones ? computeOrientationCost(theta) : 1.0f;
+        float orientationCost = parameters.useLightingCones ? LightBVH::computeOrientationCost(theta) : 1.0f;
         float cost = fluxCost * aabbCost * orientationCost;
         FALCOR_ASSERT(cost >= 0.f && !std::isnan(cost) && !std::isinf(cost));
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -689,30 +1042,13 @@ namespace Falcor
         uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
             2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
 
-        struct Bin
-        {
-            AABB bounds;
-            uint32_t triangleCount = 0;
-            float flux = 0.0f;
-            float3 coneDirection = float3(0.0f);
-            float cosConeAngle = 1.0f;
-
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1), flux(tri.flux), coneDirection(tri.coneDirection), cosConeAngle(tri.cosConeAngle) {}
-            Bin& operator|= (const Bin& rhs)
-            {
-                bounds |= rhs.bounds;
-                triangleCount += rhs.triangleCount;
-                flux += rhs.flux;
-                coneDirection += rhs.coneDirection;
-                // Note: cosConeAngle should be computed separately after the final cone direction is known
-                return *this;
-            }
-        };
-
+        using Bin = BuildScratch::SAOHBin;
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const bool parallel = parameters.useParallelBuild && triangleRange.length() >= kParallelBinningThreshold;
+
+        // Best split per dimension. Dimensions that are not evaluated keep an invalid split.
+        std::array<std::pair<float, SplitResult>, 3> axisBestSplits;
+        axisBestSplits.fill(std::make_pair(std::numeric_limits<float>::infinity(), SplitResult()));
 
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
@@ -721,11 +1057,16 @@ namespace Falcor
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto binAlongDimension = [&](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
+            auto& bins = scratch.axes[dimension].saohBins;
+            auto& costs = scratch.axes[dimension].costs;
+            auto& binIds = scratch.axes[dimension].binIds;
+
+            // Compute the bin id for each triangle.
+            computeBinIds(binIds, triangleRange.length(), parallel, [&](uint32_t i)
             {
+                const auto& td = data.trianglesData[triangleRange.begin + i];
                 float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
                 float w = bmax - bmin;
                 FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
@@ -733,16 +1074,16 @@ namespace Falcor
                 float p = td.bounds.center()[dimension];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
+            });
 
             // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
+            bins.assign(parameters.binCount, Bin());
+            costs.resize(parameters.binCount - 1);
 
             // Fill the bins with all triangles.
             for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
             {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                bins[binIds[i - triangleRange.begin]] |= data.trianglesData[i];
             }
 
             // Compute the lighting cones for each bin.
@@ -757,7 +1098,7 @@ namespace Falcor
             for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
             {
                 const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
+                Bin& bin = bins[binIds[i - triangleRange.begin]];
                 bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
             }
 
@@ -819,28 +1160,24 @@ namespace Falcor
             // Scale the cost by the ratio of the node's extent to discourage long skinny nodes.
             axisBestSplit.first *= static_cast<float>(dimensions[largestDimension]) / static_cast<float>(dimensions[dimension]);
 
-            // Early out if all lights fall on either side of the split.
+            axisBestSplits[dimension] = axisBestSplit;
+        };
+
+        // Compute the best split per dimension, then pick the best one in dimension order.
+        forEachSplitAxis(parameters.splitAlongLargest, largestDimension, parallel, binAlongDimension);
+        for (const auto& axisBestSplit : axisBestSplits)
+        {
+            if (!axisBestSplit.second.isValid()) continue;
+
+            // Skip if all lights fall on either side of the split.
             if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
+                axisBestSplit.second.triangleIndex == triangleRange.end) continue;
 
             if (axisBestSplit.first < overallBestSplit.first)
             {
                 overallBestSplit = axisBestSplit;
                 FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
             }
-        };
-
-        // Compute the best split.
-        if (parameters.splitAlongLargest)
-        {
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -848,7 +1185,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters, scratch);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -858,7 +1195,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
@@ -44,6 +44,13 @@ namespace Falcor
         The building process can be customized via the |Options|,
         which are also available in the GUI via the |renderUI()| function.
 
+        Large subtrees are built in parallel and the split binning of large nodes is
+        parallelized over the split axes, unless 'useParallelBuild' is disabled.
+        The resulting tree is bit-identical to a serial build.
+
+        When only some lights move, updateIncremental() refits the affected nodes only, and
+        periodically rebuilds subtrees whose SAOH cost degraded past 'rebuildThreshold'.
+
         TODO: Rename all things triangle* to light* as the BVH class can be used for other types.
     */
     class FALCOR_API LightBVHBuilder
@@ -78,6 +85,10 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           allowIncrementalUpdates = false;                      ///< When refitting, only refit the nodes affected by the updated lights and locally rebuild degraded subtrees. Only valid when 'allowRefitting' is enabled. Disabled by default as the periodic quality checks read back the BVH nodes, which stalls the pipeline.
+            float          rebuildThreshold = 1.5f;                              ///< Rebuild a subtree when its relative SAOH cost grows past this factor of its cost when it was built.
+            uint32_t       qualityCheckInterval = 16;                            ///< Number of incremental updates between checks of the subtree quality. Each check reads back the BVH nodes.
+            bool           useParallelBuild = true;                              ///< Build large subtrees and bin the split axes of large nodes in parallel. The result is identical to a serial build.
 
             template<typename Archive>
             void serialize(Archive& ar)
@@ -93,6 +104,10 @@ namespace Falcor
                 ar("allowRefitting", allowRefitting);
                 ar("usePreintegration", usePreintegration);
                 ar("useLightingCones", useLightingCones);
+                ar("allowIncrementalUpdates", allowIncrementalUpdates);
+                ar("rebuildThreshold", rebuildThreshold);
+                ar("qualityCheckInterval", qualityCheckInterval);
+                ar("useParallelBuild", useParallelBuild);
             }
         };
 
@@ -106,6 +121,15 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Update the BVH after some lights have changed.
+            Only the nodes affected by the updated lights are refitted. Every 'qualityCheckInterval' updates, the touched
+            subtrees whose SAOH cost degraded past 'rebuildThreshold' are rebuilt, or the whole BVH if they are too large.
+            \param[in] pRenderContext The render context.
+            \param[in,out] bvh The light BVH to update. It needs to have been built before.
+            \param[in] updatedLights Indices of the mesh lights whose triangles have changed.
+        */
+        void updateIncremental(RenderContext* pRenderContext, LightBVH& bvh, const std::vector<uint32_t>& updatedLights);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -149,18 +173,49 @@ namespace Falcor
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
         };
 
+        /** Output of building a subtree.
+            Node indices and leaf triangle offsets are relative to the subtree. Subtrees built in parallel are appended to their parent's output.
+        */
+        struct Subtree
+        {
+            std::vector<PackedNode> nodes;                  ///< Nodes in depth-first order.
+            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node.
+        };
+
+        /** Scratch memory for computing splits (bins, costs, bin indices), reused for all nodes built by a task.
+        */
+        struct BuildScratch;
+
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node, used for the leaf creation cost.
             \param[in] parameters Various parameters defining how the building should occur.
+            \param[in,out] scratch Scratch memory.
+        */
+        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch)>;
+
+        /** Create the build data of a triangle.
+        */
+        static TriangleSortData createTriangleSortData(const ILightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex);
+
+        /** Rebuild the touched subtrees whose SAOH cost degraded past the rebuild threshold.
+            \return False if the whole BVH needs to be rebuilt instead.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        bool rebuildDegradedSubtrees(RenderContext* pRenderContext, LightBVH& bvh);
+
+        /** Rebuild a subtree over the same triangles with their current positions.
+            The subtree is rebuilt in place if it fits, and otherwise moved to the end of the node list.
+            \param[in] nodeIndex Index of the root node of the subtree.
+            \param[out] newNodeIndex Index of the root node of the rebuilt subtree.
+            \return False if the rebuilt subtree could not be placed.
+        */
+        bool rebuildSubtree(RenderContext* pRenderContext, LightBVH& bvh, uint32_t nodeIndex, uint32_t& newNodeIndex);
 
         /** Renders the UI with builder options.
         */
@@ -172,9 +227,16 @@ namespace Falcor
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] subtree Output the nodes and triangle indices are appended to.
+            \param[in,out] scratch Scratch memory of the calling task.
+            \return Index of the allocated node, relative to the subtree.
+        */
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree, BuildScratch& scratch);
+
+        /** Append a subtree to another subtree, offsetting its node indices and triangle offsets.
+            \return Index of the root node of the appended subtree.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        static uint32_t appendSubtree(Subtree& subtree, const Subtree& other);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -193,9 +255,9 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/, BuildScratch& /*scratch*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
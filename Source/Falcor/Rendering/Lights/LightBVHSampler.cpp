@@ -43,6 +43,7 @@ namespace Falcor
         if (mpLightCollection != pLightCollection)
         {
             setLightCollection(std::move(pLightCollection));
+            connectUpdatedLights();
             mNeedsRebuild = true;
             mpBVH = std::make_unique<LightBVH>(mpDevice, mpLightCollection);
         }
@@ -68,13 +69,33 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            if (mOptions.buildOptions.allowIncrementalUpdates) mpBVHBuilder->updateIncremental(pRenderContext, *mpBVH, mUpdatedLights);
+            else mpBVH->refit(pRenderContext);
             samplerChanged = true;
         }
+        mUpdatedLights.clear();
 
         return samplerChanged;
     }
 
+    void LightBVHSampler::connectUpdatedLights()
+    {
+        mUpdatedLights.clear();
+        mUpdatedLightsConnection.reset();
+
+        if (mpLightCollection)
+        {
+            mUpdatedLightsConnection = mpLightCollection->getUpdateFlagsSignal().connect([&](ILightCollection::UpdateFlags flags)
+            {
+                if (is_set(flags, ILightCollection::UpdateFlags::MatrixChanged))
+                {
+                    const auto& updatedLights = mpLightCollection->getUpdatedLights();
+                    mUpdatedLights.insert(mUpdatedLights.end(), updatedLights.begin(), updatedLights.end());
+                }
+            });
+        }
+    }
+
     DefineList LightBVHSampler::getDefines() const
     {
         // Call the base class first.
@@ -156,5 +177,6 @@ namespace Falcor
         // Create the BVH and builder.
         mpBVHBuilder = std::make_unique<LightBVHBuilder>(mOptions.buildOptions);
         mpBVH = std::make_unique<LightBVH>(mpDevice, mpLightCollection);
+        connectUpdatedLights();
     }
 }
@@ -120,6 +120,8 @@ namespace Falcor
         void setOptions(const Options& options);
 
     protected:
+        void connectUpdatedLights();
+
         /// Configuration options.
         Options mOptions;
 
@@ -127,6 +129,10 @@ namespace Falcor
         std::unique_ptr<LightBVHBuilder> mpBVHBuilder;
         std::unique_ptr<LightBVH> mpBVH;
 
+        /// Lights updated since the last call to update(), accumulated from the light collection's update signal.
+        std::vector<uint32_t> mUpdatedLights;
+        sigs::Connection mUpdatedLightsConnection;
+
         /// Trigger rebuild on the next call to update(). We should always build on the first call, so the initial value is true.
         bool mNeedsRebuild = true;
     };
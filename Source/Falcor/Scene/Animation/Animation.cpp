@@ -31,6 +31,13 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Scene/Transform.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define ANIMATION_SSE2 1
+#endif
 
 namespace Falcor
 {
@@ -103,6 +110,135 @@ namespace Falcor
             result.time = math::lerp(k1.time, k2.time, (double)t);
             return result;
         }
+
+        constexpr size_t kLaneCount = 4;
+
+        /** Interpolation inputs of a batch of animations, indexed by [...][lane].
+        */
+        struct alignas(16) SampleBlock
+        {
+            float translation[2][3][kLaneCount];
+            float scaling[2][3][kLaneCount];
+            float rotation[2][4][kLaneCount];
+            float t[kLaneCount];
+            float rotationWeight[2][kLaneCount];
+            float rotationScale[kLaneCount];
+        };
+
+        /** Compute weights such that slerp(q0, q1, t) = (w0 * q0 + w1 * q1) / scale.
+            Follows the same steps as slerp() so batched and single animations produce the same result.
+        */
+        void computeSlerpWeights(const quatf& q0, const quatf& q1, float t, float& w0, float& w1, float& scale)
+        {
+            float cosTheta = dot(q0, q1);
+            float sign = 1.f;
+            if (cosTheta < 0.f)
+            {
+                sign = -1.f;
+                cosTheta = -cosTheta;
+            }
+
+            if (cosTheta > 1.f - std::numeric_limits<float>::epsilon())
+            {
+                w0 = 1.f - t;
+                w1 = sign * t;
+                scale = 1.f;
+            }
+            else
+            {
+                float angle = std::acos(cosTheta);
+                w0 = std::sin((1.f - t) * angle);
+                w1 = sign * std::sin(t * angle);
+                scale = std::sin(angle);
+            }
+        }
+
+#if ANIMATION_SSE2
+        /** Blend the interpolation inputs and compose the transforms T * R * S of four animations.
+            Each matrix row is computed for all lanes and transposed into the per-lane matrices.
+        */
+        void composeTransforms(const SampleBlock& block, float4x4* pMatrices)
+        {
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 two = _mm_set1_ps(2.f);
+            const __m128 t = _mm_load_ps(block.t);
+            const __m128 s = _mm_sub_ps(one, t);
+
+            auto lerp = [&](const float* p0, const float* p1) { return _mm_add_ps(_mm_mul_ps(s, _mm_load_ps(p0)), _mm_mul_ps(t, _mm_load_ps(p1))); };
+
+            __m128 translation[3], scaling[3], q[4];
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                translation[axis] = lerp(block.translation[0][axis], block.translation[1][axis]);
+                scaling[axis] = lerp(block.scaling[0][axis], block.scaling[1][axis]);
+            }
+            const __m128 w0 = _mm_load_ps(block.rotationWeight[0]);
+            const __m128 w1 = _mm_load_ps(block.rotationWeight[1]);
+            const __m128 rotationScale = _mm_load_ps(block.rotationScale);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                q[c] = _mm_div_ps(_mm_add_ps(_mm_mul_ps(w0, _mm_load_ps(block.rotation[0][c])), _mm_mul_ps(w1, _mm_load_ps(block.rotation[1][c]))), rotationScale);
+            }
+
+            // Rotation matrix, see math::matrixFromQuat().
+            const __m128 qxx = _mm_mul_ps(q[0], q[0]);
+            const __m128 qyy = _mm_mul_ps(q[1], q[1]);
+            const __m128 qzz = _mm_mul_ps(q[2], q[2]);
+            const __m128 qxz = _mm_mul_ps(q[0], q[2]);
+            const __m128 qxy = _mm_mul_ps(q[0], q[1]);
+            const __m128 qyz = _mm_mul_ps(q[1], q[2]);
+            const __m128 qwx = _mm_mul_ps(q[3], q[0]);
+            const __m128 qwy = _mm_mul_ps(q[3], q[1]);
+            const __m128 qwz = _mm_mul_ps(q[3], q[2]);
+
+            __m128 rows[3][4];
+            rows[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz)));
+            rows[0][1] = _mm_mul_ps(two, _mm_sub_ps(qxy, qwz));
+            rows[0][2] = _mm_mul_ps(two, _mm_add_ps(qxz, qwy));
+            rows[1][0] = _mm_mul_ps(two, _mm_add_ps(qxy, qwz));
+            rows[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz)));
+            rows[1][2] = _mm_mul_ps(two, _mm_sub_ps(qyz, qwx));
+            rows[2][0] = _mm_mul_ps(two, _mm_sub_ps(qxz, qwy));
+            rows[2][1] = _mm_mul_ps(two, _mm_add_ps(qyz, qwx));
+            rows[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy)));
+
+            for (uint32_t r = 0; r < 3; ++r)
+            {
+                for (uint32_t c = 0; c < 3; ++c) rows[r][c] = _mm_mul_ps(rows[r][c], scaling[c]);
+                rows[r][3] = translation[r];
+                _MM_TRANSPOSE4_PS(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+                for (uint32_t lane = 0; lane < kLaneCount; ++lane) _mm_storeu_ps(pMatrices[lane].data() + 4 * r, rows[r][lane]);
+            }
+            for (uint32_t lane = 0; lane < kLaneCount; ++lane) pMatrices[lane].setRow(3, float4(0.f, 0.f, 0.f, 1.f));
+        }
+#else
+        void composeTransforms(const SampleBlock& block, float4x4* pMatrices)
+        {
+            for (size_t lane = 0; lane < kLaneCount; ++lane)
+            {
+                const float t = block.t[lane];
+                float3 translation, scaling;
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    translation[axis] = math::lerp(block.translation[0][axis][lane], block.translation[1][axis][lane], t);
+                    scaling[axis] = math::lerp(block.scaling[0][axis][lane], block.scaling[1][axis][lane], t);
+                }
+                quatf q;
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    q[c] = (block.rotationWeight[0][lane] * block.rotation[0][c][lane] + block.rotationWeight[1][lane] * block.rotation[1][c][lane]) / block.rotationScale[lane];
+                }
+
+                float4x4 m = math::matrixFromQuat(q);
+                for (uint32_t r = 0; r < 3; ++r)
+                {
+                    for (uint32_t c = 0; c < 3; ++c) m[r][c] *= scaling[c];
+                    m[r][3] = translation[r];
+                }
+                pMatrices[lane] = m;
+            }
+        }
+#endif
     }
 
     Animation::Animation(std::string_view name, NodeID nodeID, double duration)
@@ -113,98 +249,153 @@ namespace Falcor
 
     float4x4 Animation::animate(double currentTime)
     {
+        Sample s = sample(currentTime);
+
+        float4x4 T = math::matrixFromTranslation(s.blend ? lerp(s.translation[0], s.translation[1], s.t) : s.translation[0]);
+        float4x4 R = math::matrixFromQuat(s.blend ? slerp(s.rotation[0], s.rotation[1], s.t) : s.rotation[0]);
+        float4x4 S = math::matrixFromScaling(s.blend ? lerp(s.scaling[0], s.scaling[1], s.t) : s.scaling[0]);
+        float4x4 transform = mul(mul(T, R), S);
+
+        return transform;
+    }
+
+    void Animation::animateBatch(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> matrices)
+    {
+        FALCOR_CHECK(animations.size() == matrices.size(), "'animations' and 'matrices' must have the same size");
+
+        for (size_t base = 0; base < animations.size(); base += kLaneCount)
+        {
+            const size_t laneCount = std::min(kLaneCount, animations.size() - base);
+
+            // Find the keyframes to interpolate and the slerp weights for each lane.
+            // Unused lanes replicate the first lane.
+            SampleBlock block;
+            for (size_t lane = 0; lane < kLaneCount; ++lane)
+            {
+                const Animation& animation = *animations[base + std::min(lane, laneCount - 1)];
+                const Sample s = animation.sample(currentTime);
+                for (uint32_t i = 0; i < 2; ++i)
+                {
+                    for (uint32_t axis = 0; axis < 3; ++axis)
+                    {
+                        block.translation[i][axis][lane] = s.translation[i][axis];
+                        block.scaling[i][axis][lane] = s.scaling[i][axis];
+                    }
+                    for (uint32_t c = 0; c < 4; ++c) block.rotation[i][c][lane] = s.rotation[i][c];
+                }
+                block.t[lane] = s.t;
+                if (s.blend)
+                {
+                    computeSlerpWeights(s.rotation[0], s.rotation[1], s.t, block.rotationWeight[0][lane], block.rotationWeight[1][lane], block.rotationScale[lane]);
+                }
+                else
+                {
+                    block.rotationWeight[0][lane] = 1.f;
+                    block.rotationWeight[1][lane] = 0.f;
+                    block.rotationScale[lane] = 1.f;
+                }
+            }
+
+            // Blend and compose the transforms of all lanes at once.
+            float4x4 laneMatrices[kLaneCount];
+            composeTransforms(block, laneCount == kLaneCount ? &matrices[base] : laneMatrices);
+            if (laneCount < kLaneCount) std::copy_n(laneMatrices, laneCount, &matrices[base]);
+        }
+    }
+
+    Animation::Sample Animation::sample(double currentTime) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
+
         // Calculate the sample time.
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < mTimes.front() || time > mTimes.back())
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
-        Keyframe interpolated;
+        auto makeSample = [](const Keyframe& k0, const Keyframe& k1, float t)
+        {
+            Sample s;
+            s.translation[0] = k0.translation;
+            s.translation[1] = k1.translation;
+            s.scaling[0] = k0.scaling;
+            s.scaling[1] = k1.scaling;
+            s.rotation[0] = k0.rotation;
+            s.rotation[1] = k1.rotation;
+            s.t = t;
+            return s;
+        };
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
+            const auto k0 = getKeyframeAt(0);
             auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
-            interpolated = interpolateLinear(k0, k1, t);
+            return makeSample(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
+            const auto k1 = getKeyframeAt(mTimes.size() - 1);
             auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
-            interpolated = interpolateLinear(k0, k1, t);
+            return makeSample(k0, k1, t);
+        }
+        else if (mInterpolationMode == InterpolationMode::Linear || mTimes.size() < 4)
+        {
+            // Interpolate directly between the keyframe tracks.
+            size_t i0, i1;
+            float t;
+            findLinearSegment(time, i0, i1, t);
+
+            Sample s;
+            s.translation[0] = mTranslations[i0];
+            s.translation[1] = mTranslations[i1];
+            s.scaling[0] = mScalings[i0];
+            s.scaling[1] = mScalings[i1];
+            s.rotation[0] = mRotations[i0];
+            s.rotation[1] = mRotations[i1];
+            s.t = t;
+            return s;
         }
         else
         {
-            interpolated = interpolate(mInterpolationMode, time);
+            auto k = interpolate(mInterpolationMode, time);
+            Sample s = makeSample(k, k, 0.f);
+            s.blend = false;
+            return s;
         }
-
-        float4x4 T = math::matrixFromTranslation(interpolated.translation);
-        float4x4 R = math::matrixFromQuat(interpolated.rotation);
-        float4x4 S = math::matrixFromScaling(interpolated.scaling);
-        float4x4 transform = mul(mul(T, R), S);
-
-        return transform;
     }
 
     Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
-
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
-
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
-        {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
-        }
-
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
-
-        // Compute index of adjacent frame including optional warping.
-        auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
-        {
-            size_t count = mKeyframes.size();
-            return mEnableWarping ? (frame + count + offset) % count : std::clamp(frame + offset, (size_t)0, count - 1);
-        };
+        FALCOR_ASSERT(!mTimes.empty());
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        if (mode == InterpolationMode::Linear || mTimes.size() < 4)
         {
-            size_t i0 = frameIndex;
-            size_t i1 = adjacentFrame(i0);
+            size_t i0, i1;
+            float t;
+            findLinearSegment(time, i0, i1, t);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-
-            double segmentDuration = k1.time - k0.time;
-            if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
-            float t = (float)std::clamp((segmentDuration > 0.0 ? (time - k0.time) / segmentDuration : 1.0), 0.0, 1.0);
-
-            return interpolateLinear(k0, k1, t);
+            return interpolateLinear(getKeyframeAt(i0), getKeyframeAt(i1), t);
         }
         else if (mode == InterpolationMode::Hermite)
         {
-            size_t i1 = frameIndex;
-            size_t i0 = adjacentFrame(i1, -1);
-            size_t i2 = adjacentFrame(i1, 1);
-            size_t i3 = adjacentFrame(i1, 2);
+            size_t i1 = findFrameIndex(time);
+            size_t i0 = getAdjacentFrameIndex(i1, -1);
+            size_t i2 = getAdjacentFrameIndex(i1, 1);
+            size_t i3 = getAdjacentFrameIndex(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
+            const Keyframe k2 = getKeyframeAt(i2);
+            const Keyframe k3 = getKeyframeAt(i3);
 
             double segmentDuration = k2.time - k1.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -218,15 +409,63 @@ namespace Falcor
         }
     }
 
+    void Animation::findLinearSegment(double time, size_t& i0, size_t& i1, float& t) const
+    {
+        i0 = findFrameIndex(time);
+        i1 = getAdjacentFrameIndex(i0, 1);
+
+        double segmentDuration = mTimes[i1] - mTimes[i0];
+        if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
+        t = (float)std::clamp((segmentDuration > 0.0 ? (time - mTimes[i0]) / segmentDuration : 1.0), 0.0, 1.0);
+    }
+
+    size_t Animation::findFrameIndex(double time) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
+        const size_t count = mTimes.size();
+
+        // Playback usually advances by less than a keyframe per update, so check the cached frame and its successor first.
+        size_t frameIndex = std::min(mCachedFrameIndex, count - 1);
+        if (mTimes[frameIndex] <= time)
+        {
+            if (frameIndex + 1 < count && mTimes[frameIndex + 1] <= time)
+            {
+                frameIndex++;
+                if (frameIndex + 1 < count && mTimes[frameIndex + 1] <= time)
+                {
+                    // Find the last keyframe at or before the time.
+                    frameIndex = std::upper_bound(mTimes.begin() + frameIndex + 1, mTimes.end(), time) - mTimes.begin() - 1;
+                }
+            }
+        }
+        else
+        {
+            // Find the last keyframe at or before the time, or the first keyframe if there is none.
+            auto it = std::upper_bound(mTimes.begin(), mTimes.begin() + frameIndex, time);
+            frameIndex = it == mTimes.begin() ? 0 : (it - mTimes.begin()) - 1;
+        }
+
+        // Cache frame index.
+        mCachedFrameIndex = frameIndex;
+        return frameIndex;
+    }
+
+    size_t Animation::getAdjacentFrameIndex(size_t frameIndex, int32_t offset) const
+    {
+        // Compute index of adjacent frame including optional warping.
+        size_t count = mTimes.size();
+        return mEnableWarping ? (frameIndex + count + offset) % count : std::clamp(frameIndex + offset, (size_t)0, count - 1);
+    }
+
     // Calculates the sample time within the keyframe range if the current time lies outside and
     // the animation does not behave linearly. If the animation behaves linearly, then the
     // current time is returned. This function should not be used if the current time lies
     // within the range of defined keyframe times.
-    double Animation::calcSampleTime(double currentTime)
+    double Animation::calcSampleTime(double currentTime) const
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mTimes.front();
+        double lastKeyframeTime = mTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -257,59 +496,52 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
+        // Find the insertion point, appending in the common case of keyframes added in order.
+        size_t index = mTimes.size();
+        if (!mTimes.empty() && mTimes.back() >= keyframe.time)
         {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
+            index = std::lower_bound(mTimes.begin(), mTimes.end(), keyframe.time) - mTimes.begin();
         }
-        else if (mKeyframes.back().time < keyframe.time)
+
+        // If we already have a key-frame at the same time, replace it
+        if (index < mTimes.size() && mTimes[index] == keyframe.time)
         {
-            mKeyframes.push_back(keyframe);
+            mTranslations[index] = keyframe.translation;
+            mScalings[index] = keyframe.scaling;
+            mRotations[index] = keyframe.rotation;
+            return;
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
 
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
+        mTimes.insert(mTimes.begin() + index, keyframe.time);
+        mTranslations.insert(mTranslations.begin() + index, keyframe.translation);
+        mScalings.insert(mScalings.begin() + index, keyframe.scaling);
+        mRotations.insert(mRotations.begin() + index, keyframe.rotation);
+    }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
-        }
+    Animation::Keyframe Animation::getKeyframe(double time) const
+    {
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        if (it == mTimes.end() || *it != time) FALCOR_THROW("'time' ({}) does not refer to an existing keyframe", time);
+        return getKeyframeAt(it - mTimes.begin());
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframeAt(size_t index) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        FALCOR_THROW("'time' ({}) does not refer to an existing keyframe", time);
+        FALCOR_CHECK(index < mTimes.size(), "'index' ({}) is out of range", index);
+        return Keyframe{ mTimes[index], mTranslations[index], mScalings[index], mRotations[index] };
+    }
+
+    std::vector<Animation::Keyframe> Animation::getKeyframes() const
+    {
+        std::vector<Keyframe> keyframes;
+        keyframes.reserve(mTimes.size());
+        for (size_t i = 0; i < mTimes.size(); ++i) keyframes.push_back(getKeyframeAt(i));
+        return keyframes;
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mTimes.begin(), mTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
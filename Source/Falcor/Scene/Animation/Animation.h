@@ -136,12 +136,27 @@ namespace Falcor
             \param[in] time Time of the keyframe.
             \return Returns the keyframe.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
+
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mTimes.size(); }
+
+        /** Get the keyframe at the specified index.
+            \param[in] index Keyframe index in the range [0, getKeyframeCount()).
+            \return Returns the keyframe.
+        */
+        Keyframe getKeyframeAt(size_t index) const;
 
         /** Gets all the keyframes in the animation.
-            \return Returns span of keyframes.
+            Keyframes are stored as separate tracks, so this assembles a copy.
+            \return Returns list of keyframes sorted by time.
+        */
+        std::vector<Keyframe> getKeyframes() const;
+
+        /** Get the keyframe times in increasing order.
         */
-        fstd::span<const Keyframe> getKeyframes() const { return mKeyframes; }
+        fstd::span<const double> getKeyframeTimes() const { return mTimes; }
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -155,13 +170,42 @@ namespace Falcor
         */
         float4x4 animate(double currentTime);
 
+        /** Compute a batch of animations.
+            Produces the same transforms as calling animate() on each animation, but the interpolated keyframes
+            are blended and converted to matrices for four animations at a time using SIMD instructions.
+            The matrix elements compare equal, but zero elements may differ in sign. Results may also differ in the
+            last bits if the compiler contracts the scalar path into fused multiply-adds.
+            Different batches can be computed concurrently as long as no animation appears in more than one batch.
+            \param[in] animations Animations to compute.
+            \param[in] currentTime The current time in seconds.
+            \param[out] matrices Transform matrix for each animation. Must have the same size as animations.
+        */
+        static void animateBatch(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> matrices);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
 
     private:
+        /** Interpolation inputs for a point in time.
+            The animated transform is the linear interpolation of the translations and scalings and the
+            spherical interpolation of the rotations with parameter t.
+        */
+        struct Sample
+        {
+            float3 translation[2];
+            float3 scaling[2];
+            quatf rotation[2];
+            float t = 0.f;
+            bool blend = true;  ///< If false, the transform is given by the first element and t is zero.
+        };
+
+        Sample sample(double currentTime) const;
         Keyframe interpolate(InterpolationMode mode, double time) const;
-        double calcSampleTime(double currentTime);
+        double calcSampleTime(double currentTime) const;
+        void findLinearSegment(double time, size_t& i0, size_t& i1, float& t) const;
+        size_t findFrameIndex(double time) const;
+        size_t getAdjacentFrameIndex(size_t frameIndex, int32_t offset) const;
 
         std::string mName;
         NodeID mNodeID;
@@ -173,7 +217,11 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
+        // Keyframe tracks, sorted by time.
+        std::vector<double> mTimes;
+        std::vector<float3> mTranslations;
+        std::vector<float3> mScalings;
+        std::vector<quatf> mRotations;
         mutable size_t mCachedFrameIndex = 0;
 
         friend class SceneCache;
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
 #include <fstream>
@@ -39,6 +40,9 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        const size_t kAnimationBatchSize = 1024; ///< Number of animations computed per parallel task.
+        const size_t kSkinningMatrixBatchSize = 1024; ///< Number of skinning matrices computed per parallel task.
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -51,6 +55,10 @@ namespace Falcor
         , mMatricesChanged(pScene->mSceneGraph.size())
         , mpScene(pScene)
     {
+        std::vector<NodeID> parents(pScene->mSceneGraph.size());
+        for (size_t i = 0; i < parents.size(); ++i) parents[i] = pScene->mSceneGraph[i].parent;
+        mTransformHierarchy = TransformHierarchy(parents);
+
         // Create GPU resources.
         FALCOR_ASSERT(mLocalMatrices.size() <= std::numeric_limits<uint32_t>::max());
 
@@ -197,6 +205,7 @@ namespace Falcor
         FALCOR_PROFILE(pRenderContext, "animate");
 
         std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        mWorldMatricesUpdated = false;
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -291,43 +300,42 @@ namespace Falcor
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        // Compute the animations in batches, then scatter the transforms to the animated nodes.
+        mAnimationMatrices.resize(mAnimations.size());
+        Threading::parallelFor(0, mAnimations.size(), kAnimationBatchSize, [&](size_t begin, size_t end)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            fstd::span<const ref<Animation>> animations(mAnimations.data() + begin, end - begin);
+            Animation::animateBatch(animations, time, fstd::span<float4x4>(mAnimationMatrices.data() + begin, end - begin));
+        });
+
+        for (size_t i = 0; i < mAnimations.size(); ++i)
+        {
+            NodeID nodeID = mAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
+            mLocalMatrices[nodeID.get()] = mAnimationMatrices[i];
             mMatricesChanged[nodeID.get()] = true;
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        // Propagate the changed local matrices level by level through the scene graph.
+        mTransformHierarchy.update(mLocalMatrices, mMatricesChanged, updateAll, mGlobalMatrices, mInvTransposeGlobalMatrices);
+        mWorldMatricesUpdated = true;
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        if (mpSkinningPass)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            const auto& sceneGraph = mpScene->mSceneGraph;
+            auto updatedNodes = mTransformHierarchy.getUpdatedNodes();
+            Threading::parallelFor(0, updatedNodes.size(), kSkinningMatrixBatchSize, [&](size_t begin, size_t end)
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
-            }
-
-            if (!mMatricesChanged[i] && !updateAll) continue;
-
-            mGlobalMatrices[i] = mLocalMatrices[i];
-
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
-            {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
-            }
-
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
-
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+                for (size_t j = begin; j < end; ++j)
+                {
+                    const uint32_t i = updatedNodes[j];
+                    mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
+                    mInvTransposeSkinningMatrices[i] = TransformHierarchy::inverseTranspose(mSkinningMatrices[i]);
+                }
+            });
         }
     }
 
@@ -351,8 +359,8 @@ namespace Falcor
             {
                 // Detect ranges of consecutive matrices that have all changed or not.
                 size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
+                bool changed = mMatricesChanged[i] != 0;
+                while (i < mGlobalMatrices.size() && (mMatricesChanged[i] != 0) == changed) ++i;
 
                 // Upload range of changed matrices.
                 if (changed)
@@ -28,6 +28,7 @@
 #pragma once
 #include "Animation.h"
 #include "AnimatedVertexCache.h"
+#include "TransformHierarchy.h"
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Pass/ComputePass.h"
@@ -110,7 +111,14 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
+
+        /** Get the nodes whose global matrix changed in the last call to animate(), ordered by scene graph level.
+        */
+        fstd::span<const uint32_t> getChangedNodes() const
+        {
+            return mWorldMatricesUpdated ? mTransformHierarchy.getUpdatedNodes() : fstd::span<const uint32_t>();
+        }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -166,7 +174,10 @@ namespace Falcor
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, non-zero if matrix changed since last frame. Stored as bytes so nodes can be updated concurrently.
+        TransformHierarchy mTransformHierarchy;     ///< Level layout of the scene graph used to propagate transforms.
+        std::vector<float4x4> mAnimationMatrices;   ///< Scratch buffer holding the transform computed by each animation.
+        bool mWorldMatricesUpdated = false;         ///< True if the global matrices were updated in the last call to animate().
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TransformHierarchy.h"
+#include "Core/Error.h"
+#include "Utils/Math/MatrixMath.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kGrainSize = 256; ///< Number of nodes updated per parallel task.
+
+        bool isAffine(const float4x4& m)
+        {
+            return m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f;
+        }
+
+        /** Multiply two matrices, skipping the last row if both are affine.
+        */
+        float4x4 mulTransforms(const float4x4& a, const float4x4& b)
+        {
+            if (!isAffine(a) || !isAffine(b)) return mul(a, b);
+
+            float4x4 result;
+            for (int r = 0; r < 3; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    result[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c] + (c == 3 ? a[r][3] : 0.f);
+                }
+            }
+            result.setRow(3, float4(0.f, 0.f, 0.f, 1.f));
+            return result;
+        }
+    }
+
+    TransformHierarchy::TransformHierarchy(const std::vector<NodeID>& parents)
+    {
+        const uint32_t nodeCount = (uint32_t)parents.size();
+        FALCOR_CHECK(parents.size() < kInvalidNode, "Too many nodes ({})", parents.size());
+
+        mParents.resize(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            mParents[i] = parents[i].get();
+            FALCOR_CHECK(mParents[i] == kInvalidNode || mParents[i] < nodeCount, "Node {} has invalid parent {}", i, mParents[i]);
+        }
+
+        // Compute the level of each node by walking up to the first node with a known level.
+        mLevels.assign(nodeCount, kInvalidNode);
+        std::vector<uint32_t> path;
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            path.clear();
+            uint32_t node = i;
+            while (node != kInvalidNode && mLevels[node] == kInvalidNode)
+            {
+                path.push_back(node);
+                FALCOR_CHECK(path.size() <= nodeCount, "Scene graph contains a cycle at node {}", i);
+                node = mParents[node];
+            }
+            uint32_t level = node == kInvalidNode ? 0 : mLevels[node] + 1;
+            for (auto it = path.rbegin(); it != path.rend(); ++it) mLevels[*it] = level++;
+            levelCount = std::max(levelCount, level);
+        }
+
+        // Sort the nodes by level.
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; ++i) mLevelOffsets[mLevels[i] + 1]++;
+        for (uint32_t level = 0; level < levelCount; ++level) mLevelOffsets[level + 1] += mLevelOffsets[level];
+        mLevelNodes.resize(nodeCount);
+        std::vector<uint32_t> offsets(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; ++i) mLevelNodes[offsets[mLevels[i]]++] = i;
+
+        // Build the lists of children.
+        mChildOffsets.assign(nodeCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            if (mParents[i] != kInvalidNode) mChildOffsets[mParents[i] + 1]++;
+        }
+        for (uint32_t i = 0; i < nodeCount; ++i) mChildOffsets[i + 1] += mChildOffsets[i];
+        mChildren.resize(mChildOffsets.back());
+        offsets.assign(mChildOffsets.begin(), mChildOffsets.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            if (mParents[i] != kInvalidNode) mChildren[offsets[mParents[i]]++] = i;
+        }
+    }
+
+    void TransformHierarchy::update(
+        fstd::span<const float4x4> localMatrices,
+        fstd::span<uint8_t> changed,
+        bool updateAll,
+        fstd::span<float4x4> globalMatrices,
+        fstd::span<float4x4> invTransposeGlobalMatrices
+    )
+    {
+        const size_t nodeCount = mParents.size();
+        FALCOR_CHECK(localMatrices.size() == nodeCount && changed.size() == nodeCount, "Expected {} nodes", nodeCount);
+        FALCOR_CHECK(globalMatrices.size() == nodeCount && invTransposeGlobalMatrices.size() == nodeCount, "Expected {} nodes", nodeCount);
+
+        if (updateAll)
+        {
+            mUpdatedNodes = mLevelNodes;
+            mUpdatedLevelOffsets = mLevelOffsets;
+        }
+        else
+        {
+            // Find the changed nodes and add their subtrees. The list is extended while it is traversed.
+            mChangedNodes.clear();
+            for (uint32_t i = 0; i < (uint32_t)nodeCount; ++i)
+            {
+                if (changed[i]) mChangedNodes.push_back(i);
+            }
+            for (size_t i = 0; i < mChangedNodes.size(); ++i)
+            {
+                const uint32_t node = mChangedNodes[i];
+                for (uint32_t j = mChildOffsets[node]; j < mChildOffsets[node + 1]; ++j)
+                {
+                    const uint32_t child = mChildren[j];
+                    if (!changed[child])
+                    {
+                        changed[child] = 1;
+                        mChangedNodes.push_back(child);
+                    }
+                }
+            }
+
+            // Sort the changed nodes by level.
+            const uint32_t levelCount = getLevelCount();
+            mUpdatedLevelOffsets.assign(levelCount + 1, 0);
+            for (uint32_t node : mChangedNodes) mUpdatedLevelOffsets[mLevels[node] + 1]++;
+            for (uint32_t level = 0; level < levelCount; ++level) mUpdatedLevelOffsets[level + 1] += mUpdatedLevelOffsets[level];
+            mUpdatedNodes.resize(mChangedNodes.size());
+            std::vector<uint32_t> offsets(mUpdatedLevelOffsets.begin(), mUpdatedLevelOffsets.end() - 1);
+            for (uint32_t node : mChangedNodes) mUpdatedNodes[offsets[mLevels[node]]++] = node;
+        }
+
+        // Update the levels in order. The parents of all nodes in a level belong to previous levels.
+        for (size_t level = 0; level + 1 < mUpdatedLevelOffsets.size(); ++level)
+        {
+            Threading::parallelFor(mUpdatedLevelOffsets[level], mUpdatedLevelOffsets[level + 1], kGrainSize, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const uint32_t node = mUpdatedNodes[i];
+                    const uint32_t parent = mParents[node];
+                    if (parent != kInvalidNode)
+                    {
+                        changed[node] |= changed[parent];
+                        globalMatrices[node] = mulTransforms(globalMatrices[parent], localMatrices[node]);
+                    }
+                    else
+                    {
+                        globalMatrices[node] = localMatrices[node];
+                    }
+                    invTransposeGlobalMatrices[node] = inverseTranspose(globalMatrices[node]);
+                }
+            });
+        }
+    }
+
+    float4x4 TransformHierarchy::inverseTranspose(const float4x4& m)
+    {
+        if (!isAffine(m)) return transpose(inverse(m));
+
+        // For m = [A t; 0 1], inverse(m) = [inverse(A) -inverse(A) * t; 0 1].
+        // The rows of the cofactor matrix C of A are cross products of the rows of A, and transpose(inverse(A)) = C / det(A).
+        const float3 a0 = m[0].xyz();
+        const float3 a1 = m[1].xyz();
+        const float3 a2 = m[2].xyz();
+        const float3 c0 = cross(a1, a2);
+        const float3 c1 = cross(a2, a0);
+        const float3 c2 = cross(a0, a1);
+        const float invDet = 1.f / dot(a0, c0);
+
+        float4x4 result;
+        result.setRow(0, float4(c0 * invDet, 0.f));
+        result.setRow(1, float4(c1 * invDet, 0.f));
+        result.setRow(2, float4(c2 * invDet, 0.f));
+        result.setRow(3, float4(-(m[0][3] * c0 + m[1][3] * c1 + m[2][3] * c2) * invDet, 1.f));
+        return result;
+    }
+}
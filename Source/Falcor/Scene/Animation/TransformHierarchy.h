@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Scene/SceneIDs.h"
+#include "Utils/Math/Matrix.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Propagates local transforms through the scene graph to compute global transforms.
+
+        Nodes are grouped by their depth in the graph. All nodes of a level only depend on nodes of previous levels,
+        so each level is updated in parallel. Incremental updates only visit the changed nodes and their subtrees.
+        Inverse transposes are computed with an affine inverse for affine transforms.
+    */
+    class FALCOR_API TransformHierarchy
+    {
+    public:
+        static constexpr uint32_t kInvalidNode = NodeID::kInvalidID;
+
+        TransformHierarchy() = default;
+
+        /** Create the hierarchy. Throws an exception if the graph contains a cycle.
+            \param[in] parents Parent of each node, or NodeID::Invalid() for root nodes. Parents don't have to precede their children.
+        */
+        TransformHierarchy(const std::vector<NodeID>& parents);
+
+        /** Get the number of nodes.
+        */
+        size_t getNodeCount() const { return mParents.size(); }
+
+        /** Get the number of levels, i.e. the depth of the deepest node plus one.
+        */
+        uint32_t getLevelCount() const { return (uint32_t)mLevelOffsets.size() - 1; }
+
+        /** Get the level of a node. Root nodes are at level zero.
+        */
+        uint32_t getLevel(uint32_t node) const { return mLevels[node]; }
+
+        /** Update the global matrices.
+            \param[in] localMatrices Local transform of each node.
+            \param[in,out] changed Flag per node. On input, flags the nodes whose local transform changed.
+                On output, also flags all nodes in the subtrees of these nodes.
+            \param[in] updateAll Update all nodes instead of only the changed ones.
+            \param[in,out] globalMatrices Object-to-world transform of each node. Only the updated nodes are written.
+            \param[in,out] invTransposeGlobalMatrices Inverse transpose of the global transform of each node. Only the updated nodes are written.
+        */
+        void update(
+            fstd::span<const float4x4> localMatrices,
+            fstd::span<uint8_t> changed,
+            bool updateAll,
+            fstd::span<float4x4> globalMatrices,
+            fstd::span<float4x4> invTransposeGlobalMatrices
+        );
+
+        /** Get the nodes updated by the last call to update(), ordered by level.
+        */
+        fstd::span<const uint32_t> getUpdatedNodes() const { return mUpdatedNodes; }
+
+        /** Compute the inverse transpose of a matrix.
+            Uses an affine inverse if the last row is (0, 0, 0, 1), and a general inverse otherwise.
+        */
+        static float4x4 inverseTranspose(const float4x4& m);
+
+    private:
+        std::vector<uint32_t> mParents;         ///< Parent of each node, or kInvalidNode.
+        std::vector<uint32_t> mLevels;          ///< Level of each node.
+        std::vector<uint32_t> mChildOffsets;    ///< Offset of the children of each node in mChildren, with an extra entry at the end.
+        std::vector<uint32_t> mChildren;        ///< Children of all nodes.
+        std::vector<uint32_t> mLevelNodes;      ///< All nodes ordered by level.
+        std::vector<uint32_t> mLevelOffsets{0}; ///< Offset of each level in mLevelNodes, with an extra entry at the end.
+
+        // Scratch data of update().
+        std::vector<uint32_t> mUpdatedNodes;        ///< Updated nodes ordered by level.
+        std::vector<uint32_t> mUpdatedLevelOffsets; ///< Offset of each level in mUpdatedNodes.
+        std::vector<uint32_t> mChangedNodes;        ///< Changed nodes in discovery order.
+    };
+}
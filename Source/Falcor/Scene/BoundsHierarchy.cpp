@@ -0,0 +1,91 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BoundsHierarchy.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace Falcor
+{
+    BoundsHierarchy::BoundsHierarchy(size_t leafCount)
+        : mLeafCount(leafCount)
+        , mLeafOffset(std::max(leafCount, size_t(1)))
+        , mNodes(2 * mLeafOffset)
+        , mDirtyFlags(2 * mLeafOffset, 0)
+    {
+        FALCOR_CHECK(2 * mLeafOffset <= std::numeric_limits<uint32_t>::max(), "Too many leaves ({}).", leafCount);
+    }
+
+    void BoundsHierarchy::setLeaf(size_t index, const AABB& bounds)
+    {
+        FALCOR_ASSERT(index < mLeafCount);
+        const uint32_t node = (uint32_t)(mLeafOffset + index);
+        mNodes[node] = bounds;
+        if (!mDirtyFlags[node])
+        {
+            mDirtyFlags[node] = 1;
+            mDirtyLeaves.push_back(node);
+        }
+    }
+
+    void BoundsHierarchy::refit()
+    {
+        // Collect the ancestors of the dirty leaves. Stop at the first ancestor that is already collected.
+        mDirtyNodes.clear();
+        for (uint32_t leaf : mDirtyLeaves)
+        {
+            mDirtyFlags[leaf] = 0;
+            for (uint32_t node = leaf >> 1; node >= 1 && !mDirtyFlags[node]; node >>= 1)
+            {
+                mDirtyFlags[node] = 1;
+                mDirtyNodes.push_back(node);
+            }
+        }
+        mDirtyLeaves.clear();
+
+        // Children have larger indices than their parent, so recompute the nodes in decreasing order.
+        std::sort(mDirtyNodes.begin(), mDirtyNodes.end(), std::greater<uint32_t>());
+        for (uint32_t node : mDirtyNodes)
+        {
+            mNodes[node] = mNodes[2 * node] | mNodes[2 * node + 1];
+            mDirtyFlags[node] = 0;
+        }
+    }
+
+    void BoundsHierarchy::build()
+    {
+        for (uint32_t leaf : mDirtyLeaves) mDirtyFlags[leaf] = 0;
+        mDirtyLeaves.clear();
+
+        for (size_t node = mLeafOffset - 1; node >= 1; --node)
+        {
+            mNodes[node] = mNodes[2 * node] | mNodes[2 * node + 1];
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Binary tree of bounding boxes over a fixed set of leaves, used to maintain the union of many boxes.
+
+        The tree is stored implicitly in an array of 2n nodes: node 1 is the root, the children of node i are
+        nodes 2i and 2i+1, and the n leaves are nodes n to 2n-1. Changing leaves only marks them as dirty.
+        refit() then recomputes the ancestors of the dirty leaves, which costs O(k log n) for k dirty leaves.
+    */
+    class FALCOR_API BoundsHierarchy
+    {
+    public:
+        BoundsHierarchy() = default;
+
+        /** Create a hierarchy with all leaves set to an empty box.
+            \param[in] leafCount Number of leaves.
+        */
+        BoundsHierarchy(size_t leafCount);
+
+        /** Get the number of leaves.
+        */
+        size_t getLeafCount() const { return mLeafCount; }
+
+        /** Get the bounds of a leaf.
+        */
+        const AABB& getLeaf(size_t index) const { return mNodes[mLeafOffset + index]; }
+
+        /** Set the bounds of a leaf. The bounds of the hierarchy are only updated by the next call to refit().
+            \param[in] index Leaf index.
+            \param[in] bounds New bounds of the leaf.
+        */
+        void setLeaf(size_t index, const AABB& bounds);
+
+        /** Recompute the internal nodes above the leaves changed since the last call.
+        */
+        void refit();
+
+        /** Recompute all internal nodes.
+        */
+        void build();
+
+        /** Get the union of all leaves, as of the last call to refit() or build().
+        */
+        const AABB& getBounds() const { return mNodes[1]; }
+
+    private:
+        size_t mLeafCount = 0;
+        size_t mLeafOffset = 1;                 ///< Index of the first leaf in mNodes.
+        std::vector<AABB> mNodes{2};            ///< Bounds of all nodes. Node 0 is unused.
+        std::vector<uint8_t> mDirtyFlags{0, 0}; ///< Flag per node, non-zero if the node is in mDirtyLeaves or mDirtyNodes.
+        std::vector<uint32_t> mDirtyLeaves;     ///< Leaf nodes changed since the last refit.
+        std::vector<uint32_t> mDirtyNodes;      ///< Scratch list of the internal nodes to recompute.
+    };
+}
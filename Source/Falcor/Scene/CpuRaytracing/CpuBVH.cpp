@@ -0,0 +1,359 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CpuBVH.h"
+#include "Core/Error.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        constexpr uint32_t kMaxBinCount = 64;
+
+        /** Range of primitives in the primitive index array.
+        */
+        struct BuildRange
+        {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            AABB bounds;            ///< Bounds of the primitives.
+            AABB centroidBounds;    ///< Bounds of the primitive centroids.
+
+            uint32_t count() const { return end - begin; }
+        };
+
+        struct Bin
+        {
+            AABB bounds;
+            uint32_t count = 0;
+        };
+
+        struct BuildContext
+        {
+            const std::vector<AABB>& primitiveBounds;
+            const std::vector<float3>& centroids;
+            std::vector<uint32_t>& primitiveIndices;
+            std::vector<CpuBVH::Node>& nodes;
+            CpuBVH::BuildOptions options;
+            std::atomic<uint32_t> nodeCount{0};
+            std::atomic<uint32_t> maxDepth{0};
+        };
+
+        void computeRangeBounds(const BuildContext& ctx, BuildRange& range)
+        {
+            range.bounds = AABB();
+            range.centroidBounds = AABB();
+            for (uint32_t i = range.begin; i < range.end; ++i)
+            {
+                uint32_t index = ctx.primitiveIndices[i];
+                range.bounds.include(ctx.primitiveBounds[index]);
+                range.centroidBounds.include(ctx.centroids[index]);
+            }
+        }
+
+        /** Split a range in two non-empty ranges.
+            Uses a binned SAH split unless the centroids are coincident or useMedian is set, in which case the
+            range is split at the object median along the largest centroid extent.
+        */
+        void splitRange(const BuildContext& ctx, const BuildRange& range, bool useMedian, BuildRange& left, BuildRange& right)
+        {
+            FALCOR_ASSERT(range.count() >= 2);
+            const uint32_t binCount = std::clamp(ctx.options.binCount, 2u, kMaxBinCount);
+            const float3 extent = range.centroidBounds.extent();
+            const float3 origin = range.centroidBounds.minPoint;
+            float3 scale;
+            for (uint32_t axis = 0; axis < 3; ++axis) scale[axis] = extent[axis] > 0.f ? binCount / extent[axis] : 0.f;
+
+            auto getBin = [&](uint32_t index, uint32_t axis)
+            {
+                int bin = (int)((ctx.centroids[index][axis] - origin[axis]) * scale[axis]);
+                return (uint32_t)std::clamp(bin, 0, (int)binCount - 1);
+            };
+
+            int bestAxis = -1;
+            uint32_t bestSplit = 0;
+
+            if (!useMedian && any(extent > float3(0.f)))
+            {
+                // Bins are indexed by [axis * kMaxBinCount + bin].
+                Bin bins[3 * kMaxBinCount];
+                auto binRange = [&](uint32_t begin, uint32_t end, Bin* pBins)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        uint32_t index = ctx.primitiveIndices[i];
+                        for (uint32_t axis = 0; axis < 3; ++axis)
+                        {
+                            Bin& bin = pBins[axis * kMaxBinCount + getBin(index, axis)];
+                            bin.bounds.include(ctx.primitiveBounds[index]);
+                            bin.count++;
+                        }
+                    }
+                };
+
+                if (range.count() >= 4 * ctx.options.parallelThreshold)
+                {
+                    // Bin chunks in parallel and merge.
+                    const uint32_t chunkSize = ctx.options.parallelThreshold;
+                    const uint32_t chunkCount = (range.count() + chunkSize - 1) / chunkSize;
+                    std::vector<Bin> chunkBins(chunkCount * 3 * kMaxBinCount);
+                    Threading::parallelFor(0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd)
+                    {
+                        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+                        {
+                            uint32_t begin = range.begin + (uint32_t)chunk * chunkSize;
+                            binRange(begin, std::min(begin + chunkSize, range.end), &chunkBins[chunk * 3 * kMaxBinCount]);
+                        }
+                    });
+                    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+                    {
+                        for (uint32_t axis = 0; axis < 3; ++axis)
+                        {
+                            for (uint32_t b = 0; b < binCount; ++b)
+                            {
+                                const Bin& src = chunkBins[(chunk * 3 + axis) * kMaxBinCount + b];
+                                bins[axis * kMaxBinCount + b].bounds.include(src.bounds);
+                                bins[axis * kMaxBinCount + b].count += src.count;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    binRange(range.begin, range.end, bins);
+                }
+
+                // Sweep the bins to find the split with the lowest SAH cost.
+                float bestCost = std::numeric_limits<float>::infinity();
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    if (extent[axis] <= 0.f) continue;
+
+                    const Bin* axisBins = &bins[axis * kMaxBinCount];
+                    float rightCost[kMaxBinCount] = {};
+                    uint32_t rightCount[kMaxBinCount] = {};
+                    AABB bounds;
+                    uint32_t count = 0;
+                    for (uint32_t b = binCount - 1; b > 0; --b)
+                    {
+                        bounds.include(axisBins[b].bounds);
+                        count += axisBins[b].count;
+                        rightCount[b] = count;
+                        rightCost[b] = count > 0 ? bounds.area() * count : 0.f;
+                    }
+
+                    bounds = AABB();
+                    count = 0;
+                    for (uint32_t b = 1; b < binCount; ++b)
+                    {
+                        bounds.include(axisBins[b - 1].bounds);
+                        count += axisBins[b - 1].count;
+                        if (count == 0 || rightCount[b] == 0) continue;
+                        float cost = bounds.area() * count + rightCost[b];
+                        if (cost < bestCost)
+                        {
+                            bestCost = cost;
+                            bestAxis = (int)axis;
+                            bestSplit = b;
+                        }
+                    }
+                }
+            }
+
+            uint32_t mid;
+            if (bestAxis >= 0)
+            {
+                auto it = std::partition(ctx.primitiveIndices.begin() + range.begin, ctx.primitiveIndices.begin() + range.end,
+                    [&](uint32_t index) { return getBin(index, bestAxis) < bestSplit; });
+                mid = (uint32_t)(it - ctx.primitiveIndices.begin());
+            }
+            else
+            {
+                uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+                mid = range.begin + range.count() / 2;
+                std::nth_element(ctx.primitiveIndices.begin() + range.begin, ctx.primitiveIndices.begin() + mid, ctx.primitiveIndices.begin() + range.end,
+                    [&](uint32_t a, uint32_t b) { return ctx.centroids[a][axis] < ctx.centroids[b][axis]; });
+            }
+            FALCOR_ASSERT(mid > range.begin && mid < range.end);
+
+            left.begin = range.begin;
+            left.end = mid;
+            right.begin = mid;
+            right.end = range.end;
+            computeRangeBounds(ctx, left);
+            computeRangeBounds(ctx, right);
+        }
+
+        void buildNode(BuildContext& ctx, uint32_t nodeIndex, const BuildRange& range, uint32_t depth)
+        {
+            uint32_t maxDepth = ctx.maxDepth.load();
+            while (depth > maxDepth && !ctx.maxDepth.compare_exchange_weak(maxDepth, depth)) {}
+
+            // Split the largest child until the node is full or all children are small enough to be leaves.
+            // Below half the maximum depth, median splits are used to bound the depth of degenerate inputs.
+            const bool useMedian = depth >= CpuBVH::kMaxDepth / 2;
+            const uint32_t maxLeafSize = std::max(ctx.options.maxLeafSize, 1u);
+            BuildRange children[CpuBVH::kWidth];
+            uint32_t childCount = 1;
+            children[0] = range;
+
+            while (childCount < CpuBVH::kWidth)
+            {
+                int best = -1;
+                float bestArea = -1.f;
+                for (uint32_t i = 0; i < childCount; ++i)
+                {
+                    float area = children[i].bounds.area();
+                    if (children[i].count() > maxLeafSize && area > bestArea)
+                    {
+                        best = (int)i;
+                        bestArea = area;
+                    }
+                }
+                if (best < 0) break;
+
+                BuildRange leftRange, rightRange;
+                splitRange(ctx, children[best], useMedian, leftRange, rightRange);
+                children[best] = leftRange;
+                children[childCount++] = rightRange;
+            }
+
+            CpuBVH::Node& node = ctx.nodes[nodeIndex];
+            node.childCount = childCount;
+            for (uint32_t i = 0; i < CpuBVH::kWidth; ++i)
+            {
+                const bool valid = i < childCount;
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    node.boundsMin[axis][i] = valid ? children[i].bounds.minPoint[axis] : 0.f;
+                    node.boundsMax[axis][i] = valid ? children[i].bounds.maxPoint[axis] : 0.f;
+                }
+                node.child[i] = CpuBVH::kInvalidIndex;
+                node.primitiveCount[i] = 0;
+                if (!valid) continue;
+
+                if (children[i].count() <= maxLeafSize)
+                {
+                    node.child[i] = children[i].begin;
+                    node.primitiveCount[i] = children[i].count();
+                }
+                else
+                {
+                    node.child[i] = ctx.nodeCount.fetch_add(1);
+                }
+            }
+
+            // Build the inner children, in parallel if the subtree is large.
+            auto buildChildren = [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (!node.isLeaf((uint32_t)i)) buildNode(ctx, node.child[i], children[i], depth + 1);
+                }
+            };
+            if (range.count() >= ctx.options.parallelThreshold) Threading::parallelFor(0, childCount, 1, buildChildren);
+            else buildChildren(0, childCount);
+        }
+    }
+
+    AABB CpuBVH::Node::getChildBounds(uint32_t i) const
+    {
+        FALCOR_ASSERT(i < childCount);
+        return AABB(float3(boundsMin[0][i], boundsMin[1][i], boundsMin[2][i]), float3(boundsMax[0][i], boundsMax[1][i], boundsMax[2][i]));
+    }
+
+    void CpuBVH::build(const std::vector<AABB>& primitiveBounds, const BuildOptions& options)
+    {
+        FALCOR_CHECK(primitiveBounds.size() < kInvalidIndex, "Too many primitives ({}).", primitiveBounds.size());
+        FALCOR_CHECK(options.binCount <= kMaxBinCount, "Bin count ({}) exceeds the maximum of {}.", options.binCount, kMaxBinCount);
+
+        mNodes.clear();
+        mPrimitiveIndices.clear();
+        mBounds = AABB();
+        mDepth = 0;
+
+        // Compute centroids and collect the primitives with valid bounds.
+        std::vector<float3> centroids(primitiveBounds.size());
+        for (uint32_t i = 0; i < (uint32_t)primitiveBounds.size(); ++i)
+        {
+            if (!primitiveBounds[i].valid()) continue;
+            centroids[i] = primitiveBounds[i].center();
+            mPrimitiveIndices.push_back(i);
+        }
+        if (mPrimitiveIndices.empty()) return;
+
+        // Every inner node has at least two children, so there are fewer inner nodes than primitives.
+        mNodes.resize(mPrimitiveIndices.size());
+
+        BuildContext ctx{primitiveBounds, centroids, mPrimitiveIndices, mNodes, options};
+        ctx.nodeCount = 1;
+
+        BuildRange root;
+        root.begin = 0;
+        root.end = (uint32_t)mPrimitiveIndices.size();
+        computeRangeBounds(ctx, root);
+        buildNode(ctx, 0, root, 1);
+
+        mNodes.resize(ctx.nodeCount.load());
+        mNodes.shrink_to_fit();
+        mBounds = root.bounds;
+        mDepth = ctx.maxDepth.load();
+    }
+
+    void CpuBVH::remapLeaves(const std::function<uint32_t(uint32_t first, uint32_t count)>& func)
+    {
+        for (Node& node : mNodes)
+        {
+            for (uint32_t i = 0; i < node.childCount; ++i)
+            {
+                if (node.isLeaf(i)) node.child[i] = func(node.child[i], node.primitiveCount[i]);
+            }
+        }
+    }
+
+    float CpuBVH::computeSAHCost() const
+    {
+        if (mNodes.empty()) return 0.f;
+
+        // Every node is visited with the probability of hitting its bounds, and tests all of its children.
+        double cost = mBounds.area();
+        for (const Node& node : mNodes)
+        {
+            for (uint32_t i = 0; i < node.childCount; ++i)
+            {
+                float area = node.getChildBounds(i).area();
+                cost += node.isLeaf(i) ? area * node.primitiveCount[i] : area;
+            }
+        }
+        float rootArea = mBounds.area();
+        return rootArea > 0.f ? (float)(cost / rootArea) : 0.f;
+    }
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Four-wide bounding volume hierarchy for ray tracing on the CPU.
+
+        The hierarchy is built top-down over a list of primitive bounding boxes. Each wide node is created by
+        repeatedly splitting its largest child with a binned SAH split until it has four children, which avoids
+        building and collapsing an intermediate binary tree. Subtrees are built in parallel.
+
+        The child bounds of a node are stored in SoA layout so that a ray can be tested against all four children
+        with SIMD instructions. The BVH only stores the primitive order, the primitive data and the leaf intersection
+        are owned by the user (see CpuSceneRaytracer).
+    */
+    class FALCOR_API CpuBVH
+    {
+    public:
+        static constexpr uint32_t kWidth = 4;                   ///< Number of children per node.
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+        static constexpr uint32_t kMaxDepth = 64;               ///< Maximum node depth. Deeper subtrees are split at the object median.
+
+        struct BuildOptions
+        {
+            uint32_t maxLeafSize = 4;       ///< Maximum number of primitives per leaf.
+            uint32_t binCount = 16;         ///< Number of bins per axis for the SAH split search.
+            uint32_t parallelThreshold = 4096; ///< Minimum number of primitives in a subtree to build it as a separate task.
+        };
+
+        /** Wide BVH node.
+            Children are stored contiguously, the first childCount entries are valid.
+            A child is a leaf if its primitive count is non-zero, otherwise it references an inner node.
+        */
+        struct alignas(64) Node
+        {
+            float boundsMin[3][kWidth];     ///< Child bounds minimum, indexed by [axis][child].
+            float boundsMax[3][kWidth];     ///< Child bounds maximum, indexed by [axis][child].
+            uint32_t child[kWidth];         ///< Inner node index, or index of the first primitive of a leaf (see remapLeaves()).
+            uint32_t primitiveCount[kWidth]; ///< Number of primitives in a leaf, or zero for inner nodes.
+            uint32_t childCount;            ///< Number of valid children.
+
+            bool isLeaf(uint32_t i) const { return primitiveCount[i] > 0; }
+            AABB getChildBounds(uint32_t i) const;
+        };
+
+        /** Build the BVH.
+            \param[in] primitiveBounds Bounding box of each primitive. Invalid (empty) boxes are not included in the BVH.
+            \param[in] options Build options.
+        */
+        void build(const std::vector<AABB>& primitiveBounds, const BuildOptions& options);
+        void build(const std::vector<AABB>& primitiveBounds) { build(primitiveBounds, BuildOptions()); }
+
+        /** Replace the leaf references by user indices.
+            After build(), leaves reference the range [child, child + primitiveCount) of getPrimitiveIndices().
+            This calls func(first, count) for every leaf and stores the returned index in place of the range start,
+            for example to reference primitive data that was reordered into leaf order.
+            \param[in] func Function returning the new leaf index for a leaf primitive range.
+        */
+        void remapLeaves(const std::function<uint32_t(uint32_t first, uint32_t count)>& func);
+
+        /** Returns true if the BVH contains no primitives.
+        */
+        bool empty() const { return mNodes.empty(); }
+
+        /** Get the nodes. The root node is at index 0.
+        */
+        const std::vector<Node>& getNodes() const { return mNodes; }
+
+        /** Get the primitive indices in leaf order.
+        */
+        const std::vector<uint32_t>& getPrimitiveIndices() const { return mPrimitiveIndices; }
+
+        /** Get the bounds of all primitives.
+        */
+        const AABB& getBounds() const { return mBounds; }
+
+        /** Get the depth of the deepest leaf (1 for a BVH with a single node).
+        */
+        uint32_t getDepth() const { return mDepth; }
+
+        /** Get the SAH cost of the BVH, normalized by the surface area of the root bounds.
+            Node traversal and primitive intersection are assumed to have the same cost.
+        */
+        float computeSAHCost() const;
+
+    private:
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mPrimitiveIndices;
+        AABB mBounds;
+        uint32_t mDepth = 0;
+    };
+}
@@ -0,0 +1,566 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CpuSceneRaytracer.h"
+#include "Scene/Scene.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPU_RAYTRACER_SSE2 1
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kStackSize = 3 * CpuBVH::kMaxDepth + 1;
+        const size_t kBatchGrainSize = 256;
+
+        /** Minimal 4-wide float vector. Uses SSE2 if available, scalar code otherwise.
+            Comparisons return lane masks with all bits set for true.
+        */
+#if CPU_RAYTRACER_SSE2
+        struct vfloat4
+        {
+            __m128 v;
+        };
+
+        inline vfloat4 vset(float s) { return { _mm_set1_ps(s) }; }
+        inline vfloat4 vload(const float* p) { return { _mm_load_ps(p) }; }
+        inline void vstore(float* p, vfloat4 a) { _mm_store_ps(p, a.v); }
+        inline vfloat4 operator+(vfloat4 a, vfloat4 b) { return { _mm_add_ps(a.v, b.v) }; }
+        inline vfloat4 operator-(vfloat4 a, vfloat4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+        inline vfloat4 operator*(vfloat4 a, vfloat4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+        inline vfloat4 operator/(vfloat4 a, vfloat4 b) { return { _mm_div_ps(a.v, b.v) }; }
+        inline vfloat4 vmin(vfloat4 a, vfloat4 b) { return { _mm_min_ps(a.v, b.v) }; }
+        inline vfloat4 vmax(vfloat4 a, vfloat4 b) { return { _mm_max_ps(a.v, b.v) }; }
+        inline vfloat4 operator<(vfloat4 a, vfloat4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+        inline vfloat4 operator<=(vfloat4 a, vfloat4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+        inline vfloat4 operator>(vfloat4 a, vfloat4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+        inline vfloat4 operator>=(vfloat4 a, vfloat4 b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+        inline vfloat4 operator!=(vfloat4 a, vfloat4 b) { return { _mm_cmpneq_ps(a.v, b.v) }; }
+        inline vfloat4 operator&(vfloat4 a, vfloat4 b) { return { _mm_and_ps(a.v, b.v) }; }
+        inline uint32_t movemask(vfloat4 a) { return (uint32_t)_mm_movemask_ps(a.v); }
+#else
+        struct vfloat4
+        {
+            float v[4];
+        };
+
+        template<typename F>
+        inline vfloat4 vmap(vfloat4 a, vfloat4 b, F f)
+        {
+            vfloat4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = f(a.v[i], b.v[i]);
+            return r;
+        }
+
+        inline float laneMask(bool b)
+        {
+            uint32_t bits = b ? 0xffffffffu : 0u;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+
+        inline bool laneSet(float f)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits != 0;
+        }
+
+        inline vfloat4 vset(float s) { return { { s, s, s, s } }; }
+        inline vfloat4 vload(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        inline void vstore(float* p, vfloat4 a) { std::memcpy(p, a.v, sizeof(a.v)); }
+        inline vfloat4 operator+(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x + y; }); }
+        inline vfloat4 operator-(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x - y; }); }
+        inline vfloat4 operator*(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x * y; }); }
+        inline vfloat4 operator/(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x / y; }); }
+        inline vfloat4 vmin(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x < y ? x : y; }); }
+        inline vfloat4 vmax(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return x > y ? x : y; }); }
+        inline vfloat4 operator<(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(x < y); }); }
+        inline vfloat4 operator<=(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(x <= y); }); }
+        inline vfloat4 operator>(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(x > y); }); }
+        inline vfloat4 operator>=(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(x >= y); }); }
+        inline vfloat4 operator!=(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(x != y); }); }
+        inline vfloat4 operator&(vfloat4 a, vfloat4 b) { return vmap(a, b, [](float x, float y) { return laneMask(laneSet(x) && laneSet(y)); }); }
+        inline uint32_t movemask(vfloat4 a)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 4; ++i) mask |= laneSet(a.v[i]) ? (1u << i) : 0u;
+            return mask;
+        }
+#endif
+
+        inline uint32_t firstBit(uint32_t mask)
+        {
+            FALCOR_ASSERT(mask != 0);
+            uint32_t i = 0;
+            while ((mask & (1u << i)) == 0) ++i;
+            return i;
+        }
+
+        /** Ray data broadcast to all lanes for box and triangle tests.
+        */
+        struct RayData
+        {
+            vfloat4 origin[3];
+            vfloat4 dir[3];
+            vfloat4 invDir[3];
+            vfloat4 tMin;
+
+            RayData(const float3& o, const float3& d, float tMin_)
+            {
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    // Avoid infinities (and NaNs from 0 * inf in the slab test) for axis-parallel rays.
+                    float inv = d[axis] != 0.f ? 1.f / d[axis] : std::copysign(1e30f, d[axis]);
+                    origin[axis] = vset(o[axis]);
+                    dir[axis] = vset(d[axis]);
+                    invDir[axis] = vset(inv);
+                }
+                tMin = vset(tMin_);
+            }
+        };
+
+        /** Intersect a ray with the children of a node.
+            \param[out] tNear Entry distance for each child.
+            \return Bit mask of the children hit within [tMin, tMax].
+        */
+        inline uint32_t intersectNode(const CpuBVH::Node& node, const RayData& ray, float tMax, float* tNear)
+        {
+            // Scale the exit distance to conservatively account for rounding errors (Ize 2013).
+            const float kScale = 1.f + 2.f * 3.f * std::numeric_limits<float>::epsilon() * 0.5f;
+            vfloat4 t0 = ray.tMin;
+            vfloat4 t1 = vset(tMax);
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                vfloat4 a = (vload(node.boundsMin[axis]) - ray.origin[axis]) * ray.invDir[axis];
+                vfloat4 b = (vload(node.boundsMax[axis]) - ray.origin[axis]) * ray.invDir[axis];
+                t0 = vmax(t0, vmin(a, b));
+                t1 = vmin(t1, vmax(a, b) * vset(kScale));
+            }
+            vstore(tNear, t0);
+            return movemask(t0 <= t1) & ((1u << node.childCount) - 1);
+        }
+
+        /** Intersect a ray with four triangles (Moller-Trumbore).
+            \return Bit mask of the triangles hit within (tMin, tMax).
+        */
+        inline uint32_t intersectTriangles(const float (&v0)[3][4], const float (&e1)[3][4], const float (&e2)[3][4], const RayData& ray, float tMax, float* tOut, float* uOut, float* vOut)
+        {
+            const vfloat4 e1x = vload(e1[0]), e1y = vload(e1[1]), e1z = vload(e1[2]);
+            const vfloat4 e2x = vload(e2[0]), e2y = vload(e2[1]), e2z = vload(e2[2]);
+            const vfloat4& dx = ray.dir[0];
+            const vfloat4& dy = ray.dir[1];
+            const vfloat4& dz = ray.dir[2];
+
+            // p = cross(dir, e2), det = dot(e1, p).
+            const vfloat4 px = dy * e2z - dz * e2y;
+            const vfloat4 py = dz * e2x - dx * e2z;
+            const vfloat4 pz = dx * e2y - dy * e2x;
+            const vfloat4 det = e1x * px + e1y * py + e1z * pz;
+            const vfloat4 invDet = vset(1.f) / det;
+
+            // s = origin - v0, q = cross(s, e1).
+            const vfloat4 sx = ray.origin[0] - vload(v0[0]);
+            const vfloat4 sy = ray.origin[1] - vload(v0[1]);
+            const vfloat4 sz = ray.origin[2] - vload(v0[2]);
+            const vfloat4 qx = sy * e1z - sz * e1y;
+            const vfloat4 qy = sz * e1x - sx * e1z;
+            const vfloat4 qz = sx * e1y - sy * e1x;
+
+            const vfloat4 u = (sx * px + sy * py + sz * pz) * invDet;
+            const vfloat4 v = (dx * qx + dy * qy + dz * qz) * invDet;
+            const vfloat4 t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+            const vfloat4 zero = vset(0.f);
+            const vfloat4 hit = (det != zero) & (u >= zero) & (v >= zero) & (u + v <= vset(1.f)) & (t > ray.tMin) & (t < vset(tMax));
+            vstore(tOut, t);
+            vstore(uOut, u);
+            vstore(vOut, v);
+            return movemask(hit);
+        }
+
+        struct StackEntry
+        {
+            uint32_t node;
+            float tNear;
+        };
+
+        /** Traverse a BVH, calling leafFunc(leafIndex, primitiveCount, tMax) for each leaf hit by the ray.
+            Inner children are visited front to back. The leaf function returns true to terminate the traversal
+            and may shorten tMax.
+        */
+        template<typename LeafFunc>
+        void traverse(const CpuBVH& bvh, const RayData& ray, float tMin, float& tMax, LeafFunc leafFunc)
+        {
+            const auto& nodes = bvh.getNodes();
+            if (nodes.empty()) return;
+
+            StackEntry stack[kStackSize];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = { 0, tMin };
+
+            while (stackSize > 0)
+            {
+                const StackEntry entry = stack[--stackSize];
+                if (entry.tNear > tMax) continue;
+
+                const CpuBVH::Node& node = nodes[entry.node];
+                alignas(16) float tNear[4];
+                uint32_t mask = intersectNode(node, ray, tMax, tNear);
+
+                // Intersect leaves right away, collect inner children sorted by descending distance.
+                StackEntry inner[CpuBVH::kWidth];
+                uint32_t innerCount = 0;
+                while (mask != 0)
+                {
+                    const uint32_t i = firstBit(mask);
+                    mask &= mask - 1;
+                    if (node.isLeaf(i))
+                    {
+                        if (leafFunc(node.child[i], node.primitiveCount[i], tMax)) return;
+                    }
+                    else
+                    {
+                        uint32_t j = innerCount++;
+                        while (j > 0 && inner[j - 1].tNear < tNear[i])
+                        {
+                            inner[j] = inner[j - 1];
+                            --j;
+                        }
+                        inner[j] = { node.child[i], tNear[i] };
+                    }
+                }
+
+                // Push the farthest child first so that the nearest is visited next.
+                FALCOR_ASSERT(stackSize + innerCount <= kStackSize);
+                for (uint32_t j = 0; j < innerCount; ++j) stack[stackSize++] = inner[j];
+            }
+        }
+    }
+
+    ref<CpuSceneRaytracer> CpuSceneRaytracer::create(const Desc& desc)
+    {
+        return make_ref<CpuSceneRaytracer>(desc);
+    }
+
+    ref<CpuSceneRaytracer> CpuSceneRaytracer::create(const Scene& scene)
+    {
+        return make_ref<CpuSceneRaytracer>(createDesc(scene));
+    }
+
+    CpuSceneRaytracer::Desc CpuSceneRaytracer::createDesc(const Scene& scene)
+    {
+        Desc desc;
+
+        if (scene.getGeometryTypes() != Scene::GeometryTypeFlags::TriangleMesh && scene.getGeometryTypes() != Scene::GeometryTypeFlags(0))
+        {
+            logWarning("CpuSceneRaytracer only supports non-displaced triangle meshes. Other geometry types are ignored.");
+        }
+
+        const auto& meshGroups = scene.getMeshGroups();
+        const auto& globalMatrices = scene.getAnimationController()->getGlobalMatrices();
+        const auto& indexData = scene.getMeshIndexData();
+        const auto& staticData = scene.getMeshStaticData();
+
+        // Create one BLAS per mesh group and the instances in the same order as Scene::fillInstanceDesc().
+        // The global geometry instance IDs of the meshes in a group instance are consecutive.
+        desc.blases.resize(meshGroups.size());
+        std::vector<std::vector<uint32_t>> groupInstanceIDs(meshGroups.size());
+        for (size_t groupIndex = 0; groupIndex < meshGroups.size(); ++groupIndex)
+        {
+            const auto& meshList = meshGroups[groupIndex].meshList;
+            FALCOR_ASSERT(!meshList.empty());
+            const auto& instanceIDs = scene.getMeshInstanceIDs(meshList[0]);
+            for (uint32_t instanceIndex = 0; instanceIndex < (uint32_t)instanceIDs.size(); ++instanceIndex)
+            {
+                InstanceDesc instance;
+                instance.blasIndex = (uint32_t)groupIndex;
+                instance.instanceID = instanceIDs[instanceIndex];
+                if (!meshGroups[groupIndex].isStatic)
+                {
+                    instance.transform = globalMatrices[scene.getGeometryInstance(instance.instanceID).globalMatrixID];
+                }
+                desc.instances.push_back(instance);
+            }
+        }
+
+        // Gather the vertex data of the BLASes in parallel.
+        // Static mesh groups are non-instanced and pre-transformed to world space, as in Scene::buildBlas().
+        Threading::parallelFor(0, meshGroups.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t groupIndex = begin; groupIndex < end; ++groupIndex)
+            {
+                const auto& group = meshGroups[groupIndex];
+                if (group.isDisplaced) continue;
+
+                BlasDesc& blas = desc.blases[groupIndex];
+                blas.geometries.resize(group.meshList.size());
+                for (size_t geometryIndex = 0; geometryIndex < group.meshList.size(); ++geometryIndex)
+                {
+                    const MeshID meshID = group.meshList[geometryIndex];
+                    const MeshDesc& mesh = scene.getMesh(meshID);
+                    GeometryDesc& geometry = blas.geometries[geometryIndex];
+
+                    float4x4 transform = float4x4::identity();
+                    if (group.isStatic)
+                    {
+                        FALCOR_ASSERT(scene.getMeshInstanceIDs(meshID).size() == 1);
+                        transform = globalMatrices[scene.getGeometryInstance(scene.getMeshInstanceIDs(meshID)[0]).globalMatrixID];
+                    }
+                    const bool isIdentity = transform == float4x4::identity();
+
+                    geometry.positions.resize(mesh.vertexCount);
+                    for (uint32_t i = 0; i < mesh.vertexCount; ++i)
+                    {
+                        float3 position = staticData[(size_t)mesh.vbOffset + i].position;
+                        geometry.positions[i] = isIdentity ? position : transformPoint(transform, position);
+                    }
+
+                    if (mesh.useVertexIndices())
+                    {
+                        geometry.indices.resize(mesh.indexCount);
+                        const uint8_t* pIndexData = reinterpret_cast<const uint8_t*>(&indexData[mesh.ibOffset]);
+                        for (uint32_t i = 0; i < mesh.indexCount; ++i)
+                        {
+                            geometry.indices[i] = mesh.use16BitIndices() ? reinterpret_cast<const uint16_t*>(pIndexData)[i] : reinterpret_cast<const uint32_t*>(pIndexData)[i];
+                        }
+                    }
+                }
+            }
+        });
+
+        return desc;
+    }
+
+    CpuSceneRaytracer::CpuSceneRaytracer(const Desc& desc)
+    {
+        for (const auto& instance : desc.instances)
+        {
+            FALCOR_CHECK(instance.blasIndex < desc.blases.size(), "Instance references invalid BLAS index {}.", instance.blasIndex);
+        }
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        // Build the BLASes in parallel, each BLAS build is parallel as well.
+        mBlases.resize(desc.blases.size());
+        Threading::parallelFor(0, desc.blases.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) buildBlas(mBlases[i], desc.blases[i]);
+        });
+
+        // Build the TLAS over the world space bounds of the instances.
+        mInstances.resize(desc.instances.size());
+        std::vector<AABB> instanceBounds(desc.instances.size());
+        for (size_t i = 0; i < desc.instances.size(); ++i)
+        {
+            const InstanceDesc& instanceDesc = desc.instances[i];
+            Instance& instance = mInstances[i];
+            instance.blasIndex = instanceDesc.blasIndex;
+            instance.instanceID = instanceDesc.instanceID;
+            instance.isIdentity = instanceDesc.transform == float4x4::identity();
+            instance.worldToObject = instance.isIdentity ? float4x4::identity() : inverse(instanceDesc.transform);
+            instanceBounds[i] = mBlases[instance.blasIndex].bvh.getBounds().transform(instanceDesc.transform);
+        }
+
+        CpuBVH::BuildOptions tlasOptions;
+        tlasOptions.maxLeafSize = 1;
+        mTlas.build(instanceBounds, tlasOptions);
+        const auto& instanceOrder = mTlas.getPrimitiveIndices();
+        mTlas.remapLeaves([&](uint32_t first, uint32_t count) { return instanceOrder[first]; });
+
+        mStats.blasCount = (uint32_t)mBlases.size();
+        mStats.instanceCount = (uint32_t)mInstances.size();
+        mStats.nodeCount = mTlas.getNodes().size();
+        mStats.memoryInBytes = mTlas.getNodes().size() * sizeof(CpuBVH::Node) + mInstances.size() * sizeof(Instance);
+        for (const Blas& blas : mBlases)
+        {
+            mStats.triangleCount += blas.bvh.getPrimitiveIndices().size();
+            mStats.nodeCount += blas.bvh.getNodes().size();
+            mStats.maxDepth = std::max(mStats.maxDepth, blas.bvh.getDepth());
+            mStats.memoryInBytes += blas.bvh.getNodes().size() * sizeof(CpuBVH::Node) + blas.packets.size() * sizeof(TrianglePacket);
+        }
+        mStats.buildTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+    }
+
+    void CpuSceneRaytracer::buildBlas(Blas& blas, const BlasDesc& desc)
+    {
+        // Flatten the triangles of all geometries.
+        std::vector<uint32_t> triangleOffsets(desc.geometries.size() + 1, 0);
+        for (size_t i = 0; i < desc.geometries.size(); ++i)
+        {
+            triangleOffsets[i + 1] = triangleOffsets[i] + desc.geometries[i].getTriangleCount();
+        }
+        const uint32_t triangleCount = triangleOffsets.back();
+
+        auto getTriangle = [&](uint32_t triangle, uint32_t& geometryIndex, uint32_t& primitiveIndex, float3 (&v)[3])
+        {
+            geometryIndex = (uint32_t)(std::upper_bound(triangleOffsets.begin(), triangleOffsets.end(), triangle) - triangleOffsets.begin()) - 1;
+            primitiveIndex = triangle - triangleOffsets[geometryIndex];
+            const GeometryDesc& geometry = desc.geometries[geometryIndex];
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                uint32_t index = geometry.indices.empty() ? 3 * primitiveIndex + j : geometry.indices[3 * primitiveIndex + j];
+                FALCOR_CHECK(index < geometry.positions.size(), "Vertex index {} is out of range.", index);
+                v[j] = geometry.positions[index];
+            }
+        };
+
+        std::vector<AABB> bounds(triangleCount);
+        Threading::parallelFor(0, triangleCount, 0, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                uint32_t geometryIndex, primitiveIndex;
+                float3 v[3];
+                getTriangle((uint32_t)i, geometryIndex, primitiveIndex, v);
+                bounds[i] = AABB(v[0]).include(v[1]).include(v[2]);
+            }
+        });
+
+        CpuBVH::BuildOptions options;
+        options.maxLeafSize = 4;
+        blas.bvh.build(bounds, options);
+
+        // Store the triangles of each leaf in a packet.
+        const auto& triangleOrder = blas.bvh.getPrimitiveIndices();
+        blas.packets.clear();
+        blas.bvh.remapLeaves([&](uint32_t first, uint32_t count)
+        {
+            FALCOR_ASSERT(count <= 4);
+            TrianglePacket packet = {};
+            for (uint32_t lane = 0; lane < count; ++lane)
+            {
+                float3 v[3];
+                getTriangle(triangleOrder[first + lane], packet.geometryIndex[lane], packet.primitiveIndex[lane], v);
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    packet.v0[axis][lane] = v[0][axis];
+                    packet.e1[axis][lane] = v[1][axis] - v[0][axis];
+                    packet.e2[axis][lane] = v[2][axis] - v[0][axis];
+                }
+            }
+            blas.packets.push_back(packet);
+            return (uint32_t)blas.packets.size() - 1;
+        });
+    }
+
+    template<bool kAnyHit>
+    bool CpuSceneRaytracer::traceBlas(const Blas& blas, const float3& origin, const float3& dir, float tMin, float& tMax, Hit& hit) const
+    {
+        const RayData ray(origin, dir, tMin);
+        bool found = false;
+        traverse(blas.bvh, ray, tMin, tMax, [&](uint32_t packetIndex, uint32_t, float& leafTMax)
+        {
+            const TrianglePacket& packet = blas.packets[packetIndex];
+            alignas(16) float t[4], u[4], v[4];
+            uint32_t mask = intersectTriangles(packet.v0, packet.e1, packet.e2, ray, leafTMax, t, u, v);
+            while (mask != 0)
+            {
+                const uint32_t lane = firstBit(mask);
+                mask &= mask - 1;
+                if (t[lane] >= leafTMax) continue;
+                leafTMax = t[lane];
+                hit.t = t[lane];
+                hit.barycentrics = float2(u[lane], v[lane]);
+                hit.primitiveIndex = packet.primitiveIndex[lane];
+                hit.geometryIndex = packet.geometryIndex[lane];
+                found = true;
+                if (kAnyHit) return true;
+            }
+            return false;
+        });
+        return found;
+    }
+
+    template<bool kAnyHit>
+    bool CpuSceneRaytracer::trace(const Ray& ray, Hit& hit) const
+    {
+        hit = Hit();
+        float tMax = ray.tMax;
+        const RayData worldRay(ray.origin, ray.dir, ray.tMin);
+        bool found = false;
+
+        traverse(mTlas, worldRay, ray.tMin, tMax, [&](uint32_t instanceIndex, uint32_t, float& leafTMax)
+        {
+            const Instance& instance = mInstances[instanceIndex];
+            // The direction is not normalized after the transform, so hit distances are the same in both spaces.
+            float3 origin = instance.isIdentity ? ray.origin : transformPoint(instance.worldToObject, ray.origin);
+            float3 dir = instance.isIdentity ? ray.dir : transformVector(instance.worldToObject, ray.dir);
+            if (traceBlas<kAnyHit>(mBlases[instance.blasIndex], origin, dir, ray.tMin, leafTMax, hit))
+            {
+                hit.type = HitType::Triangle;
+                hit.instanceIndex = instanceIndex;
+                hit.instanceID = instance.instanceID + hit.geometryIndex;
+                found = true;
+                if (kAnyHit) return true;
+            }
+            return false;
+        });
+
+        return found;
+    }
+
+    bool CpuSceneRaytracer::traceClosestHit(const Ray& ray, Hit& hit) const
+    {
+        return trace<false>(ray, hit);
+    }
+
+    bool CpuSceneRaytracer::traceAnyHit(const Ray& ray) const
+    {
+        Hit hit;
+        return trace<true>(ray, hit);
+    }
+
+    void CpuSceneRaytracer::traceClosestHits(const std::vector<Ray>& rays, std::vector<Hit>& hits) const
+    {
+        hits.resize(rays.size());
+        Threading::parallelFor(0, rays.size(), kBatchGrainSize, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) trace<false>(rays[i], hits[i]);
+        });
+    }
+
+    void CpuSceneRaytracer::traceAnyHits(const std::vector<Ray>& rays, std::vector<uint8_t>& occluded) const
+    {
+        occluded.resize(rays.size());
+        Threading::parallelFor(0, rays.size(), kBatchGrainSize, [&](size_t begin, size_t end)
+        {
+            Hit hit;
+            for (size_t i = begin; i < end; ++i) occluded[i] = trace<true>(rays[i], hit) ? 1 : 0;
+        });
+    }
+}
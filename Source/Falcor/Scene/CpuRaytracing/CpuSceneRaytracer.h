@@ -0,0 +1,211 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "CpuBVH.h"
+#include "Scene/HitInfoType.slang"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Ray.h"
+#include "Utils/Math/Vector.h"
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    class Scene;
+
+    /** Two-level ray tracing acceleration structure on the CPU.
+
+        This allows tracing rays against triangle geometry without a GPU, e.g. for headless validation and testing.
+        The structure mirrors the GPU acceleration structures built by the scene: there is one bottom-level
+        acceleration structure (BLAS) per mesh group and one top-level instance per instance of the group.
+        Both levels use a 4-wide BVH (see CpuBVH) whose nodes, as well as the triangles in the leaves, are
+        intersected four at a time with SIMD instructions.
+
+        Hits are reported with the same instance ID, primitive index and barycentrics as TriangleHit on the GPU.
+        All geometry is treated as opaque and double-sided, alpha testing is not supported.
+        Displaced meshes, curves, SDF grids and custom primitives are ignored.
+    */
+    class FALCOR_API CpuSceneRaytracer : public Object
+    {
+        FALCOR_OBJECT(CpuSceneRaytracer)
+    public:
+        /** Triangle geometry in the object space of a BLAS.
+        */
+        struct GeometryDesc
+        {
+            std::vector<float3> positions;      ///< Vertex positions.
+            std::vector<uint32_t> indices;      ///< Triangle vertex indices, or empty if the geometry is non-indexed.
+
+            uint32_t getTriangleCount() const { return (uint32_t)(indices.empty() ? positions.size() : indices.size()) / 3; }
+        };
+
+        /** Bottom-level acceleration structure.
+        */
+        struct BlasDesc
+        {
+            std::vector<GeometryDesc> geometries;
+        };
+
+        /** Top-level instance.
+        */
+        struct InstanceDesc
+        {
+            uint32_t blasIndex = 0;                         ///< Index of the instanced BLAS.
+            uint32_t instanceID = 0;                        ///< Instance ID. The reported instance ID of a hit is instanceID + geometry index.
+            float4x4 transform = float4x4::identity();      ///< Object-to-world transform.
+        };
+
+        struct Desc
+        {
+            std::vector<BlasDesc> blases;
+            std::vector<InstanceDesc> instances;
+        };
+
+        /** Ray hit information, compatible with TriangleHit in HitInfo.slang.
+        */
+        struct Hit
+        {
+            HitType type = HitType::None;   ///< HitType::Triangle for a hit, HitType::None for a miss.
+            float t = std::numeric_limits<float>::infinity(); ///< Hit distance in units of the ray direction.
+            uint32_t instanceID = 0;        ///< Global geometry instance ID (instance ID + geometry index).
+            uint32_t primitiveIndex = 0;    ///< Triangle index in the geometry.
+            float2 barycentrics = float2(0.f); ///< Barycentric weights of the second and third vertex.
+            uint32_t instanceIndex = 0;     ///< Index of the top-level instance.
+            uint32_t geometryIndex = 0;     ///< Index of the geometry in the BLAS.
+
+            bool isValid() const { return type != HitType::None; }
+        };
+
+        struct Stats
+        {
+            uint32_t blasCount = 0;
+            uint32_t instanceCount = 0;
+            uint64_t triangleCount = 0;     ///< Number of unique triangles in all BLASes.
+            uint64_t nodeCount = 0;         ///< Number of BVH nodes in all BLASes and the TLAS.
+            uint32_t maxDepth = 0;          ///< Maximum BVH depth of the BLASes.
+            uint64_t memoryInBytes = 0;     ///< Memory used by nodes, triangles and instances.
+            double buildTime = 0.0;         ///< Build time in seconds.
+        };
+
+        /** Create an acceleration structure from a description.
+            \param[in] desc Description of the BLASes and instances.
+            \return New object, or throws an exception on error.
+        */
+        static ref<CpuSceneRaytracer> create(const Desc& desc);
+
+        /** Create an acceleration structure from the triangle meshes of a scene.
+            The BLASes and instances match the ones created by Scene::buildBlas() and Scene::buildTlas(),
+            using the current instance transforms.
+            \param[in] scene Scene.
+            \return New object, or throws an exception on error.
+        */
+        static ref<CpuSceneRaytracer> create(const Scene& scene);
+
+        /** Create a description of the triangle meshes of a scene.
+            \param[in] scene Scene.
+            \return Description of the BLASes and instances.
+        */
+        static Desc createDesc(const Scene& scene);
+
+        /** Trace a ray and find the closest hit.
+            \param[in] ray Ray. The hit distance is in the range [tMin, tMax].
+            \param[out] hit Closest hit.
+            \return True if the ray hit any geometry.
+        */
+        bool traceClosestHit(const Ray& ray, Hit& hit) const;
+
+        /** Trace a ray and stop at the first hit found.
+            \param[in] ray Ray. The hit distance is in the range [tMin, tMax].
+            \return True if the ray hit any geometry.
+        */
+        bool traceAnyHit(const Ray& ray) const;
+
+        /** Trace a batch of rays in parallel and find the closest hits.
+            \param[in] rays Rays.
+            \param[out] hits Closest hit for each ray (HitType::None on miss).
+        */
+        void traceClosestHits(const std::vector<Ray>& rays, std::vector<Hit>& hits) const;
+
+        /** Trace a batch of rays in parallel and check for any hit.
+            \param[in] rays Rays.
+            \param[out] occluded Non-zero for each ray that hit any geometry.
+        */
+        void traceAnyHits(const std::vector<Ray>& rays, std::vector<uint8_t>& occluded) const;
+
+        /** Get the world space bounds of all instances.
+        */
+        const AABB& getBounds() const { return mTlas.getBounds(); }
+
+        const Stats& getStats() const { return mStats; }
+
+        CpuSceneRaytracer(const Desc& desc);
+
+    private:
+        /** Four triangles in SoA layout, intersected together.
+            Unused lanes hold degenerate triangles, which are never hit.
+        */
+        struct TrianglePacket
+        {
+            float v0[3][4];                 ///< First vertex, indexed by [axis][lane].
+            float e1[3][4];                 ///< Edge from the first to the second vertex.
+            float e2[3][4];                 ///< Edge from the first to the third vertex.
+            uint32_t primitiveIndex[4];
+            uint32_t geometryIndex[4];
+        };
+
+        struct Blas
+        {
+            CpuBVH bvh;                             ///< BVH with leaves referencing triangle packets.
+            std::vector<TrianglePacket> packets;
+        };
+
+        struct Instance
+        {
+            uint32_t blasIndex = 0;
+            uint32_t instanceID = 0;
+            bool isIdentity = true;                 ///< True if the transform is identity.
+            float4x4 worldToObject;                 ///< World-to-object transform.
+        };
+
+        template<bool kAnyHit>
+        bool trace(const Ray& ray, Hit& hit) const;
+
+        template<bool kAnyHit>
+        bool traceBlas(const Blas& blas, const float3& origin, const float3& dir, float tMin, float& tMax, Hit& hit) const;
+
+        void buildBlas(Blas& blas, const BlasDesc& desc);
+
+        std::vector<Blas> mBlases;
+        std::vector<Instance> mInstances;
+        CpuBVH mTlas;                               ///< BVH with leaves referencing instances.
+        Stats mStats;
+    };
+}
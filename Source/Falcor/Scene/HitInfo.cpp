@@ -29,6 +29,7 @@
 #include "HitInfoType.slang"
 #include "Scene.h"
 #include "Utils/Logger.h"
+#include <cmath>
 
 namespace Falcor
 {
@@ -121,4 +122,34 @@ namespace Falcor
     {
         return mUseCompression ? ResourceFormat::RG32Uint : ResourceFormat::RGBA32Uint;
     }
+
+    uint4 HitInfo::packTriangleHit(uint32_t instanceID, uint32_t primitiveIndex, float2 barycentrics) const
+    {
+        // See HitInfo::packHeader() and TriangleHit::pack() in HitInfo.slang.
+        const uint32_t typeOffset = 32u - mTypeBits;
+        const uint32_t headerBits = mTypeBits + mInstanceIDBits + mPrimitiveIndexBits;
+
+        uint4 packed(0u);
+        if (headerBits <= 32)
+        {
+            packed[0] = ((uint32_t)HitType::Triangle << typeOffset) | (instanceID << mPrimitiveIndexBits) | primitiveIndex;
+        }
+        else
+        {
+            packed[0] = ((uint32_t)HitType::Triangle << typeOffset) | instanceID;
+            packed[1] = primitiveIndex;
+        }
+
+        if (mUseCompression)
+        {
+            auto packUnorm16 = [](float v) { return (uint32_t)std::trunc(v * 65535.f + 0.5f); };
+            packed[1] = (packUnorm16(barycentrics.y) << 16) | packUnorm16(barycentrics.x);
+        }
+        else
+        {
+            packed[2] = asuint(barycentrics.x);
+            packed[3] = asuint(barycentrics.y);
+        }
+        return packed;
+    }
 }
@@ -29,6 +29,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Formats.h"
 #include "Core/Program/DefineList.h"
+#include "Utils/Math/Vector.h"
 
 namespace Falcor
 {
@@ -62,6 +63,15 @@ namespace Falcor
         */
         ResourceFormat getFormat() const;
 
+        /** Pack a triangle hit in the format written by TriangleHit::pack() in shaders.
+            This allows comparing hits found on the CPU (see CpuSceneRaytracer) with hit info read back from the GPU.
+            \param[in] instanceID Global geometry instance ID.
+            \param[in] primitiveIndex Triangle index within the mesh.
+            \param[in] barycentrics Barycentrics of the hit.
+            \return Packed hit info. With compression, only the first two components are used.
+        */
+        uint4 packTriangleHit(uint32_t instanceID, uint32_t primitiveIndex, float2 barycentrics) const;
+
     private:
         bool mUseCompression = false;       ///< Store in compressed format (64 bits instead of 128 bits).
 
@@ -151,6 +151,11 @@ namespace Falcor
         */
         virtual const std::vector<MeshLightData>& getMeshLights() const = 0;
 
+        /** Returns the indices of the mesh lights changed by the last call to update().
+            This is valid when the update signals UpdateFlags::MatrixChanged.
+        */
+        virtual const std::vector<uint32_t>& getUpdatedLights() const = 0;
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
@@ -108,6 +108,10 @@ namespace Falcor
         */
         const std::vector<MeshLightData>& getMeshLights() const override { return mMeshLights; }
 
+        /** Returns the indices of the mesh lights changed by the last call to update().
+        */
+        const std::vector<uint32_t>& getUpdatedLights() const override { return mUpdatedLights; }
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
@@ -154,6 +158,7 @@ namespace Falcor
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
+        std::vector<uint32_t>                   mUpdatedLights;         ///< Indices of the mesh lights changed by the last update().
 
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
         mutable std::vector<uint32_t>           mActiveTriangleList;    ///< List of active (non-culled) emissive triangles.
@@ -611,6 +611,33 @@ namespace Falcor
         return true;
     }
 
+    uint64_t BasicMaterial::computeHash() const
+    {
+        // Hashes the same data that is compared by operator==.
+        FNVHash64 hash;
+        hashBase(hash);
+
+        hash.insert(mData.flags);
+        hashFloat(hash, mData.displacementScale);
+        hashFloat(hash, mData.displacementOffset);
+        hashVector(hash, mData.baseColor);
+        hashVector(hash, mData.specular);
+        hashVector(hash, mData.emissive);
+        hashFloat(hash, mData.emissiveFactor);
+        hashFloat(hash, mData.diffuseTransmission);
+        hashFloat(hash, mData.specularTransmission);
+        hashVector(hash, mData.transmission);
+        hashVector(hash, mData.volumeAbsorption);
+        hashFloat(hash, mData.volumeAnisotropy);
+        hashVector(hash, mData.volumeScattering);
+
+        hashSamplerDesc(hash, mpDefaultSampler->getDesc());
+        hashSamplerDesc(hash, mpDisplacementMinSampler->getDesc());
+        hashSamplerDesc(hash, mpDisplacementMaxSampler->getDesc());
+
+        return hash.get();
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
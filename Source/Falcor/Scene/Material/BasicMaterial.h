@@ -66,6 +66,11 @@ namespace Falcor
         */
         bool isEqual(const ref<Material>& pOther) const override;
 
+        /** Compute a hash of the material properties.
+            \return Hash of all material properties *except* the name.
+        */
+        uint64_t computeHash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
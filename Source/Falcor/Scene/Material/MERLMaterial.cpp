@@ -141,6 +141,14 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        hashPath(hash, mPath);
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
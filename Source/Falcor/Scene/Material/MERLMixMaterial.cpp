@@ -235,6 +235,22 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMixMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        for (const auto& brdf : mBRDFs)
+        {
+            hashString(hash, brdf.name);
+            hashPath(hash, brdf.path);
+        }
+        hash.insert(mBRDFs.size());
+
+        hashSamplerDesc(hash, mpDefaultSampler->getDesc());
+
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -328,6 +328,59 @@ namespace Falcor
         return true;
     }
 
+    void Material::hashBase(FNVHash64& hash) const
+    {
+        // Hashes the same data that is compared by isBaseEqual().
+        hash.insert(mHeader.packedData);
+        hashVector(hash, mTextureTransform.getTranslation());
+        hashVector(hash, mTextureTransform.getScaling());
+        const quatf& rotation = mTextureTransform.getRotation();
+        hashVector(hash, float4(rotation.x, rotation.y, rotation.z, rotation.w));
+
+        FALCOR_ASSERT(mTextureSlotInfo.size() == mTextureSlotData.size());
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            bool hasSlot = hasTextureSlot((TextureSlot)i);
+            hash.insert(hasSlot);
+            if (hasSlot)
+            {
+                const auto& info = mTextureSlotInfo[i];
+                hashString(hash, info.name);
+                hash.insert(info.mask);
+                hash.insert(info.srgb);
+                hash.insert(mTextureSlotData[i].pTexture.get());
+            }
+        }
+    }
+
+    void Material::hashPath(FNVHash64& hash, const std::filesystem::path& path)
+    {
+        // Hash the path elements, as paths are compared element-wise.
+        for (const auto& element : path)
+        {
+            const auto& str = element.native();
+            hash.insert(str.size());
+            hash.insert(str.data(), str.size() * sizeof(std::filesystem::path::value_type));
+        }
+    }
+
+    void Material::hashSamplerDesc(FNVHash64& hash, const Sampler::Desc& desc)
+    {
+        hash.insert(desc.magFilter);
+        hash.insert(desc.minFilter);
+        hash.insert(desc.mipFilter);
+        hash.insert(desc.maxAnisotropy);
+        hashFloat(hash, desc.maxLod);
+        hashFloat(hash, desc.minLod);
+        hashFloat(hash, desc.lodBias);
+        hash.insert(desc.comparisonFunc);
+        hash.insert(desc.reductionMode);
+        hash.insert(desc.addressModeU);
+        hash.insert(desc.addressModeV);
+        hash.insert(desc.addressModeW);
+        hashVector(hash, desc.borderColor);
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
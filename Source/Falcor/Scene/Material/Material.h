@@ -38,6 +38,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -163,6 +164,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            The hash is consistent with isEqual(), i.e. materials that compare equal have the same hash.
+            Textures are identified by their object identity, the same way isEqual() compares them.
+            \return Hash of all material properties *except* the name.
+        */
+        virtual uint64_t computeHash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -360,6 +368,25 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
+        void hashBase(FNVHash64& hash) const;
+
+        /** Helpers for hashing values consistently with their comparison operators.
+            Positive and negative zero compare equal and are hashed identically.
+        */
+        static void hashFloat(FNVHash64& hash, float value) { hash.insert(value == 0.f ? 0.f : value); }
+        template<typename T, int N>
+        static void hashVector(FNVHash64& hash, const math::vector<T, N>& value)
+        {
+            for (int i = 0; i < N; i++)
+                hashFloat(hash, float(value[i]));
+        }
+        static void hashString(FNVHash64& hash, const std::string& str)
+        {
+            hash.insert(str.size());
+            hash.insert(str.data(), str.size());
+        }
+        static void hashPath(FNVHash64& hash, const std::filesystem::path& path);
+        static void hashSamplerDesc(FNVHash64& hash, const Sampler::Desc& desc);
 
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
@@ -226,9 +226,9 @@ namespace Falcor
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Reuse previously added materials.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            return MaterialID{(size_t)std::distance(mMaterials.begin(), it) };
+            return it->second;
         }
 
         // Add material.
@@ -245,6 +245,7 @@ namespace Falcor
 
         pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
         mMaterials.push_back(pMaterial);
+        mMaterialIDs.emplace(pMaterial.get(), materialID);
         mMaterialsChanged = true;
 
         return materialID;
@@ -261,8 +262,25 @@ namespace Falcor
         mReservedBufferDescCount += material->getMaxBufferCount();
         mReservedTexture3DDescCount += material->getMaxTexture3DCount();
 
+        // The same material can occur multiple times in the list after replaceMaterial().
+        // The map stores the first occurrence. If this is it, the next occurrence (if any) takes its place.
+        bool hasOtherOccurrence = true;
+        if (auto it = mMaterialIDs.find(material.get()); it != mMaterialIDs.end() && it->second == materialID)
+        {
+            MaterialID nextID{ materialID.get() + 1 };
+            while (nextID.get() < mMaterials.size() && mMaterials[nextID.get()] != material)
+                ++nextID;
+
+            hasOtherOccurrence = nextID.get() < mMaterials.size();
+            if (hasOtherOccurrence)
+                it->second = nextID;
+            else
+                mMaterialIDs.erase(it);
+        }
+
         // Remove textures that were used by the material and loaded via the texture manager.
-        mpTextureManager->removeTextures(material.get());
+        if (!hasOtherOccurrence)
+            mpTextureManager->removeTextures(material.get());
 
         // Remove the material.
         mMaterials[materialID.get()] = nullptr;
@@ -286,6 +304,10 @@ namespace Falcor
 
         // Replace the material.
         mMaterials[materialID.get()] = pReplacement;
+        if (auto [it, inserted] = mMaterialIDs.emplace(pReplacement.get(), materialID); !inserted && materialID.get() < it->second.get())
+        {
+            it->second = materialID;
+        }
         mMaterialsChanged = true;
     }
 
@@ -294,10 +316,9 @@ namespace Falcor
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Find material to replace.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            auto materialID = MaterialID{ (size_t)std::distance(mMaterials.begin(), it) };
-            replaceMaterial(materialID, pReplacement);
+            replaceMaterial(it->second, pReplacement);
         }
         else
         {
@@ -350,27 +371,39 @@ namespace Falcor
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Bucket unique materials by hash. Materials that are equal have the same hash,
+        // so each material only needs to be compared against materials in its bucket.
+        std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+
         // Find unique set of materials.
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[pMaterial->computeHash()];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](uint32_t index) { return uniqueMaterials[index]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
+                bucket.push_back((uint32_t)uniqueMaterials.size());
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logDebug("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[*it]->getName());
+                idMap[id.get()] = MaterialID{ *it };
             }
         }
 
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
+            logInfo("Removed {} duplicate materials.", removed);
             mMaterials = uniqueMaterials;
+            mMaterialIDs.clear();
+            for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
+            {
+                mMaterialIDs.emplace(mMaterials[id.get()].get(), id);
+            }
             mMaterialsChanged = true;
         }
 
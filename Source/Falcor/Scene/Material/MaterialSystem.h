@@ -39,6 +39,7 @@
 #include <memory>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -265,6 +266,7 @@ namespace Falcor
         ref<Device> mpDevice;
 
         std::vector<ref<Material>> mMaterials;                      ///< List of all materials.
+        std::unordered_map<const Material*, MaterialID> mMaterialIDs; ///< Map from material to the ID of its first occurrence in the list.
         std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
         std::unique_ptr<TextureManager> mpTextureManager;           ///< Texture manager holding all material textures.
         ProgramDesc::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
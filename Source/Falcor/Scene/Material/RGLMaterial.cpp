@@ -135,6 +135,14 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        hashPath(hash, mPath);
+        return hash.get();
+    }
+
     ProgramDesc::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -0,0 +1,644 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PlyReader.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <fast_float/fast_float.h>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        enum class PlyFormat
+        {
+            Ascii,
+            BinaryLittleEndian,
+            BinaryBigEndian,
+        };
+
+        enum class PlyType
+        {
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Float32,
+            Float64,
+        };
+
+        struct PlyProperty
+        {
+            std::string name;
+            PlyType type = PlyType::Float32;        ///< Value type, or item type for lists.
+            bool isList = false;
+            PlyType countType = PlyType::UInt8;     ///< Type of the item count for lists.
+        };
+
+        struct PlyElement
+        {
+            std::string name;
+            size_t count = 0;
+            std::vector<PlyProperty> properties;
+        };
+
+        struct PlyHeader
+        {
+            PlyFormat format = PlyFormat::Ascii;
+            std::vector<PlyElement> elements;
+            size_t dataOffset = 0;                  ///< Offset of the first byte after the header.
+        };
+
+        /// Vertex attributes read from the vertex element.
+        enum VertexSlot
+        {
+            kPositionX, kPositionY, kPositionZ,
+            kNormalX, kNormalY, kNormalZ,
+            kTexCoordU, kTexCoordV,
+            kVertexSlotCount,
+        };
+
+        int getVertexSlot(const std::string& name)
+        {
+            if (name == "x") return kPositionX;
+            if (name == "y") return kPositionY;
+            if (name == "z") return kPositionZ;
+            if (name == "nx") return kNormalX;
+            if (name == "ny") return kNormalY;
+            if (name == "nz") return kNormalZ;
+            if (name == "u" || name == "s" || name == "texture_u" || name == "texture_s") return kTexCoordU;
+            if (name == "v" || name == "t" || name == "texture_v" || name == "texture_t") return kTexCoordV;
+            return -1;
+        }
+
+        size_t getTypeSize(PlyType type)
+        {
+            switch (type)
+            {
+            case PlyType::Int8:
+            case PlyType::UInt8:
+                return 1;
+            case PlyType::Int16:
+            case PlyType::UInt16:
+                return 2;
+            case PlyType::Int32:
+            case PlyType::UInt32:
+            case PlyType::Float32:
+                return 4;
+            case PlyType::Float64:
+                return 8;
+            }
+            FALCOR_UNREACHABLE();
+        }
+
+        PlyType parseType(std::string_view str)
+        {
+            if (str == "char" || str == "int8") return PlyType::Int8;
+            if (str == "uchar" || str == "uint8") return PlyType::UInt8;
+            if (str == "short" || str == "int16") return PlyType::Int16;
+            if (str == "ushort" || str == "uint16") return PlyType::UInt16;
+            if (str == "int" || str == "int32") return PlyType::Int32;
+            if (str == "uint" || str == "uint32") return PlyType::UInt32;
+            if (str == "float" || str == "float32") return PlyType::Float32;
+            if (str == "double" || str == "float64") return PlyType::Float64;
+            FALCOR_THROW("Invalid PLY property type '{}'.", str);
+        }
+
+        std::vector<std::string_view> splitWords(std::string_view line)
+        {
+            std::vector<std::string_view> words;
+            size_t pos = 0;
+            while (pos < line.size())
+            {
+                while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) ++pos;
+                size_t start = pos;
+                while (pos < line.size() && !(line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) ++pos;
+                if (pos > start) words.push_back(line.substr(start, pos - start));
+            }
+            return words;
+        }
+
+        size_t parseCount(std::string_view str)
+        {
+            size_t count = 0;
+            auto result = std::from_chars(str.data(), str.data() + str.size(), count);
+            if (result.ec != std::errc() || result.ptr != str.data() + str.size())
+                FALCOR_THROW("Invalid PLY element count '{}'.", str);
+            return count;
+        }
+
+        PlyHeader parseHeader(const char* pData, size_t size)
+        {
+            PlyHeader header;
+            std::string_view data(pData, size);
+
+            // Returns the next line without the line break.
+            size_t pos = 0;
+            auto nextLine = [&]() -> std::string_view
+            {
+                size_t end = data.find('\n', pos);
+                if (end == std::string_view::npos)
+                    FALCOR_THROW("Invalid PLY header (missing 'end_header').");
+                std::string_view line = data.substr(pos, end - pos);
+                pos = end + 1;
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                return line;
+            };
+
+            if (nextLine() != "ply")
+                FALCOR_THROW("Invalid PLY header (missing 'ply' magic).");
+
+            bool hasFormat = false;
+            while (true)
+            {
+                std::string_view line = nextLine();
+                auto words = splitWords(line);
+                if (words.empty()) continue;
+
+                if (words[0] == "end_header")
+                {
+                    break;
+                }
+                else if (words[0] == "format")
+                {
+                    if (words.size() < 2)
+                        FALCOR_THROW("Invalid PLY format line '{}'.", line);
+                    if (words[1] == "ascii") header.format = PlyFormat::Ascii;
+                    else if (words[1] == "binary_little_endian") header.format = PlyFormat::BinaryLittleEndian;
+                    else if (words[1] == "binary_big_endian") header.format = PlyFormat::BinaryBigEndian;
+                    else FALCOR_THROW("Unsupported PLY format '{}'.", words[1]);
+                    hasFormat = true;
+                }
+                else if (words[0] == "element")
+                {
+                    if (words.size() != 3)
+                        FALCOR_THROW("Invalid PLY element line '{}'.", line);
+                    header.elements.push_back({std::string(words[1]), parseCount(words[2]), {}});
+                }
+                else if (words[0] == "property")
+                {
+                    if (header.elements.empty())
+                        FALCOR_THROW("PLY property '{}' defined before any element.", line);
+                    PlyProperty property;
+                    if (words.size() == 5 && words[1] == "list")
+                    {
+                        property.isList = true;
+                        property.countType = parseType(words[2]);
+                        property.type = parseType(words[3]);
+                        property.name = words[4];
+                        if (property.countType == PlyType::Float32 || property.countType == PlyType::Float64)
+                            FALCOR_THROW("Invalid PLY list count type in '{}'.", line);
+                    }
+                    else if (words.size() == 3)
+                    {
+                        property.type = parseType(words[1]);
+                        property.name = words[2];
+                    }
+                    else
+                    {
+                        FALCOR_THROW("Invalid PLY property line '{}'.", line);
+                    }
+                    header.elements.back().properties.push_back(std::move(property));
+                }
+                else if (words[0] != "comment" && words[0] != "obj_info")
+                {
+                    FALCOR_THROW("Unexpected PLY header line '{}'.", line);
+                }
+            }
+
+            if (!hasFormat)
+                FALCOR_THROW("Invalid PLY header (missing 'format').");
+
+            header.dataOffset = pos;
+            return header;
+        }
+
+        /** Convert a floating-point value read from the file to the requested type.
+            Integers are converted through int64_t, so that negative values wrap instead of being undefined.
+        */
+        template<typename T>
+        T convertValue(double value)
+        {
+            if constexpr (std::is_integral_v<T>)
+            {
+                if (!(value >= -9.0e18 && value <= 9.0e18))
+                    FALCOR_THROW("Invalid integer value in PLY file.");
+                return static_cast<T>(static_cast<int64_t>(value));
+            }
+            else
+            {
+                return static_cast<T>(value);
+            }
+        }
+
+        /** Reads values from the binary body of a PLY file.
+        */
+        class BinaryReader
+        {
+        public:
+            BinaryReader(const uint8_t* pData, size_t size, bool swapBytes)
+                : mPtr(pData), mEnd(pData + size), mSwapBytes(swapBytes)
+            {}
+
+            template<typename T>
+            T read(PlyType type)
+            {
+                switch (type)
+                {
+                case PlyType::Int8: return static_cast<T>(readRaw<int8_t>());
+                case PlyType::UInt8: return static_cast<T>(readRaw<uint8_t>());
+                case PlyType::Int16: return static_cast<T>(readRaw<int16_t>());
+                case PlyType::UInt16: return static_cast<T>(readRaw<uint16_t>());
+                case PlyType::Int32: return static_cast<T>(readRaw<int32_t>());
+                case PlyType::UInt32: return static_cast<T>(readRaw<uint32_t>());
+                case PlyType::Float32: return convertValue<T>(readRaw<float>());
+                case PlyType::Float64: return convertValue<T>(readRaw<double>());
+                }
+                FALCOR_UNREACHABLE();
+            }
+
+            void skip(PlyType type, size_t count = 1)
+            {
+                size_t size = getTypeSize(type) * count;
+                checkAvailable(size);
+                mPtr += size;
+            }
+
+            /** Read fixed size vertices with float32 attributes in native byte order.
+                \param[in] count Number of vertices.
+                \param[in] stride Size of a vertex in bytes.
+                \param[in] offsets Byte offset of each vertex slot, or -1 if not present.
+                \param[out] pDst Destination with kVertexSlotCount floats per vertex.
+            */
+            void readVertices(size_t count, size_t stride, const std::array<int, kVertexSlotCount>& offsets, float* pDst)
+            {
+                FALCOR_ASSERT(!mSwapBytes);
+                checkAvailable(count * stride);
+                for (size_t i = 0; i < count; ++i, mPtr += stride, pDst += kVertexSlotCount)
+                {
+                    for (int slot = 0; slot < kVertexSlotCount; ++slot)
+                    {
+                        if (offsets[slot] >= 0) std::memcpy(&pDst[slot], mPtr + offsets[slot], sizeof(float));
+                    }
+                }
+            }
+
+            /** Read faces with a uint8 vertex count and 32-bit indices in native byte order.
+                \param[in] count Number of faces.
+                \param[in,out] indices Index list to append the triangulated faces to.
+            */
+            void readFaces(size_t count, std::vector<uint32_t>& indices)
+            {
+                FALCOR_ASSERT(!mSwapBytes);
+                for (size_t f = 0; f < count; ++f)
+                {
+                    checkAvailable(1);
+                    uint32_t vertexCount = *mPtr++;
+                    checkAvailable(vertexCount * sizeof(uint32_t));
+                    if (vertexCount == 3)
+                    {
+                        size_t offset = indices.size();
+                        indices.resize(offset + 3);
+                        std::memcpy(&indices[offset], mPtr, 3 * sizeof(uint32_t));
+                    }
+                    else
+                    {
+                        for (uint32_t j = 2; j < vertexCount; ++j)
+                        {
+                            uint32_t triangle[3];
+                            std::memcpy(&triangle[0], mPtr, sizeof(uint32_t));
+                            std::memcpy(&triangle[1], mPtr + (j - 1) * sizeof(uint32_t), sizeof(uint32_t));
+                            std::memcpy(&triangle[2], mPtr + j * sizeof(uint32_t), sizeof(uint32_t));
+                            indices.insert(indices.end(), triangle, triangle + 3);
+                        }
+                    }
+                    mPtr += vertexCount * sizeof(uint32_t);
+                }
+            }
+
+            bool isNativeByteOrder() const { return !mSwapBytes; }
+
+        private:
+            void checkAvailable(size_t size)
+            {
+                if (size_t(mEnd - mPtr) < size)
+                    FALCOR_THROW("Unexpected end of PLY file.");
+            }
+
+            template<typename T>
+            T readRaw()
+            {
+                checkAvailable(sizeof(T));
+                T value;
+                if (mSwapBytes)
+                {
+                    uint8_t bytes[sizeof(T)];
+                    for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = mPtr[sizeof(T) - 1 - i];
+                    std::memcpy(&value, bytes, sizeof(T));
+                }
+                else
+                {
+                    std::memcpy(&value, mPtr, sizeof(T));
+                }
+                mPtr += sizeof(T);
+                return value;
+            }
+
+            const uint8_t* mPtr;
+            const uint8_t* mEnd;
+            bool mSwapBytes;
+        };
+
+        /** Reads values from the ASCII body of a PLY file.
+        */
+        class AsciiReader
+        {
+        public:
+            AsciiReader(const char* pData, size_t size)
+                : mPtr(pData), mEnd(pData + size)
+            {}
+
+            template<typename T>
+            T read(PlyType)
+            {
+                skipWhitespace();
+                if (mPtr < mEnd && *mPtr == '+') ++mPtr;
+                double value = 0.0;
+                auto result = fast_float::from_chars(mPtr, mEnd, value);
+                if (result.ec != std::errc())
+                    FALCOR_THROW("Invalid number in PLY file.");
+                mPtr = result.ptr;
+                return convertValue<T>(value);
+            }
+
+            void skip(PlyType type, size_t count = 1)
+            {
+                for (size_t i = 0; i < count; ++i) read<double>(type);
+            }
+
+        private:
+            void skipWhitespace()
+            {
+                while (mPtr < mEnd && (*mPtr == ' ' || *mPtr == '\t' || *mPtr == '\r' || *mPtr == '\n')) ++mPtr;
+                if (mPtr == mEnd)
+                    FALCOR_THROW("Unexpected end of PLY file.");
+            }
+
+            const char* mPtr;
+            const char* mEnd;
+        };
+
+        template<typename Reader>
+        void readVertexElement(Reader& reader, const PlyElement& element, PlyReader::Mesh& mesh)
+        {
+            std::array<int, kVertexSlotCount> slotProperty;
+            slotProperty.fill(-1);
+            std::vector<int> propertySlot(element.properties.size(), -1);
+            bool isFixedFloat32 = true;
+            for (size_t i = 0; i < element.properties.size(); ++i)
+            {
+                const auto& property = element.properties[i];
+                isFixedFloat32 &= !property.isList;
+                int slot = property.isList ? -1 : getVertexSlot(property.name);
+                if (slot < 0) continue;
+                isFixedFloat32 &= property.type == PlyType::Float32;
+                slotProperty[slot] = int(i);
+                propertySlot[i] = slot;
+            }
+
+            if (slotProperty[kPositionX] < 0 || slotProperty[kPositionY] < 0 || slotProperty[kPositionZ] < 0)
+                FALCOR_THROW("PLY vertex element is missing positions.");
+            mesh.hasNormals = slotProperty[kNormalX] >= 0 && slotProperty[kNormalY] >= 0 && slotProperty[kNormalZ] >= 0;
+            mesh.hasTexCoords = slotProperty[kTexCoordU] >= 0 && slotProperty[kTexCoordV] >= 0;
+
+            // The vertex slots match the memory layout of TriangleMesh::Vertex, so attributes are read in place.
+            static_assert(sizeof(TriangleMesh::Vertex) == kVertexSlotCount * sizeof(float));
+            static_assert(offsetof(TriangleMesh::Vertex, normal) == kNormalX * sizeof(float));
+            static_assert(offsetof(TriangleMesh::Vertex, texCoord) == kTexCoordU * sizeof(float));
+            mesh.vertices.resize(element.count);
+            float* pValues = reinterpret_cast<float*>(mesh.vertices.data());
+
+            if constexpr (std::is_same_v<Reader, BinaryReader>)
+            {
+                if (isFixedFloat32 && reader.isNativeByteOrder())
+                {
+                    std::array<int, kVertexSlotCount> offsets;
+                    offsets.fill(-1);
+                    size_t stride = 0;
+                    for (size_t i = 0; i < element.properties.size(); ++i)
+                    {
+                        if (propertySlot[i] >= 0) offsets[propertySlot[i]] = int(stride);
+                        stride += getTypeSize(element.properties[i].type);
+                    }
+                    reader.readVertices(element.count, stride, offsets, pValues);
+                    return;
+                }
+            }
+
+            for (size_t v = 0; v < element.count; ++v, pValues += kVertexSlotCount)
+            {
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& property = element.properties[i];
+                    if (property.isList)
+                        reader.skip(property.type, reader.template read<size_t>(property.countType));
+                    else if (propertySlot[i] >= 0)
+                        pValues[propertySlot[i]] = reader.template read<float>(property.type);
+                    else
+                        reader.skip(property.type);
+                }
+            }
+        }
+
+        template<typename Reader>
+        void readFaceElement(Reader& reader, const PlyElement& element, PlyReader::Mesh& mesh)
+        {
+            int indexProperty = -1;
+            for (size_t i = 0; i < element.properties.size(); ++i)
+            {
+                const auto& property = element.properties[i];
+                if (property.isList && (property.name == "vertex_indices" || property.name == "vertex_index"))
+                    indexProperty = int(i);
+            }
+            if (indexProperty < 0)
+                FALCOR_THROW("PLY face element is missing vertex indices.");
+
+            // Most files contain only triangles or quads.
+            mesh.indices.reserve(element.count * 3);
+
+            if constexpr (std::is_same_v<Reader, BinaryReader>)
+            {
+                const auto& property = element.properties[indexProperty];
+                const bool is32Bit = property.type == PlyType::Int32 || property.type == PlyType::UInt32;
+                if (element.properties.size() == 1 && property.countType == PlyType::UInt8 && is32Bit && reader.isNativeByteOrder())
+                {
+                    reader.readFaces(element.count, mesh.indices);
+                    return;
+                }
+            }
+
+            for (size_t f = 0; f < element.count; ++f)
+            {
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& property = element.properties[i];
+                    if (int(i) != indexProperty)
+                    {
+                        if (property.isList)
+                            reader.skip(property.type, reader.template read<size_t>(property.countType));
+                        else
+                            reader.skip(property.type);
+                        continue;
+                    }
+
+                    // Triangulate as a fan, polygons with less than three vertices are skipped.
+                    size_t count = reader.template read<size_t>(property.countType);
+                    uint32_t first = 0;
+                    uint32_t prev = 0;
+                    for (size_t j = 0; j < count; ++j)
+                    {
+                        uint32_t index = reader.template read<uint32_t>(property.type);
+                        if (j == 0)
+                        {
+                            first = index;
+                        }
+                        else if (j >= 2)
+                        {
+                            mesh.indices.push_back(first);
+                            mesh.indices.push_back(prev);
+                            mesh.indices.push_back(index);
+                        }
+                        prev = index;
+                    }
+                }
+            }
+        }
+
+        template<typename Reader>
+        void readBody(Reader& reader, const PlyHeader& header, PlyReader::Mesh& mesh)
+        {
+            bool hasVertices = false;
+            for (const auto& element : header.elements)
+            {
+                if (element.name == "vertex")
+                {
+                    readVertexElement(reader, element, mesh);
+                    hasVertices = true;
+                }
+                else if (element.name == "face")
+                {
+                    readFaceElement(reader, element, mesh);
+                }
+                else if (!element.properties.empty())
+                {
+                    // Skip unused elements. Elements without properties have no data, their count is not bounded by the file size.
+                    for (size_t e = 0; e < element.count; ++e)
+                    {
+                        for (const auto& property : element.properties)
+                        {
+                            if (property.isList)
+                                reader.skip(property.type, reader.template read<size_t>(property.countType));
+                            else
+                                reader.skip(property.type);
+                        }
+                    }
+                }
+            }
+
+            if (!hasVertices)
+                FALCOR_THROW("PLY file has no vertex element.");
+
+            for (uint32_t index : mesh.indices)
+            {
+                if (index >= mesh.vertices.size())
+                    FALCOR_THROW("PLY face references vertex {} out of {} vertices.", index, mesh.vertices.size());
+            }
+        }
+    }
+
+    PlyReader::Mesh PlyReader::readFile(const std::filesystem::path& path)
+    {
+        try
+        {
+            if (hasExtension(path, "gz"))
+            {
+                std::string data = decompressFile(path);
+                return read(data.data(), data.size());
+            }
+
+            MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+            if (!file.isOpen())
+                FALCOR_THROW("Failed to open file.");
+            return read(file.getData(), file.getSize());
+        }
+        catch (const RuntimeError& e)
+        {
+            FALCOR_THROW("Failed to read PLY file '{}': {}", path, e.what());
+        }
+    }
+
+    PlyReader::Mesh PlyReader::read(const void* pData, size_t size)
+    {
+        const char* pChars = reinterpret_cast<const char*>(pData);
+        PlyHeader header = parseHeader(pChars, size);
+
+        // Elements with properties need at least one byte per instance, which bounds the counts of corrupt files.
+        const size_t bodySize = size - header.dataOffset;
+        for (const auto& element : header.elements)
+        {
+            if (!element.properties.empty() && element.count > bodySize)
+                FALCOR_THROW("PLY element '{}' count {} exceeds the file size.", element.name, element.count);
+        }
+
+        Mesh mesh;
+        if (header.format == PlyFormat::Ascii)
+        {
+            AsciiReader reader(pChars + header.dataOffset, bodySize);
+            readBody(reader, header, mesh);
+        }
+        else
+        {
+            const bool isLittleEndian = header.format == PlyFormat::BinaryLittleEndian;
+            const uint16_t endianTest = 1;
+            const bool isHostLittleEndian = *reinterpret_cast<const uint8_t*>(&endianTest) == 1;
+            BinaryReader reader(reinterpret_cast<const uint8_t*>(pChars + header.dataOffset), bodySize, isLittleEndian != isHostLittleEndian);
+            readBody(reader, header, mesh);
+        }
+        return mesh;
+    }
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "TriangleMesh.h"
+#include "Core/Macros.h"
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Reader for triangle meshes stored in the PLY (polygon file format).
+
+        Supports ASCII and binary (little and big endian) files, optionally gzip compressed (.ply.gz).
+        Uncompressed files are memory mapped and parsed directly into a TriangleMesh vertex and index list.
+        The vertex element provides positions (x/y/z) and optionally normals (nx/ny/nz) and texture
+        coordinates (u/v, s/t, texture_u/texture_v or texture_s/texture_t). Polygonal faces are triangulated
+        as triangle fans. All other elements and properties are skipped.
+
+        The reader has no shared state, so multiple files can be loaded concurrently from different threads.
+    */
+    class FALCOR_API PlyReader
+    {
+    public:
+        struct Mesh
+        {
+            TriangleMesh::VertexList vertices;
+            TriangleMesh::IndexList indices;
+            bool hasNormals = false;    ///< True if the file contains vertex normals, otherwise normals are zero.
+            bool hasTexCoords = false;  ///< True if the file contains texture coordinates, otherwise they are zero.
+        };
+
+        /** Read a mesh from a PLY file. Files with .gz extension are decompressed first.
+            Throws a RuntimeError if the file cannot be read or is not a valid PLY file.
+            \param[in] path File path.
+            \return The mesh.
+        */
+        static Mesh readFile(const std::filesystem::path& path);
+
+        /** Read a mesh from PLY data in memory.
+            Throws a RuntimeError if the data is not a valid PLY file.
+            \param[in] pData Pointer to the file contents.
+            \param[in] size Size of the file contents in bytes.
+            \return The mesh.
+        */
+        static Mesh read(const void* pData, size_t size);
+    };
+}
@@ -603,6 +603,10 @@ void Scene::createMeshUVTiles(const std::vector<MeshDesc>& meshDescs)
 {
     mMeshUVTiles.resize(meshDescs.size());
 
+    // Access the CPU data through const references, it may be read-only data mapped from the scene cache.
+    const auto& meshIndexData = mMeshIndexData;
+    const auto& meshStaticData = mMeshStaticData;
+
     auto processMeshTile = [&](size_t meshIndex)
     {
         const MeshDesc& desc = meshDescs[meshIndex];
@@ -612,7 +616,7 @@ void Scene::createMeshUVTiles(const std::vector<MeshDesc>& meshDescs)
 
         const uint8_t* meshIndexData8 = nullptr;
         if (desc.useVertexIndices())
-            meshIndexData8 = reinterpret_cast<const uint8_t*>(&mMeshIndexData[desc.ibOffset]);
+            meshIndexData8 = reinterpret_cast<const uint8_t*>(&meshIndexData[desc.ibOffset]);
 
         const uint tcount = desc.getTriangleCount();
         for (uint tidx = 0; tidx < tcount; ++tidx)
@@ -651,9 +655,9 @@ void Scene::createMeshUVTiles(const std::vector<MeshDesc>& meshDescs)
             // Load vertices from global vertex buffer.
             // Note that the mesh local vbOffset is added to address into the global vertex buffer.
             StaticVertexData vertices[3];
-            vertices[0] = mMeshStaticData[(size_t)desc.vbOffset + vidx[0]].unpack();
-            vertices[1] = mMeshStaticData[(size_t)desc.vbOffset + vidx[1]].unpack();
-            vertices[2] = mMeshStaticData[(size_t)desc.vbOffset + vidx[2]].unpack();
+            vertices[0] = meshStaticData[(size_t)desc.vbOffset + vidx[0]].unpack();
+            vertices[1] = meshStaticData[(size_t)desc.vbOffset + vidx[1]].unpack();
+            vertices[2] = meshStaticData[(size_t)desc.vbOffset + vidx[2]].unpack();
 
             int2 v0 = int2(std::floor(vertices[0].texCrd[0]), std::floor(vertices[0].texCrd[1]));
             int2 v1 = int2(std::floor(vertices[1].texCrd[0]), std::floor(vertices[1].texCrd[1]));
@@ -922,28 +926,47 @@ void Scene::bindSelectedCamera()
         getCamera()->bindShaderData(mpSceneBlock->getRootVar()[kCamera]);
 }
 
-void Scene::updateBounds()
+void Scene::createNodeInstanceMapping()
 {
-    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+    // Count the instances of each node, then scatter the instance IDs into the per-node ranges.
+    mNodeInstanceOffsets.assign(mSceneGraph.size() + 1, 0);
+    for (const auto& inst : mGeometryInstanceData)
+    {
+        FALCOR_ASSERT(inst.globalMatrixID < mSceneGraph.size());
+        mNodeInstanceOffsets[inst.globalMatrixID + 1]++;
+    }
+    std::partial_sum(mNodeInstanceOffsets.begin(), mNodeInstanceOffsets.end(), mNodeInstanceOffsets.begin());
+
+    std::vector<uint32_t> offsets(mNodeInstanceOffsets.begin(), mNodeInstanceOffsets.end() - 1);
+    mNodeInstances.resize(mGeometryInstanceData.size());
+    for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); ++instanceID)
+    {
+        mNodeInstances[offsets[mGeometryInstanceData[instanceID].globalMatrixID]++] = instanceID;
+    }
+}
 
-    mSceneBB = AABB();
+void Scene::updateBounds(bool forceUpdate)
+{
+    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-    for (const auto& inst : mGeometryInstanceData)
+    auto updateInstanceBounds = [&](uint32_t instanceID)
     {
+        const auto& inst = mGeometryInstanceData[instanceID];
         const float4x4& transform = globalMatrices[inst.globalMatrixID];
+        AABB bounds;
         switch (inst.getType())
         {
         case GeometryType::TriangleMesh:
         case GeometryType::DisplacedTriangleMesh:
         {
             const AABB& meshBB = mMeshBBs[inst.geometryID];
-            mSceneBB |= meshBB.transform(transform);
+            bounds = meshBB.transform(transform);
             break;
         }
         case GeometryType::Curve:
         {
             const AABB& curveBB = mCurveBBs[inst.geometryID];
-            mSceneBB |= curveBB.transform(transform);
+            bounds = curveBB.transform(transform);
             break;
         }
         case GeometryType::SDFGrid:
@@ -954,12 +977,34 @@ void Scene::updateBounds()
             transform3x3[2] = abs(transform3x3[2]);
             float3 center = transform.getCol(3).xyz();
             float3 halfExtent = transformVector(transform3x3, float3(0.5f));
-            mSceneBB |= AABB(center - halfExtent, center + halfExtent);
+            bounds = AABB(center - halfExtent, center + halfExtent);
             break;
         }
         }
+        mInstanceBounds.setLeaf(instanceID, bounds);
+    };
+
+    if (forceUpdate)
+    {
+        mInstanceBounds = BoundsHierarchy(mGeometryInstanceData.size());
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); ++instanceID)
+        {
+            updateInstanceBounds(instanceID);
+        }
+        mInstanceBounds.build();
+    }
+    else
+    {
+        // Only the moved instances changed, refit their path to the root of the hierarchy.
+        for (uint32_t instanceID : mMovedGeometryInstances)
+        {
+            updateInstanceBounds(instanceID);
+        }
+        mInstanceBounds.refit();
     }
 
+    mSceneBB = mInstanceBounds.getBounds();
+
     for (const auto& aabb : mCustomPrimitiveAABBs)
     {
         mSceneBB |= aabb;
@@ -976,45 +1021,79 @@ void Scene::updateGeometryInstances(bool forceUpdate)
     if (mGeometryInstanceData.empty())
         return;
 
-    bool dataChanged = false;
     const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-    for (auto& inst : mGeometryInstanceData)
+    // Updates the flags of an instance. Returns true if they changed.
+    auto updateInstanceFlags = [&](GeometryInstanceData& inst)
     {
-        if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
-        {
-            uint32_t prevFlags = inst.flags;
+        if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh)
+            return false;
 
-            FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-            const float4x4& transform = globalMatrices[inst.globalMatrixID];
-            bool isTransformFlipped = doesTransformFlip(transform);
-            bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
-            bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+        uint32_t prevFlags = inst.flags;
 
-            if (isTransformFlipped)
-                inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-            else
-                inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+        FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+        const float4x4& transform = globalMatrices[inst.globalMatrixID];
+        bool isTransformFlipped = doesTransformFlip(transform);
+        bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
+        bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
 
-            if (isObjectFrontFaceCW)
-                inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-            else
-                inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        if (isTransformFlipped)
+            inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+        else
+            inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
 
-            if (isWorldFrontFaceCW)
-                inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-            else
-                inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        if (isObjectFrontFaceCW)
+            inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        else
+            inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
 
-            dataChanged |= (inst.flags != prevFlags);
-        }
-    }
+        if (isWorldFrontFaceCW)
+            inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        else
+            inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
 
-    if (forceUpdate || dataChanged)
+        return inst.flags != prevFlags;
+    };
+
+    if (forceUpdate)
     {
+        for (auto& inst : mGeometryInstanceData)
+        {
+            updateInstanceFlags(inst);
+        }
+
         uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
         mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+        return;
     }
+
+    // Update the moved instances and upload the ranges of consecutive instances whose data changed.
+    size_t rangeBegin = 0;
+    size_t rangeEnd = 0;
+    auto uploadRange = [&]()
+    {
+        if (rangeEnd == rangeBegin)
+            return;
+        mpGeometryInstancesBuffer->setBlob(
+            &mGeometryInstanceData[rangeBegin],
+            rangeBegin * sizeof(GeometryInstanceData),
+            (rangeEnd - rangeBegin) * sizeof(GeometryInstanceData)
+        );
+    };
+
+    for (uint32_t instanceID : mMovedGeometryInstances)
+    {
+        if (!updateInstanceFlags(mGeometryInstanceData[instanceID]))
+            continue;
+
+        if (instanceID != rangeEnd)
+        {
+            uploadRange();
+            rangeBegin = instanceID;
+        }
+        rangeEnd = instanceID + 1;
+    }
+    uploadRange();
 }
 
 IScene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
@@ -1365,9 +1444,10 @@ void Scene::finalize()
 
     mpAnimationController->animate(pRenderContext, 0); // Requires Scene block to exist
     updateGeometry(pRenderContext, true);              // Requires scene defines
+    createNodeInstanceMapping();
     updateGeometryInstances(true);
 
-    updateBounds();
+    updateBounds(true);
     createDrawList();
     if (mCameras.size() == 0)
     {
@@ -1816,10 +1896,8 @@ IScene::UpdateFlags Scene::updateGridVolumes(bool forceUpdate)
         {
             // Fetch copy of volume data.
             auto data = pGridVolume->getData();
-            data.densityGrid =
-                (pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : SdfGridID::Invalid()).getSlang();
-            data.emissionGrid =
-                (pGridVolume->getEmissionGrid() ? mGridIDs.at(pGridVolume->getEmissionGrid()) : SdfGridID::Invalid()).getSlang();
+            data.densityGrid = getGridVolumeGridID(volumeIndex, GridVolume::GridSlot::Density).getSlang();
+            data.emissionGrid = getGridVolumeGridID(volumeIndex, GridVolume::GridSlot::Emission).getSlang();
             // Merge grid and volume transforms.
             const auto& densityGrid = pGridVolume->getDensityGrid();
             if (densityGrid)
@@ -1846,6 +1924,37 @@ IScene::UpdateFlags Scene::updateGridVolumes(bool forceUpdate)
     return flags;
 }
 
+SdfGridID Scene::getGridVolumeGridID(uint32_t volumeIndex, GridVolume::GridSlot slot)
+{
+    const auto& pGridVolume = mGridVolumes[volumeIndex];
+    const auto& pGrid = pGridVolume->getGrid(slot);
+    if (!pGrid)
+        return SdfGridID::Invalid();
+
+    if (mGridVolumeGridIDs.size() != mGridVolumes.size())
+        mGridVolumeGridIDs.resize(mGridVolumes.size());
+    SdfGridID& boundID = mGridVolumeGridIDs[volumeIndex][(size_t)slot];
+
+    auto it = mGridIDs.find(pGrid);
+    if (it == mGridIDs.end())
+    {
+        // Grids of streamed grid sequences are created during playback.
+        // The new grid replaces the previous grid of the slot in the scene's grid array.
+        FALCOR_CHECK(
+            pGridVolume->getGridSequenceStream(slot) && boundID.isValid(),
+            "Grid of GridVolume '{}' is not part of the scene.",
+            pGridVolume->getName()
+        );
+        mGridIDs.erase(mGrids[boundID.get()]);
+        mGrids[boundID.get()] = pGrid;
+        it = mGridIDs.emplace(pGrid, boundID).first;
+        pGrid->bindShaderData(mpSceneBlock->getRootVar()["grids"][boundID.get()]);
+    }
+
+    boundID = it->second;
+    return boundID;
+}
+
 void Scene::bindGridVolumes()
 {
     auto var = mpSceneBlock->getRootVar();
@@ -2004,20 +2113,28 @@ IScene::UpdateFlags Scene::update(RenderContext* pRenderContext, double currentT
         bindParameterBlock();
     }
 
+    mMovedGeometryInstances.clear();
     if (mpAnimationController->animate(pRenderContext, currentTime))
     {
         mUpdates |= IScene::UpdateFlags::SceneGraphChanged;
         if (mpAnimationController->hasSkinnedMeshes())
             mUpdates |= IScene::UpdateFlags::MeshesChanged;
 
-        for (const auto& inst : mGeometryInstanceData)
+        // Collect the geometry instances of the nodes whose transform changed.
+        for (uint32_t nodeID : mpAnimationController->getChangedNodes())
         {
-            if (mpAnimationController->isMatrixChanged(NodeID{inst.globalMatrixID}))
+            for (uint32_t i = mNodeInstanceOffsets[nodeID]; i < mNodeInstanceOffsets[nodeID + 1]; ++i)
             {
-                mUpdates |= IScene::UpdateFlags::GeometryMoved;
+                mMovedGeometryInstances.push_back(mNodeInstances[i]);
             }
         }
 
+        if (!mMovedGeometryInstances.empty())
+        {
+            std::sort(mMovedGeometryInstances.begin(), mMovedGeometryInstances.end());
+            mUpdates |= IScene::UpdateFlags::GeometryMoved;
+        }
+
         // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
         if (mpAnimationController->hasAnimatedCurveCaches())
             mUpdates |= IScene::UpdateFlags::CurvesMoved;
@@ -2042,6 +2159,7 @@ IScene::UpdateFlags Scene::update(RenderContext* pRenderContext, double currentT
     {
         invalidateTlasCache();
         updateGeometryInstances(false);
+        updateBounds(false);
     }
 
     // Update existing BLASes if skinned animation and/or procedural primitives moved.
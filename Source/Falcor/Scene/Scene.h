@@ -28,6 +28,7 @@
 #pragma once
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
+#include "BoundsHierarchy.h"
 #include "HitInfo.h"
 #include "IScene.h"
 #include "Animation/Animation.h"
@@ -654,6 +655,18 @@ namespace Falcor
         */
         const MeshDesc& getMesh(MeshID meshID) const { return mMeshDesc[meshID.get()]; }
 
+        /** Get the mesh groups. Each group maps to a BLAS for ray tracing.
+        */
+        const std::vector<MeshGroup>& getMeshGroups() const { return mMeshGroups; }
+
+        /** Get the global geometry instance IDs of all instances of a mesh, sorted in ascending order.
+        */
+        const std::vector<uint32_t>& getMeshInstanceIDs(MeshID meshID) const { return mMeshIdToInstanceIds[meshID.get()]; }
+
+        /** Get the CPU copy of the mesh index data. Each mesh specifies whether its indices are 16-bit or 32-bit.
+        */
+        const SplitIndexBuffer& getMeshIndexData() const { return mMeshIndexData; }
+
         /** Get mesh vertex and index data.
             \param[in] meshID Mesh ID.
             \param[in] buffers Map of buffers containing mesh data: "triangleIndices", "positions", and "texcrds" are required.
@@ -1129,11 +1142,17 @@ namespace Falcor
         */
         void uploadGeometry();
 
+        /** Create the mapping from scene graph nodes to the geometry instances they transform.
+        */
+        void createNodeInstanceMapping();
+
         /** Update the scene's global bounding box.
+            Unless forceUpdate is set, only the bounds of the moved geometry instances are recomputed and refit into the bounds hierarchy.
         */
-        void updateBounds();
+        void updateBounds(bool forceUpdate);
 
         /** Update geometry instances.
+            Unless forceUpdate is set, only the flags of the moved geometry instances are updated and only the changed ranges are uploaded.
         */
         void updateGeometryInstances(bool forceUpdate);
 
@@ -1216,6 +1235,11 @@ namespace Falcor
         void bindGeometry();
         void bindProceduralPrimitives();
         void bindGridVolumes();
+
+        /** Get the scene grid ID of the grid in a grid volume slot. Updates the grids of streamed grid sequences.
+        */
+        SdfGridID getGridVolumeGridID(uint32_t volumeIndex, GridVolume::GridSlot slot);
+
         void bindSDFGrids();
         void bindLights();
         void bindSelectedCamera();
@@ -1238,6 +1262,9 @@ namespace Falcor
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
 
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
+        std::vector<uint32_t> mNodeInstanceOffsets;                 ///< Offset of the geometry instances of each scene graph node in mNodeInstances, with an extra entry at the end.
+        std::vector<uint32_t> mNodeInstances;                       ///< Geometry instance IDs grouped by scene graph node.
+        std::vector<uint32_t> mMovedGeometryInstances;              ///< Sorted IDs of the geometry instances whose transform changed in the current frame.
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
@@ -1303,6 +1330,7 @@ namespace Falcor
         std::vector<ref<GridVolume>> mGridVolumes;                  ///< All loaded grid volumes.
         std::vector<ref<Grid>> mGrids;                              ///< All loaded grids.
         std::unordered_map<ref<Grid>, SdfGridID> mGridIDs;          ///< Lookup table for grid IDs.
+        std::vector<std::array<SdfGridID, (size_t)GridVolume::GridSlot::Count>> mGridVolumeGridIDs; ///< Grid IDs last used by each grid volume slot.
         ref<LightCollection> mpLightCollection;                     ///< Class for managing emissive geometry. This is created lazily upon first use.
         ref<EnvMap> mpEnvMap;                                       ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
@@ -1314,6 +1342,7 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        BoundsHierarchy mInstanceBounds;                            ///< World space bounding boxes of all geometry instances.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
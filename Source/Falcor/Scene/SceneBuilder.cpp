@@ -30,17 +30,25 @@
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/TextureCache.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/NumericRange.h"
 #include <mikktspace.h>
+#include <fstd/bit.h> // TODO C++20: Replace with <bit>
+#include <atomic>
 #include <filesystem>
 #include <cmath>
+#include <cstring>
 #include <execution>
 
 namespace Falcor
@@ -177,6 +185,88 @@ namespace Falcor
             return true;
         }
 
+        template<typename T>
+        void hashVertexField(uint64_t& hash, const T& field)
+        {
+            static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+            uint32_t words[sizeof(T) / sizeof(uint32_t)];
+            std::memcpy(words, &field, sizeof(T));
+            for (uint32_t w : words)
+            {
+                // FNV-1a on 32-bit words.
+                hash ^= w;
+                hash *= 0x100000001b3ull;
+            }
+        }
+
+        uint64_t hashVertex(const SceneBuilder::Mesh::Vertex& v, uint32_t origIndex)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            hashVertexField(hash, origIndex);
+            hashVertexField(hash, v.position);
+            hashVertexField(hash, v.normal);
+            hashVertexField(hash, v.tangent);
+            hashVertexField(hash, v.texCrd);
+            hashVertexField(hash, v.curveRadius);
+            hashVertexField(hash, v.boneIDs);
+            hashVertexField(hash, v.boneWeights);
+            return hash ^ (hash >> 32);
+        }
+
+        /** Compare vertices for bitwise equality. Fields are compared individually to skip any padding.
+        */
+        bool compareVerticesExact(const SceneBuilder::Mesh::Vertex& lhs, const SceneBuilder::Mesh::Vertex& rhs)
+        {
+            return std::memcmp(&lhs.position, &rhs.position, sizeof(lhs.position)) == 0 &&
+                std::memcmp(&lhs.normal, &rhs.normal, sizeof(lhs.normal)) == 0 &&
+                std::memcmp(&lhs.tangent, &rhs.tangent, sizeof(lhs.tangent)) == 0 &&
+                std::memcmp(&lhs.texCrd, &rhs.texCrd, sizeof(lhs.texCrd)) == 0 &&
+                std::memcmp(&lhs.curveRadius, &rhs.curveRadius, sizeof(lhs.curveRadius)) == 0 &&
+                std::memcmp(&lhs.boneIDs, &rhs.boneIDs, sizeof(lhs.boneIDs)) == 0 &&
+                std::memcmp(&lhs.boneWeights, &rhs.boneWeights, sizeof(lhs.boneWeights)) == 0;
+        }
+
+        /** Mesh description referencing the data of a triangle mesh.
+            The interleaved vertex attributes are split into local arrays, so the object must not be copied.
+        */
+        struct TriangleMeshDesc
+        {
+            SceneBuilder::Mesh mesh;
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCoords;
+
+            TriangleMeshDesc(const TriangleMesh& triangleMesh, const ref<Material>& pMaterial, bool isAnimated)
+            {
+                const auto& indices = triangleMesh.getIndices();
+                const auto& vertices = triangleMesh.getVertices();
+
+                mesh.name = triangleMesh.getName();
+                mesh.faceCount = (uint32_t)(indices.size() / 3);
+                mesh.vertexCount = (uint32_t)vertices.size();
+                mesh.indexCount = (uint32_t)indices.size();
+                mesh.pIndices = indices.data();
+                mesh.topology = Vao::Topology::TriangleList;
+                mesh.isFrontFaceCW = triangleMesh.getFrontFaceCW();
+                mesh.pMaterial = pMaterial;
+                mesh.isAnimated = isAnimated;
+
+                positions.resize(vertices.size());
+                normals.resize(vertices.size());
+                texCoords.resize(vertices.size());
+                std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
+                std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
+                std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+
+                mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+            }
+
+            TriangleMeshDesc(const TriangleMeshDesc&) = delete;
+            TriangleMeshDesc& operator=(const TriangleMeshDesc&) = delete;
+        };
+
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -210,6 +300,16 @@ namespace Falcor
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+
+        // Load material textures through the on-disk cache of preprocessed textures if requested.
+        if (mSettings.getOption("textureCache", false))
+        {
+            TextureCache::Options options;
+            options.directory = mSettings.getOption<std::string>("textureCacheDirectory", (getAppDataDirectory() / "TextureCache").string());
+            options.maxSizeInBytes = mSettings.getOption<uint64_t>("textureCacheMaxSizeMB", 4096) * 1024 * 1024;
+            options.compress = mSettings.getOption("textureCacheCompress", true);
+            mSceneData.pMaterials->getTextureManager().setTextureCache(std::make_shared<TextureCache>(options));
+        }
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -347,6 +447,10 @@ namespace Falcor
         // Post-process the scene data.
         TimeReport timeReport;
 
+        // Process all meshes that were queued during import.
+        flushPendingMeshes();
+        timeReport.measure("Processing meshes");
+
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
         prepareDisplacementMaps();
@@ -354,16 +458,23 @@ namespace Falcor
         prepareSceneGraph();
         prepareMeshes();
         removeUnusedMeshes();
+        instanceDuplicateMeshes();
         flattenStaticMeshInstances();
         pretransformStaticMeshes();
         unifyTriangleWinding();
         optimizeSceneGraph();
+        timeReport.measure("Preparing scene graph");
+
         calculateMeshBoundingBoxes();
         createMeshGroups();
         optimizeGeometry();
         sortMeshes();
+        timeReport.measure("Creating mesh groups");
+
         createGlobalBuffers();
         createCurveGlobalBuffers();
+        timeReport.measure("Creating global buffers");
+
         collectVolumeGrids();
         removeDuplicateSDFGrids();
 
@@ -394,7 +505,9 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            auto compression = stringToEnum<SceneCache::Compression>(mSettings.getOption<std::string>("sceneCacheCompression", "LZ4"));
+            bool compressBuffers = mSettings.getOption("sceneCacheCompressBuffers", false);
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, compression, compressBuffers);
             timeReport.measure("Writing cache");
         }
 
@@ -415,38 +528,74 @@ namespace Falcor
         return addProcessedMesh(processMesh(mesh));
     }
 
+    std::vector<MeshID> SceneBuilder::addMeshes(fstd::span<const Mesh> meshes)
+    {
+        // Pre-process meshes in parallel.
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallelFor(0, meshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            FALCOR_PROFILE_CPU("SceneBuilder::processMeshes");
+            for (size_t i = begin; i < end; ++i)
+                processedMeshes[i] = processMesh(meshes[i]);
+        });
+
+        // Add meshes sequentially to retain a deterministic order of the meshes in the global scene buffer.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (auto& processedMesh : processedMeshes)
+            meshIDs.push_back(addProcessedMesh(std::move(processedMesh)));
+        return meshIDs;
+    }
+
     MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated)
     {
         FALCOR_CHECK(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
-        Mesh mesh;
+        // Add a placeholder mesh so that the mesh ID is valid (e.g. for adding instances) until the mesh is processed.
+        MeshSpec spec;
+        spec.name = pTriangleMesh->getName();
+        spec.topology = Vao::Topology::TriangleList;
+        spec.materialId = addMaterial(pMaterial);
+        spec.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
+        spec.isAnimated = isAnimated;
+        mMeshes.push_back(std::move(spec));
+
+        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            FALCOR_THROW("Trying to build a scene that exceeds supported number of meshes");
+        }
 
-        const auto& indices = pTriangleMesh->getIndices();
-        const auto& vertices = pTriangleMesh->getVertices();
+        MeshID meshID(mMeshes.size() - 1);
+        mPendingMeshes.push_back({ meshID, pTriangleMesh, pMaterial, isAnimated });
+        return meshID;
+    }
 
-        mesh.name = pTriangleMesh->getName();
-        mesh.faceCount = (uint32_t)(indices.size() / 3);
-        mesh.vertexCount = (uint32_t)vertices.size();
-        mesh.indexCount = (uint32_t)indices.size();
-        mesh.pIndices = indices.data();
-        mesh.topology = Vao::Topology::TriangleList;
-        mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
-        mesh.pMaterial = pMaterial;
-        mesh.isAnimated = isAnimated;
+    void SceneBuilder::flushPendingMeshes()
+    {
+        if (mPendingMeshes.empty()) return;
 
-        std::vector<float3> positions(vertices.size());
-        std::vector<float3> normals(vertices.size());
-        std::vector<float2> texCoords(vertices.size());
-        std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
-        std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
-        std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        std::vector<PendingMesh> pendingMeshes = std::move(mPendingMeshes);
+        mPendingMeshes.clear();
 
-        mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+        // Meshes are processed in parallel and written to their pre-assigned slots, so the mesh order is deterministic.
+        std::atomic<uint64_t> vertexCount{ 0 };
+        Threading::parallelFor(0, pendingMeshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            FALCOR_PROFILE_CPU("SceneBuilder::processPendingMeshes");
+            for (size_t i = begin; i < end; ++i)
+            {
+                const PendingMesh& pending = pendingMeshes[i];
+                TriangleMeshDesc desc(*pending.pTriangleMesh, pending.pMaterial, pending.isAnimated);
+                ProcessedMesh processedMesh = processMesh(desc.mesh);
+                vertexCount += processedMesh.staticData.size();
+                initMeshSpec(mMeshes[pending.meshID.get()], std::move(processedMesh));
+            }
+        });
 
-        return addMesh(mesh);
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        logInfo("Processed {} triangle meshes ({} vertices) in {:.3f} s.", pendingMeshes.size(), vertexCount.load(), duration * 1e-3);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices, std::vector<float4>* pTangents) const
@@ -557,7 +706,19 @@ namespace Falcor
         {
             vertices.reserve(mesh.vertexCount);
 
+            // Vertices sharing an original index are merged if they compare equal within a threshold (see compareVertices()).
+            // Face-varying inputs can reference each original index from many faces, which makes a linear search over the
+            // vertices of an index expensive. Most duplicates are bitwise identical, so these are first looked up in an
+            // open-addressing hash table keyed on (original index, vertex bits). Only vertices without an exact match fall
+            // back to the per-index vertex lists. The result is the same as searching the lists only: a vertex that is
+            // bitwise identical to an existing vertex cannot be within the threshold of any vertex added after that one.
+            // The second element of each vertex pair stores its original index.
+            const size_t tableSize = std::max<size_t>(16, fstd::bit_ceil(size_t(mesh.indexCount) * 2));
+            const size_t tableMask = tableSize - 1;
+            std::vector<uint32_t> table(tableSize, invalidIndex);
             std::vector<uint32_t> heads(mesh.vertexCount, invalidIndex);
+            std::vector<uint32_t> next;
+            next.reserve(mesh.vertexCount);
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -565,36 +726,46 @@ namespace Falcor
                 {
                     const Mesh::Vertex v = mesh.getVertex(face, vert);
                     const uint32_t origIndex = mesh.pIndices[face * 3 + vert];
-
-                    // Iterate over vertex list to check if it already exists.
                     FALCOR_ASSERT(origIndex < heads.size());
-                    uint32_t index = heads[origIndex];
-                    bool found = false;
 
+                    // Look for a bitwise identical vertex.
+                    size_t slot = hashVertex(v, origIndex) & tableMask;
+                    uint32_t index = table[slot];
                     while (index != invalidIndex)
                     {
-                        if (compareVertices(v, vertices[index].first))
+                        if (vertices[index].second == origIndex && compareVerticesExact(v, vertices[index].first)) break;
+                        slot = (slot + 1) & tableMask;
+                        index = table[slot];
+                    }
+                    const size_t emptySlot = slot;
+
+                    // Exact matches still need to pass the regular comparison (e.g. NaN positions are never merged).
+                    if (index != invalidIndex && !compareVertices(v, vertices[index].first)) index = invalidIndex;
+
+                    // Iterate over vertex list to check if a vertex within the threshold exists.
+                    if (index == invalidIndex)
+                    {
+                        for (index = heads[origIndex]; index != invalidIndex; index = next[index])
                         {
-                            found = true;
-                            break;
+                            if (compareVertices(v, vertices[index].first)) break;
                         }
-                        index = vertices[index].second;
                     }
 
                     // Insert new vertex if we couldn't find it.
-                    if (!found)
+                    if (index == invalidIndex)
                     {
                         FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
                         index = (uint32_t)vertices.size();
-                        vertices.push_back({ v, heads[origIndex] });
+                        vertices.push_back({ v, origIndex });
+                        next.push_back(heads[origIndex]);
+                        heads[origIndex] = index;
+                        if (table[emptySlot] == invalidIndex) table[emptySlot] = index;
 
                         if (pAttributeIndices)
                         {
                             pAttributeIndices->push_back(mesh.getAttributeIndices(face, vert));
                             FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
                         }
-
-                        heads[origIndex] = index;
                     }
 
                     // Store new vertex index.
@@ -731,16 +902,31 @@ namespace Falcor
         }
     }
 
-    MeshID SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
+    MeshID SceneBuilder::addProcessedMesh(ProcessedMesh mesh)
     {
-        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
-
         MeshSpec spec;
 
         // Add the mesh to the scene.
-        spec.name = mesh.name;
-        spec.topology = mesh.topology;
         spec.materialId = addMaterial(mesh.pMaterial);
+        initMeshSpec(spec, std::move(mesh));
+
+        mMeshes.push_back(std::move(spec));
+
+        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            FALCOR_THROW("Trying to build a scene that exceeds supported number of meshes");
+        }
+
+        return MeshID(mMeshes.size() - 1);
+    }
+
+    void SceneBuilder::initMeshSpec(MeshSpec& spec, ProcessedMesh mesh) const
+    {
+        // Note: This function may be called concurrently for different mesh specs and must not modify builder state.
+        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
+
+        spec.name = std::move(mesh.name);
+        spec.topology = mesh.topology;
         spec.isFrontFaceCW = mesh.isFrontFaceCW;
         spec.isAnimated = mesh.isAnimated;
         spec.skeletonNodeID = mesh.skeletonNodeId;
@@ -765,15 +951,6 @@ namespace Falcor
             spec.hasSkinningData = true;
             spec.prevVertexCount = spec.skinningVertexCount;
         }
-
-        mMeshes.push_back(spec);
-
-        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
-        {
-            FALCOR_THROW("Trying to build a scene that exceeds supported number of meshes");
-        }
-
-        return MeshID(mMeshes.size() - 1);
     }
 
     void SceneBuilder::addCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
@@ -1419,51 +1596,163 @@ namespace Falcor
         if (unusedCount > 0)
         {
             logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+            removeMeshesWithoutInstances();
+        }
+    }
 
-            const size_t meshCount = mMeshes.size();
-            MeshList meshes;
-            meshes.reserve(meshCount);
+    void SceneBuilder::removeMeshesWithoutInstances()
+    {
+        // Rebuild the mesh list without the meshes that are not referenced by the scene graph,
+        // and update all mesh IDs to the new list.
 
-            for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
-            {
-                auto& mesh = mMeshes[meshID.get()];
-                if (mesh.instances.empty()) continue; // Skip unused meshes
+        const size_t meshCount = mMeshes.size();
+        MeshList meshes;
+        meshes.reserve(meshCount);
 
-                // Get new mesh ID.
-                const MeshID newMeshID(meshes.size());
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
+        {
+            auto& mesh = mMeshes[meshID.get()];
+            if (mesh.instances.empty()) continue; // Skip unused meshes
 
-                // Update the mesh IDs in the scene graph nodes.
-                for (const auto& nodeID : mesh.instances)
-                {
-                    FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
-                    auto& node = mSceneGraph[nodeID.get()];
-                    std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
-                }
+            // Get new mesh ID.
+            const MeshID newMeshID(meshes.size());
 
-                // Update the mesh IDs of cached meshes.
-                for (auto &cachedMesh : mSceneData.cachedMeshes)
-                {
-                    if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
-                }
-                for (auto& cache : mSceneData.cachedCurves)
+            // Update the mesh IDs in the scene graph nodes.
+            for (const auto& nodeID : mesh.instances)
+            {
+                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID.get()];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+            }
+
+            // Update the mesh IDs of cached meshes.
+            for (auto &cachedMesh : mSceneData.cachedMeshes)
+            {
+                if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+            }
+            for (auto& cache : mSceneData.cachedCurves)
+            {
+                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
                 {
-                    if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
-                    {
-                        if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
-                    }
+                    if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
                 }
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
+
+        mMeshes = std::move(meshes);
+
+        // Validate scene graph.
+        for (const auto& node : mSceneGraph)
+        {
+            for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+        }
+    }
+
+    void SceneBuilder::instanceDuplicateMeshes()
+    {
+        // This function optionally replaces static meshes that have identical geometry and material by instances
+        // of a single mesh. Formats such as pbrt and Mitsuba often repeat the same geometry as separate shapes,
+        // which would otherwise be stored and built into a BLAS once per copy.
+        // Only meshes that are identical in object space are detected. The pass is disabled by default.
+
+        if (!is_set(mFlags, Flags::InstanceDuplicateMeshes)) return;
+
+        if (is_set(mFlags, Flags::FlattenStaticMeshInstances))
+        {
+            logWarning("Ignoring 'InstanceDuplicateMeshes' as 'FlattenStaticMeshInstances' is set.");
+            return;
+        }
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        const bool mergeMaterials = !is_set(mFlags, Flags::DontMergeMaterials);
 
-                meshes.push_back(std::move(mesh));
+        // Dynamic meshes are excluded as their vertices are modified at runtime.
+        auto isCandidate = [](const MeshSpec& mesh) { return !mesh.isDynamic() && !mesh.instances.empty(); };
+
+        // Materials with equal properties are merged later by removeDuplicateMaterials(), so unless
+        // material merging is disabled, meshes with equal but distinct materials are duplicates too.
+        auto isSameMaterial = [&](MaterialID lhs, MaterialID rhs)
+        {
+            if (lhs == rhs) return true;
+            return mergeMaterials && mSceneData.pMaterials->getMaterial(lhs)->isEqual(mSceneData.pMaterials->getMaterial(rhs));
+        };
+
+        auto isDuplicate = [&](const MeshSpec& lhs, const MeshSpec& rhs)
+        {
+            return lhs.topology == rhs.topology && lhs.vertexCount == rhs.vertexCount && lhs.indexCount == rhs.indexCount &&
+                lhs.use16BitIndices == rhs.use16BitIndices && lhs.isFrontFaceCW == rhs.isFrontFaceCW && lhs.isDisplaced == rhs.isDisplaced &&
+                lhs.staticData.size() == rhs.staticData.size() && lhs.indexData == rhs.indexData &&
+                std::memcmp(lhs.staticData.data(), rhs.staticData.data(), lhs.staticData.size() * sizeof(StaticVertexData)) == 0 &&
+                isSameMaterial(lhs.materialId, rhs.materialId);
+        };
+
+        // Hash the processed geometry of all candidate meshes in parallel.
+        std::vector<uint64_t> hashes(mMeshes.size());
+        Threading::parallelFor(0, mMeshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto& mesh = mMeshes[i];
+                if (!isCandidate(mesh)) continue;
+
+                FNVHash64 hash;
+                hash.insert(mesh.topology);
+                hash.insert(mesh.vertexCount);
+                hash.insert(mesh.indexCount);
+                hash.insert(mesh.use16BitIndices);
+                hash.insert(mesh.isFrontFaceCW);
+                hash.insert(mesh.isDisplaced);
+                hash.insert(mergeMaterials ? mSceneData.pMaterials->getMaterial(mesh.materialId)->computeHash() : mesh.materialId.get());
+                hash.insert(mesh.staticData.data(), mesh.staticData.size() * sizeof(StaticVertexData));
+                hash.insert(mesh.indexData.data(), mesh.indexData.size() * sizeof(uint32_t));
+                hashes[i] = hash.get();
+            }
+        });
+
+        // Move the instances of each duplicate to the first mesh with the same geometry.
+        std::unordered_map<uint64_t, std::vector<MeshID>> uniqueMeshes;
+        size_t duplicateCount = 0;
+        size_t savedBytes = 0;
+
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
+        {
+            auto& mesh = mMeshes[meshID.get()];
+            if (!isCandidate(mesh)) continue;
+
+            auto& bucket = uniqueMeshes[hashes[meshID.get()]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MeshID id) { return isDuplicate(mMeshes[id.get()], mesh); });
+            if (it == bucket.end())
+            {
+                bucket.push_back(meshID);
+                continue;
             }
 
-            mMeshes = std::move(meshes);
+            // Keep duplicates that are instanced by the same node as the unique mesh, as the node can only instance a mesh once.
+            const MeshID uniqueMeshID = *it;
+            auto& uniqueMesh = mMeshes[uniqueMeshID.get()];
+            if (std::any_of(mesh.instances.begin(), mesh.instances.end(), [&](NodeID nodeID) { return uniqueMesh.instances.count(nodeID) > 0; })) continue;
 
-            // Validate scene graph.
-            FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-            for (const auto& node : mSceneGraph)
+            for (NodeID nodeID : mesh.instances)
             {
-                for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID.get()];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, uniqueMeshID);
+                uniqueMesh.instances.insert(nodeID);
             }
+            mesh.instances.clear();
+
+            duplicateCount++;
+            savedBytes += mesh.staticData.size() * sizeof(StaticVertexData) + mesh.indexData.size() * sizeof(uint32_t);
+        }
+
+        if (duplicateCount > 0)
+        {
+            removeMeshesWithoutInstances();
+
+            double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+            logInfo("Instanced {} duplicate meshes, saving {:.2f} MB of vertex and index data ({:.3f} s).", duplicateCount, savedBytes / (1024.0 * 1024.0), duration * 1e-3);
         }
     }
 
@@ -2962,6 +3251,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("InstanceDuplicateMeshes", SceneBuilder::Flags::InstanceDuplicateMeshes);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -44,6 +44,7 @@
 #include "Utils/Settings/Settings.h"
 
 #include <pybind11/pytypes.h>
+#include <fstd/span.h> // TODO C++20: Replace with <span>
 
 #include <filesystem>
 #include <memory>
@@ -77,6 +78,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            InstanceDuplicateMeshes         = 0x20000,  ///< Convert static meshes with identical geometry and material into instances of a single mesh. Reduces memory use and BLAS build time for scenes with repeated geometry.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -126,7 +128,7 @@ namespace Falcor
             bool isFrontFaceCW = false;                 ///< Indicate whether front-facing side has clockwise winding in object space.
             bool isAnimated = false;                    ///< True if the mesh vertices can be modified during rendering (e.g., skinning or inverse rendering).
             bool useOriginalTangentSpace = false;       ///< Indicate whether to use the original tangent space that was loaded with the mesh. By default, we will ignore it and use MikkTSpace to generate the tangent space.
-            bool mergeDuplicateVertices = true;         ///< Indicate whether to merge identical vertices and adjust indices.
+            bool mergeDuplicateVertices = true;         ///< Indicate whether to merge identical vertices and adjust indices. Vertices with the same index are merged if their positions are equal and the other attributes differ by at most 1e-6.
             NodeID skeletonNodeId{ NodeID::Invalid() }; ///< For skinned meshes, the node ID of the skeleton's world transform. If invalid, the skeleton is based on the mesh's own world position (Assimp behavior pre-multiplies instance transform).
 
             template<typename T>
@@ -415,7 +417,19 @@ namespace Falcor
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add a batch of meshes.
+            The meshes are pre-processed in parallel and added in order, i.e., the assigned mesh IDs are
+            identical to calling addMesh() for each mesh sequentially.
+            Throws an exception if something went wrong.
+            \param meshes The meshes to add. The referenced vertex/index data must stay valid for the duration of the call.
+            \return The IDs of the meshes in the scene.
+        */
+        std::vector<MeshID> addMeshes(fstd::span<const Mesh> meshes);
+
         /** Add a triangle mesh.
+            The mesh ID is assigned immediately, but processing of the mesh is deferred until flushPendingMeshes()
+            or getScene() is called, at which point all pending meshes are processed in parallel.
+            The triangle mesh must not be modified after it has been added.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
             \param isAnimated True if the mesh vertices can be modified during rendering (e.g., skinning or inverse rendering).
@@ -423,6 +437,11 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated = false);
 
+        /** Process all meshes queued by addTriangleMesh().
+            This is called automatically by getScene(). Throws an exception if processing of any mesh failed.
+        */
+        void flushPendingMeshes();
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -442,7 +461,7 @@ namespace Falcor
             \param mesh The pre-processed mesh.
             \return The ID of the mesh in the scene. Note that all of the instances share the same mesh ID.
         */
-        MeshID addProcessedMesh(const ProcessedMesh& mesh);
+        MeshID addProcessedMesh(ProcessedMesh mesh);
 
         /** Add mesh vertex cache for animation.
             \param[in] cachedCurves The mesh vertex cache data (will be moved from).
@@ -758,6 +777,17 @@ namespace Falcor
             std::vector<StaticCurveVertexData> staticData;
         };
 
+        /** Triangle mesh queued for deferred processing.
+            A placeholder MeshSpec is added to mMeshes when the mesh is queued, its data is filled in by flushPendingMeshes().
+        */
+        struct PendingMesh
+        {
+            MeshID meshID;
+            ref<TriangleMesh> pTriangleMesh;
+            ref<Material> pMaterial;
+            bool isAnimated = false;
+        };
+
         using SceneGraph = std::vector<InternalNode>;
         using MeshList = std::vector<MeshSpec>;
         using MeshGroup = Scene::MeshGroup;
@@ -783,6 +813,8 @@ namespace Falcor
         MeshList mMeshes;
         MeshGroupList mMeshGroups; ///< Groups of meshes. Each group represents all the geometries in a BLAS for ray tracing.
 
+        std::vector<PendingMesh> mPendingMeshes; ///< Meshes queued by addTriangleMesh() that are not processed yet.
+
         CurveList mCurves;
 
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
@@ -793,6 +825,7 @@ namespace Falcor
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
         bool mergeNodes(NodeID dstNodeID, NodeID srcNodeID);
         void flipTriangleWinding(MeshSpec& mesh);
+        void initMeshSpec(MeshSpec& spec, ProcessedMesh mesh) const;
         void updateSDFGridID(SdfGridID oldID, SdfGridID newID);
 
         /** Split a mesh by the given axis-aligned splitting plane.
@@ -816,6 +849,8 @@ namespace Falcor
         void prepareSceneGraph();
         void prepareMeshes();
         void removeUnusedMeshes();
+        void removeMeshesWithoutInstances();
+        void instanceDuplicateMeshes();
         void flattenStaticMeshInstances();
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
@@ -30,10 +30,17 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
+#include <lz4hc.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 
 namespace Falcor
@@ -43,7 +50,12 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 27;
+
+        /** Specifies the last version using the single LZ4 stream format.
+            Caches of this version are still readable to allow migrating to the sectioned format.
+        */
+        const uint32_t kLegacyVersion = 25;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -51,6 +63,14 @@ namespace Falcor
 
         const size_t kBlockSize = 1 * 1024 * 1024;
 
+        /** Compressed sections are split into independently compressed chunks of this size,
+            which allows decompressing them in parallel.
+        */
+        const size_t kChunkSize = 1 * 1024 * 1024;
+
+        const size_t kSectionAlignment = 64;
+        const size_t kRawBlockAlignment = 16;
+
         const char* kMagic = "FalcorS$";
         struct Header
         {
@@ -59,21 +79,255 @@ namespace Falcor
 
             bool isValid() const
             {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && (version == kVersion || version == kLegacyVersion);
             }
         };
+
+        /** The sectioned cache format (kVersion) has the following layout:
+            - Header
+            - uint32_t section count
+            - SectionDesc table
+            - Section payloads, each aligned to kSectionAlignment.
+
+            The first section holds the serialized scene data. All following sections hold data blocks, each aligned
+            to kRawBlockAlignment (e.g. split vertex/index buffers). Uncompressed sections are directly referenced
+            from the memory mapping. Compressed sections start with a table of (chunkCount + 1) uint64_t chunk
+            offsets relative to the end of the table, followed by the compressed chunks. LZ4 and LZ4-HC compressed
+            chunks share the same block format.
+        */
+        enum class SectionCompression : uint32_t
+        {
+            None = 0,
+            LZ4 = 1,
+        };
+
+        struct SectionDesc
+        {
+            char name[24]{};
+            uint64_t offset{};              ///< Offset of the payload from the start of the file.
+            uint64_t size{};                ///< Size of the payload in bytes.
+            uint64_t uncompressedSize{};    ///< Size of the uncompressed data in bytes.
+            SectionCompression compression{SectionCompression::None};
+            uint32_t chunkCount{};          ///< Number of compressed chunks.
+        };
+        static_assert(sizeof(SectionDesc) == 56);
+
+        const char* kSceneDataSection = "SceneData";
+
+        size_t alignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        /** Compute the offsets of data blocks stored in a raw section.
+        */
+        std::vector<uint64_t> computeRawBlockOffsets(const std::vector<uint64_t>& blockSizes)
+        {
+            std::vector<uint64_t> offsets(blockSizes.size());
+            uint64_t offset = 0;
+            for (size_t i = 0; i < blockSizes.size(); ++i)
+            {
+                offsets[i] = alignUp(offset, kRawBlockAlignment);
+                offset = offsets[i] + blockSizes[i];
+            }
+            return offsets;
+        }
+
+        /** Raw data blocks of a section, referencing the scene data to be written.
+        */
+        struct RawSection
+        {
+            std::string name;
+            std::vector<fstd::span<const uint8_t>> blocks;
+        };
+
+        /** Compress data into independent LZ4 chunks, including the chunk offset table.
+            Chunks are compressed in parallel and concatenated in order.
+        */
+        std::vector<uint8_t> compressSection(fstd::span<const uint8_t> data, SceneCache::Compression compression, uint32_t& chunkCount)
+        {
+            FALCOR_ASSERT(compression != SceneCache::Compression::None);
+            chunkCount = (uint32_t)((data.size() + kChunkSize - 1) / kChunkSize);
+            const size_t tableSize = (chunkCount + 1) * sizeof(uint64_t);
+
+            std::vector<std::vector<uint8_t>> chunks(chunkCount);
+            std::atomic<bool> failed{false};
+            Threading::parallelFor(
+                0,
+                chunkCount,
+                1,
+                [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const size_t srcOffset = i * kChunkSize;
+                        const int srcSize = (int)std::min(kChunkSize, data.size() - srcOffset);
+                        const char* pSrc = reinterpret_cast<const char*>(data.data() + srcOffset);
+                        auto& chunk = chunks[i];
+                        chunk.resize(LZ4_compressBound(srcSize));
+                        char* pDst = reinterpret_cast<char*>(chunk.data());
+                        int compressedSize = compression == SceneCache::Compression::LZ4HC
+                            ? LZ4_compress_HC(pSrc, pDst, srcSize, (int)chunk.size(), LZ4HC_CLEVEL_DEFAULT)
+                            : LZ4_compress_default(pSrc, pDst, srcSize, (int)chunk.size());
+                        if (compressedSize <= 0) failed = true;
+                        chunk.resize(std::max(compressedSize, 0));
+                    }
+                }
+            );
+            if (failed) FALCOR_THROW("Failed to compress scene cache data.");
+
+            std::vector<uint64_t> chunkOffsets(chunkCount + 1, 0);
+            for (uint32_t i = 0; i < chunkCount; ++i) chunkOffsets[i + 1] = chunkOffsets[i] + chunks[i].size();
+
+            std::vector<uint8_t> result(tableSize + chunkOffsets[chunkCount]);
+            std::memcpy(result.data(), chunkOffsets.data(), tableSize);
+            for (uint32_t i = 0; i < chunkCount; ++i)
+                std::memcpy(result.data() + tableSize + chunkOffsets[i], chunks[i].data(), chunks[i].size());
+            return result;
+        }
+
+        /** Decompress a chunked LZ4 section. Chunks are decompressed in parallel.
+        */
+        std::vector<uint8_t> decompressSection(const uint8_t* pPayload, const SectionDesc& desc)
+        {
+            const size_t tableSize = (desc.chunkCount + 1) * sizeof(uint64_t);
+            if (desc.size < tableSize || desc.uncompressedSize > desc.chunkCount * kChunkSize)
+                FALCOR_THROW("Invalid compressed section '{}' in scene cache.", desc.name);
+
+            std::vector<uint64_t> chunkOffsets(desc.chunkCount + 1);
+            std::memcpy(chunkOffsets.data(), pPayload, tableSize);
+            if (chunkOffsets.back() > desc.size - tableSize)
+                FALCOR_THROW("Invalid compressed section '{}' in scene cache.", desc.name);
+
+            std::vector<uint8_t> data(desc.uncompressedSize);
+            std::atomic<bool> failed{false};
+            Threading::parallelFor(
+                0,
+                desc.chunkCount,
+                1,
+                [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const size_t dstOffset = i * kChunkSize;
+                        const int dstSize = (int)std::min(kChunkSize, data.size() - dstOffset);
+                        if (chunkOffsets[i] > chunkOffsets[i + 1] || dstOffset >= data.size())
+                        {
+                            failed = true;
+                            continue;
+                        }
+                        int size = LZ4_decompress_safe(
+                            reinterpret_cast<const char*>(pPayload + tableSize + chunkOffsets[i]),
+                            reinterpret_cast<char*>(data.data() + dstOffset),
+                            (int)(chunkOffsets[i + 1] - chunkOffsets[i]),
+                            dstSize
+                        );
+                        if (size != dstSize) failed = true;
+                    }
+                }
+            );
+            if (failed) FALCOR_THROW("Failed to decompress section '{}' in scene cache.", desc.name);
+            return data;
+        }
+
+        /** Memory-mapped cache file in the sectioned format.
+        */
+        struct MappedCache
+        {
+            std::shared_ptr<MemoryMappedFile> pFile;
+            std::vector<SectionDesc> sections;
+
+            const uint8_t* getPayload(uint32_t sectionIndex) const
+            {
+                return static_cast<const uint8_t*>(pFile->getData()) + sections[sectionIndex].offset;
+            }
+
+            /** Get the (uncompressed) data of a section. Uncompressed sections are referenced from the mapping,
+                compressed sections are decompressed into a new buffer.
+                \param[in] sectionIndex Section index.
+                \param[out] pStorage Storage owning the returned data.
+                \return Returns a view of the section data.
+            */
+            fstd::span<const uint8_t> getSectionData(uint32_t sectionIndex, std::shared_ptr<const void>& pStorage) const
+            {
+                const SectionDesc& desc = sections[sectionIndex];
+                switch (desc.compression)
+                {
+                case SectionCompression::None:
+                    pStorage = pFile;
+                    return fstd::span<const uint8_t>(getPayload(sectionIndex), desc.size);
+                case SectionCompression::LZ4:
+                {
+                    auto pData = std::make_shared<std::vector<uint8_t>>(decompressSection(getPayload(sectionIndex), desc));
+                    pStorage = pData;
+                    return fstd::span<const uint8_t>(pData->data(), pData->size());
+                }
+                default:
+                    FALCOR_THROW("Unknown compression of section '{}' in scene cache.", desc.name);
+                }
+            }
+        };
+
+        /** Replace a cache file with a newly written one.
+            The existing cache may still be memory-mapped by a loaded scene. Windows does not allow replacing a mapped file,
+            but allows renaming it, so the existing cache is moved aside and removed once it is no longer mapped.
+            \param[in] tempPath Path of the newly written cache.
+            \param[in] path Path of the cache.
+            \return True if successful.
+        */
+        bool replaceCacheFile(const std::filesystem::path& tempPath, const std::filesystem::path& path)
+        {
+            const std::string staleExtension = ".stale";
+            std::error_code ec;
+
+            // Remove caches moved aside by earlier writes, unless they are still mapped.
+            const std::string stalePrefix = path.filename().string() + ".";
+            const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+            for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+            {
+                const std::string filename = it->path().filename().string();
+                if (filename.size() > stalePrefix.size() + staleExtension.size() && filename.compare(0, stalePrefix.size(), stalePrefix) == 0 &&
+                    filename.compare(filename.size() - staleExtension.size(), staleExtension.size(), staleExtension) == 0)
+                {
+                    std::error_code removeEc;
+                    std::filesystem::remove(it->path(), removeEc);
+                }
+            }
+
+            std::filesystem::rename(tempPath, path, ec);
+            if (!ec) return true;
+            if (!std::filesystem::exists(path, ec)) return false;
+
+            auto stalePath = path;
+            stalePath += fmt::format(".{}{}", std::chrono::system_clock::now().time_since_epoch().count(), staleExtension);
+            std::filesystem::rename(path, stalePath, ec);
+            if (ec) return false;
+
+            std::filesystem::rename(tempPath, path, ec);
+            if (ec)
+            {
+                std::filesystem::rename(stalePath, path, ec);
+                return false;
+            }
+            std::filesystem::remove(stalePath, ec);
+            return true;
+        }
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Helper to serialize basic types to a memory buffer.
+        Large data blocks can be written into raw sections that are stored uncompressed.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(std::vector<uint8_t>& data, std::vector<RawSection>* pRawSections = nullptr)
+            : mData(data), mpRawSections(pRawSections)
+        {}
 
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(data);
+            mData.insert(mData.end(), pBytes, pBytes + len);
         }
 
         template<typename T>
@@ -128,20 +382,45 @@ namespace Falcor
             }
         }
 
+        /** True if the stream supports raw sections (sectioned format).
+        */
+        bool hasRawSections() const { return mpRawSections != nullptr; }
+
+        /** Add a raw section. The referenced data needs to stay alive until the cache is written.
+            \return Returns the section index.
+        */
+        uint32_t addRawSection(const std::string& name, std::vector<fstd::span<const uint8_t>> blocks)
+        {
+            FALCOR_ASSERT(mpRawSections);
+            mpRawSections->push_back({name, std::move(blocks)});
+            // Section 0 holds the scene data.
+            return (uint32_t)mpRawSections->size();
+        }
+
     private:
-        std::ostream& mStream;
+        std::vector<uint8_t>& mData;
+        std::vector<RawSection>* mpRawSections;
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Helper to deserialize basic types from either a std::istream (legacy format) or a memory buffer.
+        When reading from a memory-mapped cache, raw sections are accessible without copying.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(std::istream& stream) : mpStream(&stream) {}
+        InputStream(fstd::span<const uint8_t> data, const MappedCache* pCache) : mData(data), mpCache(pCache) {}
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (mpStream)
+            {
+                mpStream->read(reinterpret_cast<char*>(data), len);
+                return;
+            }
+            if (len > mData.size() - mOffset) FALCOR_THROW("Unexpected end of scene cache data.");
+            std::memcpy(data, mData.data() + mOffset, len);
+            mOffset += len;
         }
 
         template<typename T>
@@ -211,8 +490,28 @@ namespace Falcor
             }
         }
 
+        /** True if reading from a memory-mapped cache in the sectioned format.
+        */
+        bool isMapped() const { return mpCache != nullptr; }
+
+        /** Get the data of a raw section.
+            \param[in] sectionIndex Section index.
+            \param[out] pStorage Storage owning the data (the memory mapping or a decompressed buffer).
+            \return Returns a view of the section data.
+        */
+        fstd::span<const uint8_t> getRawSection(uint32_t sectionIndex, std::shared_ptr<const void>& pStorage) const
+        {
+            FALCOR_ASSERT(mpCache);
+            if (sectionIndex == 0 || sectionIndex >= mpCache->sections.size())
+                FALCOR_THROW("Invalid raw section index {} in scene cache.", sectionIndex);
+            return mpCache->getSectionData(sectionIndex, pStorage);
+        }
+
     private:
-        std::istream& mStream;
+        std::istream* mpStream = nullptr;
+        fstd::span<const uint8_t> mData;
+        size_t mOffset = 0;
+        const MappedCache* mpCache = nullptr;
     };
 
     bool SceneCache::hasValidCache(const Key& key)
@@ -230,53 +529,233 @@ namespace Falcor
         return !fs.eof() && header.isValid();
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, Compression compression, bool compressBuffers)
     {
-        auto cachePath = getCachePath(key);
+        writeCache(sceneData, getCachePath(key), compression, compressBuffers);
+    }
 
-        logInfo("Writing scene cache to '{}'.", cachePath);
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const std::filesystem::path& path, Compression compression, bool compressBuffers)
+    {
+        logInfo("Writing scene cache to '{}' (compression: {}{}).", path, enumToString(compression), compressBuffers ? ", including buffers" : "");
 
+        CpuTimer timer;
+        timer.update();
+
+        // Serialize scene data. Large buffers are collected in raw sections.
+        std::vector<uint8_t> data;
+        std::vector<RawSection> rawSections;
+        OutputStream stream(data, &rawSections);
+        writeSceneData(stream, sceneData);
+
+        // Setup section table.
+        std::vector<SectionDesc> sections(1 + rawSections.size());
+        auto setName = [](SectionDesc& desc, const std::string& name)
+        {
+            std::strncpy(desc.name, name.c_str(), sizeof(SectionDesc::name) - 1);
+        };
+
+        // Compressed section payloads (empty for uncompressed sections, which are written directly from the scene data).
+        std::vector<std::vector<uint8_t>> payloads(sections.size());
+        auto compress = [&](size_t sectionIndex, fstd::span<const uint8_t> sectionData)
+        {
+            SectionDesc& desc = sections[sectionIndex];
+            desc.uncompressedSize = sectionData.size();
+            if (compression == Compression::None)
+            {
+                desc.size = sectionData.size();
+                return false;
+            }
+            payloads[sectionIndex] = compressSection(sectionData, compression, desc.chunkCount);
+            desc.size = payloads[sectionIndex].size();
+            desc.compression = SectionCompression::LZ4;
+            return true;
+        };
+
+        setName(sections[0], kSceneDataSection);
+        if (!compress(0, data)) payloads[0] = std::move(data);
+
+        std::vector<std::vector<uint64_t>> rawBlockOffsets(rawSections.size());
+        for (size_t i = 0; i < rawSections.size(); ++i)
+        {
+            std::vector<uint64_t> blockSizes;
+            for (const auto& block : rawSections[i].blocks) blockSizes.push_back(block.size());
+            rawBlockOffsets[i] = computeRawBlockOffsets(blockSizes);
+
+            SectionDesc& desc = sections[i + 1];
+            setName(desc, rawSections[i].name);
+            desc.size = blockSizes.empty() ? 0 : rawBlockOffsets[i].back() + blockSizes.back();
+            desc.uncompressedSize = desc.size;
+
+            if (compressBuffers && compression != Compression::None)
+            {
+                // Gather the blocks with their final layout and compress them as a whole.
+                std::vector<uint8_t> sectionData(desc.size, 0);
+                for (size_t j = 0; j < blockSizes.size(); ++j)
+                    std::memcpy(sectionData.data() + rawBlockOffsets[i][j], rawSections[i].blocks[j].data(), blockSizes[j]);
+                compress(i + 1, sectionData);
+            }
+        }
+
+        uint64_t offset = sizeof(Header) + sizeof(uint32_t) + sections.size() * sizeof(SectionDesc);
+        for (auto& desc : sections)
+        {
+            desc.offset = alignUp(offset, kSectionAlignment);
+            offset = desc.offset + desc.size;
+        }
+
+        // Create directories if not existing.
+        std::filesystem::create_directories(path.parent_path());
+
+        // Write to a temporary file first, an existing cache may still be memory-mapped.
+        auto tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            if (!fs) FALCOR_THROW("Failed to create scene cache file '{}'.", tempPath);
+
+            uint64_t fileOffset = 0;
+            auto writeBytes = [&](const void* pData, size_t size)
+            {
+                fs.write(reinterpret_cast<const char*>(pData), size);
+                fileOffset += size;
+            };
+            auto writePadding = [&](uint64_t targetOffset)
+            {
+                static const uint8_t kZeros[kSectionAlignment] = {};
+                FALCOR_ASSERT(targetOffset >= fileOffset && targetOffset - fileOffset <= kSectionAlignment);
+                writeBytes(kZeros, targetOffset - fileOffset);
+            };
+
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            writeBytes(&header, sizeof(header));
+            uint32_t sectionCount = (uint32_t)sections.size();
+            writeBytes(&sectionCount, sizeof(sectionCount));
+            writeBytes(sections.data(), sections.size() * sizeof(SectionDesc));
+
+            writePadding(sections[0].offset);
+            writeBytes(payloads[0].data(), payloads[0].size());
+
+            for (size_t i = 0; i < rawSections.size(); ++i)
+            {
+                uint64_t sectionOffset = sections[i + 1].offset;
+                writePadding(sectionOffset);
+                if (sections[i + 1].compression != SectionCompression::None)
+                {
+                    writeBytes(payloads[i + 1].data(), payloads[i + 1].size());
+                    continue;
+                }
+                for (size_t j = 0; j < rawSections[i].blocks.size(); ++j)
+                {
+                    writePadding(sectionOffset + rawBlockOffsets[i][j]);
+                    writeBytes(rawSections[i].blocks[j].data(), rawSections[i].blocks[j].size());
+                }
+            }
+
+            if (!fs) FALCOR_THROW("Failed to write scene cache file to '{}'.", tempPath);
+        }
+
+        if (!replaceCacheFile(tempPath, path))
+        {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            FALCOR_THROW("Failed to write scene cache file to '{}'.", path);
+        }
+
+        timer.update();
+        logInfo("Wrote scene cache ({} sections, {:.1f} MB) in {:.2f} s.", sections.size(), offset / (1024.0 * 1024.0), timer.delta());
+    }
+
+    void SceneCache::writeLegacyCache(const Scene::SceneData& sceneData, const std::filesystem::path& path)
+    {
         // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+        std::filesystem::create_directories(path.parent_path());
 
         // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
+        std::ofstream fs(path.c_str(), std::ios_base::binary);
+        if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", path);
 
         // Write header (uncompressed).
         Header header;
         std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
+        header.version = kLegacyVersion;
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
         // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
+        std::vector<uint8_t> data;
+        OutputStream stream(data);
         writeSceneData(stream, sceneData);
-        if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
+        {
+            lz4_stream::basic_ostream<kBlockSize> zs(fs);
+            zs.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+        if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", path);
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
     {
-        auto cachePath = getCachePath(key);
+        return readCache(pDevice, getCachePath(key));
+    }
 
-        logInfo("Loading scene cache from '{}'.", cachePath);
+    Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const std::filesystem::path& path)
+    {
+        logInfo("Loading scene cache from '{}'.", path);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to open scene cache file '{}'.", cachePath);
+        MappedCache cache;
+        cache.pFile = std::make_shared<MemoryMappedFile>(path);
+        if (!cache.pFile->isOpen()) FALCOR_THROW("Failed to open scene cache file '{}'.", path);
 
-        // Read header (uncompressed).
+        const uint8_t* pData = static_cast<const uint8_t*>(cache.pFile->getData());
+        const size_t fileSize = cache.pFile->getMappedSize();
+
+        // Read header.
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", cachePath);
+        if (fileSize < sizeof(header)) FALCOR_THROW("Invalid header in scene cache file '{}'.", path);
+        std::memcpy(&header, pData, sizeof(header));
+        if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", path);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        if (header.version == kLegacyVersion)
+        {
+            logInfo("Scene cache '{}' uses the legacy format, it will be loaded without memory mapping.", path);
+            cache.pFile.reset();
+
+            std::ifstream fs(path.c_str(), std::ios_base::binary);
+            if (fs.bad()) FALCOR_THROW("Failed to open scene cache file '{}'.", path);
+            fs.seekg(sizeof(header));
+
+            // Read cache (compressed).
+            lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
+            InputStream stream(zs);
+            auto sceneData = readSceneData(stream, pDevice);
+            if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", path);
+            return sceneData;
+        }
+
+        // Read section table.
+        size_t offset = sizeof(header);
+        uint32_t sectionCount = 0;
+        if (fileSize < offset + sizeof(sectionCount)) FALCOR_THROW("Invalid section table in scene cache file '{}'.", path);
+        std::memcpy(&sectionCount, pData + offset, sizeof(sectionCount));
+        offset += sizeof(sectionCount);
+        if (sectionCount == 0 || (fileSize - offset) / sizeof(SectionDesc) < sectionCount)
+            FALCOR_THROW("Invalid section table in scene cache file '{}'.", path);
+        cache.sections.resize(sectionCount);
+        std::memcpy(cache.sections.data(), pData + offset, sectionCount * sizeof(SectionDesc));
+        for (auto& desc : cache.sections)
+        {
+            desc.name[sizeof(SectionDesc::name) - 1] = '\0';
+            if (desc.offset > fileSize || desc.size > fileSize - desc.offset)
+                FALCOR_THROW("Section '{}' exceeds the size of scene cache file '{}'.", desc.name, path);
+        }
+        if (std::strcmp(cache.sections[0].name, kSceneDataSection) != 0)
+            FALCOR_THROW("Missing scene data section in scene cache file '{}'.", path);
+
+        // Decompress scene data. Uncompressed raw sections are only accessed on demand through the mapping.
+        std::shared_ptr<const void> pSceneDataStorage;
+        InputStream stream(cache.getSectionData(0, pSceneDataStorage), &cache);
+        return readSceneData(stream, pDevice);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -844,14 +1323,30 @@ namespace Falcor
         stream.write(pGridVolume->mNodeID);
 
         stream.write(pGridVolume->mName);
-        for (const auto& gridSequence : pGridVolume->mGrids)
+        for (size_t slotIndex = 0; slotIndex < pGridVolume->mGrids.size(); ++slotIndex)
         {
+            // Streamed sequences only reference the grid of the current frame, the other frames are restored from the stream source.
+            const auto& gridSequence = pGridVolume->mGrids[slotIndex];
             stream.write((uint32_t)gridSequence.size());
             for (const auto& pGrid : gridSequence)
             {
                 uint32_t id = pGrid ? (uint32_t)std::distance(grids.begin(), std::find(grids.begin(), grids.end(), pGrid)) : uint32_t(-1);
                 stream.write(id);
             }
+
+            const auto& pStream = pGridVolume->mGridStreams[slotIndex];
+            if (!stream.hasRawSections())
+            {
+                if (pStream) FALCOR_THROW("Grid volume '{}' uses a streamed grid sequence, which is not supported by the legacy scene cache format.", pGridVolume->mName);
+                continue;
+            }
+            stream.write(pStream != nullptr);
+            if (pStream)
+            {
+                stream.write(pStream->getPaths());
+                stream.write(pStream->getGridname());
+                stream.write(pStream->getOptions());
+            }
         }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
@@ -868,14 +1363,29 @@ namespace Falcor
         stream.read(pGridVolume->mNodeID);
 
         stream.read(pGridVolume->mName);
-        for (auto& gridSequence : pGridVolume->mGrids)
+        for (size_t slotIndex = 0; slotIndex < pGridVolume->mGrids.size(); ++slotIndex)
         {
+            auto& gridSequence = pGridVolume->mGrids[slotIndex];
             gridSequence.resize(stream.read<uint32_t>());
             for (auto& pGrid : gridSequence)
             {
                 auto id = stream.read<uint32_t>();
                 pGrid = id == uint32_t(-1) ? nullptr : grids[id];
             }
+
+            // The legacy format has no streamed grid sequences.
+            if (!stream.isMapped()) continue;
+            if (stream.read<bool>())
+            {
+                auto paths = stream.read<std::vector<std::filesystem::path>>();
+                auto gridname = stream.read<std::string>();
+                auto options = stream.read<GridSequenceStream::Options>();
+                if (paths.size() != gridSequence.size())
+                    FALCOR_THROW("Invalid streamed grid sequence of grid volume '{}' in scene cache.", pGridVolume->mName);
+
+                // The grid of the current frame is part of the scene's grids, other frames are loaded on demand.
+                pGridVolume->mGridStreams[slotIndex] = GridSequenceStream::create(pDevice, paths, gridname, options);
+            }
         }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
@@ -951,7 +1461,7 @@ namespace Falcor
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        stream.write(pAnimation->getKeyframes());
     }
 
     ref<Animation> SceneCache::readAnimation(InputStream& stream)
@@ -964,7 +1474,9 @@ namespace Falcor
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        std::vector<Animation::Keyframe> keyframes;
+        stream.read(keyframes);
+        for (const auto& keyframe : keyframes) pAnimation->addKeyframe(keyframe);
         return pAnimation;
     }
 
@@ -987,7 +1499,33 @@ namespace Falcor
     {
         stream.write(buffer.mBufferName);
         stream.write(buffer.mBufferCountDefinePrefix);
-        stream.write(buffer.mCpuBuffers);
+
+        const size_t bufferCount = buffer.getCpuBufferCount();
+        if (stream.hasRawSections())
+        {
+            // Store the buffer data in a raw section, allowing it to be used directly from the memory mapping.
+            std::vector<fstd::span<const uint8_t>> blocks;
+            std::vector<uint64_t> elementCounts;
+            for (size_t i = 0; i < bufferCount; ++i)
+            {
+                auto cpuData = buffer.getCpuData(i);
+                blocks.emplace_back(reinterpret_cast<const uint8_t*>(cpuData.data()), cpuData.size_bytes());
+                elementCounts.push_back(cpuData.size());
+            }
+            stream.write(stream.addRawSection(buffer.mBufferName, std::move(blocks)));
+            stream.write(elementCounts);
+        }
+        else
+        {
+            // Legacy format matching the serialization of std::vector<std::vector<T>>.
+            stream.write((uint64_t)bufferCount);
+            for (size_t i = 0; i < bufferCount; ++i)
+            {
+                auto cpuData = buffer.getCpuData(i);
+                stream.write((uint64_t)cpuData.size());
+                stream.write(cpuData.data(), cpuData.size_bytes());
+            }
+        }
     }
 
     template<typename T, bool TUseByteAddressBuffer>
@@ -995,7 +1533,34 @@ namespace Falcor
     {
         stream.read(buffer.mBufferName);
         stream.read(buffer.mBufferCountDefinePrefix);
-        stream.read(buffer.mCpuBuffers);
+
+        if (stream.isMapped())
+        {
+            const uint32_t sectionIndex = stream.read<uint32_t>();
+            std::vector<uint64_t> elementCounts;
+            stream.read(elementCounts);
+
+            std::shared_ptr<const void> pStorage;
+            auto section = stream.getRawSection(sectionIndex, pStorage);
+            std::vector<uint64_t> blockSizes(elementCounts.size());
+            for (size_t i = 0; i < elementCounts.size(); ++i) blockSizes[i] = elementCounts[i] * sizeof(T);
+            auto offsets = computeRawBlockOffsets(blockSizes);
+
+            std::vector<fstd::span<const T>> buffers;
+            for (size_t i = 0; i < elementCounts.size(); ++i)
+            {
+                if (offsets[i] > section.size() || blockSizes[i] > section.size() - offsets[i])
+                    FALCOR_THROW("Split buffer '{}' exceeds the size of its scene cache section.", buffer.mBufferName);
+                const uint8_t* pData = section.data() + offsets[i];
+                FALCOR_CHECK(reinterpret_cast<uintptr_t>(pData) % alignof(T) == 0, "Split buffer '{}' is misaligned in the scene cache.", buffer.mBufferName);
+                buffers.emplace_back(reinterpret_cast<const T*>(pData), elementCounts[i]);
+            }
+            buffer.setExternalCpuData(std::move(buffers), std::move(pStorage));
+        }
+        else
+        {
+            stream.read(buffer.mCpuBuffers);
+        }
     }
 
 }
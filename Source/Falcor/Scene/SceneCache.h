@@ -38,6 +38,7 @@
 #include "Material/MaterialTextureLoader.h"
 
 #include "Core/Macros.h"
+#include "Core/Enum.h"
 #include "Core/API/fwd.h"
 #include "Utils/CryptoUtils.h"
 
@@ -53,12 +54,35 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        Cache files are split into sections listed in a table of contents. The serialized scene data is stored
+        in independently compressed chunks that are decompressed in parallel. Large vertex/index buffers are stored
+        uncompressed and are used directly from a memory mapping of the file without copying.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** Compression of the cache sections.
+            Uncompressed caches are fastest to write and read on fast local storage (e.g. NVMe),
+            LZ4-HC produces the smallest caches for slow (e.g. network) storage at the cost of slower writes.
+        */
+        enum class Compression : uint32_t
+        {
+            None,   ///< No compression.
+            LZ4,    ///< LZ4 fast compression.
+            LZ4HC,  ///< LZ4 high compression.
+        };
+
+        FALCOR_ENUM_INFO(
+            Compression,
+            {
+                { Compression::None, "None" },
+                { Compression::LZ4, "LZ4" },
+                { Compression::LZ4HC, "LZ4HC" },
+            }
+        );
+
         /** Check if there is a valid scene cache for a given cache key.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
@@ -66,10 +90,13 @@ namespace Falcor
         static bool hasValidCache(const Key& key);
 
         /** Write a scene cache.
+            The scene data is compressed in independent chunks on the worker threads.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] compression Compression of the scene data.
+            \param[in] compressBuffers Also compress the vertex/index buffers. These can then no longer be used directly from the memory mapping.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, Compression compression = Compression::LZ4, bool compressBuffers = false);
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -78,6 +105,28 @@ namespace Falcor
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Write a scene cache to a given file.
+            \param[in] sceneData Scene data.
+            \param[in] path File path.
+            \param[in] compression Compression of the scene data.
+            \param[in] compressBuffers Also compress the vertex/index buffers.
+        */
+        static void writeCache(const Scene::SceneData& sceneData, const std::filesystem::path& path, Compression compression = Compression::LZ4, bool compressBuffers = false);
+
+        /** Read a scene cache from a given file. Files in the legacy stream format are also supported.
+            Split vertex/index buffers of the returned scene data may reference the memory-mapped file.
+            \param[in] pDevice GPU device.
+            \param[in] path File path.
+            \return Returns the loaded scene data.
+        */
+        static Scene::SceneData readCache(ref<Device> pDevice, const std::filesystem::path& path);
+
+        /** Write a scene cache in the legacy stream format (used for testing migration and benchmarking).
+            \param[in] sceneData Scene data.
+            \param[in] path File path.
+        */
+        static void writeLegacyCache(const Scene::SceneData& sceneData, const std::filesystem::path& path);
+
     private:
         class OutputStream;
         class InputStream;
@@ -129,4 +178,6 @@ namespace Falcor
         template<typename T, bool TUseByteAddressBuffer>
         static void readSplitBuffer(InputStream& stream, SplitBuffer<T, TUseByteAddressBuffer>& buffer);
     };
+
+    FALCOR_ENUM_REGISTER(SceneCache::Compression);
 }
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TriangleMesh.h"
+#include "PlyReader.h"
 #include "GlobalState.h"
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
@@ -34,10 +35,132 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 namespace Falcor
 {
+    namespace
+    {
+        bool isPlyFile(const std::filesystem::path& path)
+        {
+            return hasExtension(path, "ply") || (hasExtension(path, "gz") && hasExtension(path.stem(), "ply"));
+        }
+
+        /** Generate normals for a mesh without normals, matching ASSIMP's GenNormals/GenSmoothNormals post-processing.
+            ASSIMP computes smooth normals on meshes with unique vertices per triangle. Each vertex gets the average
+            of the unit normals of the triangles using a vertex at the same position, i.e. the normals are not area
+            weighted. Facet normals require vertices to be unique per triangle, so the mesh is converted to a
+            non-indexed mesh in that case.
+        */
+        void generateNormals(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices, bool smooth)
+        {
+            auto faceNormal = [&](uint32_t i0, uint32_t i1, uint32_t i2)
+            {
+                const float3& p0 = vertices[i0].position;
+                return cross(vertices[i1].position - p0, vertices[i2].position - p0);
+            };
+            auto safeNormalize = [](float3 n) { return dot(n, n) > 0.f ? normalize(n) : float3(0.f, 1.f, 0.f); };
+
+            if (smooth)
+            {
+                // Sum the unit normals of the triangles using each vertex. Degenerate triangles don't contribute.
+                std::vector<float3> normalSums(vertices.size(), float3(0.f));
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    float3 n = faceNormal(indices[i], indices[i + 1], indices[i + 2]);
+                    if (dot(n, n) > 0.f) n = normalize(n);
+                    for (size_t j = 0; j < 3; ++j) normalSums[indices[i + j]] += n;
+                }
+
+                // Find the vertices at the same position by sorting them along an axis, like ASSIMP's SpatialSort.
+                // Positions within 1e-4 of the bounding box diagonal are considered the same.
+                float3 minPos(std::numeric_limits<float>::max());
+                float3 maxPos(-std::numeric_limits<float>::max());
+                for (const auto& vertex : vertices)
+                {
+                    minPos = math::min(minPos, vertex.position);
+                    maxPos = math::max(maxPos, vertex.position);
+                }
+                const float epsilon = vertices.empty() ? 0.f : length(maxPos - minPos) * 1e-4f;
+                const float3 axis = normalize(float3(0.8523f, 0.0016f, 0.5231f));
+
+                std::vector<std::pair<float, uint32_t>> sorted(vertices.size());
+                for (uint32_t i = 0; i < vertices.size(); ++i) sorted[i] = {dot(vertices[i].position, axis), i};
+                std::sort(sorted.begin(), sorted.end());
+
+                std::vector<bool> done(vertices.size(), false);
+                std::vector<uint32_t> found;
+                for (uint32_t i = 0; i < vertices.size(); ++i)
+                {
+                    if (done[i]) continue;
+
+                    const float3 p = vertices[i].position;
+                    const float d = dot(p, axis);
+                    found.clear();
+                    float3 n(0.f);
+                    auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(d - epsilon, 0u));
+                    for (; it != sorted.end() && it->first <= d + epsilon; ++it)
+                    {
+                        const float3 offset = vertices[it->second].position - p;
+                        if (dot(offset, offset) > epsilon * epsilon) continue;
+                        found.push_back(it->second);
+                        n += normalSums[it->second];
+                    }
+
+                    n = safeNormalize(n);
+                    for (uint32_t j : found)
+                    {
+                        vertices[j].normal = n;
+                        done[j] = true;
+                    }
+                }
+            }
+            else
+            {
+                TriangleMesh::VertexList unindexed(indices.size());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    float3 n = safeNormalize(faceNormal(indices[i], indices[i + 1], indices[i + 2]));
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        unindexed[i + j] = vertices[indices[i + j]];
+                        unindexed[i + j].normal = n;
+                        indices[i + j] = (uint32_t)(i + j);
+                    }
+                }
+                vertices = std::move(unindexed);
+            }
+        }
+
+        ref<TriangleMesh> createFromPlyFile(const std::filesystem::path& path, TriangleMesh::ImportFlags importFlags)
+        {
+            PlyReader::Mesh mesh;
+            try
+            {
+                mesh = PlyReader::readFile(path);
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("Failed to load triangle mesh from '{}': {}", path, e.what());
+                return nullptr;
+            }
+
+            if (!mesh.hasNormals)
+                generateNormals(mesh.vertices, mesh.indices, is_set(importFlags, TriangleMesh::ImportFlags::GenSmoothNormals));
+
+            // Match ASSIMP's FlipUVs post-processing.
+            if (mesh.hasTexCoords)
+            {
+                for (auto& vertex : mesh.vertices) vertex.texCoord.y = 1.f - vertex.texCoord.y;
+            }
+
+            return TriangleMesh::create(mesh.vertices, mesh.indices);
+        }
+    }
+
     ref<TriangleMesh> TriangleMesh::create()
     {
         return ref<TriangleMesh>(new TriangleMesh());
@@ -201,6 +324,9 @@ namespace Falcor
             return nullptr;
         }
 
+        if (isPlyFile(path) && !is_set(importFlags, ImportFlags::UseAssimp))
+            return createFromPlyFile(path, importFlags);
+
         Assimp::Importer importer;
 
         unsigned int flags =
@@ -330,6 +456,7 @@ namespace Falcor
         flags.value("Default", TriangleMesh::ImportFlags::Default);
         flags.value("GenSmoothNormals", TriangleMesh::ImportFlags::GenSmoothNormals);
         flags.value("JoinIdenticalVertices", TriangleMesh::ImportFlags::JoinIdenticalVertices);
+        flags.value("UseAssimp", TriangleMesh::ImportFlags::UseAssimp);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<TriangleMesh, ref<TriangleMesh>> triangleMesh(m, "TriangleMesh");
@@ -51,6 +51,7 @@ namespace Falcor
             None = 0x0,
             GenSmoothNormals = 0x1,
             JoinIdenticalVertices = 0x2,
+            UseAssimp = 0x4,                ///< Use ASSIMP also for formats with a native reader (PLY).
 
             Default = None
         };
@@ -112,6 +113,9 @@ namespace Falcor
         /** Creates a triangle mesh from a file.
             This is using ASSIMP to support a wide variety of asset formats.
             All geometry found in the asset is pre-transformed and merged into the same triangle mesh.
+            PLY files (.ply and .ply.gz) are loaded with a native reader (see PlyReader) that produces the same
+            result without the overhead of ASSIMP. PLY meshes are already indexed, so JoinIdenticalVertices has no effect.
+            This function can be called concurrently from multiple threads.
             \param[in] path File path to load mesh from (absolute or relative to working directory).
             \param[in] flags Flags controlling ASSIMP mesh import options.
             \return Returns the triangle mesh or nullptr if the mesh failed to load.
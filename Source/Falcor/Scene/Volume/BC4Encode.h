@@ -30,8 +30,27 @@
 #include <cstdint>
 #include <climits>
 
-// this file exposes a single function, CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 encoded block
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define BC4_ENCODE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#define BC4_ENCODE_TARGET(isa)
+#else
+#define BC4_ENCODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// this file exposes a single function, CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 encoded block.
+// the endpoint search and codebook fitting are vectorized with SSE2, or AVX2 when the cpu supports it (detected at runtime).
+// CompressAlphaDxt5Scalar is the reference implementation, all variants produce bit identical blocks.
 static void CompressAlphaDxt5(uint8_t* tile, void* block);
+static void CompressAlphaDxt5Scalar(uint8_t* tile, void* block);
 
 // derived from libsquish, alpha.cpp
 /* -----------------------------------------------------------------------------
@@ -184,7 +203,24 @@ static void WriteAlphaBlock7(int alpha0, int alpha1, uint8_t const* indices, voi
 }
 
 
-static void CompressAlphaDxt5(uint8_t* tile, void* block)
+static void BuildCodes(int min5, int max5, int min7, int max7, uint8_t* codes5, uint8_t* codes7)
+{
+    // set up the 5-alpha code book
+    codes5[0] = (uint8_t)min5;
+    codes5[1] = (uint8_t)max5;
+    for (int i = 1; i < 5; ++i)
+        codes5[1 + i] = (uint8_t)(((5 - i) * min5 + i * max5) / 5);
+    codes5[6] = 0;
+    codes5[7] = 255;
+
+    // set up the 7-alpha code book
+    codes7[0] = (uint8_t)min7;
+    codes7[1] = (uint8_t)max7;
+    for (int i = 1; i < 7; ++i)
+        codes7[1 + i] = (uint8_t)(((7 - i) * min7 + i * max7) / 7);
+}
+
+static void CompressAlphaDxt5Scalar(uint8_t* tile, void* block)
 {
     // get the range for 5-alpha and 7-alpha interpolation
     int min5 = 255;
@@ -215,21 +251,9 @@ static void CompressAlphaDxt5(uint8_t* tile, void* block)
     FixRange(min5, max5, 5);
     FixRange(min7, max7, 7);
 
-    // set up the 5-alpha code book
     uint8_t codes5[8];
-    codes5[0] = (uint8_t)min5;
-    codes5[1] = (uint8_t)max5;
-    for (int i = 1; i < 5; ++i)
-        codes5[1 + i] = (uint8_t)(((5 - i) * min5 + i * max5) / 5);
-    codes5[6] = 0;
-    codes5[7] = 255;
-
-    // set up the 7-alpha code book
     uint8_t codes7[8];
-    codes7[0] = (uint8_t)min7;
-    codes7[1] = (uint8_t)max7;
-    for (int i = 1; i < 7; ++i)
-        codes7[1 + i] = (uint8_t)(((7 - i) * min7 + i * max7) / 7);
+    BuildCodes(min5, max5, min7, max7, codes5, codes7);
 
     // fit the data to both code books
     uint8_t indices5[16];
@@ -244,3 +268,188 @@ static void CompressAlphaDxt5(uint8_t* tile, void* block)
         WriteAlphaBlock7(min7, max7, indices7, block);
 }
 
+#if BC4_ENCODE_SSE2
+
+static inline int HorizontalMinU8(__m128i v)
+{
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static inline int HorizontalMaxU8(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static inline int HorizontalSumI32(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+// fits all 16 values to the codebook at once. the absolute difference selects the same code as the squared
+// error, ties keep the lowest index as in FitCodes.
+static int FitCodesSSE2(__m128i values, uint8_t const* codes, uint8_t* indices)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i least = _mm_set1_epi8((char)0xff);
+    __m128i index = zero;
+    for (int j = 0; j < 8; ++j)
+    {
+        __m128i code = _mm_set1_epi8((char)codes[j]);
+        __m128i dist = _mm_or_si128(_mm_subs_epu8(values, code), _mm_subs_epu8(code, values));
+        __m128i notCloser = _mm_cmpeq_epi8(_mm_subs_epu8(least, dist), zero);
+        index = _mm_or_si128(_mm_and_si128(notCloser, index), _mm_andnot_si128(notCloser, _mm_set1_epi8((char)j)));
+        least = _mm_min_epu8(least, dist);
+    }
+    _mm_storeu_si128((__m128i*)indices, index);
+
+    // accumulate the squared error
+    __m128i lo = _mm_unpacklo_epi8(least, zero);
+    __m128i hi = _mm_unpackhi_epi8(least, zero);
+    return HorizontalSumI32(_mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+}
+
+// fits all 16 values to both codebooks at once, the 5-alpha codebook in the lower and the 7-alpha codebook in the upper lane.
+BC4_ENCODE_TARGET("avx2") static void FitCodesAVX2(__m128i values, uint8_t const* codes5, uint8_t const* codes7, uint8_t* indices5, uint8_t* indices7, int& err5, int& err7)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i values2 = _mm256_broadcastsi128_si256(values);
+    __m256i least = _mm256_set1_epi8((char)0xff);
+    __m256i index = zero;
+    for (int j = 0; j < 8; ++j)
+    {
+        __m256i code = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi8((char)codes5[j])), _mm_set1_epi8((char)codes7[j]), 1);
+        __m256i dist = _mm256_or_si256(_mm256_subs_epu8(values2, code), _mm256_subs_epu8(code, values2));
+        __m256i notCloser = _mm256_cmpeq_epi8(_mm256_subs_epu8(least, dist), zero);
+        index = _mm256_blendv_epi8(_mm256_set1_epi8((char)j), index, notCloser);
+        least = _mm256_min_epu8(least, dist);
+    }
+    _mm_storeu_si128((__m128i*)indices5, _mm256_castsi256_si128(index));
+    _mm_storeu_si128((__m128i*)indices7, _mm256_extracti128_si256(index, 1));
+
+    // accumulate the squared error per lane
+    __m256i lo = _mm256_unpacklo_epi8(least, zero);
+    __m256i hi = _mm256_unpackhi_epi8(least, zero);
+    __m256i sq = _mm256_add_epi32(_mm256_madd_epi16(lo, lo), _mm256_madd_epi16(hi, hi));
+    err5 = HorizontalSumI32(_mm256_castsi256_si128(sq));
+    err7 = HorizontalSumI32(_mm256_extracti128_si256(sq, 1));
+}
+
+// returns true if the cpu and the os support AVX2.
+static bool HasAVX2()
+{
+    uint32_t ecx1 = 0, ebx7 = 0;
+    uint64_t xcr0 = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    ecx1 = uint32_t(info[2]);
+    __cpuidex(info, 7, 0);
+    ebx7 = uint32_t(info[1]);
+    if (ecx1 & (1u << 27))
+        xcr0 = _xgetbv(0);
+#else
+    uint32_t eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx) || !__get_cpuid_count(7, 0, &eax, &ebx7, &ecx, &edx))
+        return false;
+    if (ecx1 & (1u << 27))
+    {
+        uint32_t lo, hi;
+        __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = (uint64_t(hi) << 32) | lo;
+    }
+#endif
+    // AVX2 instructions are VEX encoded, which requires the os to save the AVX register state (OSXSAVE, XCR0).
+    const bool avx = (ecx1 & (1u << 28)) != 0 && (xcr0 & 0x6) == 0x6;
+    return avx && (ebx7 & (1u << 5)) != 0;
+}
+
+// computes the endpoints and code books of both interpolation modes.
+static void BuildCodesSSE2(__m128i values, int& min5, int& max5, int& min7, int& max7, uint8_t* codes5, uint8_t* codes7)
+{
+    // get the range for 5-alpha and 7-alpha interpolation, the 5-alpha range ignores 0 and 255
+    min7 = HorizontalMinU8(values);
+    max7 = HorizontalMaxU8(values);
+    min5 = HorizontalMinU8(_mm_or_si128(values, _mm_cmpeq_epi8(values, _mm_setzero_si128())));
+    max5 = HorizontalMaxU8(_mm_andnot_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8((char)0xff)), values));
+
+    // handle the case that no valid range was found
+    if (min5 > max5)
+        min5 = max5;
+
+    // fix the range to be the minimum in each case
+    FixRange(min5, max5, 5);
+    FixRange(min7, max7, 7);
+
+    BuildCodes(min5, max5, min7, max7, codes5, codes7);
+}
+
+static void CompressAlphaDxt5SSE2(uint8_t* tile, void* block)
+{
+    __m128i values = _mm_loadu_si128((const __m128i*)tile);
+    int min5, max5, min7, max7;
+    uint8_t codes5[8];
+    uint8_t codes7[8];
+    BuildCodesSSE2(values, min5, max5, min7, max7, codes5, codes7);
+
+    // fit the data to both code books
+    uint8_t indices5[16];
+    uint8_t indices7[16];
+    int err5 = FitCodesSSE2(values, codes5, indices5);
+    int err7 = FitCodesSSE2(values, codes7, indices7);
+
+    // save the block with least error
+    if (err5 <= err7)
+        WriteAlphaBlock5(min5, max5, indices5, block);
+    else
+        WriteAlphaBlock7(min7, max7, indices7, block);
+}
+
+// must only be called if HasAVX2() returns true.
+BC4_ENCODE_TARGET("avx2") static void CompressAlphaDxt5AVX2(uint8_t* tile, void* block)
+{
+    __m128i values = _mm_loadu_si128((const __m128i*)tile);
+    int min5, max5, min7, max7;
+    uint8_t codes5[8];
+    uint8_t codes7[8];
+    BuildCodesSSE2(values, min5, max5, min7, max7, codes5, codes7);
+
+    // fit the data to both code books
+    uint8_t indices5[16];
+    uint8_t indices7[16];
+    int err5, err7;
+    FitCodesAVX2(values, codes5, codes7, indices5, indices7, err5, err7);
+
+    // save the block with least error
+    if (err5 <= err7)
+        WriteAlphaBlock5(min5, max5, indices5, block);
+    else
+        WriteAlphaBlock7(min7, max7, indices7, block);
+}
+
+#endif // BC4_ENCODE_SSE2
+
+static void CompressAlphaDxt5(uint8_t* tile, void* block)
+{
+#if BC4_ENCODE_SSE2
+    static const bool hasAVX2 = HasAVX2();
+    if (hasAVX2)
+        CompressAlphaDxt5AVX2(tile, block);
+    else
+        CompressAlphaDxt5SSE2(tile, block);
+#else
+    CompressAlphaDxt5Scalar(tile, block);
+#endif
+}
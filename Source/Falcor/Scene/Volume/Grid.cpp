@@ -90,25 +90,39 @@ namespace Falcor
     }
 
     ref<Grid> Grid::createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto handle = loadGridHandle(path, gridname);
+        if (!handle) return nullptr;
+        return createFromGridHandle(pDevice, std::move(handle));
+    }
+
+    ref<Grid> Grid::createFromGridHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        auto floatGrid = gridHandle.grid<float>();
+        FALCOR_CHECK(floatGrid && floatGrid->gridType() == nanovdb::GridType::Float, "Grid handle does not contain a grid of type float.");
+        return ref<Grid>(new Grid(pDevice, std::move(gridHandle)));
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadGridHandle(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!std::filesystem::exists(path))
         {
             logWarning("Error when loading grid. Can't open grid file '{}'.", path);
-            return nullptr;
+            return {};
         }
 
         if (hasExtension(path, "nvdb"))
         {
-            return createFromNanoVDBFile(pDevice, path, gridname);
+            return loadNanoVDBGridHandle(path, gridname);
         }
         else if (hasExtension(path, "vdb"))
         {
-            return createFromOpenVDBFile(pDevice, path, gridname);
+            return loadOpenVDBGridHandle(path, gridname);
         }
         else
         {
             logWarning("Error when loading grid. Unsupported grid file '{}'.", path);
-            return nullptr;
+            return {};
         }
     }
 
@@ -225,38 +239,38 @@ namespace Falcor
         mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
     }
 
-    ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadNanoVDBGridHandle(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return handle;
     }
 
-    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadOpenVDBGridHandle(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -278,25 +292,23 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
-
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return nanovdb::openToNanoVDB(floatGrid);
     }
 
 
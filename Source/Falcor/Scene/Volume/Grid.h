@@ -89,6 +89,21 @@ namespace Falcor
         */
         static ref<Grid> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Create a grid from a NanoVDB grid handle.
+            \param[in] pDevice GPU device.
+            \param[in] gridHandle NanoVDB grid handle holding a grid of type float.
+            \return A new grid.
+        */
+        static ref<Grid> createFromGridHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+
+        /** Load a NanoVDB grid handle from a file without creating any GPU resources.
+            This is safe to call from worker threads, e.g. for streaming grid sequences.
+            \param[in] path File path of the grid (absolute or relative to working directory).
+            \param[in] gridname Name of the grid to load.
+            \return The grid handle, or an empty handle if the grid failed to load.
+        */
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadGridHandle(const std::filesystem::path& path, const std::string& gridname);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -147,8 +162,8 @@ namespace Falcor
     private:
         Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
 
-        static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
-        static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadNanoVDBGridHandle(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadOpenVDBGridHandle(const std::filesystem::path& path, const std::string& gridname);
 
         ref<Device> mpDevice;
 
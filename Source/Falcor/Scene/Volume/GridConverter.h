@@ -32,7 +32,7 @@
 #include "Core/API/Formats.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -46,8 +46,7 @@
 #endif
 
 #include <algorithm>
-#include <atomic>
-#include <execution>
+#include <functional>
 #include <vector>
 
 namespace Falcor
@@ -61,17 +60,39 @@ namespace Falcor
     struct NanoVDBToBricksConverter
     {
     public:
-        NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
+        /** Create a converter.
+            \param[in] grid NanoVDB grid to convert.
+            \param[in] parallel Convert leaves in parallel on the job system.
+            \param[in] useSimd Use the vectorized BC4 encoder (if available). The output is identical to the scalar encoder.
+        */
+        NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid, bool parallel = true, bool useSimd = true);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
         BrickedGrid convert(ref<Device> pDevice);
 
+        /** Convert the grid to the bricked representation in host memory without creating any GPU resources.
+            The result is deterministic, i.e. independent of the number of threads used.
+        */
+        void convertToHost();
+
+        const std::vector<uint32_t>& getRangeData() const { return mRangeData; }
+        const std::vector<uint32_t>& getPtrData() const { return mPtrData; }
+        const std::vector<TexelType>& getAtlasData() const { return mAtlasData; }
+        uint32_t getNonEmptyCount() const { return mNonEmptyCount; }
+
+        /** Get the number of voxels in the (leaf aligned) domain of the grid.
+        */
+        uint64_t getVoxelCount() const { return (uint64_t)mPixDim.x * mPixDim.y * mPixDim.z; }
+
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
 
-        void convertSlice(int z);
-        void computeMip(int mip);
+        void computeLeafRanges(int y, int z);
+        void assignBricks();
+        void writeBrick(uint32_t brick);
+        void computeMip(int mip, int z);
+        void forEach(size_t count, const std::function<void(size_t)>& func);
 
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
@@ -104,6 +125,8 @@ namespace Falcor
         }
 
         const nanovdb::FloatGrid* mpFloatGrid;
+        bool mParallel;
+        bool mUseSimd;
         uint3 mAtlasSizeBricks;
         int3 mLeafDim[4];
         int3 mBBMin, mBBMax, mPixDim;
@@ -111,13 +134,15 @@ namespace Falcor
         std::vector<uint32_t> mRangeData;
         std::vector<uint32_t> mPtrData;
         std::vector<TexelType> mAtlasData;
-        std::atomic_uint32_t mNonEmptyCount;
+        std::vector<uint32_t> mBrickLeaves; ///< Leaf index of each allocated brick.
+        uint32_t mNonEmptyCount = 0;
     };
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid)
+    NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid, bool parallel, bool useSimd)
+        : mParallel(parallel)
+        , mUseSimd(useSimd)
     {
-        mNonEmptyCount.store(0);
         mpFloatGrid = grid;
         auto& voxelbox = mpFloatGrid->indexBBox();
         mBBMin = (int3(voxelbox.min().x(), voxelbox.min().y(), voxelbox.min().z())) & (~7);
@@ -141,118 +166,145 @@ namespace Falcor
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeLeafRanges(int y, int z)
     {
-        uint3 atlasSizePixels = getAtlasSizePixels();
+        // First pass: compute the value range of a row of leaves. Non-empty leaves are flagged in the pointer data and get a brick allocated in assignBricks().
+        size_t offset = (z * mLeafDim[0].y + y) * mLeafDim[0].x;
+        uint32_t* rangedst = mRangeData.data() + offset;
+        uint32_t* ptrdst = mPtrData.data() + offset;
+        auto a = mpFloatGrid->getAccessor();
+        for (int x = 0; x < mLeafDim[0].x; ++x)
+        {
+            nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+            auto val = a.getValue(ijk);
+            auto leaf = a.probeLeaf(ijk);
+            float minorant = val, majorant = val;
+            if (leaf)
+            {
+                // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
+                const float* data = leaf->data()->mValues;
+                for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
+                // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
+                for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
+                for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
+                for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
+                for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
+            }
+            *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
+            *ptrdst++ = (leaf && majorant != minorant) ? 1 : 0;
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::assignBricks()
+    {
+        // Second pass: allocate atlas bricks for non-empty leaves in leaf order, which keeps the atlas layout deterministic.
         uint brickMax = getAtlasMaxBrick();
         uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
+        mBrickLeaves.clear();
+        mNonEmptyCount = 0;
+        for (uint32_t leafIndex = 0; leafIndex < mLeafCount[0]; ++leafIndex)
+        {
+            uint32_t& range = mRangeData[leafIndex];
+            uint32_t& ptr = mPtrData[leafIndex];
+            uint32_t majorant = range & 0xffff;
+            if (!ptr) continue;
+            uint32_t myleaf = mNonEmptyCount++;
+            if (myleaf >= brickMax)
+            {
+                range = majorant + (majorant << 16); // force identical major and minor
+                ptr = 0;
+            }
+            else
+            {
+                range = (majorant + 1) + (range & 0xffff0000); // round the majorant up
+                uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
+                uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+                uint32_t atlasz = myleaf / bricksPerSlice;
+                ptr = (atlasx + (atlasy << 8) + (atlasz << 16));
+                mBrickLeaves.push_back(leafIndex);
+            }
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeBrick(uint32_t brick)
+    {
+        // Third pass: quantize the voxels of a non-empty leaf into its atlas brick.
+        uint3 atlasSizePixels = getAtlasSizePixels();
         uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
 
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
-        uint32_t* rangedst = mRangeData.data() + offset;
-        uint32_t* ptrdst = mPtrData.data() + offset;
+        uint32_t leafIndex = mBrickLeaves[brick];
+        int x = leafIndex % mLeafDim[0].x;
+        int y = (leafIndex / mLeafDim[0].x) % mLeafDim[0].y;
+        int z = leafIndex / (mLeafDim[0].x * mLeafDim[0].y);
         auto a = mpFloatGrid->getAccessor();
-        for (int y = 0; y < mLeafDim[0].y; ++y)
-        {
-            for (int x = 0; x < mLeafDim[0].x; ++x)
+        auto leaf = a.probeLeaf(nanovdb::Coord(x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z));
+        FALCOR_ASSERT(leaf);
+        const float* data = leaf->data()->mValues;
+
+        float2 majmin = unpackMajMin(&mRangeData[leafIndex]);
+        float majorant = majmin.x, minorant = majmin.y;
+        uint32_t ptr = mPtrData[leafIndex];
+        uint32_t atlasx = ptr & 0xff;
+        uint32_t atlasy = (ptr >> 8) & 0xff;
+        uint32_t atlasz = ptr >> 16;
+
+        if (!kBC4Compress) {
+            float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
+            TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
-                uint myleaf = 0;
-                if (leaf)
-                {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->data()->mValues;
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
-                }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+                for (int pixy = 0; pixy < kBrickSize; ++pixy)
                 {
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
-                    *ptrdst++ = 0;
+                    for (int pixx = 0; pixx < kBrickSize; ++pixx)
+                    {
+                        float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
+                        *atlasdst++ = TexelType((f - minorant) * invRange);
+                    }
+                    atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
                 }
-                else
+                atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+            }
+        }
+        else {
+            // BC4 compression:
+            float invRange = (255.f) / (majorant - minorant);
+            uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
+            {
+                for (int tiley = 0; tiley < kBrickSize; tiley += 4)
                 {
-                    const float* data = leaf->data()->mValues;
-                    majorant = f16tof32(f32tof16(majorant) + 1);
-                    minorant = f16tof32(f32tof16(minorant));
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                        uint8_t tilevals[4][4];
+                        for (int pixy = 0; pixy < 4; ++pixy)
                         {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                            for (int pixx = 0; pixx < 4; ++pixx)
                             {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
-                                {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
-                                }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                                float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
+                                tilevals[pixy][pixx] = uint8_t((f - minorant) * invRange);
                             }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
                         }
+                        if (mUseSimd) CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                        else CompressAlphaDxt5Scalar((uint8_t*)&tilevals[0][0], atlasdst);
+                        atlasdst++;
                     }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
-                                    {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
-                                    }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
-                                }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
-            } // x brick loop
-        } // y brick loop
+                    atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                }
+                atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+            } // z slice loop
+        } // bc4 compress?
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip, int z)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -261,35 +313,50 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1] + z * slicestride_tgt;
+        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0) + 2 * z * slicestride_src;
+
+        for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
+            for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
             {
-                for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
-                {
-                    float2 majmin_dst = combineMajMin(
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
-                        ),
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
-                        )
-                    );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
-                } // x
-            } // y
-        } // z
+                float2 majmin_dst = combineMajMin(
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                    ),
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                    )
+                );
+                *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+            } // x
+        } // y
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::forEach(size_t count, const std::function<void(size_t)>& func)
+    {
+        auto chunk = [&](size_t begin, size_t end) { for (size_t i = begin; i < end; ++i) func(i); };
+        if (mParallel) Threading::parallelFor(0, count, 0, chunk);
+        else chunk(0, count);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertToHost()
+    {
+        forEach(mLeafDim[0].y * mLeafDim[0].z, [&](size_t row) { computeLeafRanges(int(row % mLeafDim[0].y), int(row / mLeafDim[0].y)); });
+        assignBricks();
+        forEach(mBrickLeaves.size(), [&](size_t brick) { writeBrick(uint32_t(brick)); });
+        for (int mip = 1; mip < 4; ++mip) forEach(mLeafDim[mip].z, [&](size_t z) { computeMip(mip, int(z)); });
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
+        convertToHost();
 
         BrickedGrid bricks;
         bricks.range = pDevice->createTexture3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource);
@@ -297,7 +364,7 @@ namespace Falcor
         bricks.atlas = pDevice->createTexture3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource);
 
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount, getAtlasMaxBrick());
         return bricks;
     }
 }
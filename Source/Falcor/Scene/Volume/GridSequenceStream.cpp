@@ -0,0 +1,286 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridSequenceStream.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+    GridSequenceStream::GridSequenceStream(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options)
+        : mpDevice(pDevice)
+        , mPaths(paths)
+        , mGridname(gridname)
+        , mOptions(options)
+        , mFrames(paths.size())
+    {
+        FALCOR_CHECK(!mPaths.empty(), "Grid sequence stream needs at least one frame.");
+    }
+
+    GridSequenceStream::~GridSequenceStream()
+    {
+        // Wait for pending loads, which reference this object. Load errors are kept with the frames.
+        for (auto& frame : mFrames)
+        {
+            if (frame.task.isValid()) frame.task.finish();
+        }
+    }
+
+    ref<Grid> GridSequenceStream::getGrid(uint32_t frameIndex, int direction)
+    {
+        FALCOR_CHECK(frameIndex < getFrameCount(), "Frame index {} is out of range (frame count is {}).", frameIndex, getFrameCount());
+        direction = direction < 0 ? -1 : 1;
+
+        Frame& frame = mFrames[frameIndex];
+        frame.lastUse = ++mUseCounter;
+
+        FrameState state;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            state = frame.state;
+        }
+
+        if (state == FrameState::Resident)
+        {
+            mStats.hits++;
+        }
+        else
+        {
+            if (state == FrameState::Unloaded) requestLoad(frameIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                state = frame.state;
+            }
+
+            if (state == FrameState::Loaded)
+            {
+                mStats.hits++;
+            }
+            else if (state == FrameState::Loading)
+            {
+                mStats.misses++;
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                frame.task.finish();
+                mStats.stallTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+            }
+
+            // Create GPU resources on the calling thread.
+            nanovdb::GridHandle<nanovdb::HostBuffer> handle;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                frame.task = {};
+
+                // Report a failed load to the requester, the next request reloads the frame.
+                if (frame.state == FrameState::Failed)
+                {
+                    std::exception_ptr error = std::move(frame.error);
+                    frame.error = nullptr;
+                    frame.state = FrameState::Unloaded;
+                    std::rethrow_exception(error);
+                }
+
+                FALCOR_ASSERT(frame.state == FrameState::Loaded);
+                handle = std::move(frame.handle);
+            }
+
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            ref<Grid> pGrid = handle ? Grid::createFromGridHandle(mpDevice, std::move(handle)) : nullptr;
+            mStats.createTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            frame.pGrid = pGrid;
+            frame.memory = pGrid ? pGrid->getGridHandle().size() + pGrid->getGridSizeInBytes() : 0;
+            frame.state = FrameState::Resident;
+        }
+
+        // Prefetch the following frames in playback direction.
+        const uint32_t prefetchCount = std::min(mOptions.prefetchCount, std::max(mOptions.windowSize, 1u) - 1);
+        for (uint32_t distance = 1; distance <= std::min(prefetchCount, getFrameCount() - 1); ++distance)
+        {
+            uint32_t prefetchFrame = getPrefetchFrame(frameIndex, direction, distance);
+            bool unloaded;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                unloaded = mFrames[prefetchFrame].state == FrameState::Unloaded;
+            }
+            if (unloaded)
+            {
+                requestLoad(prefetchFrame);
+                mStats.prefetches++;
+            }
+            mFrames[prefetchFrame].lastUse = mUseCounter;
+        }
+
+        mLastFrame = frameIndex;
+        mLastDirection = direction;
+        evict(frameIndex, direction);
+
+        return frame.pGrid;
+    }
+
+    void GridSequenceStream::setOptions(const Options& options)
+    {
+        mOptions = options;
+        evict(mLastFrame, mLastDirection);
+    }
+
+    GridSequenceStream::Stats GridSequenceStream::getStats() const
+    {
+        Stats stats = mStats;
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& frame : mFrames)
+        {
+            if (frame.state == FrameState::Loaded || frame.state == FrameState::Resident)
+            {
+                stats.residentFrameCount++;
+                stats.residentMemory += frame.memory;
+            }
+        }
+        return stats;
+    }
+
+    void GridSequenceStream::resetStats()
+    {
+        mStats = {};
+    }
+
+    void GridSequenceStream::renderUI(Gui::Widgets& widget)
+    {
+        Stats stats = getStats();
+        widget.text(fmt::format(
+            "Resident frames: {} / {}\nMemory: {}\nHits: {}\nMisses: {}\nPrefetches: {}\nEvictions: {}\nStall time: {:.3f} s\nCreate time: {:.3f} s",
+            stats.residentFrameCount, getFrameCount(), formatByteSize(stats.residentMemory), stats.hits, stats.misses,
+            stats.prefetches, stats.evictions, stats.stallTime, stats.createTime
+        ));
+        if (widget.button("Reset stats")) resetStats();
+
+        Options options = mOptions;
+        bool changed = false;
+        changed |= widget.var("Window size", options.windowSize, 1u, getFrameCount(), 1u);
+        changed |= widget.var("Prefetch count", options.prefetchCount, 0u, getFrameCount(), 1u);
+        uint32_t budgetMB = (uint32_t)(options.memoryBudget >> 20);
+        if (widget.var("Memory budget (MB)", budgetMB, 0u, std::numeric_limits<uint32_t>::max(), 64u))
+        {
+            options.memoryBudget = (uint64_t)budgetMB << 20;
+            changed = true;
+        }
+        widget.tooltip("Zero means unlimited.");
+        if (changed) setOptions(options);
+    }
+
+    void GridSequenceStream::requestLoad(uint32_t frameIndex)
+    {
+        Frame& frame = mFrames[frameIndex];
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (frame.state != FrameState::Unloaded) return;
+            frame.state = FrameState::Loading;
+        }
+
+        frame.task = Threading::dispatchTask(
+            [this, frameIndex]()
+            {
+                // Errors are kept with the frame, so that they are reported to the requester even if the load was a prefetch.
+                nanovdb::GridHandle<nanovdb::HostBuffer> handle;
+                std::exception_ptr error;
+                try
+                {
+                    handle = Grid::loadGridHandle(mPaths[frameIndex], mGridname);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                Frame& frame = mFrames[frameIndex];
+                frame.memory = handle.size();
+                frame.handle = std::move(handle);
+                frame.error = error;
+                frame.state = error ? FrameState::Failed : FrameState::Loaded;
+            }
+        );
+    }
+
+    void GridSequenceStream::evict(uint32_t requestedFrame, int direction)
+    {
+        const uint32_t windowSize = std::max(mOptions.windowSize, 1u);
+        const uint32_t prefetchCount = std::min({mOptions.prefetchCount, windowSize - 1, getFrameCount() - 1});
+
+        auto isProtected = [&](uint32_t frameIndex)
+        {
+            if (frameIndex == requestedFrame) return true;
+            for (uint32_t distance = 1; distance <= prefetchCount; ++distance)
+            {
+                if (getPrefetchFrame(requestedFrame, direction, distance) == frameIndex) return true;
+            }
+            return false;
+        };
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        while (true)
+        {
+            // Frames being loaded count against the window but can only be evicted once loaded.
+            // Failed frames hold no data, they are kept until their error is reported to the requester.
+            uint32_t residentCount = 0;
+            uint64_t residentMemory = 0;
+            Frame* pCandidate = nullptr;
+            for (uint32_t i = 0; i < getFrameCount(); ++i)
+            {
+                Frame& frame = mFrames[i];
+                if (frame.state == FrameState::Unloaded || frame.state == FrameState::Failed) continue;
+                residentCount++;
+                residentMemory += frame.memory;
+                if (frame.state != FrameState::Loading && !isProtected(i) && (!pCandidate || frame.lastUse < pCandidate->lastUse))
+                    pCandidate = &frame;
+            }
+
+            bool overWindow = residentCount > windowSize;
+            bool overBudget = mOptions.memoryBudget > 0 && residentMemory > mOptions.memoryBudget;
+            if (!pCandidate || !(overWindow || overBudget)) break;
+
+            pCandidate->handle = {};
+            pCandidate->pGrid = nullptr;
+            pCandidate->memory = 0;
+            pCandidate->task = {};
+            pCandidate->state = FrameState::Unloaded;
+            mStats.evictions++;
+        }
+    }
+
+    uint32_t GridSequenceStream::getPrefetchFrame(uint32_t frame, int direction, uint32_t distance) const
+    {
+        const uint32_t frameCount = getFrameCount();
+        distance %= frameCount;
+        return direction > 0 ? (frame + distance) % frameCount : (frame + frameCount - distance) % frameCount;
+    }
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Threading.h"
+#include "Utils/UI/Gui.h"
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams the frames of a grid sequence from disk, keeping only a bounded set of frames resident.
+
+        Grid files are loaded on worker threads (file I/O and conversion to NanoVDB), GPU resources
+        are created on the calling thread when a frame is requested. After each request, the next frames
+        in playback direction are prefetched. Frames exceeding the resident window or the memory budget
+        are evicted in least recently used order, never evicting the requested or prefetched frames.
+    */
+    class FALCOR_API GridSequenceStream : public Object
+    {
+        FALCOR_OBJECT(GridSequenceStream)
+    public:
+        struct Options
+        {
+            uint32_t windowSize = 8;        ///< Maximum number of resident frames (including prefetched frames).
+            uint32_t prefetchCount = 2;     ///< Number of frames to prefetch in playback direction.
+            uint64_t memoryBudget = 0;      ///< Memory budget in bytes for resident frames (host and device memory). Zero means unlimited.
+        };
+
+        struct Stats
+        {
+            uint64_t hits = 0;              ///< Number of requests for frames that were resident or already loaded.
+            uint64_t misses = 0;            ///< Number of requests that had to wait for a frame to load.
+            uint64_t prefetches = 0;        ///< Number of issued prefetches.
+            uint64_t evictions = 0;         ///< Number of evicted frames.
+            double stallTime = 0.0;         ///< Total time in seconds spent waiting for frames to load.
+            double createTime = 0.0;        ///< Total time in seconds spent creating GPU resources for frames.
+            uint32_t residentFrameCount = 0;///< Number of currently resident frames.
+            uint64_t residentMemory = 0;    ///< Memory used by resident frames in bytes.
+        };
+
+        /** Create a grid sequence stream.
+            \param[in] pDevice GPU device.
+            \param[in] paths File paths of the grids, one per frame.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return A new grid sequence stream.
+        */
+        static ref<GridSequenceStream> create(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options = Options())
+        {
+            return make_ref<GridSequenceStream>(pDevice, paths, gridname, options);
+        }
+
+        GridSequenceStream(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const Options& options);
+        ~GridSequenceStream();
+
+        /** Get the grid of a frame.
+            Blocks if the frame is not loaded yet. Afterwards, the following frames in playback direction are prefetched.
+            \param[in] frame Frame index.
+            \param[in] direction Playback direction (positive for forward, negative for backward playback).
+            \return The grid, or nullptr if the grid failed to load.
+            Throws if loading the frame threw, including errors of an earlier prefetch of the frame. The frame is reloaded on the next request.
+        */
+        ref<Grid> getGrid(uint32_t frame, int direction = 1);
+
+        /** Get the number of frames in the sequence.
+        */
+        uint32_t getFrameCount() const { return (uint32_t)mFrames.size(); }
+
+        /** Get the file paths of the grids.
+        */
+        const std::vector<std::filesystem::path>& getPaths() const { return mPaths; }
+
+        /** Get the name of the streamed grid.
+        */
+        const std::string& getGridname() const { return mGridname; }
+
+        /** Set the streaming options. Evicts frames if the new limits are exceeded.
+        */
+        void setOptions(const Options& options);
+
+        /** Get the streaming options.
+        */
+        const Options& getOptions() const { return mOptions; }
+
+        /** Get the streaming statistics.
+        */
+        Stats getStats() const;
+
+        /** Reset the hit/miss/stall statistics.
+        */
+        void resetStats();
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        enum class FrameState
+        {
+            Unloaded,   ///< Frame is not loaded.
+            Loading,    ///< Frame is being loaded on a worker thread.
+            Loaded,     ///< Host data is loaded, GPU resources are not created yet.
+            Resident,   ///< Grid is created.
+            Failed,     ///< Loading threw, the error is reported on the next request.
+        };
+
+        struct Frame
+        {
+            FrameState state = FrameState::Unloaded;
+            Threading::Task task;
+            nanovdb::GridHandle<nanovdb::HostBuffer> handle;
+            ref<Grid> pGrid;
+            uint64_t memory = 0;
+            uint64_t lastUse = 0;
+            std::exception_ptr error;
+        };
+
+        void requestLoad(uint32_t frame);
+        void evict(uint32_t requestedFrame, int direction);
+        uint32_t getPrefetchFrame(uint32_t frame, int direction, uint32_t distance) const;
+
+        ref<Device> mpDevice;
+        std::vector<std::filesystem::path> mPaths;
+        std::string mGridname;
+        Options mOptions;
+        Stats mStats;
+
+        mutable std::mutex mMutex;  ///< Protects frame state and host data written by worker threads.
+        std::vector<Frame> mFrames;
+        uint64_t mUseCounter = 0;
+        uint32_t mLastFrame = 0;
+        int mLastDirection = 1;
+    };
+}
@@ -31,6 +31,7 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
+#include <optional>
 #include <set>
 #include <filesystem>
 
@@ -80,6 +81,15 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            if (const auto& pStream = mGridStreams[slotIndex])
+            {
+                const char* label = (GridSlot)slotIndex == GridSlot::Density ? "Density Grid Streaming" : "Emission Grid Streaming";
+                if (auto group = widget.group(label)) pStream->renderUI(group);
+            }
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -145,16 +155,40 @@ namespace Falcor
     }
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+    {
+        auto paths = enumerateGridFiles(path);
+        return paths ? loadGridSequence(slot, *paths, gridname, keepEmpty) : 0;
+    }
+
+    uint32_t GridVolume::loadGridSequenceStream(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStream::Options& options)
+    {
+        if (paths.empty())
+        {
+            logWarning("Cannot stream an empty grid sequence.");
+            return 0;
+        }
+        auto pStream = GridSequenceStream::create(mpDevice, paths, gridname, options);
+        setGridSequenceStream(slot, pStream);
+        return pStream->getFrameCount();
+    }
+
+    uint32_t GridVolume::loadGridSequenceStream(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStream::Options& options)
+    {
+        auto paths = enumerateGridFiles(path);
+        return paths ? loadGridSequenceStream(slot, *paths, gridname, options) : 0;
+    }
+
+    std::optional<std::vector<std::filesystem::path>> GridVolume::enumerateGridFiles(const std::filesystem::path& path)
     {
         if (!std::filesystem::exists(path))
         {
             logWarning("'{}' does not exist.", path);
-            return 0;
+            return std::nullopt;
         }
         if (!std::filesystem::is_directory(path))
         {
             logWarning("'{}' is not a directory.", path);
-            return 0;
+            return std::nullopt;
         }
 
         // Enumerate grid files.
@@ -172,7 +206,28 @@ namespace Falcor
         };
         std::sort(paths.begin(), paths.end(), cmp);
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+        return paths;
+    }
+
+    void GridVolume::setGridSequenceStream(GridSlot slot, const ref<GridSequenceStream>& pStream)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        mGridStreams[slotIndex] = pStream;
+        mGrids[slotIndex] = pStream ? GridSequence(pStream->getFrameCount()) : GridSequence{};
+        updateSequence();
+        updateStreams();
+        updateBounds();
+        markUpdates(UpdateFlags::GridsChanged);
+    }
+
+    const ref<GridSequenceStream>& GridVolume::getGridSequenceStream(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        return mGridStreams[slotIndex];
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -180,8 +235,9 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mGridStreams[slotIndex])
         {
+            mGridStreams[slotIndex] = nullptr;
             mGrids[slotIndex] = grids;
             updateSequence();
             updateBounds();
@@ -228,7 +284,12 @@ namespace Falcor
     {
         if (mGridFrame != gridFrame)
         {
+            // Track the playback direction (shortest distance on the looping sequence) for prefetching streamed grids.
+            uint32_t forward = (gridFrame + mGridFrameCount - mGridFrame % mGridFrameCount) % mGridFrameCount;
+            mPlaybackDirection = forward <= mGridFrameCount - forward ? 1 : -1;
+
             mGridFrame = gridFrame;
+            updateStreams();
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -325,6 +386,21 @@ namespace Falcor
         }
     }
 
+    void GridVolume::updateStreams()
+    {
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            const auto& pStream = mGridStreams[slotIndex];
+            if (!pStream) continue;
+
+            // Only reference the grid of the current frame, other frames are owned (and evicted) by the stream.
+            auto& grids = mGrids[slotIndex];
+            std::fill(grids.begin(), grids.end(), nullptr);
+            uint32_t frame = std::min(mGridFrame, (uint32_t)grids.size() - 1);
+            grids[frame] = pStream->getGrid(frame, mPlaybackDirection);
+        }
+    }
+
     void GridVolume::updateSequence()
     {
         mGridFrameCount = 1;
@@ -421,6 +497,21 @@ namespace Falcor
             { return self.loadGridSequence(slot, getActiveAssetResolver().resolvePath(path), gridname, keepEmpty); },
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true
         ); // PYTHONDEPRECATED
+        volume.def("loadGridSequenceStream",
+            [](GridVolume& self, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t windowSize, uint32_t prefetchCount, uint64_t memoryBudget)
+            {
+                std::vector<std::filesystem::path> resolvedPaths;
+                for (const auto& path : paths)
+                    resolvedPaths.push_back(getActiveAssetResolver().resolvePath(path));
+                return self.loadGridSequenceStream(slot, resolvedPaths, gridname, {windowSize, prefetchCount, memoryBudget});
+            },
+            "slot"_a, "paths"_a, "gridname"_a, "windowSize"_a = 8, "prefetchCount"_a = 2, "memoryBudget"_a = 0
+        );
+        volume.def("loadGridSequenceStream",
+            [](GridVolume& self, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t windowSize, uint32_t prefetchCount, uint64_t memoryBudget)
+            { return self.loadGridSequenceStream(slot, getActiveAssetResolver().resolvePath(path), gridname, {windowSize, prefetchCount, memoryBudget}); },
+            "slot"_a, "path"_a, "gridname"_a, "windowSize"_a = 8, "prefetchCount"_a = 2, "memoryBudget"_a = 0
+        );
 
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStream.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -36,6 +37,7 @@
 #include <array>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -146,6 +148,37 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Load a sequence of grids from files to a grid slot, streaming frames from disk during playback.
+            Only a bounded window of frames is kept in memory, see GridSequenceStream.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t loadGridSequenceStream(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridSequenceStream::Options& options = GridSequenceStream::Options());
+
+        /** Load a sequence of grids from a directory to a grid slot, streaming frames from disk during playback.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the sequence.
+        */
+        uint32_t loadGridSequenceStream(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridSequenceStream::Options& options = GridSequenceStream::Options());
+
+        /** Set a streamed grid sequence for the specified slot.
+            The grid sequence of the slot only holds the grid of the current frame, other frames are streamed on demand.
+            Note: This will replace any existing grid sequence for that slot.
+        */
+        void setGridSequenceStream(GridSlot slot, const ref<GridSequenceStream>& pStream);
+
+        /** Get the grid sequence stream for the specified slot (nullptr if the slot is not streamed).
+        */
+        const ref<GridSequenceStream>& getGridSequenceStream(GridSlot slot) const;
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
@@ -283,6 +316,9 @@ namespace Falcor
         void updateFromAnimation(const float4x4& transform) override;
 
     private:
+        static std::optional<std::vector<std::filesystem::path>> enumerateGridFiles(const std::filesystem::path& path);
+
+        void updateStreams();
         void updateSequence();
         void updateBounds();
 
@@ -292,7 +328,9 @@ namespace Falcor
         ref<Device> mpDevice;
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<ref<GridSequenceStream>, (size_t)GridSlot::Count> mGridStreams;
         uint32_t mGridFrame = 0;
+        int mPlaybackDirection = 1;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
         uint32_t mStartFrame = 0;
@@ -28,6 +28,7 @@
 #include "BufferAllocator.h"
 #include "Core/API/Device.h"
 #include "Utils/Math/Common.h"
+#include <fstd/bit.h>
 
 namespace Falcor
 {
@@ -73,7 +74,7 @@ void BufferAllocator::modified(size_t byteOffset, size_t byteSize)
 void BufferAllocator::clear()
 {
     mBuffer.clear();
-    mDirty = {};
+    mDirtyPages.clear();
 }
 
 ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
@@ -104,24 +105,108 @@ ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
             mpGpuBuffer = pDevice->createBuffer(bufSize, mBindFlags, MemoryType::DeviceLocal, nullptr);
         }
 
-        mDirty = Range(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+        markAsDirty(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
     }
 
     // If any range is dirty, upload the data from the CPU to the GPU.
-    if (mDirty.start < mDirty.end)
+    std::vector<Range> ranges = getDirtyRanges();
+    if (!ranges.empty())
     {
-        size_t byteSize = mDirty.end - mDirty.start;
-        size_t byteOffset = mDirty.start;
-        FALCOR_ASSERT(byteOffset + byteSize <= mBuffer.size());
         FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
-        mpGpuBuffer->setBlob(mBuffer.data() + byteOffset, byteOffset, byteSize);
+        for (const Range& range : ranges)
+        {
+            FALCOR_ASSERT(range.start < range.end && range.end <= mBuffer.size());
+            mpGpuBuffer->setBlob(mBuffer.data() + range.start, range.start, range.end - range.start);
+            mUploadStats.uploadedBytes += range.end - range.start;
+        }
+        mUploadStats.uploadCount++;
+        mUploadStats.rangeCount += ranges.size();
+        if (ranges.size() == 1 && ranges[0].start == 0 && ranges[0].end == mBuffer.size())
+            mUploadStats.fullUploadCount++;
 
-        mDirty = {mBuffer.size(), 0}; // Reset dirty range to inverted range. Any min/max operation on it will work.
+        std::fill(mDirtyPages.begin(), mDirtyPages.end(), 0);
     }
 
     return mpGpuBuffer;
 }
 
+void BufferAllocator::setUploadOptions(const UploadOptions& options)
+{
+    FALCOR_CHECK(options.pageSize > 0 && isPowerOf2(options.pageSize), "Page size must be a power of two.");
+    FALCOR_CHECK(options.fullUploadRatio >= 0.f, "Full upload ratio must be non-negative.");
+
+    // Re-mark the dirty memory at the new page granularity.
+    std::vector<Range> dirtyRanges = getDirtyRanges();
+    mUploadOptions = options;
+    mDirtyPages.clear();
+    for (const Range& range : dirtyRanges)
+        markAsDirty(range);
+}
+
+std::vector<BufferAllocator::Range> BufferAllocator::getDirtyRanges() const
+{
+    std::vector<Range> ranges;
+    const size_t pageSize = mUploadOptions.pageSize;
+    const size_t pageCount = div_round_up(mBuffer.size(), pageSize);
+    const size_t wordCount = std::min(mDirtyPages.size(), div_round_up(pageCount, (size_t)64));
+
+    // Find runs of dirty pages and merge runs that are close to each other.
+    size_t dirtyBytes = 0;
+    size_t page = 0;
+    while (page < pageCount)
+    {
+        // Skip to the next dirty page.
+        size_t word = page / 64;
+        if (word >= wordCount)
+            break;
+        uint64_t bits = mDirtyPages[word] & (~0ull << (page % 64));
+        if (bits == 0)
+        {
+            page = (word + 1) * 64;
+            continue;
+        }
+        const size_t first = word * 64 + fstd::countr_zero(bits);
+        if (first >= pageCount)
+            break;
+
+        // Find the end of the run.
+        size_t last = first + 1;
+        while (last < pageCount)
+        {
+            word = last / 64;
+            if (word >= wordCount)
+                break;
+            uint64_t clean = ~mDirtyPages[word] & (~0ull << (last % 64));
+            if (clean != 0)
+            {
+                last = word * 64 + fstd::countr_zero(clean);
+                break;
+            }
+            last = (word + 1) * 64;
+        }
+        last = std::min(last, pageCount);
+        page = last;
+
+        Range range(first * pageSize, std::min(last * pageSize, mBuffer.size()));
+        if (!ranges.empty() && range.start - ranges.back().end <= mUploadOptions.mergeDistance)
+        {
+            dirtyBytes += range.end - ranges.back().end;
+            ranges.back().end = range.end;
+        }
+        else
+        {
+            dirtyBytes += range.end - range.start;
+            ranges.push_back(range);
+        }
+    }
+
+    // Upload the entire buffer if most of it is dirty.
+    if (ranges.size() > 1 && (double)dirtyBytes > (double)mUploadOptions.fullUploadRatio * (double)mBuffer.size())
+        ranges = {Range(0, mBuffer.size())};
+
+    return ranges;
+}
+
 // Private
 
 void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
@@ -163,7 +248,19 @@ size_t BufferAllocator::allocInternal(size_t byteSize)
 void BufferAllocator::markAsDirty(const Range& range)
 {
     FALCOR_ASSERT(range.start < range.end);
-    mDirty.start = std::min(mDirty.start, range.start);
-    mDirty.end = std::max(mDirty.end, range.end);
+    const size_t firstPage = range.start / mUploadOptions.pageSize;
+    const size_t lastPage = (range.end - 1) / mUploadOptions.pageSize;
+    if (lastPage / 64 >= mDirtyPages.size())
+        mDirtyPages.resize(lastPage / 64 + 1, 0);
+
+    for (size_t word = firstPage / 64; word <= lastPage / 64; ++word)
+    {
+        uint64_t mask = ~0ull;
+        if (word == firstPage / 64)
+            mask &= ~0ull << (firstPage % 64);
+        if (word == lastPage / 64)
+            mask &= ~0ull >> (63 - lastPage % 64);
+        mDirtyPages[word] |= mask;
+    }
 }
 } // namespace Falcor
@@ -53,6 +53,36 @@ namespace Falcor
 class FALCOR_API BufferAllocator
 {
 public:
+    /// Byte range [start, end).
+    struct Range
+    {
+        size_t start = 0;
+        size_t end = 0;
+        Range(){};
+        Range(size_t s, size_t e) : start(s), end(e) {}
+        bool operator==(const Range& other) const { return start == other.start && end == other.end; }
+    };
+
+    /// Options controlling how modified memory is uploaded to the GPU buffer.
+    struct UploadOptions
+    {
+        /// Granularity of dirty tracking in bytes. Must be a power of two.
+        size_t pageSize = 4096;
+        /// Dirty ranges separated by at most this many bytes are merged into a single upload.
+        size_t mergeDistance = 16384;
+        /// If the merged dirty ranges exceed this fraction of the buffer size, the entire buffer is uploaded instead.
+        float fullUploadRatio = 0.5f;
+    };
+
+    /// Upload statistics accumulated over calls to getGPUBuffer().
+    struct UploadStats
+    {
+        uint64_t uploadCount = 0;     ///< Number of getGPUBuffer() calls that uploaded data.
+        uint64_t fullUploadCount = 0; ///< Number of uploads of the entire buffer.
+        uint64_t rangeCount = 0;      ///< Number of uploaded ranges.
+        uint64_t uploadedBytes = 0;   ///< Number of uploaded bytes.
+    };
+
     /**
      * Create a buffer allocator.
      * @param[in] alignment Minimum alignment in bytes for any allocation.
@@ -197,18 +227,38 @@ public:
      */
     ref<Buffer> getGPUBuffer(ref<Device> pDevice);
 
+    /**
+     * Set the options for uploading modified memory. Memory that is currently dirty stays dirty.
+     * @param[in] options Upload options.
+     */
+    void setUploadOptions(const UploadOptions& options);
+
+    /**
+     * Get the options for uploading modified memory.
+     */
+    const UploadOptions& getUploadOptions() const { return mUploadOptions; }
+
+    /**
+     * Get the byte ranges that the next call to getGPUBuffer() uploads, unless the GPU buffer needs to be reallocated.
+     * Dirty pages are merged into ranges according to the upload options. The ranges are sorted and disjoint.
+     * @return List of byte ranges.
+     */
+    std::vector<Range> getDirtyRanges() const;
+
+    /**
+     * Get the upload statistics.
+     */
+    const UploadStats& getUploadStats() const { return mUploadStats; }
+
+    /**
+     * Reset the upload statistics.
+     */
+    void resetUploadStats() { mUploadStats = {}; }
+
 private:
     void computeAndAllocatePadding(size_t byteSize);
     size_t allocInternal(size_t byteSize);
 
-    struct Range
-    {
-        size_t start = 0;
-        size_t end = 0;
-        Range(){};
-        Range(size_t s, size_t e) : start(s), end(e) {}
-    };
-
     void markAsDirty(const Range& range);
     void markAsDirty(size_t byteOffset, size_t byteSize) { markAsDirty(Range(byteOffset, byteOffset + byteSize)); }
 
@@ -224,9 +274,13 @@ private:
     /// Bind flags for the GPU buffer.
     const ResourceBindFlags mBindFlags;
 
-    /// Range of buffer that is dirty and needs to be updatd on the GPU. We track a single dirty range for now to minimize the number of
-    /// uploads, but this could be changed.
-    Range mDirty;
+    /// Options for uploading modified memory.
+    UploadOptions mUploadOptions;
+
+    /// Bitmap of pages that are dirty and need to be updated on the GPU. Each bit represents mUploadOptions.pageSize bytes.
+    std::vector<uint64_t> mDirtyPages;
+
+    UploadStats mUploadStats;
 
     std::vector<uint8_t> mBuffer; ///< CPU buffer holding a copy of the data.
     ref<Buffer> mpGpuBuffer;      ///< GPU buffer holding the data.
@@ -26,8 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "TextureCache.h"
 #include "Core/API/Device.h"
 #include "Utils/Threading.h"
+#include "Utils/Timing/Profiler.h"
 
 namespace Falcor
 {
@@ -77,6 +79,12 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     return mLoadRequestQueue.back().promise.get_future();
 }
 
+void AsyncTextureLoader::setTextureCache(std::shared_ptr<TextureCache> pTextureCache)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mpTextureCache = pTextureCache;
+}
+
 void AsyncTextureLoader::runWorkers(size_t threadCount)
 {
     // Create a barrier to synchronize worker threads before issuing a global flush.
@@ -129,6 +137,7 @@ void AsyncTextureLoader::runWorker()
         // Pop next load request from queue.
         auto request = std::move(mLoadRequestQueue.front());
         mLoadRequestQueue.pop();
+        auto pTextureCache = mpTextureCache;
 
         lock.unlock();
 
@@ -136,12 +145,23 @@ void AsyncTextureLoader::runWorker()
         ref<Texture> pTexture;
         if (request.paths.size() == 1)
         {
-            pTexture = Texture::createFromFile(
-                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
-            );
+            FALCOR_PROFILE_CPU("AsyncTextureLoader::loadFromFile");
+            if (pTextureCache)
+            {
+                pTexture = pTextureCache->loadTexture(
+                    mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
+                );
+            }
+            if (!pTexture)
+            {
+                pTexture = Texture::createFromFile(
+                    mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
+                );
+            }
         }
         else
         {
+            FALCOR_PROFILE_CPU("AsyncTextureLoader::loadMippedFromFiles");
             pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
         }
 
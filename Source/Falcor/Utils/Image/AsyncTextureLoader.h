@@ -43,6 +43,7 @@
 namespace Falcor
 {
 class Barrier;
+class TextureCache;
 
 /**
  * Utility class to load textures asynchronously using multiple worker threads.
@@ -100,6 +101,12 @@ public:
         LoadCallback callback = {}
     );
 
+    /**
+     * Set a cache of preprocessed textures used for loading single-file textures.
+     * @param[in] pTextureCache Texture cache, or nullptr to load all textures directly.
+     */
+    void setTextureCache(std::shared_ptr<TextureCache> pTextureCache);
+
 private:
     void runWorkers(size_t threadCount);
     void runWorker();
@@ -124,7 +131,8 @@ private:
     std::vector<std::thread> mThreads;      ///< Worker threads.
 
     // Internal state. Do not access outside of critical section.
-    std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::queue<LoadRequest> mLoadRequestQueue;     ///< Texture loading request queue.
+    std::shared_ptr<TextureCache> mpTextureCache; ///< Cache of preprocessed textures, or nullptr if disabled.
 
     bool mTerminate = false;     ///< Flag to terminate worker threads.
     bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
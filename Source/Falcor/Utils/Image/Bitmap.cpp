@@ -30,7 +30,7 @@
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Math/ScalarMath.h"
-#include "Utils/Math/Float16.h"
+#include "Utils/Math/FormatConversion.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 
@@ -114,44 +114,36 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
 }
 
 /**
- * Converts half float image to RGBA float image.
+ * Converts an image with 1-4 channels to RGBA float image.
+ * The source values are converted to float using the given conversion function, processing the image in
+ * chunks of pixels when it needs to be expanded to RGBA. Missing channels are set to zero and alpha to one.
  */
-static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
+template<typename SrcT, typename ConvertFunc>
+static std::vector<float> convertToRGBA32Float(
+    uint32_t width,
+    uint32_t height,
+    uint32_t channelCount,
+    const void* pData,
+    ConvertFunc convert
+)
 {
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
+    const size_t pixelCount = size_t(width) * height;
+    std::vector<float> newData(pixelCount * 4u);
+    const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
 
-    for (uint32_t i = 0; i < width * height; ++i)
+    if (channelCount == 4)
     {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++);
-        }
-        pDst += (4 - channelCount);
+        convert(pSrc, newData.data(), pixelCount * 4);
+        return newData;
     }
 
-    return newData;
-}
-
-/**
- * Converts integer image to RGBA float image.
- * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
- */
-template<typename SrcT>
-static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-{
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
+    constexpr size_t kChunkSize = 1024;
+    float temp[kChunkSize * 4];
+    for (size_t i = 0; i < pixelCount; i += kChunkSize)
     {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
-        }
-        pDst += (4 - channelCount);
+        const size_t count = std::min(kChunkSize, pixelCount - i);
+        convert(pSrc + i * channelCount, temp, count * channelCount);
+        expandToRGBA32Float(temp, channelCount, newData.data() + i * 4, count);
     }
 
     return newData;
@@ -159,6 +151,7 @@ static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t heigh
 
 /**
  * Converts an image of the given format to an RGBA float image.
+ * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
  */
 static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
 {
@@ -168,41 +161,20 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
     uint32_t channelCount = getFormatChannelCount(format);
     uint32_t channelBits = getNumChannelBits(format, 0);
 
-    std::vector<float> floatData;
+    auto convertInt = [](const auto* pSrc, float* pDst, size_t count) { convertIntToNormalizedFloat32(pSrc, pDst, count); };
 
     if (type == FormatType::Float && channelBits == 16)
-    {
-        floatData = convertHalfToRGBA32Float(width, height, channelCount, pData);
-    }
+        return convertToRGBA32Float<uint16_t>(width, height, channelCount, pData, convertFloat16ToFloat32);
     else if (type == FormatType::Uint && channelBits == 16)
-    {
-        floatData = convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData);
-    }
+        return convertToRGBA32Float<uint16_t>(width, height, channelCount, pData, convertInt);
     else if (type == FormatType::Uint && channelBits == 32)
-    {
-        floatData = convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData);
-    }
+        return convertToRGBA32Float<uint32_t>(width, height, channelCount, pData, convertInt);
     else if (type == FormatType::Sint && channelBits == 16)
-    {
-        floatData = convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData);
-    }
+        return convertToRGBA32Float<int16_t>(width, height, channelCount, pData, convertInt);
     else if (type == FormatType::Sint && channelBits == 32)
-    {
-        floatData = convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData);
-    }
+        return convertToRGBA32Float<int32_t>(width, height, channelCount, pData, convertInt);
     else
-    {
         FALCOR_UNREACHABLE();
-    }
-
-    // Default alpha channel to 1.
-    if (channelCount < 4)
-    {
-        for (uint32_t i = 0; i < width * height; ++i)
-            floatData[i * 4 + 3] = 1.f;
-    }
-
-    return floatData;
 }
 
 /**
@@ -225,17 +197,8 @@ static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
 
     for (unsigned y = 0; y < height; y++)
     {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
-
-        for (unsigned x = 0; x < width; x++)
-        {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
-        }
+        // Convert pixels directly, while adding a "dummy" alpha of 1.0
+        expandToRGBA32Float((const float*)src_bits, 3, (float*)dst_bits, width);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -265,19 +228,17 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
+    // Convert pixels to float16 directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
+    std::vector<float> row(type == FIT_RGBF ? width * 4 : 0);
     for (uint32_t y = 0; y < height; y++)
     {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
-
-        for (uint32_t x = 0; x < width; x++)
+        const float* src_pixel = (const float*)src_bits;
+        if (type == FIT_RGBF)
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            expandToRGBA32Float(src_pixel, 3, row.data(), width);
+            src_pixel = row.data();
         }
+        convertFloat32ToFloat16(src_pixel, (uint16_t*)dst_bits, size_t(width) * 4);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -412,15 +373,8 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         return nullptr;
     }
 
-    // Convert the image to RGBX image
-    if (bpp == 24)
-    {
-        bpp = 32;
-        auto pNew = FreeImage_ConvertTo32Bits(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-    else if ((bpp == 96 || bpp == 128) && is_set(importFlags, ImportFlags::ConvertToFloat16))
+    // 24bpp images are expanded to BGRX directly into the bitmap below.
+    if ((bpp == 96 || bpp == 128) && is_set(importFlags, ImportFlags::ConvertToFloat16))
     {
         bpp = 64;
         format = ResourceFormat::RGBA16Float;
@@ -441,9 +395,21 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         isTopDown = !isTopDown;
 
     UniqueConstPtr pBmp = UniqueConstPtr(new Bitmap(width, height, format));
-    FreeImage_ConvertToRawBits(
-        pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
-    );
+    if (bpp == 24)
+    {
+        // Expand the BGR scanlines to BGRX with an opaque alpha channel.
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const BYTE* pSrc = FreeImage_GetScanLine(pDib, isTopDown ? height - y - 1 : y);
+            expandRGB8ToRGBA8(pSrc, pBmp->getData() + size_t(y) * pBmp->getRowPitch(), width, 0xff);
+        }
+    }
+    else
+    {
+        FreeImage_ConvertToRawBits(
+            pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
+        );
+    }
     FreeImage_Unload(pDib);
     return pBmp;
 }
@@ -611,21 +577,12 @@ void Bitmap::saveImage(
     uint32_t bytesPerPixel = getFormatBytesPerBlock(resourceFormat);
 
     // Convert 8-bit RGBA to BGRA byte order.
-    // TODO: Replace this code for swapping channels. Can't use FreeImage masks b/c they only care about 16 bpp images.
+    // Can't use FreeImage masks b/c they only care about 16 bpp images.
     if (resourceFormat == ResourceFormat::RGBA8Unorm || resourceFormat == ResourceFormat::RGBA8Snorm ||
         resourceFormat == ResourceFormat::RGBA8UnormSrgb)
     {
-        for (uint32_t a = 0; a < width * height; a++)
-        {
-            uint32_t* pPixel = (uint32_t*)pData;
-            pPixel += a;
-            uint8_t* ch = (uint8_t*)pPixel;
-            std::swap(ch[0], ch[2]);
-            if (is_set(exportFlags, ExportFlags::ExportAlpha) == false)
-            {
-                ch[3] = 0xff;
-            }
-        }
+        const bool forceOpaque = !is_set(exportFlags, ExportFlags::ExportAlpha);
+        swizzleRGBA8ToBGRA8((uint8_t*)pData, (uint8_t*)pData, size_t(width) * height, forceOpaque);
     }
 
     if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -669,12 +626,7 @@ void Bitmap::saveImage(
             else
             {
                 FALCOR_ASSERT(exportAlpha == false);
-                for (unsigned x = 0; x < width; x++)
-                {
-                    dstBits[x * 3 + 0] = (((float*)head)[x * 4 + 0]);
-                    dstBits[x * 3 + 1] = (((float*)head)[x * 4 + 1]);
-                    dstBits[x * 3 + 2] = (((float*)head)[x * 4 + 2]);
-                }
+                convertRGBA32FloatToRGB32Float((const float*)head, dstBits, width);
             }
             head += bytesPerPixel * width;
         }
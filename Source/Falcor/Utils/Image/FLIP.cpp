@@ -0,0 +1,1055 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FLIP.h"
+#include "Core/Error.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Vector.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLIP_SSE2 1
+#endif
+
+namespace Falcor
+{
+namespace
+{
+// FLIP constants, see FLIPPass.cs.slang.
+const float kQc = 0.7f;
+const float kPc = 0.4f;
+const float kPt = 0.95f;
+const float kW = 0.082f;
+const float kQf = 0.5f;
+
+const float kPi = 3.14159265358979323846f;
+const float kSqrt1_2 = 0.707106781186547524401f;
+
+/// Smallest luminance used for computing the exposure range. Avoids infinite ranges for black images.
+const float kMinExposureLuminance = 1e-6f;
+
+/// Horizontally filtered planes stored per image and row.
+enum Plane
+{
+    kPlaneY,   ///< Y filtered with the achromatic CSF.
+    kPlaneCx,  ///< Cx filtered with the red-green CSF.
+    kPlaneCz1, ///< Cz filtered with the first blue-yellow CSF Gaussian.
+    kPlaneCz2, ///< Cz filtered with the second blue-yellow CSF Gaussian.
+    kPlaneG,   ///< Luminance filtered with the feature Gaussian.
+    kPlaneP,   ///< Luminance filtered with the point detector.
+    kPlaneE,   ///< Luminance filtered with the edge detector.
+    kPlaneCount
+};
+
+/// Vertically filtered values stored per image for the current row.
+enum Output
+{
+    kOutputY,
+    kOutputCx,
+    kOutputCz1,
+    kOutputCz2,
+    kOutputEdgeX,
+    kOutputPointX,
+    kOutputPointY,
+    kOutputEdgeY,
+    kOutputCount
+};
+
+/**
+ * 1D filter kernels of the given radius.
+ * All FLIP filters are separable: the 2D weights of FLIPPass.cs.slang are products of a horizontal and a vertical kernel.
+ * The kernels are either even (w(-j) = w(j)) or odd (w(-j) = -w(j)), so only the weights w(0), ..., w(radius) are stored.
+ * Amplitudes and normalization factors are folded into the horizontal kernels.
+ */
+struct Kernels
+{
+    int radius = 0;
+    std::vector<float> horizontal[kPlaneCount];
+    std::vector<float> gaussianA;   ///< Vertical achromatic CSF.
+    std::vector<float> gaussianRG;  ///< Vertical red-green CSF.
+    std::vector<float> gaussianBY1; ///< Vertical blue-yellow CSF (first Gaussian).
+    std::vector<float> gaussianBY2; ///< Vertical blue-yellow CSF (second Gaussian).
+    std::vector<float> feature;     ///< Feature Gaussian.
+    std::vector<float> point;       ///< Normalized point detector.
+    std::vector<float> edge;        ///< Normalized edge detector (odd).
+};
+
+Kernels createKernels(float pixelsPerDegree)
+{
+    Kernels k;
+
+    // Use radius of the spatial filter kernel, as it is always greater than or equal to the radius of the feature detection kernel.
+    // See FLIP paper for explanation of the 0.04 and 3.0 factors.
+    k.radius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * kPi * kPi)) * pixelsPerDegree));
+    const float dx = 1.f / pixelsPerDegree;
+
+    // Sum of an even kernel over [-radius, radius].
+    auto sum = [](const std::vector<float>& w)
+    {
+        float s = w[0];
+        for (size_t j = 1; j < w.size(); ++j)
+            s += 2.f * w[j];
+        return s;
+    };
+
+    // CSF Gaussians. 2D weight is a * sqrt(pi / b) * exp(-pi^2 * (x^2 + y^2) / b).
+    auto csf = [&](float b)
+    {
+        std::vector<float> w(k.radius + 1);
+        for (int j = 0; j <= k.radius; ++j)
+        {
+            float p = j * dx;
+            w[j] = std::exp(-(p * p) * kPi * kPi / b);
+        }
+        return w;
+    };
+
+    // a1, b1 for A and RG, and a1, a2, b1, b2 for BY.
+    const float aA = 1.f, bA = 0.0047f;
+    const float aRG = 1.f, bRG = 0.0053f;
+    const float aBY1 = 34.1f, aBY2 = 13.5f, bBY1 = 0.04f, bBY2 = 0.025f;
+
+    k.gaussianA = csf(bA);
+    k.gaussianRG = csf(bRG);
+    k.gaussianBY1 = csf(bBY1);
+    k.gaussianBY2 = csf(bBY2);
+
+    const float scaleA = aA * std::sqrt(kPi / bA);
+    const float scaleRG = aRG * std::sqrt(kPi / bRG);
+    const float scaleBY1 = aBY1 * std::sqrt(kPi / bBY1);
+    const float scaleBY2 = aBY2 * std::sqrt(kPi / bBY2);
+
+    // The filtered colors are normalized by the sum of the 2D kernel.
+    const float sumA = scaleA * sum(k.gaussianA) * sum(k.gaussianA);
+    const float sumRG = scaleRG * sum(k.gaussianRG) * sum(k.gaussianRG);
+    const float sumBY = scaleBY1 * sum(k.gaussianBY1) * sum(k.gaussianBY1) + scaleBY2 * sum(k.gaussianBY2) * sum(k.gaussianBY2);
+
+    // Feature detection. The 2D Gaussian is g(x) * g(y), the point detector (x^2 / sigma^2 - 1) * g(x) * g(y)
+    // and the edge detector -x * g(x) * g(y). The normalization of the point detector depends on the sign of the weight,
+    // the edge detector is normalized by the sum of its positive weights.
+    const float sigmaFeatures = 0.5f * kW * pixelsPerDegree;
+    const float sigmaFeaturesSquared = sigmaFeatures * sigmaFeatures;
+    k.feature.resize(k.radius + 1);
+    std::vector<float> pointWeights(k.radius + 1);
+    float positiveSum = 0.f;
+    float negativeSum = 0.f;
+    float edgeSum = 0.f;
+    for (int j = 0; j <= k.radius; ++j)
+    {
+        float x = float(j);
+        k.feature[j] = std::exp(-(x * x) / (2.f * sigmaFeaturesSquared));
+        pointWeights[j] = (x * x / sigmaFeaturesSquared - 1.f) * k.feature[j];
+        float count = j == 0 ? 1.f : 2.f;
+        positiveSum += count * std::max(pointWeights[j], 0.f);
+        negativeSum += count * std::max(-pointWeights[j], 0.f);
+        edgeSum += x * k.feature[j];
+    }
+    const float featureSum = sum(k.feature);
+    positiveSum *= featureSum;
+    negativeSum *= featureSum;
+    edgeSum *= featureSum;
+
+    k.point.resize(k.radius + 1);
+    k.edge.resize(k.radius + 1);
+    for (int j = 0; j <= k.radius; ++j)
+    {
+        k.point[j] = pointWeights[j] / (pointWeights[j] >= 0.f ? positiveSum : negativeSum);
+        k.edge[j] = -float(j) * k.feature[j] / edgeSum;
+    }
+
+    auto scaled = [](const std::vector<float>& w, float scale)
+    {
+        std::vector<float> result(w);
+        for (float& v : result)
+            v *= scale;
+        return result;
+    };
+    k.horizontal[kPlaneY] = scaled(k.gaussianA, scaleA / sumA);
+    k.horizontal[kPlaneCx] = scaled(k.gaussianRG, scaleRG / sumRG);
+    k.horizontal[kPlaneCz1] = scaled(k.gaussianBY1, scaleBY1 / sumBY);
+    k.horizontal[kPlaneCz2] = scaled(k.gaussianBY2, scaleBY2 / sumBY);
+    k.horizontal[kPlaneG] = k.feature;
+    k.horizontal[kPlaneP] = k.point;
+    k.horizontal[kPlaneE] = k.edge;
+
+    return k;
+}
+
+/// Tone mappers of HDR-FLIP, see ToneMappers.slang in FLIPPass.
+float3 toneMap(float3 color, FLIP::ToneMapper toneMapper)
+{
+    float k0, k1, k2, k3, k4, k5;
+    if (toneMapper == FLIP::ToneMapper::ACES)
+    {
+        // Source: ACES approximation: https://knarkowicz.wordpress.com/2016/01/06/aces-filmic-tone-mapping-curve/
+        // Include pre-exposure cancelation in constants.
+        k0 = 0.6f * 0.6f * 2.51f;
+        k1 = 0.6f * 0.03f;
+        k2 = 0.f;
+        k3 = 0.6f * 0.6f * 2.43f;
+        k4 = 0.6f * 0.59f;
+        k5 = 0.14f;
+    }
+    else if (toneMapper == FLIP::ToneMapper::Hable)
+    {
+        // Source: https://64.github.io/tonemapping/
+        const float A = 0.15f;
+        const float B = 0.50f;
+        const float C = 0.10f;
+        const float D = 0.20f;
+        const float E = 0.02f;
+        const float F = 0.30f;
+        k0 = A * F - A * E;
+        k1 = C * B * F - B * E;
+        k2 = 0.f;
+        k3 = A * F;
+        k4 = B * F;
+        k5 = D * F * F;
+
+        const float W = 11.2f;
+        const float nom = k0 * W * W + k1 * W + k2;
+        const float denom = k3 * W * W + k4 * W + k5;
+        const float whiteScale = denom / nom;
+
+        // Include white scale and exposure bias in rational polynomial coefficients.
+        k0 = 4.f * k0 * whiteScale;
+        k1 = 2.f * k1 * whiteScale;
+        k2 = k2 * whiteScale;
+        k3 = 4.f * k3;
+        k4 = 2.f * k4;
+    }
+    else
+    {
+        float Y = luminance(color);
+        return float3(
+            std::clamp(color.x / (Y + 1.f), 0.f, 1.f), std::clamp(color.y / (Y + 1.f), 0.f, 1.f), std::clamp(color.z / (Y + 1.f), 0.f, 1.f)
+        );
+    }
+
+    float3 result;
+    for (int i = 0; i < 3; ++i)
+    {
+        float c = color[i];
+        float nom = k0 * c * c + k1 * c + k2;
+        float denom = k3 * c * c + k4 * c + k5;
+        if (std::isinf(denom))
+            denom = 1.f; // Avoid inf / inf division.
+        result[i] = std::clamp(nom / denom, 0.f, 1.f);
+    }
+    return result;
+}
+
+/// Tone mapper coefficients used for computing the exposure range, see FLIPPass::computeExposureParameters().
+void getToneMapperCoefficients(FLIP::ToneMapper toneMapper, float coefficients[6])
+{
+    static const float kReinhard[6] = {0.f, 1.f, 0.f, 0.f, 1.f, 1.f};
+    // 0.6 is pre-exposure cancellation.
+    static const float kACES[6] = {0.6f * 0.6f * 2.51f, 0.6f * 0.03f, 0.f, 0.6f * 0.6f * 2.43f, 0.6f * 0.59f, 0.14f};
+    static const float kHable[6] = {0.231683f, 0.013791f, 0.f, 0.18f, 0.3f, 0.018f};
+
+    const float* src = nullptr;
+    switch (toneMapper)
+    {
+    case FLIP::ToneMapper::ACES:
+        src = kACES;
+        break;
+    case FLIP::ToneMapper::Hable:
+        src = kHable;
+        break;
+    case FLIP::ToneMapper::Reinhard:
+        src = kReinhard;
+        break;
+    default:
+        FALCOR_THROW("Invalid FLIP tone mapper.");
+    }
+    std::copy(src, src + 6, coefficients);
+}
+
+float3 huntAdjust(float3 lab)
+{
+    float huntValue = 0.01f * lab.x;
+    return float3(lab.x, huntValue * lab.y, huntValue * lab.z);
+}
+
+float hyAB(float3 a, float3 b)
+{
+    float3 diff = a - b;
+    return std::abs(diff.x) + std::sqrt(diff.y * diff.y + diff.z * diff.z);
+}
+
+float getMaxDistance()
+{
+    static const float maxDistance = std::pow(
+        hyAB(huntAdjust(linearRGBToCIELab(float3(0.f, 1.f, 0.f))), huntAdjust(linearRGBToCIELab(float3(0.f, 0.f, 1.f)))), kQc
+    );
+    return maxDistance;
+}
+
+#if !FLIP_SSE2
+float redistributeErrors(float colorDifference, float featureDifference)
+{
+    const float maxDistance = getMaxDistance();
+    float error = std::pow(colorDifference, kQc);
+
+    // Normalization.
+    float perceptualCutoff = kPc * maxDistance;
+    if (error < perceptualCutoff)
+        error *= kPt / perceptualCutoff;
+    else
+        error = kPt + ((error - perceptualCutoff) / (maxDistance - perceptualCutoff)) * (1.f - kPt);
+
+    return std::pow(error, 1.f - featureDifference);
+}
+#endif
+
+float3 clampColor(float3 color)
+{
+    return float3(std::clamp(color.x, 0.f, 1.f), std::clamp(color.y, 0.f, 1.f), std::clamp(color.z, 0.f, 1.f));
+}
+
+#if FLIP_SSE2
+
+/// Linear color transforms of ColorHelpers.slang as row-major 3x3 matrices.
+struct ColorMatrices
+{
+    float xyzToRGB[9];
+    float rgbToXYZ[9];
+};
+
+const ColorMatrices& getColorMatrices()
+{
+    static const ColorMatrices matrices = []()
+    {
+        ColorMatrices m;
+        for (int j = 0; j < 3; ++j)
+        {
+            float3 e(0.f);
+            e[j] = 1.f;
+            float3 rgb = XYZToLinearRGB(e);
+            float3 xyz = linearRGBToXYZ(e);
+            for (int i = 0; i < 3; ++i)
+            {
+                m.xyzToRGB[i * 3 + j] = rgb[i];
+                m.rgbToXYZ[i * 3 + j] = xyz[i];
+            }
+        }
+        return m;
+    }();
+    return matrices;
+}
+
+// Vectorized math functions based on the Cephes single precision approximations.
+
+/// Natural logarithm of positive, finite values.
+__m128 logSSE(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+
+    // Split into exponent and mantissa in [0.5, 1).
+    __m128i exponentBits = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(126));
+    x = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x807fffff))), _mm_set1_ps(0.5f));
+    __m128 e = _mm_cvtepi32_ps(exponentBits);
+
+    // Map the mantissa to [sqrt(0.5), sqrt(2)) and subtract one.
+    __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+    __m128 tmp = _mm_and_ps(x, mask);
+    x = _mm_sub_ps(x, one);
+    e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+    x = _mm_add_ps(x, tmp);
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(7.0376836292e-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+    // log(2) is split into 0.693359375 - 2.12194440e-4 for accuracy.
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    x = _mm_add_ps(x, y);
+    return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+/// Exponential function. Returns zero for arguments below -88.37.
+__m128 expSSE(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+    x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+    // exp(x) = 2^n * exp(g) with n = floor(x / log(2) + 0.5).
+    __m128 n = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(n));
+    n = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, n), one));
+    x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), one);
+
+    __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+__m128 selectSSE(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/// Power function for x >= 0, with pow(0, 0) = 1.
+__m128 powSSE(__m128 x, __m128 y)
+{
+    const __m128 zero = _mm_setzero_ps();
+    __m128 result = expSSE(_mm_mul_ps(y, logSSE(x)));
+    __m128 zeroResult = _mm_and_ps(_mm_cmpeq_ps(y, zero), _mm_set1_ps(1.f));
+    return selectSSE(_mm_cmpgt_ps(x, zero), result, zeroResult);
+}
+
+__m128 absSSE(__m128 x)
+{
+    return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+#endif // FLIP_SSE2
+
+/// Source of a horizontal convolution. Tap j of pixel x is src[x + radius + j].
+struct RowSource
+{
+    const float* src;
+    uint32_t radius;
+    const float* get(int j, uint32_t x) const { return src + x + radius + j; }
+};
+
+/// Source of a vertical convolution. Tap j of pixel x is rows[radius + j][x].
+struct ColumnSource
+{
+    const float* const* rows;
+    uint32_t radius;
+    const float* get(int j, uint32_t x) const { return rows[radius + j] + x; }
+};
+
+/**
+ * Convolve a source with several kernels at once.
+ * The first kEven kernels are even and the remaining kOdd kernels odd. Each kernel is given by its weights
+ * w(0), ..., w(radius). Computes dst[i][x] = sum_{j=-radius}^{radius} w_i(j) * tap(j, x) for x in [0, count).
+ * The symmetry is used to halve the number of multiplications, and the taps are loaded once for all kernels.
+ * The SIMD and scalar paths perform the same operations in the same order, so the result does not depend on the path.
+ */
+template<uint32_t kEven, uint32_t kOdd, typename Source>
+void convolve(const Source& source, uint32_t radius, const float* const* weights, float* const* dst, uint32_t count)
+{
+    constexpr uint32_t kCount = kEven + kOdd;
+    uint32_t x = 0;
+#if FLIP_SSE2
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128 sum[kCount];
+        const __m128 center = _mm_loadu_ps(source.get(0, x));
+        for (uint32_t i = 0; i < kEven; ++i)
+            sum[i] = _mm_mul_ps(_mm_set1_ps(weights[i][0]), center);
+        for (uint32_t i = kEven; i < kCount; ++i)
+            sum[i] = _mm_setzero_ps();
+        for (uint32_t j = 1; j <= radius; ++j)
+        {
+            const __m128 a = _mm_loadu_ps(source.get(int(j), x));
+            const __m128 b = _mm_loadu_ps(source.get(-int(j), x));
+            const __m128 s = _mm_add_ps(a, b);
+            const __m128 d = _mm_sub_ps(a, b);
+            for (uint32_t i = 0; i < kEven; ++i)
+                sum[i] = _mm_add_ps(sum[i], _mm_mul_ps(_mm_set1_ps(weights[i][j]), s));
+            for (uint32_t i = kEven; i < kCount; ++i)
+                sum[i] = _mm_add_ps(sum[i], _mm_mul_ps(_mm_set1_ps(weights[i][j]), d));
+        }
+        for (uint32_t i = 0; i < kCount; ++i)
+            _mm_storeu_ps(dst[i] + x, sum[i]);
+    }
+#endif
+    for (; x < count; ++x)
+    {
+        float sum[kCount];
+        const float center = *source.get(0, x);
+        for (uint32_t i = 0; i < kEven; ++i)
+            sum[i] = weights[i][0] * center;
+        for (uint32_t i = kEven; i < kCount; ++i)
+            sum[i] = 0.f;
+        for (uint32_t j = 1; j <= radius; ++j)
+        {
+            const float a = *source.get(int(j), x);
+            const float b = *source.get(-int(j), x);
+            const float s = a + b;
+            const float d = a - b;
+            for (uint32_t i = 0; i < kEven; ++i)
+                sum[i] += weights[i][j] * s;
+            for (uint32_t i = kEven; i < kCount; ++i)
+                sum[i] += weights[i][j] * d;
+        }
+        for (uint32_t i = 0; i < kCount; ++i)
+            dst[i][x] = sum[i];
+    }
+}
+
+/// Per-exposure FLIP evaluation of a band of rows.
+class BandEvaluator
+{
+public:
+    BandEvaluator(
+        const Kernels& kernels,
+        const float* const images[2],
+        uint32_t width,
+        uint32_t height,
+        uint32_t channelCount,
+        const FLIP::Options& options
+    )
+        : mKernels(kernels)
+        , mWidth(width)
+        , mHeight(height)
+        , mChannelCount(channelCount)
+        , mOptions(options)
+        , mRadius(uint32_t(kernels.radius))
+        , mTapCount(2 * mRadius + 1)
+        , mPaddedWidth(width + 2 * mRadius)
+        , mOutputStride((width + 3) & ~3u)
+    {
+        mImages[0] = images[0];
+        mImages[1] = images[1];
+        mPadded.resize(4 * size_t(mPaddedWidth));
+        mRing.resize(size_t(mTapCount) * 2 * kPlaneCount * width);
+        mOutputs.resize(2 * kOutputCount * size_t(mOutputStride));
+        mRowPointers.resize(size_t(kPlaneCount) * mTapCount);
+    }
+
+    /**
+     * Evaluate LDR-FLIP at the given exposure for rows [y0, y1).
+     * @param[out] pErrors FLIP errors, (y1 - y0) * width values.
+     */
+    void evaluate(uint32_t y0, uint32_t y1, float exposure, float* pErrors)
+    {
+        const int radius = mKernels.radius;
+        const float exposureScale = std::exp2(exposure);
+
+        // Horizontally filtered rows are kept in a ring buffer indexed by source row.
+        // Rows in the window [y - radius, y + radius] clamped to the image never map to the same slot.
+        int nextRow = std::max(0, int(y0) - radius);
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            const int lastRow = std::min(int(mHeight) - 1, int(y) + radius);
+            for (; nextRow <= lastRow; ++nextRow)
+                filterRow(uint32_t(nextRow), exposureScale);
+
+            filterColumns(y);
+
+            evaluateRow(pErrors + size_t(y - y0) * mWidth);
+        }
+    }
+
+private:
+    float* getRingRow(uint32_t row, uint32_t image, uint32_t plane)
+    {
+        uint32_t slot = row % mTapCount;
+        return mRing.data() + ((size_t(slot) * 2 + image) * kPlaneCount + plane) * mWidth;
+    }
+
+    float* getOutput(uint32_t image, uint32_t output) { return mOutputs.data() + (size_t(image) * kOutputCount + output) * mOutputStride; }
+
+    /// Convert a source row to YCxCz and filter it horizontally.
+    void filterRow(uint32_t row, float exposureScale)
+    {
+        const int radius = mKernels.radius;
+        for (uint32_t image = 0; image < 2; ++image)
+        {
+            float* pY = mPadded.data();
+            float* pCx = pY + mPaddedWidth;
+            float* pCz = pCx + mPaddedWidth;
+            float* pL = pCz + mPaddedWidth;
+
+            const float* pSrc = mImages[image] + size_t(row) * mWidth * mChannelCount;
+            for (uint32_t x = 0; x < mWidth; ++x, pSrc += mChannelCount)
+            {
+                float3 color(pSrc[0], pSrc[1], pSrc[2]);
+                if (mOptions.isHDR)
+                {
+                    if (mOptions.clampInput)
+                        color = float3(std::max(color.x, 0.f), std::max(color.y, 0.f), std::max(color.z, 0.f));
+                    color = toneMap(exposureScale * color, mOptions.toneMapper);
+                }
+                else if (mOptions.clampInput)
+                {
+                    color = clampColor(color);
+                }
+                float3 ycxcz = linearRGBToYCxCz(color);
+                pY[radius + x] = ycxcz.x;
+                pCx[radius + x] = ycxcz.y;
+                pCz[radius + x] = ycxcz.z;
+                pL[radius + x] = (ycxcz.x + 16.f) / 116.f; // Normalized Y from YCxCz.
+            }
+
+            // Clamp to edge.
+            for (float* p : {pY, pCx, pCz, pL})
+            {
+                std::fill(p, p + radius, p[radius]);
+                std::fill(p + radius + mWidth, p + mPaddedWidth, p[radius + mWidth - 1]);
+            }
+
+            const RowSource sourceY{pY, mRadius};
+            const RowSource sourceCx{pCx, mRadius};
+            const RowSource sourceCz{pCz, mRadius};
+            const RowSource sourceL{pL, mRadius};
+            const auto& h = mKernels.horizontal;
+            convolveRow<1, 0>(sourceY, {h[kPlaneY].data()}, row, image, {kPlaneY});
+            convolveRow<1, 0>(sourceCx, {h[kPlaneCx].data()}, row, image, {kPlaneCx});
+            convolveRow<2, 0>(sourceCz, {h[kPlaneCz1].data(), h[kPlaneCz2].data()}, row, image, {kPlaneCz1, kPlaneCz2});
+            convolveRow<2, 1>(
+                sourceL, {h[kPlaneG].data(), h[kPlaneP].data(), h[kPlaneE].data()}, row, image, {kPlaneG, kPlaneP, kPlaneE}
+            );
+        }
+    }
+
+    template<uint32_t kEven, uint32_t kOdd>
+    void convolveRow(
+        const RowSource& source,
+        const std::array<const float*, kEven + kOdd>& weights,
+        uint32_t row,
+        uint32_t image,
+        const std::array<uint32_t, kEven + kOdd>& planes
+    )
+    {
+        std::array<float*, kEven + kOdd> dst;
+        for (size_t i = 0; i < planes.size(); ++i)
+            dst[i] = getRingRow(row, image, planes[i]);
+        convolve<kEven, kOdd>(source, mRadius, weights.data(), dst.data(), mWidth);
+    }
+
+    /// Filter the horizontally filtered rows around row y vertically.
+    void filterColumns(uint32_t y)
+    {
+        const int radius = int(mRadius);
+        for (uint32_t image = 0; image < 2; ++image)
+        {
+            auto column = [&](uint32_t plane)
+            {
+                const float** rows = mRowPointers.data() + plane * mTapCount;
+                for (int k = -radius; k <= radius; ++k)
+                {
+                    uint32_t row = uint32_t(std::clamp(int(y) + k, 0, int(mHeight) - 1));
+                    rows[k + radius] = getRingRow(row, image, plane);
+                }
+                return ColumnSource{rows, mRadius};
+            };
+            auto output = [&](uint32_t index) { return getOutput(image, index); };
+
+            const Kernels& k = mKernels;
+            convolveColumn<1, 0>(column(kPlaneY), {k.gaussianA.data()}, {output(kOutputY)});
+            convolveColumn<1, 0>(column(kPlaneCx), {k.gaussianRG.data()}, {output(kOutputCx)});
+            convolveColumn<1, 0>(column(kPlaneCz1), {k.gaussianBY1.data()}, {output(kOutputCz1)});
+            convolveColumn<1, 0>(column(kPlaneCz2), {k.gaussianBY2.data()}, {output(kOutputCz2)});
+            convolveColumn<1, 0>(column(kPlaneE), {k.feature.data()}, {output(kOutputEdgeX)});
+            convolveColumn<1, 0>(column(kPlaneP), {k.feature.data()}, {output(kOutputPointX)});
+            convolveColumn<1, 1>(column(kPlaneG), {k.point.data(), k.edge.data()}, {output(kOutputPointY), output(kOutputEdgeY)});
+        }
+    }
+
+    template<uint32_t kEven, uint32_t kOdd>
+    void convolveColumn(
+        const ColumnSource& source,
+        const std::array<const float*, kEven + kOdd>& weights,
+        const std::array<float*, kEven + kOdd>& dst
+    )
+    {
+        convolve<kEven, kOdd>(source, mRadius, weights.data(), dst.data(), mWidth);
+    }
+
+    /// Compute the FLIP errors of the current row from the filtered values.
+    void evaluateRow(float* pErrors)
+    {
+#if FLIP_SSE2
+        // Evaluate all pixels with SIMD instructions so the result does not depend on the position in the row.
+        // The outputs are padded to a multiple of 4 pixels.
+        const ColorMatrices& m = getColorMatrices();
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const float delta = 6.f / 29.f;
+        const __m128 deltaCube = _mm_set1_ps(delta * delta * delta);
+        const __m128 labFactor = _mm_set1_ps(1.f / (3.f * delta * delta));
+        const __m128 labTerm = _mm_set1_ps(4.f / 29.f);
+        const __m128 oneThird = _mm_set1_ps(1.f / 3.f);
+        const float maxDistance = getMaxDistance();
+        const float perceptualCutoff = kPc * maxDistance;
+
+        auto transform = [](const float* matrix, const __m128 v[3], __m128 result[3])
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                result[i] = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(matrix[i * 3]), v[0]), _mm_mul_ps(_mm_set1_ps(matrix[i * 3 + 1]), v[1])),
+                    _mm_mul_ps(_mm_set1_ps(matrix[i * 3 + 2]), v[2])
+                );
+            }
+        };
+        auto labComponent = [&](__m128 t)
+        {
+            __m128 root = powSSE(t, oneThird);
+            return selectSSE(_mm_cmpgt_ps(t, deltaCube), root, _mm_add_ps(_mm_mul_ps(labFactor, t), labTerm));
+        };
+        auto length = [](__m128 x, __m128 y) { return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))); };
+
+        for (uint32_t x = 0; x < mWidth; x += 4)
+        {
+            __m128 lab[2][3];
+            __m128 edge[2];
+            __m128 point[2];
+            for (uint32_t image = 0; image < 2; ++image)
+            {
+                auto load = [&](uint32_t output) { return _mm_loadu_ps(getOutput(image, output) + x); };
+
+                // YCxCz to XYZ.
+                __m128 y = _mm_div_ps(_mm_add_ps(load(kOutputY), _mm_set1_ps(16.f)), _mm_set1_ps(116.f));
+                __m128 cz = _mm_add_ps(load(kOutputCz1), load(kOutputCz2));
+                __m128 xyz[3] = {
+                    _mm_mul_ps(_mm_add_ps(_mm_div_ps(load(kOutputCx), _mm_set1_ps(500.f)), y), _mm_set1_ps(kD65ReferenceIlluminant.x)),
+                    _mm_mul_ps(y, _mm_set1_ps(kD65ReferenceIlluminant.y)),
+                    _mm_mul_ps(_mm_sub_ps(y, _mm_div_ps(cz, _mm_set1_ps(200.f))), _mm_set1_ps(kD65ReferenceIlluminant.z)),
+                };
+
+                // Clamp in linear RGB and convert back to XYZ.
+                __m128 rgb[3];
+                transform(m.xyzToRGB, xyz, rgb);
+                for (int i = 0; i < 3; ++i)
+                    rgb[i] = _mm_min_ps(_mm_max_ps(rgb[i], zero), one);
+                transform(m.rgbToXYZ, rgb, xyz);
+
+                // XYZ to CIELab with Hunt adjustment.
+                __m128 fx = labComponent(_mm_mul_ps(xyz[0], _mm_set1_ps(kInvD65ReferenceIlluminant.x)));
+                __m128 fy = labComponent(_mm_mul_ps(xyz[1], _mm_set1_ps(kInvD65ReferenceIlluminant.y)));
+                __m128 fz = labComponent(_mm_mul_ps(xyz[2], _mm_set1_ps(kInvD65ReferenceIlluminant.z)));
+                __m128 l = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.f), fy), _mm_set1_ps(16.f));
+                __m128 huntValue = _mm_mul_ps(_mm_set1_ps(0.01f), l);
+                lab[image][0] = l;
+                lab[image][1] = _mm_mul_ps(huntValue, _mm_mul_ps(_mm_set1_ps(500.f), _mm_sub_ps(fx, fy)));
+                lab[image][2] = _mm_mul_ps(huntValue, _mm_mul_ps(_mm_set1_ps(200.f), _mm_sub_ps(fy, fz)));
+
+                edge[image] = length(load(kOutputEdgeX), load(kOutputEdgeY));
+                point[image] = length(load(kOutputPointX), load(kOutputPointY));
+            }
+
+            // HyAB color difference.
+            __m128 colorDifference = _mm_add_ps(
+                absSSE(_mm_sub_ps(lab[0][0], lab[1][0])), length(_mm_sub_ps(lab[0][1], lab[1][1]), _mm_sub_ps(lab[0][2], lab[1][2]))
+            );
+
+            // Feature difference. The exponent kQf is 0.5.
+            __m128 featureDifference = _mm_max_ps(absSSE(_mm_sub_ps(point[0], point[1])), absSSE(_mm_sub_ps(edge[0], edge[1])));
+            featureDifference = _mm_sqrt_ps(_mm_mul_ps(featureDifference, _mm_set1_ps(kSqrt1_2)));
+
+            // Redistribute errors, see redistributeErrors().
+            __m128 error = powSSE(colorDifference, _mm_set1_ps(kQc));
+            __m128 low = _mm_mul_ps(error, _mm_set1_ps(kPt / perceptualCutoff));
+            __m128 high = _mm_add_ps(
+                _mm_set1_ps(kPt),
+                _mm_mul_ps(
+                    _mm_div_ps(_mm_sub_ps(error, _mm_set1_ps(perceptualCutoff)), _mm_set1_ps(maxDistance - perceptualCutoff)),
+                    _mm_set1_ps(1.f - kPt)
+                )
+            );
+            error = selectSSE(_mm_cmplt_ps(error, _mm_set1_ps(perceptualCutoff)), low, high);
+            error = powSSE(error, _mm_sub_ps(one, featureDifference));
+
+            if (x + 4 <= mWidth)
+            {
+                _mm_storeu_ps(pErrors + x, error);
+            }
+            else
+            {
+                float values[4];
+                _mm_storeu_ps(values, error);
+                std::copy(values, values + (mWidth - x), pErrors + x);
+            }
+        }
+#else
+        for (uint32_t x = 0; x < mWidth; ++x)
+        {
+            float3 lab[2];
+            float edge[2];
+            float point[2];
+            for (uint32_t image = 0; image < 2; ++image)
+            {
+                float3 ycxcz(
+                    getOutput(image, kOutputY)[x],
+                    getOutput(image, kOutputCx)[x],
+                    getOutput(image, kOutputCz1)[x] + getOutput(image, kOutputCz2)[x]
+                );
+                lab[image] = huntAdjust(linearRGBToCIELab(clampColor(YCxCzToLinearRGB(ycxcz))));
+
+                float edgeX = getOutput(image, kOutputEdgeX)[x];
+                float edgeY = getOutput(image, kOutputEdgeY)[x];
+                float pointX = getOutput(image, kOutputPointX)[x];
+                float pointY = getOutput(image, kOutputPointY)[x];
+                edge[image] = std::sqrt(edgeX * edgeX + edgeY * edgeY);
+                point[image] = std::sqrt(pointX * pointX + pointY * pointY);
+            }
+
+            float colorDifference = hyAB(lab[0], lab[1]);
+            float edgeDifference = std::abs(edge[0] - edge[1]);
+            float pointDifference = std::abs(point[0] - point[1]);
+            float featureDifference = std::pow(std::max(pointDifference, edgeDifference) * kSqrt1_2, kQf);
+
+            pErrors[x] = redistributeErrors(colorDifference, featureDifference);
+        }
+#endif
+    }
+
+    const Kernels& mKernels;
+    const float* mImages[2];
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mChannelCount;
+    const FLIP::Options& mOptions;
+    uint32_t mRadius;
+    uint32_t mTapCount;
+    uint32_t mPaddedWidth;
+    uint32_t mOutputStride; ///< Row stride of the vertically filtered values, padded to a multiple of 4.
+
+    std::vector<float> mPadded;             ///< Y, Cx, Cz and normalized luminance of the current source row, padded by the radius.
+    std::vector<float> mRing;               ///< Ring buffer of horizontally filtered rows (tapCount slots, 2 images, kPlaneCount planes).
+    std::vector<float> mOutputs;            ///< Vertically filtered values of the current row (2 images, kOutputCount outputs).
+    std::vector<const float*> mRowPointers; ///< Source rows of the vertical filter for each plane.
+};
+} // namespace
+
+FLIP::ExposureParameters FLIP::computeExposureParameters(
+    const float* pReference,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channelCount,
+    ToneMapper toneMapper,
+    uint32_t threadCount
+)
+{
+    FALCOR_CHECK(pReference != nullptr, "Reference image is missing.");
+    FALCOR_CHECK(width > 0 && height > 0, "Invalid image size {}x{}.", width, height);
+    FALCOR_CHECK(channelCount == 3 || channelCount == 4, "Invalid channel count {}.", channelCount);
+
+    float coefficients[6];
+    getToneMapperCoefficients(toneMapper, coefficients);
+
+    // Compute median and max luminance of the reference image.
+    const size_t pixelCount = size_t(width) * height;
+    std::vector<float> luminances(pixelCount);
+    Threading::parallelFor(
+        0,
+        pixelCount,
+        threadCount > 0 ? (pixelCount + threadCount - 1) / threadCount : 0,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const float* p = pReference + i * channelCount;
+                luminances[i] = luminance(float3(p[0], p[1], p[2]));
+            }
+        }
+    );
+
+    const size_t middle = pixelCount / 2;
+    std::nth_element(luminances.begin(), luminances.begin() + middle, luminances.end());
+    float Ymedian = luminances[middle];
+    if ((pixelCount & 1) == 0) // Even number of values.
+        Ymedian = (*std::max_element(luminances.begin(), luminances.begin() + middle) + Ymedian) * 0.5f;
+    const float Ymax = *std::max_element(luminances.begin() + middle, luminances.end());
+
+    // Solve a * x^2 + b * x + c = 0 for the input value that is tone mapped to t.
+    const float t = 0.85f;
+    const float a = coefficients[0] - t * coefficients[3];
+    const float b = coefficients[1] - t * coefficients[4];
+    const float c = coefficients[2] - t * coefficients[5];
+
+    float xMax;
+    if (a == 0.f)
+    {
+        xMax = -c / b;
+    }
+    else
+    {
+        float d1 = -0.5f * (b / a);
+        float d2 = std::sqrt((d1 * d1) - (c / a));
+        xMax = d1 + d2;
+    }
+
+    ExposureParameters params;
+    params.startExposure = std::log2(xMax / std::max(Ymax, kMinExposureLuminance));
+    params.stopExposure = std::log2(xMax / std::max(Ymedian, kMinExposureLuminance));
+    params.numExposures = uint32_t(std::max(2.f, std::ceil(params.stopExposure - params.startExposure)));
+    return params;
+}
+
+FLIP::Result FLIP::compute(
+    const float* pReference,
+    const float* pTest,
+    uint32_t width,
+    uint32_t height,
+    uint32_t channelCount,
+    const Options& options,
+    float* pErrorMap,
+    float* pExposureMap
+)
+{
+    FALCOR_CHECK(pReference != nullptr && pTest != nullptr, "Reference or test image is missing.");
+    FALCOR_CHECK(width > 0 && height > 0, "Invalid image size {}x{}.", width, height);
+    FALCOR_CHECK(channelCount == 3 || channelCount == 4, "Invalid channel count {}.", channelCount);
+    FALCOR_CHECK(
+        options.monitorWidthPixels > 0 && options.monitorWidthMeters > 0.f && options.monitorDistanceMeters > 0.f,
+        "Invalid viewing conditions."
+    );
+
+    Result result;
+    if (options.isHDR)
+    {
+        if (options.useCustomExposureParameters)
+            result.exposure = options.exposure;
+        else
+            result.exposure = computeExposureParameters(pReference, width, height, channelCount, options.toneMapper, options.threadCount);
+        FALCOR_CHECK(result.exposure.numExposures >= 2, "HDR-FLIP requires at least two exposures.");
+    }
+    const uint32_t numExposures = options.isHDR ? result.exposure.numExposures : 1;
+    const float exposureDelta =
+        options.isHDR ? (result.exposure.stopExposure - result.exposure.startExposure) / (numExposures - 1.f) : 0.f;
+
+    // Pixels per degree (PPD).
+    const float pixelsPerDegree =
+        options.monitorDistanceMeters * (options.monitorWidthPixels / options.monitorWidthMeters) * (kPi / 180.f);
+    const Kernels kernels = createKernels(pixelsPerDegree);
+
+    // Each band recomputes the horizontal filter for the radius rows above and below it.
+    // Use enough bands to balance the load, but keep them large enough to amortize this overhead.
+    // With a limited thread count, the bands are split into at most that many chunks.
+    const uint32_t poolThreadCount = Threading::getWorkerCount() + 1;
+    const bool limitThreads = options.threadCount > 0 && options.threadCount < poolThreadCount;
+    const uint32_t threadCount = limitThreads ? options.threadCount : poolThreadCount;
+    const uint32_t bandHeight = std::min(height, std::max(4 * uint32_t(kernels.radius), (height + 4 * threadCount - 1) / (4 * threadCount)));
+    const uint32_t bandCount = (height + bandHeight - 1) / bandHeight;
+
+    std::vector<double> rowSums(height);
+    std::vector<float> rowMin(height);
+    std::vector<float> rowMax(height);
+    const float* const images[2] = {pReference, pTest};
+
+    Threading::parallelFor(
+        0,
+        bandCount,
+        limitThreads ? (bandCount + threadCount - 1) / threadCount : 1,
+        [&](size_t begin, size_t end)
+        {
+            BandEvaluator evaluator(kernels, images, width, height, channelCount, options);
+            std::vector<float> errors(size_t(bandHeight) * width);
+            std::vector<float> maxErrors(size_t(bandHeight) * width);
+            std::vector<uint32_t> maxIndices(size_t(bandHeight) * width);
+
+            for (size_t band = begin; band < end; ++band)
+            {
+                const uint32_t y0 = uint32_t(band) * bandHeight;
+                const uint32_t y1 = std::min(height, y0 + bandHeight);
+                const size_t count = size_t(y1 - y0) * width;
+
+                if (options.isHDR)
+                {
+                    // HDR-FLIP is maximum LDR-FLIP over a range of exposures.
+                    std::fill(maxErrors.begin(), maxErrors.begin() + count, 0.f);
+                    std::fill(maxIndices.begin(), maxIndices.begin() + count, 0);
+                    for (uint32_t i = 0; i < numExposures; ++i)
+                    {
+                        evaluator.evaluate(y0, y1, result.exposure.startExposure + i * exposureDelta, errors.data());
+                        for (size_t j = 0; j < count; ++j)
+                        {
+                            if (errors[j] > maxErrors[j])
+                            {
+                                maxErrors[j] = errors[j];
+                                maxIndices[j] = i;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    evaluator.evaluate(y0, y1, 0.f, maxErrors.data());
+                }
+
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    const size_t offset = size_t(y - y0) * width;
+                    double sum = 0.0;
+                    float minValue = std::numeric_limits<float>::infinity();
+                    float maxValue = -std::numeric_limits<float>::infinity();
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        float value = maxErrors[offset + x];
+                        if (std::isnan(value) || std::isinf(value) || value < 0.f || value > 1.f)
+                            value = 1.f;
+                        sum += value;
+                        minValue = std::min(minValue, value);
+                        maxValue = std::max(maxValue, value);
+                        if (pErrorMap)
+                            pErrorMap[size_t(y) * width + x] = value;
+                        if (pExposureMap)
+                            pExposureMap[size_t(y) * width + x] = options.isHDR ? maxIndices[offset + x] / (numExposures - 1.f) : 0.f;
+                    }
+                    rowSums[y] = sum;
+                    rowMin[y] = minValue;
+                    rowMax[y] = maxValue;
+                }
+            }
+        }
+    );
+
+    double sum = 0.0;
+    result.min = std::numeric_limits<float>::infinity();
+    result.max = -std::numeric_limits<float>::infinity();
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        sum += rowSums[y];
+        result.min = std::min(result.min, rowMin[y]);
+        result.max = std::max(result.max, rowMax[y]);
+    }
+    result.mean = float(sum / (double(width) * height));
+    return result;
+}
+} // namespace Falcor
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * CPU implementation of the FLIP image difference evaluator.
+ *
+ * Computes the same per-pixel LDR-FLIP and HDR-FLIP errors as the FLIPPass render pass,
+ * without requiring a GPU. The CSF and feature detection filters are evaluated separably
+ * using SIMD instructions, and the image is processed in horizontal bands in parallel
+ * using the global thread pool (see Threading). The result does not depend on the number
+ * of threads.
+ *
+ * See FLIPPass for references to the FLIP papers.
+ */
+class FALCOR_API FLIP
+{
+public:
+    /// Tone mapper assumed by HDR-FLIP. Matches FLIPToneMapperType used by FLIPPass.
+    enum class ToneMapper : uint32_t
+    {
+        ACES = 0,
+        Hable = 1,
+        Reinhard = 2,
+    };
+
+    /// Range of exposures evaluated by HDR-FLIP.
+    struct ExposureParameters
+    {
+        float startExposure = 0.f;
+        float stopExposure = 0.f;
+        uint32_t numExposures = 2; ///< Number of exposures in [startExposure, stopExposure]. Must be at least 2.
+    };
+
+    struct Options
+    {
+        bool isHDR = false;     ///< Use HDR-FLIP instead of LDR-FLIP.
+        bool clampInput = true; ///< Clamp input to the expected range ([0,1] for LDR-FLIP and [0,inf) for HDR-FLIP).
+        ToneMapper toneMapper = ToneMapper::ACES; ///< Tone mapper assumed by HDR-FLIP.
+        bool useCustomExposureParameters = false; ///< Use 'exposure' instead of computing the exposures from the reference image.
+        ExposureParameters exposure;              ///< Custom exposure parameters for HDR-FLIP.
+        uint32_t threadCount = 0; ///< Maximum number of threads, including the calling thread. Zero uses all threads of the thread pool.
+
+        // Viewing conditions for the pixels per degree computation.
+        uint32_t monitorWidthPixels = 3840;
+        float monitorWidthMeters = 0.7f;
+        float monitorDistanceMeters = 0.7f;
+    };
+
+    struct Result
+    {
+        float mean = 0.f; ///< Mean FLIP error.
+        float min = 0.f;  ///< Minimum FLIP error.
+        float max = 0.f;  ///< Maximum FLIP error.
+        ExposureParameters exposure; ///< Exposure parameters used by HDR-FLIP.
+    };
+
+    /**
+     * Compute the HDR-FLIP exposure parameters from the luminance of the reference image.
+     * @param[in] pReference Reference image (RGB or RGBA float32, tightly packed).
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] channelCount Number of channels per pixel (3 or 4).
+     * @param[in] toneMapper Tone mapper assumed by HDR-FLIP.
+     * @param[in] threadCount Maximum number of threads, including the calling thread. Zero uses all threads of the thread pool.
+     * @return Exposure parameters.
+     */
+    static ExposureParameters computeExposureParameters(
+        const float* pReference,
+        uint32_t width,
+        uint32_t height,
+        uint32_t channelCount,
+        ToneMapper toneMapper,
+        uint32_t threadCount = 0
+    );
+
+    /**
+     * Compute the FLIP error between a reference and a test image.
+     * Pixels with an invalid error (NaN, inf or outside [0,1]) are assigned an error of one, like in FLIPPass.
+     * Throws an exception if the arguments are invalid.
+     * @param[in] pReference Reference image (RGB or RGBA float32, tightly packed). Alpha is ignored.
+     * @param[in] pTest Test image with the same layout as the reference image.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] channelCount Number of channels per pixel (3 or 4).
+     * @param[in] options FLIP options.
+     * @param[out] pErrorMap Optional per-pixel FLIP error (width * height values).
+     * @param[out] pExposureMap Optional per-pixel normalized index of the exposure with the largest error for HDR-FLIP
+     * (width * height values in [0,1]). Zero for LDR-FLIP.
+     * @return Pooled FLIP values and the exposure parameters that were used.
+     */
+    static Result compute(
+        const float* pReference,
+        const float* pTest,
+        uint32_t width,
+        uint32_t height,
+        uint32_t channelCount,
+        const Options& options,
+        float* pErrorMap = nullptr,
+        float* pExposureMap = nullptr
+    );
+};
+} // namespace Falcor
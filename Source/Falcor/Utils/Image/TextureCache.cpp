@@ -0,0 +1,340 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "Core/Error.h"
+#include "Core/API/Device.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Version of the cache entries. Increment when the layout of the cached data changes to invalidate existing entries.
+const uint32_t kCacheVersion = 1;
+const char kEntryExtension[] = ".dds";
+const char kTempExtension[] = ".tmp";
+} // namespace
+
+/// Pins a cache entry for the lifetime of the object.
+class TextureCache::EntryPin
+{
+public:
+    EntryPin(TextureCache& cache, const std::string& name) : mCache(cache), mName(name)
+    {
+        std::lock_guard<std::mutex> lock(mCache.mMutex);
+        mCache.pinEntry(mName);
+    }
+
+    ~EntryPin()
+    {
+        std::lock_guard<std::mutex> lock(mCache.mMutex);
+        mCache.unpinEntry(mName);
+    }
+
+private:
+    TextureCache& mCache;
+    std::string mName;
+};
+
+TextureCache::TextureCache(const Options& options) : mOptions(options)
+{
+    FALCOR_CHECK(!mOptions.directory.empty(), "Texture cache directory must not be empty.");
+
+    std::error_code ec;
+    std::filesystem::create_directories(mOptions.directory, ec);
+    if (ec)
+        FALCOR_THROW("Failed to create texture cache directory '{}': {}", mOptions.directory, ec.message());
+
+    // Index the existing entries in the order of their last use.
+    struct File
+    {
+        std::filesystem::file_time_type time;
+        std::string name;
+        uint64_t size;
+    };
+    std::vector<File> files;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(mOptions.directory, ec))
+    {
+        if (!dirEntry.is_regular_file(ec) || dirEntry.path().extension() != kEntryExtension)
+            continue;
+        files.push_back({dirEntry.last_write_time(ec), dirEntry.path().filename().string(), dirEntry.file_size(ec)});
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& file : files)
+        addEntry(file.name, file.size);
+    evict();
+}
+
+ref<Texture> TextureCache::loadTexture(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSRGB,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags
+)
+{
+    // DDS files are already preprocessed, and cached textures are always created with the default bind flags.
+    if (hasExtension(path, "dds") || bindFlags != ResourceBindFlags::ShaderResource)
+        return nullptr;
+
+    auto key = computeKey(path, generateMipLevels, importFlags);
+    if (!key)
+        return nullptr;
+
+    const std::filesystem::path entryPath = getEntryPath(*key);
+    const std::string name = entryPath.filename().string();
+    std::error_code ec;
+
+    // Pin the entry while its file is read or written, so that loads on other threads don't evict it.
+    EntryPin pin(*this, name);
+
+    ref<Texture> pTexture;
+    if (std::filesystem::exists(entryPath, ec))
+    {
+        pTexture = ImageIO::loadTextureFromDDS(pDevice, entryPath, loadAsSRGB);
+        if (pTexture)
+        {
+            // Store the last use in the file so that the LRU order persists between sessions.
+            // The entry may have been added by another process, so it is indexed with its current size.
+            std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), ec);
+            uint64_t size = std::filesystem::file_size(entryPath, ec);
+            std::lock_guard<std::mutex> lock(mMutex);
+            addEntry(name, ec ? 0 : size);
+            mStats.hitCount++;
+        }
+        else
+        {
+            logWarning("Removing invalid texture cache entry '{}'.", entryPath);
+            std::filesystem::remove(entryPath, ec);
+            if (!ec)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                removeEntry(name);
+            }
+        }
+    }
+
+    if (!pTexture)
+    {
+        // Prepare the texture and write it to a temporary file first, so that other threads and processes never see a partial entry.
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true, importFlags);
+        if (!pBitmap)
+            return nullptr;
+
+        ImageIO::CompressionMode mode = ImageIO::CompressionMode::None;
+        if (mOptions.compress)
+            mode = getCompressionMode(pBitmap->getFormat(), pBitmap->getWidth(), pBitmap->getHeight());
+
+        std::filesystem::path tempPath = entryPath;
+        tempPath += "." + getTempFilePath().filename().string() + kTempExtension;
+        try
+        {
+            ImageIO::saveToDDS(tempPath, *pBitmap, mode, generateMipLevels);
+            std::filesystem::rename(tempPath, entryPath);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to add texture '{}' to the texture cache: {}", path, e.what());
+            std::filesystem::remove(tempPath, ec);
+            return nullptr;
+        }
+
+        pTexture = ImageIO::loadTextureFromDDS(pDevice, entryPath, loadAsSRGB);
+        if (!pTexture)
+            return nullptr;
+
+        // The cache is trimmed to its maximum size once the entry is unpinned.
+        uint64_t size = std::filesystem::file_size(entryPath, ec);
+        std::lock_guard<std::mutex> lock(mMutex);
+        addEntry(name, ec ? 0 : size);
+        mStats.missCount++;
+    }
+
+    pTexture->setSourcePath(path);
+    pTexture->mImportFlags = importFlags;
+    return pTexture;
+}
+
+std::optional<SHA1::MD> TextureCache::computeKey(const std::filesystem::path& path, bool generateMipLevels, Bitmap::ImportFlags importFlags)
+    const
+{
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (!file.isOpen())
+        return {};
+
+    SHA1 sha1;
+    sha1.update(kCacheVersion);
+    sha1.update(generateMipLevels);
+    sha1.update((uint32_t)importFlags);
+    sha1.update(mOptions.compress);
+    sha1.update(file.getData(), file.getSize());
+    return sha1.finalize();
+}
+
+std::filesystem::path TextureCache::getEntryPath(const SHA1::MD& key) const
+{
+    return mOptions.directory / (SHA1::toString(key) + kEntryExtension);
+}
+
+ImageIO::CompressionMode TextureCache::getCompressionMode(ResourceFormat format, uint32_t width, uint32_t height)
+{
+    // Block compressed textures need a base level that is a multiple of the block size.
+    if (isCompressedFormat(format) || width % 4 != 0 || height % 4 != 0)
+        return ImageIO::CompressionMode::None;
+
+    // Only compress 8-bit color data. HDR data keeps its precision, BC6 would also drop the alpha channel.
+    FormatType type = getFormatType(format);
+    if ((type != FormatType::Unorm && type != FormatType::UnormSrgb) || getNumChannelBits(format, 0) != 8)
+        return ImageIO::CompressionMode::None;
+
+    switch (getFormatChannelCount(format))
+    {
+    case 1:
+        return ImageIO::CompressionMode::BC4;
+    case 2:
+        return ImageIO::CompressionMode::BC5;
+    default:
+        return ImageIO::CompressionMode::BC7;
+    }
+}
+
+void TextureCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::error_code ec;
+    for (auto it = mEntries.begin(); it != mEntries.end();)
+    {
+        // Pinned entries are in use, and entries whose file can't be removed still take up space.
+        if (it->second.pinCount == 0)
+        {
+            std::filesystem::remove(mOptions.directory / it->first, ec);
+            if (!ec)
+            {
+                mSizeInBytes -= it->second.size;
+                it = mEntries.erase(it);
+                continue;
+            }
+            logWarning("Failed to remove texture cache entry '{}': {}", it->first, ec.message());
+        }
+        ++it;
+    }
+}
+
+TextureCache::Stats TextureCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    stats.entryCount = std::count_if(mEntries.begin(), mEntries.end(), [](const auto& entry) { return entry.second.lastUse > 0; });
+    stats.sizeInBytes = mSizeInBytes;
+    return stats;
+}
+
+void TextureCache::addEntry(const std::string& name, uint64_t size)
+{
+    auto [it, inserted] = mEntries.try_emplace(name);
+    mSizeInBytes = mSizeInBytes - it->second.size + size;
+    it->second.size = size;
+    it->second.lastUse = ++mUseCounter;
+}
+
+void TextureCache::removeEntry(const std::string& name)
+{
+    auto it = mEntries.find(name);
+    if (it == mEntries.end())
+        return;
+
+    // Pinned entries are kept until they are unpinned.
+    mSizeInBytes -= it->second.size;
+    if (it->second.pinCount > 0)
+        it->second = Entry{0, 0, it->second.pinCount};
+    else
+        mEntries.erase(it);
+}
+
+void TextureCache::pinEntry(const std::string& name)
+{
+    mEntries[name].pinCount++;
+}
+
+void TextureCache::unpinEntry(const std::string& name)
+{
+    auto it = mEntries.find(name);
+    FALCOR_ASSERT(it != mEntries.end() && it->second.pinCount > 0);
+    if (--it->second.pinCount == 0 && it->second.lastUse == 0)
+    {
+        // The entry was never added, e.g. because the load failed.
+        mEntries.erase(it);
+    }
+
+    // Entries that were pinned during an earlier eviction may be evicted now.
+    evict();
+}
+
+void TextureCache::evict()
+{
+    if (mSizeInBytes <= mOptions.maxSizeInBytes)
+        return;
+
+    // Remove the least recently used entries until the cache fits.
+    std::vector<std::pair<uint64_t, std::string>> entries;
+    entries.reserve(mEntries.size());
+    for (const auto& [name, entry] : mEntries)
+        entries.emplace_back(entry.lastUse, name);
+    std::sort(entries.begin(), entries.end());
+
+    std::error_code ec;
+    for (const auto& [lastUse, name] : entries)
+    {
+        if (mSizeInBytes <= mOptions.maxSizeInBytes)
+            break;
+
+        // Pinned entries are being loaded and are evicted once they are unpinned.
+        auto it = mEntries.find(name);
+        if (it->second.pinCount > 0)
+            continue;
+
+        // Entries whose file can't be removed stay in the index, as the file still takes up space.
+        std::filesystem::remove(mOptions.directory / name, ec);
+        if (ec)
+        {
+            logWarning("Failed to evict texture cache entry '{}': {}", name, ec.message());
+            continue;
+        }
+        mSizeInBytes -= it->second.size;
+        mEntries.erase(it);
+        mStats.evictionCount++;
+    }
+}
+} // namespace Falcor
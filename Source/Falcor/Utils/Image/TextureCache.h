@@ -0,0 +1,156 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Formats.h"
+#include "Core/API/Texture.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace Falcor
+{
+/**
+ * On-disk cache of preprocessed textures.
+ *
+ * Source images are converted to DDS files holding the full mip chain and block compressed data.
+ * The cache entries are keyed by the SHA-1 hash of the source file content and the load options,
+ * so a texture is found again after it has been moved or renamed, and a changed file is never
+ * served stale data. A warm load only maps the DDS file and uploads its data.
+ *
+ * The total size of the cache is bounded. When the limit is exceeded, the least recently used
+ * entries are evicted. The last use of an entry is stored as the modification time of its file
+ * so that the order is preserved between sessions. All operations are thread-safe.
+ */
+class FALCOR_API TextureCache
+{
+public:
+    struct Options
+    {
+        std::filesystem::path directory;                     ///< Cache directory. Created if it doesn't exist.
+        uint64_t maxSizeInBytes = 4ull * 1024 * 1024 * 1024; ///< Maximum total size of the cache files.
+        bool compress = true;                                ///< Block compress the textures. Otherwise only mips are generated.
+    };
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;      ///< Number of textures loaded from the cache.
+        uint64_t missCount = 0;     ///< Number of textures added to the cache.
+        uint64_t evictionCount = 0; ///< Number of evicted entries.
+        uint64_t entryCount = 0;    ///< Current number of entries.
+        uint64_t sizeInBytes = 0;   ///< Current total size of the entries.
+    };
+
+    /**
+     * Constructor. Scans the cache directory for existing entries and evicts entries if the cache is too large.
+     * @param[in] options Cache options.
+     */
+    TextureCache(const Options& options);
+
+    /**
+     * Load a texture through the cache, adding it to the cache if it isn't cached yet.
+     * DDS files and textures that need other bind flags than ShaderResource are not cached.
+     * @param[in] pDevice GPU device.
+     * @param[in] path Full path of the source image.
+     * @param[in] generateMipLevels Whether the full mip-chain should be generated.
+     * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
+     * @param[in] bindFlags The bind flags for the texture resource.
+     * @param[in] importFlags Flags for the image import.
+     * @return The texture, or nullptr if the texture is not cacheable or loading failed. The caller should then load the texture directly.
+     */
+    ref<Texture> loadTexture(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSRGB,
+        ResourceBindFlags bindFlags,
+        Bitmap::ImportFlags importFlags
+    );
+
+    /**
+     * Compute the cache key of a texture. The key covers the content of the source file and all options affecting the cached data.
+     * @return The key, or an empty optional if the file can't be read.
+     */
+    std::optional<SHA1::MD> computeKey(const std::filesystem::path& path, bool generateMipLevels, Bitmap::ImportFlags importFlags) const;
+
+    /**
+     * Get the path of the cache file for a key.
+     */
+    std::filesystem::path getEntryPath(const SHA1::MD& key) const;
+
+    /**
+     * Get the block compression mode used to store an image.
+     * 8-bit color data uses BC4, BC5 or BC7 depending on the channel count. Other formats, including HDR data, are stored uncompressed.
+     * @param[in] format Format of the source image.
+     * @param[in] width Width of the source image.
+     * @param[in] height Height of the source image.
+     * @return Compression mode.
+     */
+    static ImageIO::CompressionMode getCompressionMode(ResourceFormat format, uint32_t width, uint32_t height);
+
+    /**
+     * Remove all entries that are not being loaded by another thread.
+     */
+    void clear();
+
+    const Options& getOptions() const { return mOptions; }
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        uint64_t size = 0;     ///< File size in bytes.
+        uint64_t lastUse = 0;  ///< Use counter value at the last use. Zero while the entry is not added yet.
+        uint32_t pinCount = 0; ///< Number of loads reading or writing the file. Pinned entries are not evicted.
+    };
+
+    class EntryPin;
+
+    void addEntry(const std::string& name, uint64_t size);
+    void removeEntry(const std::string& name);
+    void pinEntry(const std::string& name);
+    void unpinEntry(const std::string& name);
+    void evict();
+
+    Options mOptions;
+
+    mutable std::mutex mMutex;                       ///< Mutex for synchronizing access to the index and stats.
+    std::unordered_map<std::string, Entry> mEntries; ///< Index of the cache files and pinned entries, by file name.
+    uint64_t mUseCounter = 0;                        ///< Counter incremented on every use of an entry.
+    uint64_t mSizeInBytes = 0;                       ///< Total size of the cache files.
+    uint64_t mTempFileCounter = 0;                   ///< Counter to create unique names for files being written.
+    Stats mStats;
+};
+} // namespace Falcor
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "TextureCache.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
@@ -323,15 +324,7 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         }
 #else
         // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
-        {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
-        }
-        else
-        {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
-        }
+        ref<Texture> pTexture = loadTextureFromKey(textureKey, mpTextureCache);
 
         // Add new texture desc.
         TextureDesc desc = {TextureState::Loaded, pTexture};
@@ -408,6 +401,7 @@ void TextureManager::endDeferredLoading()
         return;
 
     // Load textures in parallel.
+    const std::shared_ptr<TextureCache> pTextureCache = getTextureCache();
     std::atomic<size_t> texturesLoaded;
     NumericRange<size_t> jobRange(0, jobs.size());
     std::for_each(
@@ -418,19 +412,7 @@ void TextureManager::endDeferredLoading()
         {
             const auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
-            {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
-            }
-            else
-            {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
-            }
+            desc.pTexture = loadTextureFromKey(job.key, pTextureCache);
             if (texturesLoaded.fetch_add(1) % 10 == 9)
             {
                 logDebug("Flush");
@@ -645,6 +627,41 @@ TextureManager::Stats TextureManager::getStats() const
     return s;
 }
 
+void TextureManager::setTextureCache(std::shared_ptr<TextureCache> pTextureCache)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mpTextureCache = pTextureCache;
+    mAsyncTextureLoader.setTextureCache(pTextureCache);
+}
+
+std::shared_ptr<TextureCache> TextureManager::getTextureCache() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mpTextureCache;
+}
+
+ref<Texture> TextureManager::loadTextureFromKey(const TextureKey& key, const std::shared_ptr<TextureCache>& pTextureCache) const
+{
+    if (key.fullPaths.size() > 1)
+    {
+        logDebug("Loading mipped texture from '{}'", key.fullPaths[0]);
+        return Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    }
+
+    logDebug("Loading texture from '{}'", key.fullPaths[0]);
+    ref<Texture> pTexture;
+    if (pTextureCache)
+    {
+        pTexture =
+            pTextureCache->loadTexture(mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    }
+    if (!pTexture)
+    {
+        pTexture = Texture::createFromFile(mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    }
+    return pTexture;
+}
+
 TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     CpuTextureHandle handle;
@@ -44,6 +44,7 @@
 namespace Falcor
 {
 class AssetResolver;
+class TextureCache;
 
 /**
  * Multi-threaded texture manager.
@@ -279,6 +280,18 @@ public:
      */
     Stats getStats() const;
 
+    /**
+     * Set a cache of preprocessed textures.
+     * Textures loaded from single image files are then loaded through the cache, which stores them with mips and block compression.
+     * @param[in] pTextureCache Texture cache, or nullptr to load all textures directly.
+     */
+    void setTextureCache(std::shared_ptr<TextureCache> pTextureCache);
+
+    /**
+     * Get the cache of preprocessed textures, or nullptr if none is used.
+     */
+    std::shared_ptr<TextureCache> getTextureCache() const;
+
 private:
     size_t getUdimRange(size_t requiredSize);
     void freeUdimRange(size_t rangeStart);
@@ -339,6 +352,14 @@ private:
         }
     };
 
+    /**
+     * Load the texture identified by a key, through the texture cache if possible.
+     * @param[in] key Texture key.
+     * @param[in] pTextureCache Texture cache to use, or nullptr to load from the source file. Callers pass a
+     * snapshot of mpTextureCache taken while holding mMutex, as this function is called from worker threads.
+     */
+    ref<Texture> loadTextureFromKey(const TextureKey& key, const std::shared_ptr<TextureCache>& pTextureCache) const;
+
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
@@ -370,7 +391,8 @@ private:
 
     bool mUseDeferredLoading = false;
 
-    AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
+    AsyncTextureLoader mAsyncTextureLoader;       ///< Utility for asynchronous texture loading.
+    std::shared_ptr<TextureCache> mpTextureCache; ///< Cache of preprocessed textures, or nullptr if disabled.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
 
     const size_t mMaxTextureCount; ///< Maximum number of textures that can be simultaneously managed.
@@ -29,23 +29,35 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_map>
 
 namespace Falcor
 {
 namespace
 {
-std::mutex sMutex;
-Logger::Level sVerbosity = Logger::Level::Info;
+std::mutex sMutex; ///< Protects the output state. Held while writing messages.
+std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
 Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
 std::filesystem::path sLogFilePath;
 
 bool sInitialized = false;
 FILE* sLogFile = nullptr;
 
+std::atomic<Logger::OverflowPolicy> sOverflowPolicy{Logger::OverflowPolicy::Block};
+std::atomic<uint32_t> sRateLimit{0};
+std::atomic<uint64_t> sDroppedCount{0};
+std::atomic<uint64_t> sSuppressedCount{0};
+
 std::filesystem::path generateLogFilePath()
 {
     std::string prefix = getExecutableName();
@@ -85,12 +97,10 @@ void printToLogFile(const std::string& s)
     if (sLogFile)
     {
         std::fprintf(sLogFile, "%s", s.c_str());
-        std::fflush(sLogFile);
     }
 }
-} // namespace
 
-void Logger::shutdown()
+void closeLogFile()
 {
     if (sLogFile)
     {
@@ -100,6 +110,369 @@ void Logger::shutdown()
     }
 }
 
+/// Write a message to the outputs. Expects sMutex to be held.
+void writeMessage(Logger::Level level, const std::string& s)
+{
+    // Write to console.
+    if (is_set(sOutputs, Logger::OutputFlags::Console))
+    {
+        auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
+        os << s;
+    }
+
+    // Write to file.
+    if (is_set(sOutputs, Logger::OutputFlags::File))
+    {
+        printToLogFile(s);
+    }
+
+    // Write to debug window if debugger is attached.
+    if (is_set(sOutputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
+    {
+        printToDebugWindow(s);
+    }
+}
+
+/// Flush the console and log file. Expects sMutex to be held.
+void flushOutputs()
+{
+    std::cout.flush();
+    std::cerr.flush();
+    if (sLogFile)
+        std::fflush(sLogFile);
+}
+
+/// True on the background writer thread.
+thread_local bool tIsWriterThread = false;
+
+/**
+ * Asynchronous log writer.
+ * Logging threads push formatted messages into a bounded lock-free ring buffer (Vyukov's bounded MPMC queue,
+ * used with a single consumer). A background thread drains the ring in batches and writes them to the outputs,
+ * flushing the outputs once per batch instead of once per message.
+ */
+class AsyncWriter
+{
+public:
+    static constexpr size_t kCapacity = 4096; ///< Queue capacity in messages. Must be a power of two.
+    static constexpr size_t kMaxBatchSize = 256;
+
+    static AsyncWriter& instance()
+    {
+        // Intentionally leaked so that messages logged during static destruction can still be written synchronously.
+        static AsyncWriter* spInstance = new AsyncWriter();
+        return *spInstance;
+    }
+
+    /**
+     * Queue a message for the writer thread.
+     * @return False if the writer thread is not running and the caller must write the message itself.
+     */
+    bool enqueue(Logger::Level level, std::string& text)
+    {
+        if (tIsWriterThread || !ensureRunning())
+            return false;
+
+        // Register as active producer before re-checking the state, so that stop() either waits for this push or we see
+        // the writer stopped and write synchronously.
+        mActiveProducers.fetch_add(1);
+        struct ProducerScope
+        {
+            std::atomic<uint32_t>& count;
+            ~ProducerScope() { count.fetch_sub(1); }
+        } producerScope{mActiveProducers};
+        if (mState.load() != State::Running)
+            return false;
+
+        while (!tryPush(level, text))
+        {
+            if (sOverflowPolicy.load(std::memory_order_relaxed) == Logger::OverflowPolicy::Drop)
+            {
+                sDroppedCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (mState.load() != State::Running)
+                return false;
+            wakeWriter();
+            std::this_thread::yield();
+        }
+
+        wakeWriter();
+        return true;
+    }
+
+    /// Block until all messages queued before the call have been written.
+    void flush()
+    {
+        if (tIsWriterThread)
+            return;
+
+        const size_t target = mEnqueuePos.load();
+        mFlushWaiters.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWakeCond.notify_one();
+            while (mWrittenPos.load() < target && mState.load() == State::Running)
+                mFlushCond.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        mFlushWaiters.fetch_sub(1);
+    }
+
+    /**
+     * Stop the writer thread after writing all pending messages.
+     * @param[in] permanent If true, the writer is never restarted (used at static destruction).
+     */
+    void stop(bool permanent)
+    {
+        std::lock_guard<std::mutex> controlLock(mControlMutex);
+        if (mState.load() == State::Running)
+        {
+            // New messages are written synchronously from here on.
+            mState.store(State::Stopped);
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mStopRequested.store(true);
+            }
+            mWakeCond.notify_one();
+            mThread.join();
+
+            // Producers that saw the writer running may still be pushing. Wait for them so that their messages are
+            // part of the final drain, later producers see the stopped state.
+            while (mActiveProducers.load() > 0)
+                std::this_thread::yield();
+
+            // Write messages that were pushed while the writer was shutting down.
+            drain(std::numeric_limits<size_t>::max());
+        }
+        if (permanent)
+            mState.store(State::ShutDown);
+    }
+
+    void setEnabled(bool enabled)
+    {
+        mEnabled.store(enabled);
+        if (!enabled)
+            stop(false);
+    }
+
+    bool isEnabled() const { return mEnabled.load(); }
+
+private:
+    enum class State
+    {
+        Stopped,
+        Running,
+        ShutDown,
+    };
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Logger::Level level;
+        std::string text;
+    };
+
+    AsyncWriter() : mCells(new Cell[kCapacity])
+    {
+        for (size_t i = 0; i < kCapacity; ++i)
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool ensureRunning()
+    {
+        State state = mState.load();
+        if (state == State::Running)
+            return true;
+        if (state == State::ShutDown || !mEnabled.load())
+            return false;
+
+        std::lock_guard<std::mutex> controlLock(mControlMutex);
+        if (mState.load() == State::Stopped && mEnabled.load())
+        {
+            mStopRequested.store(false);
+            try
+            {
+                mThread = std::thread([this]() { run(); });
+                mState.store(State::Running);
+            }
+            catch (const std::system_error&)
+            {
+                // Fall back to synchronous logging if the thread cannot be created.
+                mEnabled.store(false);
+            }
+        }
+        return mState.load() == State::Running;
+    }
+
+    bool tryPush(Logger::Level level, std::string& text)
+    {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell* pCell;
+        while (true)
+        {
+            pCell = &mCells[pos & (kCapacity - 1)];
+            size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // Queue is full.
+            }
+            else
+            {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        pCell->level = level;
+        pCell->text = std::move(text);
+        pCell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(Logger::Level& level, std::string& text)
+    {
+        Cell& cell = mCells[mDequeuePos & (kCapacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+            return false;
+        level = cell.level;
+        text = std::move(cell.text);
+        cell.sequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+        ++mDequeuePos;
+        return true;
+    }
+
+    bool hasPending() const
+    {
+        const Cell& cell = mCells[mDequeuePos & (kCapacity - 1)];
+        return cell.sequence.load(std::memory_order_acquire) == mDequeuePos + 1;
+    }
+
+    void wakeWriter()
+    {
+        // Pairs with the fence in run() so that either the writer sees the new message or we see it idle.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mWriterIdle.load())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+            }
+            mWakeCond.notify_one();
+        }
+    }
+
+    /// Write up to maxCount pending messages. Only called by the consumer.
+    size_t drain(size_t maxCount)
+    {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            Logger::Level level = Logger::Level::Info;
+            std::string text;
+            while (count < maxCount && tryPop(level, text))
+            {
+                writeMessage(level, text);
+                ++count;
+            }
+
+            uint64_t droppedCount = sDroppedCount.load(std::memory_order_relaxed);
+            if (droppedCount > mReportedDroppedCount)
+            {
+                writeMessage(
+                    Logger::Level::Warning,
+                    fmt::format("(Warning) {} log messages were dropped because the log queue was full.\n", droppedCount - mReportedDroppedCount)
+                );
+                mReportedDroppedCount = droppedCount;
+                ++count;
+            }
+
+            if (count > 0)
+                flushOutputs();
+        }
+
+        if (count > 0)
+        {
+            mWrittenPos.store(mDequeuePos);
+            if (mFlushWaiters.load() > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mWakeMutex);
+                }
+                mFlushCond.notify_all();
+            }
+        }
+        return count;
+    }
+
+    void run()
+    {
+        tIsWriterThread = true;
+        while (true)
+        {
+            if (drain(kMaxBatchSize) > 0)
+                continue;
+            if (mStopRequested.load())
+                break;
+
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWriterIdle.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // The timeout is only a safety net, wake-ups are signaled by wakeWriter() and stop().
+            mWakeCond.wait_for(
+                lock, std::chrono::milliseconds(100), [this]() { return mStopRequested.load() || hasPending(); }
+            );
+            mWriterIdle.store(false);
+        }
+    }
+
+    std::unique_ptr<Cell[]> mCells;
+    alignas(64) std::atomic<size_t> mEnqueuePos{0}; ///< Next position to claim by a producer.
+    alignas(64) std::atomic<size_t> mWrittenPos{0}; ///< Position up to which messages have been written and flushed.
+    size_t mDequeuePos = 0;                         ///< Next position to pop. Only accessed by the consumer.
+    uint64_t mReportedDroppedCount = 0;             ///< Number of dropped messages already reported. Only accessed by the consumer.
+
+    std::mutex mControlMutex; ///< Serializes starting/stopping the writer thread.
+    std::thread mThread;
+    std::atomic<State> mState{State::Stopped};
+    std::atomic<bool> mEnabled{true};
+    std::atomic<bool> mStopRequested{false};
+    std::atomic<uint32_t> mActiveProducers{0}; ///< Number of producers inside enqueue() that may push a message.
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCond;  ///< Signaled to wake up the writer thread.
+    std::condition_variable mFlushCond; ///< Signaled when the writer thread has written a batch.
+    std::atomic<bool> mWriterIdle{false};
+    std::atomic<uint32_t> mFlushWaiters{0};
+};
+
+/// Stops the writer thread at static destruction if the application did not call Logger::shutdown().
+struct AsyncWriterGuard
+{
+    ~AsyncWriterGuard() { AsyncWriter::instance().stop(true); }
+} sAsyncWriterGuard;
+} // namespace
+
+void Logger::shutdown()
+{
+    AsyncWriter::instance().stop(false);
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    flushOutputs();
+    closeLogFile();
+}
+
+void Logger::flush()
+{
+    AsyncWriter::instance().flush();
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    flushOutputs();
+}
+
 inline const char* getLogLevelString(Logger::Level level)
 {
     switch (level)
@@ -146,48 +519,113 @@ private:
     std::set<std::string, std::less<>> mStrings;
 };
 
-void Logger::log(Level level, const std::string_view msg, Frequency frequency)
+/**
+ * Limits the number of messages per second reported from a single call site.
+ * Call sites are distributed over a number of shards to avoid contention between logging threads.
+ */
+class CallSiteRateLimiter
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    if (level <= sVerbosity)
+public:
+    static CallSiteRateLimiter& instance()
     {
-        std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+        static CallSiteRateLimiter sInstance;
+        return sInstance;
+    }
 
-        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
-            return;
+    /**
+     * Check if a message from a call site should be reported.
+     * @param[in] pCallSite Call site key.
+     * @param[in] maxMessagesPerSecond Maximum number of messages per second.
+     * @param[out] suppressedCount Number of messages suppressed in the previous window that have not been reported yet.
+     * @return True if the message should be reported.
+     */
+    bool shouldLog(const void* pCallSite, uint32_t maxMessagesPerSecond, uint64_t& suppressedCount)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        Shard& shard = mShards[std::hash<const void*>()(pCallSite) % kShardCount];
 
-        // Write to console.
-        if (is_set(sOutputs, OutputFlags::Console))
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        CallSite& site = shard.callSites[pCallSite];
+        suppressedCount = 0;
+        if (now - site.windowStart >= std::chrono::seconds(1))
         {
-            auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-            os << s;
-            os.flush();
+            suppressedCount = site.suppressedCount;
+            site.windowStart = now;
+            site.count = 0;
+            site.suppressedCount = 0;
         }
 
-        // Write to file.
-        if (is_set(sOutputs, OutputFlags::File))
+        if (site.count < maxMessagesPerSecond)
         {
-            printToLogFile(s);
+            ++site.count;
+            return true;
         }
 
-        // Write to debug window if debugger is attached.
-        if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-        {
-            printToDebugWindow(s);
-        }
+        ++site.suppressedCount;
+        sSuppressedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
+
+private:
+    static constexpr size_t kShardCount = 16;
+
+    struct CallSite
+    {
+        std::chrono::steady_clock::time_point windowStart;
+        uint32_t count = 0;
+        uint64_t suppressedCount = 0;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<const void*, CallSite> callSites;
+    };
+
+    CallSiteRateLimiter() = default;
+
+    Shard mShards[kShardCount];
+};
+
+void Logger::log(Level level, const std::string_view msg, Frequency frequency, const void* pCallSite)
+{
+    if (level > sVerbosity.load(std::memory_order_relaxed))
+        return;
+
+    uint64_t suppressedCount = 0;
+    const uint32_t rateLimit = sRateLimit.load(std::memory_order_relaxed);
+    if (pCallSite && rateLimit > 0 && level != Level::Fatal &&
+        !CallSiteRateLimiter::instance().shouldLog(pCallSite, rateLimit, suppressedCount))
+        return;
+
+    std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+
+    if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
+        return;
+
+    if (suppressedCount > 0)
+        s += fmt::format("{} {} similar messages were suppressed in the last second.\n", getLogLevelString(level), suppressedCount);
+
+    // Fatal errors are typically followed by process termination. Write all pending messages and the
+    // fatal message itself before returning.
+    if (level == Level::Fatal)
+        AsyncWriter::instance().flush();
+    else if (AsyncWriter::instance().enqueue(level, s))
+        return;
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    writeMessage(level, s);
+    flushOutputs();
 }
 
 void Logger::setVerbosity(Level level)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    sVerbosity = level;
+    sVerbosity.store(level);
 }
 
 Logger::Level Logger::getVerbosity()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    return sVerbosity;
+    return sVerbosity.load();
 }
 
 void Logger::setOutputs(OutputFlags outputs)
@@ -204,13 +642,11 @@ Logger::OutputFlags Logger::getOutputs()
 
 void Logger::setLogFilePath(const std::filesystem::path& path)
 {
+    // Write pending messages to the current log file first.
+    AsyncWriter::instance().flush();
+
     std::lock_guard<std::mutex> lock(sMutex);
-    if (sLogFile)
-    {
-        fclose(sLogFile);
-        sLogFile = nullptr;
-        sInitialized = false;
-    }
+    closeLogFile();
     sLogFilePath = path;
 }
 
@@ -220,6 +656,46 @@ std::filesystem::path Logger::getLogFilePath()
     return sLogFilePath;
 }
 
+void Logger::setAsyncEnabled(bool enabled)
+{
+    AsyncWriter::instance().setEnabled(enabled);
+}
+
+bool Logger::isAsyncEnabled()
+{
+    return AsyncWriter::instance().isEnabled();
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy)
+{
+    sOverflowPolicy.store(policy);
+}
+
+Logger::OverflowPolicy Logger::getOverflowPolicy()
+{
+    return sOverflowPolicy.load();
+}
+
+uint64_t Logger::getDroppedMessageCount()
+{
+    return sDroppedCount.load();
+}
+
+void Logger::setRateLimit(uint32_t maxMessagesPerSecond)
+{
+    sRateLimit.store(maxMessagesPerSecond);
+}
+
+uint32_t Logger::getRateLimit()
+{
+    return sRateLimit.load();
+}
+
+uint64_t Logger::getSuppressedMessageCount()
+{
+    return sSuppressedCount.load();
+}
+
 FALCOR_SCRIPT_BINDING(Logger)
 {
     using namespace pybind11::literals;
@@ -234,6 +710,10 @@ FALCOR_SCRIPT_BINDING(Logger)
     level.value("Info", Logger::Level::Info);
     level.value("Debug", Logger::Level::Debug);
 
+    pybind11::enum_<Logger::OverflowPolicy> overflowPolicy(logger, "OverflowPolicy");
+    overflowPolicy.value("Block", Logger::OverflowPolicy::Block);
+    overflowPolicy.value("Drop", Logger::OverflowPolicy::Drop);
+
     pybind11::enum_<Logger::OutputFlags> outputFlags(logger, "OutputFlags");
     outputFlags.value("None_", Logger::OutputFlags::None);
     outputFlags.value("Console", Logger::OutputFlags::Console);
@@ -256,6 +736,26 @@ FALCOR_SCRIPT_BINDING(Logger)
         [](pybind11::object, std::filesystem::path path) { Logger::setLogFilePath(path); }
     );
 
+    logger.def_property_static(
+        "async_enabled",
+        [](pybind11::object) { return Logger::isAsyncEnabled(); },
+        [](pybind11::object, bool enabled) { Logger::setAsyncEnabled(enabled); }
+    );
+    logger.def_property_static(
+        "overflow_policy",
+        [](pybind11::object) { return Logger::getOverflowPolicy(); },
+        [](pybind11::object, Logger::OverflowPolicy policy) { Logger::setOverflowPolicy(policy); }
+    );
+    logger.def_property_static(
+        "rate_limit",
+        [](pybind11::object) { return Logger::getRateLimit(); },
+        [](pybind11::object, uint32_t maxMessagesPerSecond) { Logger::setRateLimit(maxMessagesPerSecond); }
+    );
+    logger.def_property_readonly_static("dropped_message_count", [](pybind11::object) { return Logger::getDroppedMessageCount(); });
+    logger.def_property_readonly_static("suppressed_message_count", [](pybind11::object) { return Logger::getSuppressedMessageCount(); });
+
+    logger.def_static("flush", &Logger::flush);
+
     logger.def_static(
         "log",
         [](Logger::Level level, const std::string_view msg) { Logger::log(level, msg, Logger::Frequency::Always); },
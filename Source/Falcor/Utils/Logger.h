@@ -31,12 +31,17 @@
 #include <fmt/core.h>
 #include <string_view>
 #include <filesystem>
+#include <cstdint>
 
 namespace Falcor
 {
 /**
  * Container class for logging messages.
  * Messages are only printed to the selected outputs if they match the verbosity level.
+ *
+ * By default, messages are formatted on the calling thread and pushed into a bounded lock-free queue,
+ * which is drained by a background writer thread. Fatal messages flush the queue and are written synchronously.
+ * Call flush() to wait for all pending messages to be written.
  */
 class FALCOR_API Logger
 {
@@ -68,11 +73,70 @@ public:
         DebugWindow = 0x4, ///< Output to debug window (if debugger is attached).
     };
 
+    /// Behavior when the asynchronous message queue is full.
+    enum class OverflowPolicy
+    {
+        Block, ///< Block the logging thread until the writer thread has made room in the queue.
+        Drop,  ///< Drop the message and increment the dropped message count.
+    };
+
     /**
      * Shutdown the logger and close the log file.
+     * All pending messages are written before the log file is closed.
      */
     static void shutdown();
 
+    /**
+     * Block until all messages logged so far have been written to the outputs.
+     */
+    static void flush();
+
+    /**
+     * Enable/disable asynchronous logging.
+     * When disabled, messages are written synchronously on the logging thread.
+     * @param enabled True to write messages on a background thread.
+     */
+    static void setAsyncEnabled(bool enabled);
+
+    /**
+     * Check if asynchronous logging is enabled.
+     */
+    static bool isAsyncEnabled();
+
+    /**
+     * Set the policy for handling messages when the asynchronous queue is full.
+     * @param policy Overflow policy.
+     */
+    static void setOverflowPolicy(OverflowPolicy policy);
+
+    /**
+     * Get the policy for handling messages when the asynchronous queue is full.
+     */
+    static OverflowPolicy getOverflowPolicy();
+
+    /**
+     * Get the total number of messages dropped due to a full queue.
+     */
+    static uint64_t getDroppedMessageCount();
+
+    /**
+     * Set the maximum number of messages per second that are reported from a single call site.
+     * Only messages logged with a call site (i.e. the formatting log helpers) are rate limited.
+     * Fatal messages are never rate limited.
+     * @param maxMessagesPerSecond Maximum number of messages per second and call site, or 0 to disable rate limiting.
+     */
+    static void setRateLimit(uint32_t maxMessagesPerSecond);
+
+    /**
+     * Get the maximum number of messages per second that are reported from a single call site (0 if disabled).
+     */
+    static uint32_t getRateLimit();
+
+    /**
+     * Get the total number of messages suppressed by the rate limit.
+     */
+    static uint64_t getSuppressedMessageCount();
+
     /**
      * Set the logger verbosity.
      * @param level Log level.
@@ -113,8 +177,10 @@ public:
      * Log a message.
      * @param[in] level Log level.
      * @param[in] msg Log message.
+     * @param[in] frequency Log frequency.
+     * @param[in] pCallSite Key identifying the call site for rate limiting, or nullptr to disable rate limiting.
      */
-    static void log(Level level, const std::string_view msg, Frequency frequency = Frequency::Always);
+    static void log(Level level, const std::string_view msg, Frequency frequency = Frequency::Always, const void* pCallSite = nullptr);
 
 private:
     Logger() = delete;
@@ -125,6 +191,7 @@ FALCOR_ENUM_CLASS_OPERATORS(Logger::OutputFlags);
 // We define two types of logging helpers, one taking raw strings,
 // the other taking formatted strings. We don't want string formatting and
 // errors being thrown due to missing arguments when passing raw strings.
+// The formatting helpers use the address of the format string as the call site for rate limiting.
 
 inline void logDebug(const std::string_view msg)
 {
@@ -134,7 +201,7 @@ inline void logDebug(const std::string_view msg)
 template<typename... Args>
 inline void logDebug(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...));
+    Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Always, fmt::string_view(format).data());
 }
 
 inline void logInfo(const std::string_view msg)
@@ -145,7 +212,7 @@ inline void logInfo(const std::string_view msg)
 template<typename... Args>
 inline void logInfo(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...));
+    Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Always, fmt::string_view(format).data());
 }
 
 inline void logWarning(const std::string_view msg)
@@ -156,7 +223,7 @@ inline void logWarning(const std::string_view msg)
 template<typename... Args>
 inline void logWarning(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
+    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Always, fmt::string_view(format).data());
 }
 
 inline void logWarningOnce(const std::string_view msg)
@@ -167,7 +234,7 @@ inline void logWarningOnce(const std::string_view msg)
 template<typename... Args>
 inline void logWarningOnce(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once, fmt::string_view(format).data());
 }
 
 inline void logError(const std::string_view msg)
@@ -178,7 +245,7 @@ inline void logError(const std::string_view msg)
 template<typename... Args>
 inline void logError(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
+    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Always, fmt::string_view(format).data());
 }
 
 inline void logErrorOnce(const std::string_view msg)
@@ -189,7 +256,7 @@ inline void logErrorOnce(const std::string_view msg)
 template<typename... Args>
 inline void logErrorOnce(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once, fmt::string_view(format).data());
 }
 
 inline void logFatal(const std::string_view msg)
@@ -200,7 +267,7 @@ inline void logFatal(const std::string_view msg)
 template<typename... Args>
 inline void logFatal(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...));
+    Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Always, fmt::string_view(format).data());
 }
 
 } // namespace Falcor
@@ -0,0 +1,603 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FormatConversion.h"
+#include "Float16.h"
+#include "Core/Error.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define FORMAT_CONVERSION_SSE2 1
+#endif
+
+#if FALCOR_MSVC
+#define FORMAT_CONVERSION_TARGET(isa)
+#else
+#define FORMAT_CONVERSION_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace Falcor
+{
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//                          Scalar implementations
+///////////////////////////////////////////////////////////////////////////////
+
+void float16ToFloat32Scalar(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = math::float16ToFloat32(pSrc[i]);
+}
+
+void float32ToFloat16Scalar(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = math::float32ToFloat16(pSrc[i]);
+}
+
+template<typename SrcT>
+void intToNormalizedFloat32Scalar(const SrcT* pSrc, float* pDst, size_t count)
+{
+    const float scale = float(std::numeric_limits<SrcT>::max());
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float(pSrc[i]) / scale;
+}
+
+void expandRGB8ToRGBA8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        pDst[i * 4 + 0] = pSrc[i * 3 + 0];
+        pDst[i * 4 + 1] = pSrc[i * 3 + 1];
+        pDst[i * 4 + 2] = pSrc[i * 3 + 2];
+        pDst[i * 4 + 3] = alpha;
+    }
+}
+
+void swizzleRGBA8ToBGRA8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque)
+{
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        uint8_t r = pSrc[i * 4 + 0];
+        uint8_t g = pSrc[i * 4 + 1];
+        uint8_t b = pSrc[i * 4 + 2];
+        uint8_t a = pSrc[i * 4 + 3];
+        pDst[i * 4 + 0] = b;
+        pDst[i * 4 + 1] = g;
+        pDst[i * 4 + 2] = r;
+        pDst[i * 4 + 3] = forceOpaque ? 0xff : a;
+    }
+}
+
+#if FORMAT_CONVERSION_SSE2
+
+///////////////////////////////////////////////////////////////////////////////
+//                          SIMD implementations
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Converts float16 to float32 using F16C. The results are bit-identical to math::float16ToFloat32(),
+ * except that vcvtph2ps sets the quiet bit of signaling NaNs. Sign and payload are preserved.
+ */
+FORMAT_CONVERSION_TARGET("avx,f16c") void float16ToFloat32F16C(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm256_storeu_ps(pDst + i, _mm256_cvtph_ps(h));
+    }
+    float16ToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+/**
+ * Converts 4 floats to float16 with the same rounding as math::float32ToFloat16().
+ * F16C is not used here as it rounds ties to even, while float16_t rounds ties away from zero.
+ * Normal results (including overflow to inf) are computed directly, values below the smallest
+ * denormal are flushed to zero. Returns a mask of the lanes that need the scalar path (denormals and NaN).
+ */
+inline int float32ToFloat16x4(const float* pSrc, __m128i& result)
+{
+    const __m128i kAbsMask = _mm_set1_epi32(0x7fffffff);
+    const __m128i kMinNormal = _mm_set1_epi32(0x38800000);   // 2^-14, smallest normal float16.
+    const __m128i kMinDenormal = _mm_set1_epi32(0x33000000); // 2^-25, smaller values round to zero.
+    const __m128i kInf = _mm_set1_epi32(0x7f800000);
+    const __m128i kBias = _mm_set1_epi32((127 - 15) << 23);
+    const __m128i kRound = _mm_set1_epi32(0x1000);
+    const __m128i kHalfInf = _mm_set1_epi32(0x7c00);
+
+    __m128i bits = _mm_castps_si128(_mm_loadu_ps(pSrc));
+    __m128i abs = _mm_and_si128(bits, kAbsMask);
+    __m128i sign = _mm_srli_epi32(_mm_andnot_si128(kAbsMask, bits), 16);
+
+    __m128i h = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(abs, kBias), kRound), 13);
+    __m128i overflow = _mm_cmpgt_epi32(h, kHalfInf);
+    h = _mm_or_si128(_mm_and_si128(overflow, kHalfInf), _mm_andnot_si128(overflow, h));
+    __m128i tiny = _mm_cmplt_epi32(abs, kMinDenormal);
+    h = _mm_andnot_si128(tiny, h);
+    result = _mm_or_si128(h, sign);
+
+    __m128i denormal = _mm_andnot_si128(tiny, _mm_cmplt_epi32(abs, kMinNormal));
+    __m128i nan = _mm_cmpgt_epi32(abs, kInf);
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(denormal, nan)));
+}
+
+void float32ToFloat16SSE2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    // Values are biased to signed range for the saturating pack and unbiased afterwards.
+    const __m128i kPackBias32 = _mm_set1_epi32(0x8000);
+    const __m128i kPackBias16 = _mm_set1_epi16(int16_t(0x8000));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo, hi;
+        int slowMask = float32ToFloat16x4(pSrc + i, lo) | (float32ToFloat16x4(pSrc + i + 4, hi) << 4);
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, kPackBias32), _mm_sub_epi32(hi, kPackBias32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_xor_si128(packed, kPackBias16));
+
+        while (slowMask)
+        {
+            int lane = 0;
+            while (!(slowMask & (1 << lane)))
+                ++lane;
+            pDst[i + lane] = math::float32ToFloat16(pSrc[i + lane]);
+            slowMask &= ~(1 << lane);
+        }
+    }
+    float32ToFloat16Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void intToNormalizedFloat32SSE2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    const __m128 kScale = _mm_set1_ps(float(std::numeric_limits<uint16_t>::max()));
+    const __m128i kZero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm_storeu_ps(pDst + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, kZero)), kScale));
+        _mm_storeu_ps(pDst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, kZero)), kScale));
+    }
+    intToNormalizedFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void intToNormalizedFloat32SSE2(const int16_t* pSrc, float* pDst, size_t count)
+{
+    const __m128 kScale = _mm_set1_ps(float(std::numeric_limits<int16_t>::max()));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // Sign extend by placing the values in the high half of each dword and shifting down.
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(pDst + i, _mm_div_ps(_mm_cvtepi32_ps(lo), kScale));
+        _mm_storeu_ps(pDst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(hi), kScale));
+    }
+    intToNormalizedFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void intToNormalizedFloat32SSE2(const uint32_t* pSrc, float* pDst, size_t count)
+{
+    const __m128 kScale = _mm_set1_ps(float(std::numeric_limits<uint32_t>::max()));
+    const __m128 k65536 = _mm_set1_ps(65536.f);
+    const __m128i kLoMask = _mm_set1_epi32(0xffff);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // There is no unsigned conversion in SSE2. Both halves convert exactly, so the sum is rounded once.
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(v, 16)), k65536);
+        __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, kLoMask));
+        _mm_storeu_ps(pDst + i, _mm_div_ps(_mm_add_ps(hi, lo), kScale));
+    }
+    intToNormalizedFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void intToNormalizedFloat32SSE2(const int32_t* pSrc, float* pDst, size_t count)
+{
+    const __m128 kScale = _mm_set1_ps(float(std::numeric_limits<int32_t>::max()));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm_storeu_ps(pDst + i, _mm_div_ps(_mm_cvtepi32_ps(v), kScale));
+    }
+    intToNormalizedFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void expandRGB32FloatToRGBA32FloatSSE2(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    const __m128 kRGBMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 kAlpha = _mm_set_ps(1.f, 0.f, 0.f, 0.f);
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        // a = r0 g0 b0 r1, b = g1 b1 r2 g2, c = b2 r3 g3 b3
+        __m128 a = _mm_loadu_ps(pSrc + i * 3);
+        __m128 b = _mm_loadu_ps(pSrc + i * 3 + 4);
+        __m128 c = _mm_loadu_ps(pSrc + i * 3 + 8);
+        __m128 t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 3)); // r1 r1 g1 b1
+        __m128 p1 = _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(3, 3, 2, 0));
+        __m128 p2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));
+        __m128 p3 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 2, 1));
+        _mm_storeu_ps(pDst + i * 4, _mm_or_ps(_mm_and_ps(a, kRGBMask), kAlpha));
+        _mm_storeu_ps(pDst + i * 4 + 4, _mm_or_ps(_mm_and_ps(p1, kRGBMask), kAlpha));
+        _mm_storeu_ps(pDst + i * 4 + 8, _mm_or_ps(_mm_and_ps(p2, kRGBMask), kAlpha));
+        _mm_storeu_ps(pDst + i * 4 + 12, _mm_or_ps(_mm_and_ps(p3, kRGBMask), kAlpha));
+    }
+    for (; i < pixelCount; ++i)
+    {
+        pDst[i * 4 + 0] = pSrc[i * 3 + 0];
+        pDst[i * 4 + 1] = pSrc[i * 3 + 1];
+        pDst[i * 4 + 2] = pSrc[i * 3 + 2];
+        pDst[i * 4 + 3] = 1.f;
+    }
+}
+
+void convertRGBA32FloatToRGB32FloatSSE2(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128 p0 = _mm_loadu_ps(pSrc + i * 4);
+        __m128 p1 = _mm_loadu_ps(pSrc + i * 4 + 4);
+        __m128 p2 = _mm_loadu_ps(pSrc + i * 4 + 8);
+        __m128 p3 = _mm_loadu_ps(pSrc + i * 4 + 12);
+        __m128 t0 = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 2, 2)); // b0 b0 r1 r1
+        __m128 t2 = _mm_shuffle_ps(p2, p3, _MM_SHUFFLE(0, 0, 2, 2)); // b2 b2 r3 r3
+        _mm_storeu_ps(pDst + i * 3, _mm_shuffle_ps(p0, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(pDst + i * 3 + 4, _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(1, 0, 2, 1)));
+        _mm_storeu_ps(pDst + i * 3 + 8, _mm_shuffle_ps(t2, p3, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+    for (; i < pixelCount; ++i)
+    {
+        pDst[i * 3 + 0] = pSrc[i * 4 + 0];
+        pDst[i * 3 + 1] = pSrc[i * 4 + 1];
+        pDst[i * 3 + 2] = pSrc[i * 4 + 2];
+    }
+}
+
+FORMAT_CONVERSION_TARGET("ssse3") void expandRGB8ToRGBA8SSSE3(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    const __m128i kShuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i kAlpha = _mm_set1_epi32(int32_t(uint32_t(alpha) << 24));
+    size_t i = 0;
+    // Each iteration reads 16 bytes but consumes only 4 pixels, so stop while at least 6 pixels remain.
+    for (; i + 6 <= pixelCount; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, kShuffle), kAlpha));
+    }
+    expandRGB8ToRGBA8Scalar(pSrc + i * 3, pDst + i * 4, pixelCount - i, alpha);
+}
+
+void swizzleRGBA8ToBGRA8SSE2(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque)
+{
+    const __m128i kRBMask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i kAlpha = _mm_set1_epi32(forceOpaque ? int32_t(0xff000000) : 0);
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 4));
+        __m128i rb = _mm_and_si128(v, kRBMask);
+        __m128i ga = _mm_andnot_si128(kRBMask, v);
+        __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), _mm_or_si128(_mm_or_si128(ga, br), kAlpha));
+    }
+    swizzleRGBA8ToBGRA8Scalar(pSrc + i * 4, pDst + i * 4, pixelCount - i, forceOpaque);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                          Runtime dispatch
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t readXCR0()
+{
+#if FALCOR_MSVC
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+#endif
+}
+
+struct CpuFeatures
+{
+    bool ssse3 = false;
+    bool f16c = false;
+};
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+    uint32_t ecx = 0;
+#if FALCOR_MSVC
+    int info[4];
+    __cpuid(info, 1);
+    ecx = uint32_t(info[2]);
+#else
+    uint32_t eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return features;
+#endif
+    features.ssse3 = (ecx & (1u << 9)) != 0;
+    // F16C instructions are VEX encoded, which also requires the OS to save the AVX register state.
+    const bool osxsave = (ecx & (1u << 27)) != 0;
+    const bool avx = (ecx & (1u << 28)) != 0;
+    const bool f16c = (ecx & (1u << 29)) != 0;
+    features.f16c = osxsave && avx && f16c && (readXCR0() & 0x6) == 0x6;
+    return features;
+}
+
+#endif // FORMAT_CONVERSION_SSE2
+
+/// Kernels that depend on instruction sets beyond the compile-time baseline.
+struct Kernels
+{
+    void (*float16ToFloat32)(const uint16_t*, float*, size_t) = float16ToFloat32Scalar;
+    void (*expandRGB8ToRGBA8)(const uint8_t*, uint8_t*, size_t, uint8_t) = expandRGB8ToRGBA8Scalar;
+};
+
+const Kernels& getKernels()
+{
+    static const Kernels kernels = []()
+    {
+        Kernels k;
+#if FORMAT_CONVERSION_SSE2
+        CpuFeatures features = detectCpuFeatures();
+        if (features.f16c)
+            k.float16ToFloat32 = float16ToFloat32F16C;
+        if (features.ssse3)
+            k.expandRGB8ToRGBA8 = expandRGB8ToRGBA8SSSE3;
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                          sRGB tables
+///////////////////////////////////////////////////////////////////////////////
+
+double srgbToLinear(double v)
+{
+    return v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+}
+
+double linearToSrgb(double v)
+{
+    return v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055;
+}
+
+uint8_t linearToSrgb8Reference(float v)
+{
+    return uint8_t(std::floor(linearToSrgb(v) * 255.0 + 0.5));
+}
+
+struct SrgbTables
+{
+    static constexpr uint32_t kBucketCount = 4096;
+
+    std::array<float, 256> decode;
+    /// Smallest linear value that encodes to code i, for i in [1,255]. Entry 0 is unused, entry 256 is infinity.
+    std::array<float, 257> threshold;
+    /// Code of the lower bound of each bucket of width 1/kBucketCount.
+    std::array<uint8_t, kBucketCount + 1> bucket;
+
+    SrgbTables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+            decode[i] = float(srgbToLinear(i / 255.0));
+
+        // Thresholds are the first float32 values that round up to the next code.
+        threshold[0] = 0.f;
+        for (uint32_t i = 1; i < 256; ++i)
+        {
+            float t = float(srgbToLinear((i - 0.5) / 255.0));
+            while (linearToSrgb8Reference(t) >= i)
+                t = std::nextafter(t, 0.f);
+            while (linearToSrgb8Reference(t) < i)
+                t = std::nextafter(t, 1.f);
+            threshold[i] = t;
+        }
+        threshold[256] = std::numeric_limits<float>::infinity();
+
+        // The buckets are narrower than the spacing of the thresholds, so each bucket contains at most one threshold.
+        uint32_t code = 0;
+        for (uint32_t k = 0; k <= kBucketCount; ++k)
+        {
+            const float v = float(k) / kBucketCount;
+            while (code < 255 && v >= threshold[code + 1])
+                ++code;
+            FALCOR_ASSERT(k == 0 || code - bucket[k - 1] <= 1);
+            bucket[k] = uint8_t(code);
+        }
+    }
+
+    uint8_t encode(float v) const
+    {
+        // Clamp to [0,1], mapping NaN to zero.
+        v = v > 0.f ? v : 0.f;
+        v = v < 1.f ? v : 1.f;
+        uint32_t code = bucket[uint32_t(v * kBucketCount)];
+        return uint8_t(code + (v >= threshold[code + 1] ? 1 : 0));
+    }
+};
+
+const SrgbTables& getSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+} // namespace
+
+void convertFloat16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().float16ToFloat32(pSrc, pDst, count);
+}
+
+void convertFloat32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count)
+{
+#if FORMAT_CONVERSION_SSE2
+    float32ToFloat16SSE2(pSrc, pDst, count);
+#else
+    float32ToFloat16Scalar(pSrc, pDst, count);
+#endif
+}
+
+#if FORMAT_CONVERSION_SSE2
+#define FORMAT_CONVERSION_INT_TO_FLOAT intToNormalizedFloat32SSE2
+#else
+#define FORMAT_CONVERSION_INT_TO_FLOAT intToNormalizedFloat32Scalar
+#endif
+
+void convertIntToNormalizedFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    FORMAT_CONVERSION_INT_TO_FLOAT(pSrc, pDst, count);
+}
+
+void convertIntToNormalizedFloat32(const int16_t* pSrc, float* pDst, size_t count)
+{
+    FORMAT_CONVERSION_INT_TO_FLOAT(pSrc, pDst, count);
+}
+
+void convertIntToNormalizedFloat32(const uint32_t* pSrc, float* pDst, size_t count)
+{
+    FORMAT_CONVERSION_INT_TO_FLOAT(pSrc, pDst, count);
+}
+
+void convertIntToNormalizedFloat32(const int32_t* pSrc, float* pDst, size_t count)
+{
+    FORMAT_CONVERSION_INT_TO_FLOAT(pSrc, pDst, count);
+}
+
+#undef FORMAT_CONVERSION_INT_TO_FLOAT
+
+void expandToRGBA32Float(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount)
+{
+    FALCOR_ASSERT(channelCount >= 1 && channelCount <= 4);
+    switch (channelCount)
+    {
+    case 4:
+        if (pixelCount > 0)
+            std::memcpy(pDst, pSrc, pixelCount * 4 * sizeof(float));
+        break;
+    case 3:
+#if FORMAT_CONVERSION_SSE2
+        expandRGB32FloatToRGBA32FloatSSE2(pSrc, pDst, pixelCount);
+        break;
+#endif
+    default:
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+                pDst[i * 4 + c] = c < channelCount ? pSrc[i * channelCount + c] : 0.f;
+            pDst[i * 4 + 3] = 1.f;
+        }
+        break;
+    }
+}
+
+void convertRGBA32FloatToRGB32Float(const float* pSrc, float* pDst, size_t pixelCount)
+{
+#if FORMAT_CONVERSION_SSE2
+    convertRGBA32FloatToRGB32FloatSSE2(pSrc, pDst, pixelCount);
+#else
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        pDst[i * 3 + 0] = pSrc[i * 4 + 0];
+        pDst[i * 3 + 1] = pSrc[i * 4 + 1];
+        pDst[i * 3 + 2] = pSrc[i * 4 + 2];
+    }
+#endif
+}
+
+void expandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    getKernels().expandRGB8ToRGBA8(pSrc, pDst, pixelCount, alpha);
+}
+
+void swizzleRGBA8ToBGRA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque)
+{
+#if FORMAT_CONVERSION_SSE2
+    swizzleRGBA8ToBGRA8SSE2(pSrc, pDst, pixelCount, forceOpaque);
+#else
+    swizzleRGBA8ToBGRA8Scalar(pSrc, pDst, pixelCount, forceOpaque);
+#endif
+}
+
+void convertSrgb8ToFloat32(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const auto& decode = getSrgbTables().decode;
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = decode[pSrc[i]];
+}
+
+void convertFloat32ToSrgb8(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const SrgbTables& tables = getSrgbTables();
+    size_t i = 0;
+#if FORMAT_CONVERSION_SSE2
+    // Clamp and compute the bucket indices with SIMD, the table lookups are scalar.
+    const __m128 kZero = _mm_setzero_ps();
+    const __m128 kOne = _mm_set1_ps(1.f);
+    const __m128 kBucketCount = _mm_set1_ps(float(SrgbTables::kBucketCount));
+    alignas(16) float clamped[4];
+    alignas(16) int32_t index[4];
+    for (; i + 4 <= count; i += 4)
+    {
+        // maxps returns the second operand if either is NaN, which maps NaN to zero.
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + i), kZero), kOne);
+        _mm_store_ps(clamped, v);
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(_mm_mul_ps(v, kBucketCount)));
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            uint32_t code = tables.bucket[index[j]];
+            pDst[i + j] = uint8_t(code + (clamped[j] >= tables.threshold[code + 1] ? 1 : 0));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        pDst[i] = tables.encode(pSrc[i]);
+}
+
+} // namespace Falcor
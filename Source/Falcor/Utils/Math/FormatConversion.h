@@ -29,6 +29,9 @@
 
 #include "ScalarMath.h"
 #include "Vector.h"
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
 
 namespace Falcor
 {
@@ -90,4 +93,97 @@ inline uint packSnorm2x16(float2 v)
     return (floatToSnorm16(v.x) & 0x0000ffff) | (floatToSnorm16(v.y) << 16);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//                          Bulk pixel conversion
+///////////////////////////////////////////////////////////////////////////////
+
+// The functions below convert arrays of pixel data. They use SIMD instructions
+// when available, with the instruction set selected once at runtime based on the
+// CPU. All results are bit-identical to the scalar conversions (e.g. float16_t),
+// with the exception that signaling NaNs may be returned as quiet NaNs.
+
+/**
+ * Convert an array of float16 values to float32.
+ * @param[in] pSrc Source float16 values (bit patterns).
+ * @param[out] pDst Destination float32 values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Convert an array of float32 values to float16.
+ * Rounding matches math::float32ToFloat16(), values out of range are converted to +-inf.
+ * @param[in] pSrc Source float32 values.
+ * @param[out] pDst Destination float16 values (bit patterns).
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count);
+
+/**
+ * Convert an array of integers to normalized float32 values.
+ * Each value is divided by the largest value of the integer type, i.e. unsigned integers
+ * map to [0,1] and signed integers to approximately [-1,1] (the smallest value is not clamped).
+ * @param[in] pSrc Source integer values.
+ * @param[out] pDst Destination float32 values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertIntToNormalizedFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToNormalizedFloat32(const int16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToNormalizedFloat32(const uint32_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToNormalizedFloat32(const int32_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Expand float32 pixels with 1-4 channels to RGBA.
+ * Missing color channels are set to zero and a missing alpha channel to one.
+ * @param[in] pSrc Source pixels with tightly packed channels.
+ * @param[in] channelCount Number of channels in the source pixels (1-4).
+ * @param[out] pDst Destination RGBA pixels. Must not overlap the source.
+ * @param[in] pixelCount Number of pixels.
+ */
+FALCOR_API void expandToRGBA32Float(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount);
+
+/**
+ * Convert float32 RGBA pixels to RGB by dropping the alpha channel.
+ * @param[in] pSrc Source RGBA pixels.
+ * @param[out] pDst Destination RGB pixels. Must not overlap the source.
+ * @param[in] pixelCount Number of pixels.
+ */
+FALCOR_API void convertRGBA32FloatToRGB32Float(const float* pSrc, float* pDst, size_t pixelCount);
+
+/**
+ * Expand 8-bit 3-channel pixels to 4 channels. The channel order is preserved,
+ * so this works equally for RGB->RGBA and BGR->BGRA.
+ * @param[in] pSrc Source pixels (3 bytes per pixel).
+ * @param[out] pDst Destination pixels (4 bytes per pixel). Must not overlap the source.
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] alpha Value written to the fourth channel.
+ */
+FALCOR_API void expandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha = 0xff);
+
+/**
+ * Swap the first and third channel of 8-bit 4-channel pixels (RGBA <-> BGRA).
+ * @param[in] pSrc Source pixels.
+ * @param[out] pDst Destination pixels. May be equal to the source for in-place conversion.
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] forceOpaque If true, the fourth channel is set to 0xff.
+ */
+FALCOR_API void swizzleRGBA8ToBGRA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque = false);
+
+/**
+ * Convert 8-bit sRGB encoded values to linear float32 values.
+ * @param[in] pSrc Source sRGB values.
+ * @param[out] pDst Destination linear values in [0,1].
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertSrgb8ToFloat32(const uint8_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Convert linear float32 values to 8-bit sRGB encoded values.
+ * Values are clamped to [0,1] (NaN maps to zero) and rounded to nearest.
+ * @param[in] pSrc Source linear values.
+ * @param[out] pDst Destination sRGB values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToSrgb8(const float* pSrc, uint8_t* pDst, size_t count);
+
 } // namespace Falcor
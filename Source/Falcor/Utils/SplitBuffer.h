@@ -32,8 +32,10 @@
 #include "Core/Program/ShaderVar.h"
 #include "Core/Error.h"
 
-#include <vector>
+#include <fstd/span.h> // TODO C++20: Replace with <span>
 #include <fmt/format.h>
+#include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -93,6 +95,7 @@ public:
     uint32_t insert(Iter first, Iter last)
     {
         FALCOR_ASSERT(mGpuBuffers.empty(), "Cannot insert after creating GPU buffers.");
+        FALCOR_ASSERT(!hasExternalCpuData(), "Cannot insert into external CPU data.");
         if (first == last)
             return 0;
         const size_t itemCount = std::distance(first, last);
@@ -125,6 +128,7 @@ public:
     uint32_t insertEmpty(size_t itemCount)
     {
         FALCOR_ASSERT(mGpuBuffers.empty(), "Cannot insert after creating GPU buffers.");
+        FALCOR_ASSERT(!hasExternalCpuData(), "Cannot insert into external CPU data.");
         if (itemCount == 0)
             return 0;
 
@@ -152,22 +156,40 @@ public:
         return ((bufferIndex << kBufferIndexOffset) | elementIndex);
     }
 
+    /// Sets the CPU data to views of externally owned memory (e.g., a memory-mapped file) without copying it.
+    /// The storage object is kept alive as long as the CPU data is in use. The external data is read-only,
+    /// further inserts are not possible.
+    void setExternalCpuData(std::vector<fstd::span<const T>> buffers, std::shared_ptr<const void> pStorage)
+    {
+        FALCOR_ASSERT(mGpuBuffers.empty(), "Cannot set CPU data after creating GPU buffers.");
+        FALCOR_CHECK(buffers.size() <= kMaxBufferCount, "Cannot exceed the max number of buffers ({}).", kMaxBufferCount);
+        for (const auto& buffer : buffers)
+            FALCOR_CHECK(buffer.size() * sizeof(T) <= kBufferSizeLimit, "Buffer {} exceeds the buffer size limit.", mBufferName);
+        mCpuBuffers.clear();
+        mExternalCpuBuffers = std::move(buffers);
+        mpExternalStorage = std::move(pStorage);
+    }
+
+    /// True when the CPU data references external memory.
+    bool hasExternalCpuData() const { return mpExternalStorage != nullptr; }
+
     /// Creates the GPU buffers, locking further inserts.
     /// Will clear any existing GPU buffers.
     void createGpuBuffers(const ref<Device>& mpDevice, ResourceBindFlags bindFlags)
     {
         mGpuBuffers.clear();
-        mGpuBuffers.reserve(mCpuBuffers.size());
-        for (size_t i = 0; i < mCpuBuffers.size(); ++i)
+        mGpuBuffers.reserve(getCpuBufferCount());
+        for (size_t i = 0; i < getCpuBufferCount(); ++i)
         {
-            if (mCpuBuffers[i].empty())
+            fstd::span<const T> cpuData = getCpuData(i);
+            if (cpuData.empty())
             {
                 mGpuBuffers.push_back({});
                 continue;
             }
 
             ref<Buffer> buffer = mpDevice->createStructuredBuffer(
-                sizeof(T), mCpuBuffers[i].size(), bindFlags, MemoryType::DeviceLocal, mCpuBuffers[i].data(), false
+                sizeof(T), cpuData.size(), bindFlags, MemoryType::DeviceLocal, cpuData.data(), false
             );
             buffer->setName(fmt::format("SplitBuffer:{}:[{}]", mBufferName, i));
             mGpuBuffers.push_back(std::move(buffer));
@@ -182,6 +204,9 @@ public:
         for (auto& it : mCpuBuffers)
             if (!it.empty())
                 return false;
+        for (auto& it : mExternalCpuBuffers)
+            if (!it.empty())
+                return false;
         for (auto& it : mGpuBuffers)
             if (it)
                 return false;
@@ -193,17 +218,17 @@ public:
     {
         // We check both CPU and GPU buffers, to get correct answer even before `createGpuBuffers`
         // and after `dropCpuBuffers`
-        return std::max(mCpuBuffers.size(), mGpuBuffers.size());
+        return std::max(getCpuBufferCount(), mGpuBuffers.size());
     }
 
     /// Total number of bytes used by the buffers (mostly for statistics)
     size_t getByteSize() const
     {
         size_t result = 0;
-        if (!mCpuBuffers.empty())
+        if (hasCpuData())
         {
-            for (auto& it : mCpuBuffers)
-                result += it.size() * sizeof(T);
+            for (size_t i = 0; i < getCpuBufferCount(); ++i)
+                result += getCpuData(i).size_bytes();
         }
         else
         {
@@ -220,31 +245,52 @@ public:
     /// Access to the CPU data via index returned from `insert`
     const T& operator[](uint32_t index) const
     {
-        FALCOR_ASSERT(!mCpuBuffers.empty());
+        FALCOR_ASSERT(hasCpuData());
         const uint32_t bufferIndex = getBufferIndex(index);
         const uint32_t elementIndex = getElementIndex(index);
-        return mCpuBuffers[bufferIndex][elementIndex];
+        return getCpuData(bufferIndex)[elementIndex];
     }
 
     /// Access to the CPU data via index returned from `insert`
     T& operator[](uint32_t index)
     {
         FALCOR_ASSERT(!mCpuBuffers.empty());
+        FALCOR_ASSERT(!hasExternalCpuData(), "External CPU data is read-only.");
         const uint32_t bufferIndex = getBufferIndex(index);
         const uint32_t elementIndex = getElementIndex(index);
         return mCpuBuffers[bufferIndex][elementIndex];
     }
 
     /// Removes all CPU data, to conserve memory.
-    void dropCpuData() { mCpuBuffers.clear(); }
+    void dropCpuData()
+    {
+        mCpuBuffers.clear();
+        mExternalCpuBuffers.clear();
+        mpExternalStorage.reset();
+    }
 
     /// True when there is any CPU buffer present.
-    bool hasCpuData() const { return !mCpuBuffers.empty(); }
+    bool hasCpuData() const { return !mCpuBuffers.empty() || !mExternalCpuBuffers.empty(); }
 
     /// Return a GPU buffer, indexed by buffer index.
     ref<Buffer> getGpuBuffer(uint32_t bufferIndex) const { return mGpuBuffers[bufferIndex]; }
 
-    const std::vector<T>& getCpuBuffer(uint32_t bufferIndex) const { return mCpuBuffers[bufferIndex]; }
+    const std::vector<T>& getCpuBuffer(uint32_t bufferIndex) const
+    {
+        FALCOR_ASSERT(!hasExternalCpuData(), "Use getCpuData() to access external CPU data.");
+        return mCpuBuffers[bufferIndex];
+    }
+
+    /// Return a view of the CPU data of a buffer, indexed by buffer index. Works for both owned and external CPU data.
+    fstd::span<const T> getCpuData(size_t bufferIndex) const
+    {
+        if (hasExternalCpuData())
+            return mExternalCpuBuffers[bufferIndex];
+        return fstd::span<const T>(mCpuBuffers[bufferIndex].data(), mCpuBuffers[bufferIndex].size());
+    }
+
+    /// Returns the number of CPU buffers.
+    size_t getCpuBufferCount() const { return hasExternalCpuData() ? mExternalCpuBuffers.size() : mCpuBuffers.size(); }
 
     /// Gets GPU address of the index returned from `insert`
     uint64_t getGpuAddress(uint32_t index) const
@@ -290,6 +336,8 @@ private:
     std::string mBufferName;
     std::string mBufferCountDefinePrefix;
     std::vector<std::vector<T>> mCpuBuffers;
+    std::vector<fstd::span<const T>> mExternalCpuBuffers; ///< Views of external CPU data (used instead of mCpuBuffers if set).
+    std::shared_ptr<const void> mpExternalStorage;        ///< Keeps the external CPU data alive.
     std::vector<ref<Buffer>> mGpuBuffers;
 
     friend class SceneCache;
@@ -27,17 +27,199 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Error.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <vector>
 
 namespace Falcor
 {
+struct Threading::Task::State
+{
+    std::function<void(void)> func;
+    std::atomic<bool> done{false};
+    std::exception_ptr exception;
+    std::atomic<bool> exceptionObserved{false}; ///< True once the exception has been rethrown by Task::finish().
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::shared_ptr<State>> continuations; ///< Tasks to dispatch when this task finishes (protected by mutex).
+
+    ~State()
+    {
+        // Only report exceptions of fire-and-forget tasks. Exceptions of waited-on tasks are rethrown to the caller instead.
+        if (exception && !exceptionObserved.load())
+        {
+            try
+            {
+                std::rethrow_exception(exception);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Unhandled exception in dispatched task: {}", e.what());
+            }
+            catch (...)
+            {
+                logWarning("Unhandled unknown exception in dispatched task.");
+            }
+        }
+    }
+};
+
 namespace
 {
+using TaskStatePtr = std::shared_ptr<Threading::Task::State>;
+
+/// Per-worker task deque. The owning worker uses the back, thieves use the front.
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<TaskStatePtr> tasks;
+};
+
 struct ThreadingData
 {
     bool initialized = false;
     std::vector<std::thread> threads;
-    uint32_t current;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<uint32_t> nextQueue{0};
+    std::atomic<bool> terminate{false};
+
+    std::atomic<size_t> queuedCount{0};   ///< Number of tasks in the queues.
+    std::atomic<size_t> pendingCount{0};  ///< Number of tasks queued or executing.
+    std::atomic<uint32_t> sleepingCount{0};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCond; ///< Signaled when tasks are queued or the pool terminates.
+    std::condition_variable idleCond; ///< Signaled when the pool runs out of pending tasks.
 } gData; // TODO: REMOVEGLOBAL
+
+/// Index of the worker owning the current thread, or kInvalidWorker for non-worker threads.
+constexpr uint32_t kInvalidWorker = uint32_t(-1);
+thread_local uint32_t tWorkerIndex = kInvalidWorker;
+
+void pushTask(TaskStatePtr pState)
+{
+    const uint32_t queueCount = (uint32_t)gData.queues.size();
+    FALCOR_ASSERT(queueCount > 0);
+    uint32_t index = tWorkerIndex < queueCount ? tWorkerIndex : gData.nextQueue.fetch_add(1, std::memory_order_relaxed) % queueCount;
+
+    gData.pendingCount.fetch_add(1);
+    {
+        WorkQueue& queue = *gData.queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(pState));
+    }
+    gData.queuedCount.fetch_add(1);
+
+    // Only touch the wake mutex if a worker is (about to go) asleep.
+    if (gData.sleepingCount.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gData.wakeMutex);
+        }
+        gData.wakeCond.notify_one();
+    }
+}
+
+TaskStatePtr popTask()
+{
+    if (gData.queuedCount.load() == 0)
+        return nullptr;
+
+    const uint32_t queueCount = (uint32_t)gData.queues.size();
+    const uint32_t self = tWorkerIndex;
+
+    // Pop from the back of our own queue first (most recently spawned, likely cache hot).
+    if (self < queueCount)
+    {
+        WorkQueue& queue = *gData.queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            TaskStatePtr pState = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            gData.queuedCount.fetch_sub(1);
+            return pState;
+        }
+    }
+
+    // Steal from the front of the other queues.
+    static thread_local uint32_t tStealStart = 0;
+    uint32_t start = self < queueCount ? self + 1 : tStealStart++;
+    for (uint32_t i = 0; i < queueCount; ++i)
+    {
+        uint32_t index = (start + i) % queueCount;
+        if (index == self)
+            continue;
+        WorkQueue& queue = *gData.queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            TaskStatePtr pState = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            gData.queuedCount.fetch_sub(1);
+            return pState;
+        }
+    }
+
+    return nullptr;
+}
+
+void executeTask(const TaskStatePtr& pState)
+{
+    try
+    {
+        pState->func();
+    }
+    catch (...)
+    {
+        pState->exception = std::current_exception();
+    }
+    pState->func = nullptr; // Release captured state early.
+
+    std::vector<TaskStatePtr> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pState->mutex);
+        pState->done.store(true);
+        continuations.swap(pState->continuations);
+    }
+    pState->cond.notify_all();
+
+    // Queue continuations before releasing our pending count so that Threading::finish() waits for them.
+    for (auto& pContinuation : continuations)
+        pushTask(std::move(pContinuation));
+
+    if (gData.pendingCount.fetch_sub(1) == 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gData.wakeMutex);
+        }
+        gData.idleCond.notify_all();
+    }
+}
+
+void workerMain(uint32_t index)
+{
+    tWorkerIndex = index;
+    while (true)
+    {
+        if (TaskStatePtr pState = popTask())
+        {
+            executeTask(pState);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.wakeMutex);
+        gData.sleepingCount.fetch_add(1);
+        gData.wakeCond.wait(lock, []() { return gData.queuedCount.load() > 0 || gData.terminate.load(); });
+        gData.sleepingCount.fetch_sub(1);
+        if (gData.terminate.load() && gData.queuedCount.load() == 0)
+            break;
+    }
+    tWorkerIndex = kInvalidWorker;
+}
 } // namespace
 
 static std::mutex sThreadingInitMutex;
@@ -48,7 +230,14 @@ void Threading::start(uint32_t threadCount)
     std::lock_guard<std::mutex> lock(sThreadingInitMutex);
     if (sThreadingInitCount++ == 0)
     {
-        gData.threads.resize(threadCount);
+        threadCount = std::max(threadCount, 1u);
+        gData.terminate = false;
+        gData.queues.clear();
+        for (uint32_t i = 0; i < threadCount; ++i)
+            gData.queues.push_back(std::make_unique<WorkQueue>());
+        gData.threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+            gData.threads.emplace_back(workerMain, i);
         gData.initialized = true;
     }
 }
@@ -59,46 +248,164 @@ void Threading::shutdown()
     uint32_t count = sThreadingInitCount--;
     if (count == 1)
     {
+        finish();
+        {
+            std::lock_guard<std::mutex> wakeLock(gData.wakeMutex);
+            gData.terminate = true;
+        }
+        gData.wakeCond.notify_all();
         for (auto& t : gData.threads)
             if (t.joinable())
                 t.join();
+        gData.threads.clear();
+        gData.queues.clear();
         gData.initialized = false;
     }
     else if (count == 0)
         FALCOR_THROW("Threading::stop() called more times than Threading::start().");
 }
 
-Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+uint32_t Threading::getWorkerCount()
+{
+    return gData.initialized ? (uint32_t)gData.threads.size() : 0;
+}
+
+Threading::Task Threading::dispatchTask(std::function<void(void)> func)
 {
     FALCOR_ASSERT(gData.initialized);
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+    auto pState = std::make_shared<Task::State>();
+    pState->func = std::move(func);
+    pushTask(pState);
 
-    return Task();
+    return Task(pState);
 }
 
 void Threading::finish()
 {
-    for (auto& t : gData.threads)
+    FALCOR_CHECK(tWorkerIndex == kInvalidWorker, "Threading::finish() must not be called from a worker thread.");
+
+    while (gData.pendingCount.load() > 0)
     {
-        if (t.joinable())
-            t.join();
+        if (TaskStatePtr pState = popTask())
+        {
+            executeTask(pState);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(gData.wakeMutex);
+        gData.idleCond.wait_for(lock, std::chrono::milliseconds(1), []() { return gData.pendingCount.load() == 0; });
     }
 }
 
-Threading::Task::Task() {}
+void Threading::parallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (begin >= end)
+        return;
+
+    const size_t count = end - begin;
+    const uint32_t workerCount = getWorkerCount();
+    if (grainSize == 0)
+        grainSize = std::max<size_t>(1, count / (size_t(std::max(workerCount, 1u)) * 8));
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+    if (workerCount == 0 || chunkCount == 1)
+    {
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += std::min(grainSize, end - chunkBegin))
+            func(chunkBegin, std::min(end, chunkBegin + grainSize));
+        return;
+    }
+
+    // Chunks are handed out dynamically, so the number of helper tasks only bounds the parallelism.
+    std::atomic<size_t> nextChunk{0};
+    auto runChunks = [&]()
+    {
+        size_t chunk;
+        while ((chunk = nextChunk.fetch_add(1)) < chunkCount)
+        {
+            size_t chunkBegin = begin + chunk * grainSize;
+            func(chunkBegin, std::min(end, chunkBegin + grainSize));
+        }
+    };
+
+    const size_t helperCount = std::min<size_t>(workerCount, chunkCount - 1);
+    std::vector<Task> helpers;
+    helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; ++i)
+        helpers.push_back(dispatchTask(runChunks));
+
+    std::exception_ptr exception;
+    try
+    {
+        runChunks();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+        nextChunk = chunkCount; // Stop handing out chunks.
+    }
 
-bool Threading::Task::isRunning()
+    // Helpers reference local state, so always wait for all of them.
+    for (auto& helper : helpers)
+    {
+        try
+        {
+            helper.finish();
+        }
+        catch (...)
+        {
+            if (!exception)
+                exception = std::current_exception();
+        }
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    return mpState && !mpState->done.load();
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+
+    while (!mpState->done.load())
+    {
+        // Help executing pending tasks while waiting.
+        if (TaskStatePtr pState = popTask())
+        {
+            executeTask(pState);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mpState->mutex);
+        mpState->cond.wait_for(lock, std::chrono::milliseconds(1), [this]() { return mpState->done.load(); });
+    }
+
+    if (mpState->exception)
+    {
+        mpState->exceptionObserved.store(true);
+        std::rethrow_exception(mpState->exception);
+    }
+}
+
+Threading::Task Threading::Task::then(std::function<void(void)> func)
+{
+    FALCOR_CHECK(mpState, "Cannot add a continuation to an empty task handle.");
+
+    auto pContinuation = std::make_shared<State>();
+    pContinuation->func = std::move(func);
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        if (!mpState->done.load())
+        {
+            mpState->continuations.push_back(pContinuation);
+            return Task(pContinuation);
+        }
+    }
+    pushTask(pContinuation);
+    return Task(pContinuation);
 }
 } // namespace Falcor
@@ -29,33 +29,67 @@
 #include "Core/Macros.h"
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <cstdint>
 
 namespace Falcor
 {
+/**
+ * Global CPU job system.
+ *
+ * Tasks are executed by a pool of persistent worker threads. Each worker owns a task deque:
+ * tasks spawned from a worker are pushed to (and popped from) the back of its own deque,
+ * idle workers steal from the front of other workers' deques. Tasks dispatched from
+ * non-worker threads are distributed round-robin over the worker deques.
+ *
+ * Threads waiting on a task (Task::finish(), parallelFor()) execute pending tasks while
+ * waiting, so it is safe to wait on tasks from within other tasks.
+ */
 class FALCOR_API Threading
 {
 public:
     const static uint32_t kDefaultThreadCount = 16;
 
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
+     * Handles are cheap to copy and all copies refer to the same task.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        /// Create an empty handle. An empty handle is never running.
+        Task() = default;
+
+        /// Check if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
+
+        /// Check if task is still pending or executing.
+        bool isRunning() const;
 
-        /// Wait for task to finish executing
+        /**
+         * Wait for task to finish executing.
+         * The calling thread executes other pending tasks while waiting.
+         * If the task threw an exception, it is rethrown here. Exceptions of tasks that are never
+         * waited on are logged as warnings once the last handle to the task is released.
+         */
         void finish();
 
+        /**
+         * Add a continuation that is dispatched once this task has finished.
+         * If the task has already finished, the continuation is dispatched immediately.
+         * @param[in] func Function to execute.
+         * @return Handle to the continuation task.
+         */
+        Task then(std::function<void(void)> func);
+
+        struct State;
+
     private:
-        Task();
+        Task(std::shared_ptr<State> pState) : mpState(std::move(pState)) {}
+
+        std::shared_ptr<State> mpState;
         friend class Threading;
     };
 
@@ -66,7 +100,7 @@ public:
     static void start(uint32_t threadCount = kDefaultThreadCount);
 
     /**
-     * Waits for all currently executing threads to finish
+     * Waits for all currently dispatched tasks to finish
      */
     static void finish();
 
@@ -80,11 +114,28 @@ public:
      */
     static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
+    /**
+     * Returns the number of worker threads in the pool (0 if the pool is not running).
+     */
+    static uint32_t getWorkerCount();
+
     /**
      * Starts a task on an available thread.
      * @return Handle to the task
      */
-    static Task dispatchTask(const std::function<void(void)>& func);
+    static Task dispatchTask(std::function<void(void)> func);
+
+    /**
+     * Execute a function over a range of indices in parallel and wait for completion.
+     * The range is split into chunks of at most grainSize indices which are processed by the
+     * worker threads and the calling thread. If the pool is not running, the range is processed
+     * serially on the calling thread.
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] grainSize Maximum number of indices per chunk (0 selects a chunk size automatically).
+     * @param[in] func Function called as func(chunkBegin, chunkEnd) for each chunk.
+     */
+    static void parallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func);
 };
 
 /**
@@ -31,7 +31,14 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
+#include <set>
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -46,6 +53,134 @@ const float kSigma = 0.98f;
 // for computing statistics (min, max, mean, stddev) over the recent history.
 const size_t kMaxHistorySize = 512;
 
+// Capacity of the per-thread CPU event buffers. Events recorded while a buffer is full are dropped.
+const size_t kCpuEventBufferCapacity = 1 << 14;
+
+/**
+ * Per-thread ring buffer of CPU events.
+ * The recording thread is the only producer and the capture draining it (under the registry lock) the only consumer,
+ * so events are exchanged without locks.
+ */
+struct CpuEventBuffer
+{
+    struct Entry
+    {
+        Profiler::EventName name;
+        uint32_t depth = 0;
+        CpuTimer::TimePoint startTime;
+        CpuTimer::TimePoint endTime;
+    };
+
+    std::vector<Entry> entries = std::vector<Entry>(kCpuEventBufferCapacity);
+    std::atomic<uint64_t> head{0};    ///< Number of events written, only modified by the producer.
+    std::atomic<uint64_t> tail{0};    ///< Number of events read, only modified by the consumer.
+    std::atomic<uint64_t> dropped{0}; ///< Number of events dropped because the buffer was full.
+    uint32_t threadIndex = 0;
+    uint32_t depth = 0; ///< Current nesting depth, only accessed by the producer.
+
+    void push(const Entry& entry)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= kCpuEventBufferCapacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        entries[h % kCpuEventBufferCapacity] = entry;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    template<typename Func>
+    void drain(const Func& func)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        for (uint64_t i = t; i < h; ++i)
+            func(entries[i % kCpuEventBufferCapacity]);
+        tail.store(h, std::memory_order_release);
+    }
+};
+
+/**
+ * Registry of the CPU event buffers of all threads.
+ * When a thread exits, its pending events are moved to a list of orphaned events, so that they can still be collected,
+ * and its buffer is recycled for new threads. This keeps short-lived threads from accumulating buffers.
+ */
+struct CpuEventRegistry
+{
+    struct OrphanedEvent
+    {
+        uint32_t threadIndex;
+        CpuEventBuffer::Entry entry;
+    };
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<CpuEventBuffer>> buffers;     ///< Buffers of running threads.
+    std::vector<std::shared_ptr<CpuEventBuffer>> freeBuffers; ///< Buffers of exited threads, ready for reuse.
+    std::vector<OrphanedEvent> orphanedEvents;                ///< Uncollected events of exited threads.
+    uint64_t orphanedDroppedCount = 0;                        ///< Uncollected dropped event count of exited threads.
+    std::atomic<uint32_t> activeCaptureCount{0};
+
+    std::shared_ptr<CpuEventBuffer> acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<CpuEventBuffer> pBuffer;
+        if (freeBuffers.empty())
+        {
+            pBuffer = std::make_shared<CpuEventBuffer>();
+        }
+        else
+        {
+            pBuffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        pBuffer->threadIndex = Profiler::getThreadIndex();
+        pBuffer->depth = 0;
+        buffers.push_back(pBuffer);
+        return pBuffer;
+    }
+
+    void release(const std::shared_ptr<CpuEventBuffer>& pBuffer)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Keep the pending events for the running capture. Without a capture, nobody will collect them.
+        const bool keepEvents = activeCaptureCount.load() > 0;
+        pBuffer->drain(
+            [&](const CpuEventBuffer::Entry& entry)
+            {
+                if (keepEvents)
+                    orphanedEvents.push_back({pBuffer->threadIndex, entry});
+            }
+        );
+        const uint64_t droppedCount = pBuffer->dropped.exchange(0);
+        if (keepEvents)
+            orphanedDroppedCount += droppedCount;
+
+        buffers.erase(std::find(buffers.begin(), buffers.end(), pBuffer));
+        freeBuffers.push_back(pBuffer);
+    }
+};
+
+CpuEventRegistry& getCpuEventRegistry()
+{
+    static CpuEventRegistry registry;
+    return registry;
+}
+
+/// Owns the CPU event buffer of a thread and returns it to the registry when the thread exits.
+struct ThreadCpuEventBuffer
+{
+    std::shared_ptr<CpuEventBuffer> pBuffer = getCpuEventRegistry().acquire();
+    ~ThreadCpuEventBuffer() { getCpuEventRegistry().release(pBuffer); }
+};
+
+CpuEventBuffer& getThreadCpuEventBuffer()
+{
+    thread_local ThreadCpuEventBuffer threadBuffer;
+    return *threadBuffer.pBuffer;
+}
+
 pybind11::dict toPython(const Profiler::Stats& stats)
 {
     pybind11::dict d;
@@ -257,7 +392,80 @@ void Profiler::Capture::writeToFile(const std::filesystem::path& path) const
     ofs.write(json.data(), json.size());
 }
 
-Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames) : mReservedFrames(reservedFrames)
+std::string Profiler::Capture::toChromeTraceString() const
+{
+    // See the Trace Event Format specification. Times are given in microseconds.
+    nlohmann::json traceEvents = nlohmann::json::array();
+
+    std::set<uint32_t> threadIndices{mThreadIndex};
+    for (const auto& event : mTraceEvents)
+        threadIndices.insert(event.threadIndex);
+    for (uint32_t threadIndex : threadIndices)
+    {
+        std::string threadName = threadIndex == mThreadIndex ? "Profiler thread" : fmt::format("Thread {}", threadIndex);
+        traceEvents.push_back(
+            {{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", threadIndex}, {"args", {{"name", std::move(threadName)}}}}
+        );
+    }
+
+    // Sort parents before their children, as events with equal start times are nested in order of appearance.
+    std::vector<const TraceEvent*> sortedEvents;
+    sortedEvents.reserve(mTraceEvents.size());
+    for (const auto& event : mTraceEvents)
+        sortedEvents.push_back(&event);
+    std::stable_sort(
+        sortedEvents.begin(),
+        sortedEvents.end(),
+        [](const TraceEvent* a, const TraceEvent* b)
+        { return a->startTime < b->startTime || (a->startTime == b->startTime && a->depth < b->depth); }
+    );
+    for (const TraceEvent* pEvent : sortedEvents)
+    {
+        traceEvents.push_back(
+            {{"name", pEvent->name.str()},
+             {"cat", "cpu"},
+             {"ph", "X"},
+             {"ts", pEvent->startTime * 1e3},
+             {"dur", pEvent->duration * 1e3},
+             {"pid", 0},
+             {"tid", pEvent->threadIndex}}
+        );
+    }
+
+    // Per-frame lanes are written as counters at the end of each frame.
+    for (const auto& lane : mLanes)
+    {
+        for (size_t frame = 0; frame < lane.records.size() && frame < mFrameTimes.size(); ++frame)
+        {
+            traceEvents.push_back(
+                {{"name", lane.name},
+                 {"cat", "frame"},
+                 {"ph", "C"},
+                 {"ts", mFrameTimes[frame] * 1e3},
+                 {"pid", 0},
+                 {"tid", mThreadIndex},
+                 {"args", {{"ms", lane.records[frame]}}}}
+            );
+        }
+    }
+
+    nlohmann::json trace = {
+        {"traceEvents", std::move(traceEvents)},
+        {"displayTimeUnit", "ms"},
+        {"otherData", {{"frame_count", mFrameCount}, {"dropped_cpu_events", mDroppedEventCount}}},
+    };
+    return trace.dump();
+}
+
+void Profiler::Capture::writeChromeTrace(const std::filesystem::path& path) const
+{
+    auto json = toChromeTraceString();
+    std::ofstream ofs(path);
+    ofs.write(json.data(), json.size());
+}
+
+Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames)
+    : mReservedFrames(reservedFrames), mStartTime(CpuTimer::getCurrentTimePoint()), mThreadIndex(getThreadIndex())
 {
     // Speculativly allocate event record storage.
     mLanes.resize(reservedEvents * 2);
@@ -294,9 +502,25 @@ void Profiler::Capture::captureEvents(const std::vector<Event*>& events)
         mLanes[i * 2 + 1].records.push_back(pEvent->getGpuTime());
     }
 
+    mFrameTimes.push_back(CpuTimer::calcDuration(mStartTime, CpuTimer::getCurrentTimePoint()));
     ++mFrameCount;
 }
 
+void Profiler::Capture::recordTraceEvent(
+    EventName name,
+    uint32_t threadIndex,
+    uint32_t depth,
+    CpuTimer::TimePoint startTime,
+    CpuTimer::TimePoint endTime
+)
+{
+    // Skip events that started before the capture.
+    if (startTime < mStartTime)
+        return;
+
+    mTraceEvents.push_back({name, threadIndex, depth, CpuTimer::calcDuration(mStartTime, startTime), CpuTimer::calcDuration(startTime, endTime)});
+}
+
 void Profiler::Capture::finalize()
 {
     FALCOR_ASSERT(!mFinalized);
@@ -318,49 +542,61 @@ Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice)
 }
 
 void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+{
+    startEvent(pRenderContext, internName(name), flags);
+}
+
+void Profiler::startEvent(RenderContext* pRenderContext, EventName name, Flags flags)
 {
     if (mEnabled && is_set(flags, Flags::Internal))
     {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
+        Event* pEvent = getChildEvent(name);
+        if (pEvent)
         {
-            logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
-            return;
-        }
-
-        mCurrentEventName = mCurrentEventName + "/" + name;
+            if (!mPaused)
+                pEvent->start(*this, mFrameIndex);
 
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->start(*this, mFrameIndex);
+            if (pEvent->mRegisteredFrame != mFrameIndex)
+            {
+                pEvent->mRegisteredFrame = mFrameIndex;
+                mCurrentFrameEvents.push_back(pEvent);
+            }
 
-        if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
-        {
-            mCurrentFrameEvents.push_back(pEvent);
+            mpCurrentEvent = pEvent;
         }
     }
     if (is_set(flags, Flags::Pix))
     {
         FALCOR_ASSERT(pRenderContext);
-        pRenderContext->getLowLevelData()->beginDebugEvent(name.c_str());
+        pRenderContext->getLowLevelData()->beginDebugEvent(name.str().c_str());
     }
 }
 
 void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+{
+    endEvent(pRenderContext, internName(name), flags);
+}
+
+void Profiler::endEvent(RenderContext* pRenderContext, EventName name, Flags flags)
 {
     if (mEnabled && is_set(flags, Flags::Internal))
     {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
-            return;
-
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->end(mFrameIndex);
-
-        mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        // Events with invalid names, or started while the profiler was disabled, are not running.
+        if (mpCurrentEvent && mpCurrentEvent->mLocalName == name)
+        {
+            Event* pEvent = mpCurrentEvent;
+            if (!mPaused)
+            {
+                pEvent->end(mFrameIndex);
+                if (mpCapture && pEvent->mTriggered == 0)
+                {
+                    const auto& frameData = pEvent->mFrameData[mFrameIndex % 2];
+                    mpCapture->recordTraceEvent(name, mpCapture->mThreadIndex, pEvent->mDepth, frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
+                }
+            }
+
+            mpCurrentEvent = mpCurrentEvent->mpParent;
+        }
     }
 
     if (is_set(flags, Flags::Pix))
@@ -370,6 +606,30 @@ void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name,
     }
 }
 
+Profiler::Event* Profiler::getChildEvent(EventName name)
+{
+    auto& children = mpCurrentEvent ? mpCurrentEvent->mChildren : mRootEvents;
+    for (Event* pChild : children)
+    {
+        if (pChild->mLocalName == name)
+            return pChild;
+    }
+
+    // '/' is used as a "path delimiter", so it cannot be used in the event name.
+    if (name.str().find('/') != std::string::npos)
+    {
+        logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
+        return nullptr;
+    }
+
+    Event* pEvent = getEvent((mpCurrentEvent ? mpCurrentEvent->mName : std::string()) + "/" + name.str());
+    pEvent->mLocalName = name;
+    pEvent->mpParent = mpCurrentEvent;
+    pEvent->mDepth = mpCurrentEvent ? mpCurrentEvent->mDepth + 1 : 0;
+    children.push_back(pEvent);
+    return pEvent;
+}
+
 Profiler::Event* Profiler::getEvent(const std::string& name)
 {
     auto event = findEvent(name);
@@ -397,7 +657,10 @@ void Profiler::endFrame(RenderContext* pRenderContext)
     mFenceValue = pRenderContext->signal(mpFence.get());
 
     if (mpCapture)
+    {
         mpCapture->captureEvents(mCurrentFrameEvents);
+        collectCpuEvents();
+    }
 
     mLastFrameEvents = std::move(mCurrentFrameEvents);
     ++mFrameIndex;
@@ -418,11 +681,19 @@ void Profiler::resetStats()
 void Profiler::startCapture(size_t reservedFrames)
 {
     setEnabled(true);
+    if (!mpCapture)
+        ++getCpuEventRegistry().activeCaptureCount;
     mpCapture = std::make_shared<Capture>(mLastFrameEvents.size(), reservedFrames);
 }
 
 std::shared_ptr<Profiler::Capture> Profiler::endCapture()
 {
+    if (mpCapture)
+    {
+        collectCpuEvents();
+        --getCpuEventRegistry().activeCaptureCount;
+    }
+
     std::shared_ptr<Capture> pCapture;
     std::swap(pCapture, mpCapture);
     if (pCapture)
@@ -430,6 +701,24 @@ std::shared_ptr<Profiler::Capture> Profiler::endCapture()
     return pCapture;
 }
 
+void Profiler::collectCpuEvents()
+{
+    FALCOR_ASSERT(mpCapture);
+    auto& registry = getCpuEventRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& pBuffer : registry.buffers)
+    {
+        pBuffer->drain([&](const CpuEventBuffer::Entry& entry)
+                       { mpCapture->recordTraceEvent(entry.name, pBuffer->threadIndex, entry.depth, entry.startTime, entry.endTime); });
+        mpCapture->mDroppedEventCount += pBuffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    for (const auto& event : registry.orphanedEvents)
+        mpCapture->recordTraceEvent(event.entry.name, event.threadIndex, event.entry.depth, event.entry.startTime, event.entry.endTime);
+    mpCapture->mDroppedEventCount += registry.orphanedDroppedCount;
+    registry.orphanedEvents.clear();
+    registry.orphanedDroppedCount = 0;
+}
+
 bool Profiler::isCapturing() const
 {
     return mpCapture != nullptr;
@@ -453,7 +742,34 @@ void Profiler::breakStrongReferenceToDevice()
     mpDevice.breakStrongReference();
 }
 
+Profiler::EventName Profiler::internName(std::string_view name)
+{
+    // Elements of an unordered set are never moved, so the handles stay valid.
+    static std::mutex sMutex;
+    static std::unordered_set<std::string> sNames;
+    std::lock_guard<std::mutex> lock(sMutex);
+    return EventName(&*sNames.emplace(name).first);
+}
+
+uint32_t Profiler::getThreadIndex()
+{
+    static std::atomic<uint32_t> sThreadCount{0};
+    thread_local uint32_t threadIndex = sThreadCount++;
+    return threadIndex;
+}
+
+size_t Profiler::getCpuEventBufferCount()
+{
+    auto& registry = getCpuEventRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.buffers.size() + registry.freeBuffers.size();
+}
+
 ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
+    : ScopedProfilerEvent(pRenderContext, Profiler::internName(name), flags)
+{}
+
+ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::EventName name, Profiler::Flags flags)
     : mpRenderContext(pRenderContext), mName(name), mFlags(flags)
 {
     FALCOR_ASSERT(mpRenderContext);
@@ -465,17 +781,39 @@ ScopedProfilerEvent::~ScopedProfilerEvent()
     mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName, mFlags);
 }
 
+ScopedCpuProfilerEvent::ScopedCpuProfilerEvent(Profiler::EventName name) : mName(name)
+{
+    if (getCpuEventRegistry().activeCaptureCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    mActive = true;
+    ++getThreadCpuEventBuffer().depth;
+    mStartTime = CpuTimer::getCurrentTimePoint();
+}
+
+ScopedCpuProfilerEvent::~ScopedCpuProfilerEvent()
+{
+    if (!mActive)
+        return;
+
+    const auto endTime = CpuTimer::getCurrentTimePoint();
+    auto& buffer = getThreadCpuEventBuffer();
+    buffer.push({mName, --buffer.depth, mStartTime, endTime});
+}
+
 /// Implements a Python context manager for profiling events.
 class PythonProfilerEvent
 {
 public:
-    PythonProfilerEvent(RenderContext* pRenderContext, std::string_view name) : mpRenderContext(pRenderContext), mName(name) {}
+    PythonProfilerEvent(RenderContext* pRenderContext, std::string_view name)
+        : mpRenderContext(pRenderContext), mName(Profiler::internName(name))
+    {}
     void enter() { mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName); }
     void exit(pybind11::object, pybind11::object, pybind11::object) { mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName); }
 
 private:
     RenderContext* mpRenderContext;
-    std::string mName;
+    Profiler::EventName mName;
 };
 
 FALCOR_SCRIPT_BINDING(Profiler)
@@ -484,12 +822,16 @@ FALCOR_SCRIPT_BINDING(Profiler)
 
     using namespace pybind11::literals;
 
-    auto endCapture = [](Profiler* pProfiler)
+    auto endCapture = [](Profiler* pProfiler, std::optional<std::filesystem::path> chromeTracePath)
     {
         std::optional<pybind11::dict> result;
         auto pCapture = pProfiler->endCapture();
         if (pCapture)
+        {
             result = toPython(*pCapture);
+            if (chromeTracePath)
+                pCapture->writeChromeTrace(*chromeTracePath);
+        }
         return result;
     };
 
@@ -499,7 +841,7 @@ FALCOR_SCRIPT_BINDING(Profiler)
     profiler.def_property_readonly("is_capturing", &Profiler::isCapturing);
     profiler.def_property_readonly("events", [](const Profiler& profiler) { return toPython(profiler.getEvents()); });
     profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000);
-    profiler.def("end_capture", endCapture);
+    profiler.def("end_capture", endCapture, "chrome_trace_path"_a = std::optional<std::filesystem::path>());
     profiler.def("end_frame", [](Profiler& self) { self.endFrame(self.getDevice()->getRenderContext()); });
     profiler.def("reset_stats", &Profiler::resetStats);
 
@@ -33,6 +33,8 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -46,6 +48,8 @@ class RenderContext;
  * It automatically creates event hierarchies based on the order and nesting of the calls made.
  * This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
  * ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+ * Event names are interned (see EventName), so starting and ending an event does not involve string operations.
+ * CPU-only events can be recorded from any thread with FALCOR_PROFILE_CPU, and show up in the Chrome trace export of captures.
  */
 class FALCOR_API Profiler
 {
@@ -59,6 +63,38 @@ public:
         Default = Internal | Pix
     };
 
+    /**
+     * Interned event name.
+     * Names are interned once into a process-wide table, so that events can be looked up by comparing handles.
+     * Handles are valid for the lifetime of the process and compare equal if and only if the names are equal.
+     */
+    class EventName
+    {
+    public:
+        EventName() = default;
+
+        const std::string& str() const
+        {
+            FALCOR_ASSERT(mpName);
+            return *mpName;
+        }
+
+        bool operator==(const EventName& other) const { return mpName == other.mpName; }
+        bool operator!=(const EventName& other) const { return mpName != other.mpName; }
+
+    private:
+        explicit EventName(const std::string* pName) : mpName(pName) {}
+
+        const std::string* mpName = nullptr;
+
+        friend class Profiler;
+    };
+
+    /// True if a name of type T is a constant character array (e.g. a string literal), which can be interned once per call site.
+    template<typename T>
+    static constexpr bool kIsStaticName =
+        std::is_array_v<std::remove_reference_t<T>> && std::is_const_v<std::remove_extent_t<std::remove_reference_t<T>>>;
+
     struct Stats
     {
         float min;
@@ -92,7 +128,12 @@ public:
         void end(uint32_t frameIndex);
         void endFrame(uint32_t frameIndex);
 
-        std::string mName; ///< Nested event name.
+        std::string mName;              ///< Nested event name.
+        EventName mLocalName;           ///< Name of the event within its parent.
+        Event* mpParent = nullptr;      ///< Parent event in the hierarchy, or nullptr for top-level events.
+        std::vector<Event*> mChildren;  ///< Child events started while this event was running.
+        uint32_t mDepth = 0;            ///< Nesting depth in the hierarchy.
+        uint32_t mRegisteredFrame = uint32_t(-1); ///< Frame index for which the event was last added to the frame events.
 
         float mCpuTime = 0.0; ///< CPU time (previous frame).
         float mGpuTime = 0.0; ///< GPU time (previous frame).
@@ -133,16 +174,40 @@ public:
             std::vector<float> records;
         };
 
+        /// Single occurrence of an event, recorded for the trace export.
+        struct TraceEvent
+        {
+            EventName name;
+            uint32_t threadIndex = 0; ///< Index of the recording thread, see Profiler::getThreadIndex().
+            uint32_t depth = 0;       ///< Nesting depth on the recording thread.
+            double startTime = 0.0;   ///< Start time in ms relative to the start of the capture.
+            double duration = 0.0;    ///< Duration in ms.
+        };
+
         Capture(size_t reservedEvents, size_t reservedFrames);
 
         size_t getFrameCount() const { return mFrameCount; }
         const std::vector<Lane>& getLanes() const { return mLanes; }
 
+        /// Get all event occurrences, from the profiler's thread and from CPU events on other threads.
+        const std::vector<TraceEvent>& getTraceEvents() const { return mTraceEvents; }
+
+        /// Get the number of CPU events that were lost because a per-thread event buffer was full.
+        size_t getDroppedEventCount() const { return mDroppedEventCount; }
+
         std::string toJsonString() const;
         void writeToFile(const std::filesystem::path& path) const;
 
+        /**
+         * Convert the capture to the Chrome trace event format, which can be inspected with chrome://tracing or Perfetto.
+         * Events are written as complete events per thread, and the per-frame lanes as counters.
+         */
+        std::string toChromeTraceString() const;
+        void writeChromeTrace(const std::filesystem::path& path) const;
+
     private:
         void captureEvents(const std::vector<Event*>& events);
+        void recordTraceEvent(EventName name, uint32_t threadIndex, uint32_t depth, CpuTimer::TimePoint startTime, CpuTimer::TimePoint endTime);
         void finalize();
 
         size_t mReservedFrames = 0;
@@ -151,6 +216,12 @@ public:
         std::vector<Lane> mLanes;
         bool mFinalized = false;
 
+        CpuTimer::TimePoint mStartTime;     ///< Time at which the capture was started.
+        uint32_t mThreadIndex = 0;          ///< Index of the profiler's thread.
+        std::vector<double> mFrameTimes;    ///< Time in ms at which each captured frame ended.
+        std::vector<TraceEvent> mTraceEvents;
+        size_t mDroppedEventCount = 0;
+
         friend class Profiler;
     };
 
@@ -217,6 +288,14 @@ public:
      */
     void startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+    /**
+     * Start profiling a new event and update the events hierarchies.
+     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] name The interned event name.
+     * @param[in] flags The event flags.
+     */
+    void startEvent(RenderContext* pRenderContext, EventName name, Flags flags = Flags::Default);
+
     /**
      * Finish profiling a new event and update the events hierarchies.
      * @param[in] pRenderContext Render context for measuring GPU time.
@@ -225,6 +304,14 @@ public:
      */
     void endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+    /**
+     * Finish profiling a new event and update the events hierarchies.
+     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] name The interned event name.
+     * @param[in] flags The event flags.
+     */
+    void endEvent(RenderContext* pRenderContext, EventName name, Flags flags = Flags::Default);
+
     /**
      * Get the event, or create a new one if the event does not yet exist.
      * This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled
@@ -246,7 +333,38 @@ public:
 
     void breakStrongReferenceToDevice();
 
+    /**
+     * Intern an event name.
+     * This takes a lock, so hot code should intern its names once. FALCOR_PROFILE does this automatically for string literals.
+     * @param[in] name The event name.
+     * @return Returns the interned name.
+     */
+    static EventName internName(std::string_view name);
+
+    /**
+     * Get a small index identifying the calling thread in traces. Indices are assigned in order of first use.
+     */
+    static uint32_t getThreadIndex();
+
+    /**
+     * Get the number of allocated per-thread CPU event buffers.
+     * Buffers of exited threads are reused by new threads, their pending events are kept until collected.
+     */
+    static size_t getCpuEventBufferCount();
+
 private:
+    /**
+     * Get the child event of the current event, or create it if it does not yet exist.
+     * @param[in] name The interned event name.
+     * @return Returns the event, or nullptr if the name is invalid.
+     */
+    Event* getChildEvent(EventName name);
+
+    /**
+     * Move CPU events recorded by all threads into the active capture.
+     */
+    void collectCpuEvents();
+
     /**
      * Create a new event.
      * @param[in] name The event name.
@@ -267,10 +385,10 @@ private:
     bool mPaused = false;
 
     std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
+    std::vector<Event*> mRootEvents;                                 ///< Top-level events of the hierarchy.
     std::vector<Event*> mCurrentFrameEvents;                         ///< Events registered for current frame.
     std::vector<Event*> mLastFrameEvents;                            ///< Events from last frame.
-    std::string mCurrentEventName;                                   ///< Current nested event name.
-    uint32_t mCurrentLevel = 0;                                      ///< Current nesting level.
+    Event* mpCurrentEvent = nullptr;                                 ///< Currently running innermost event, or nullptr if none.
     uint32_t mFrameIndex = 0;                                        ///< Current frame index.
     bool mPendingReset = false;                                      ///< Reset profiler stats at the next call to endFrame().
 
@@ -292,21 +410,56 @@ class FALCOR_API ScopedProfilerEvent
 {
 public:
     ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags = Profiler::Flags::Default);
+    ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::EventName name, Profiler::Flags flags = Profiler::Flags::Default);
     ~ScopedProfilerEvent();
 
 private:
     RenderContext* mpRenderContext;
-    const std::string mName;
+    const Profiler::EventName mName;
     Profiler::Flags mFlags;
 };
+
+/**
+ * Helper class for recording CPU-only events using RAII, from any thread and without a render context.
+ * Events are only recorded while a profiler capture is active. Each thread writes to its own lock-free ring buffer,
+ * which the capture drains at the end of each frame and when the capture ends.
+ * The FALCOR_PROFILE_CPU macro should be used instead of directly creating ScopedCpuProfilerEvent objects.
+ */
+class FALCOR_API ScopedCpuProfilerEvent
+{
+public:
+    ScopedCpuProfilerEvent(Profiler::EventName name);
+    ~ScopedCpuProfilerEvent();
+
+private:
+    const Profiler::EventName mName;
+    CpuTimer::TimePoint mStartTime;
+    bool mActive = false;
+};
 } // namespace Falcor
 
+/// Intern an event name, only once per call site if the name is a string literal.
+#define FALCOR_PROFILE_EVENT_NAME(_name)                                                                \
+    [](auto&& name_)                                                                                    \
+    {                                                                                                   \
+        if constexpr (Falcor::Profiler::kIsStaticName<decltype(name_)>)                                 \
+        {                                                                                               \
+            static const Falcor::Profiler::EventName kEventName = Falcor::Profiler::internName(name_); \
+            return kEventName;                                                                          \
+        }                                                                                               \
+        else                                                                                            \
+            return Falcor::Profiler::internName(name_);                                                 \
+    }(_name)
+
 #if FALCOR_ENABLE_PROFILER
 #define FALCOR_PROFILE(_pRenderContext, _name) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name)
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, FALCOR_PROFILE_EVENT_NAME(_name))
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name, _flags)
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, FALCOR_PROFILE_EVENT_NAME(_name), _flags)
+#define FALCOR_PROFILE_CPU(_name) \
+    Falcor::ScopedCpuProfilerEvent FALCOR_CONCAT_STRINGS(_profileCpuEvent, __LINE__)(FALCOR_PROFILE_EVENT_NAME(_name))
 #else
 #define FALCOR_PROFILE(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE_CPU(_name)
 #endif
@@ -279,6 +279,19 @@ void ProfilerUI::renderOptions()
                 pCapture->writeToFile(path);
             }
         }
+
+        ImGui::SameLine();
+        if (ImGui::Button("End Capture (Chrome Trace)"))
+        {
+            auto pCapture = mpProfiler->endCapture();
+            FALCOR_ASSERT(pCapture);
+            FileDialogFilterVec filters{{"json", "Chrome Trace JSON"}};
+            std::filesystem::path path;
+            if (saveFileDialog(filters, path))
+            {
+                pCapture->writeChromeTrace(path);
+            }
+        }
     }
     else
     {
@@ -53,7 +53,13 @@ int runMain(int argc, char** argv)
     args::Flag listTags(parser, "", "List tags", {"list-tags"});
     args::ValueFlag<std::string> testSuiteFilterFlag(parser, "regex", "Filter test suites to run.", {'s', "test-suite"});
     args::ValueFlag<std::string> testCaseFilterFlag(parser, "regex", "Filter test cases to run.", {'f', "test-case"});
-    args::ValueFlag<std::string> tagFilterFlag(parser, "tags", "Filter test cases by tags.", {'t', "tags"});
+    args::ValueFlag<std::string> tagFilterFlag(
+        parser,
+        "tags",
+        "Filter test cases by tags (comma separated, prefix with '-' to exclude). "
+        "Defaults to -benchmark, unless a test suite or test case filter is given.",
+        {'t', "tags"}
+    );
     args::ValueFlag<std::string> xmlReportFlag(parser, "path", "XML report output file.", {'x', "xml-report"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
@@ -121,8 +127,11 @@ int runMain(int argc, char** argv)
         options.testSuiteFilter = args::get(testSuiteFilterFlag);
     if (testCaseFilterFlag)
         options.testCaseFilter = args::get(testCaseFilterFlag);
+    // Benchmarks are slow and only report timings, they are only run when explicitly requested by tag or by name.
     if (tagFilterFlag)
         options.tagFilter = args::get(tagFilterFlag);
+    else if (!testSuiteFilterFlag && !testCaseFilterFlag)
+        options.tagFilter = "-benchmark";
     if (xmlReportFlag)
         options.xmlReportPath = args::get(xmlReportFlag);
     if (parallelFlag)
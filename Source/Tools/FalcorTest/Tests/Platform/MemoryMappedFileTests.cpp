@@ -114,4 +114,30 @@ CPU_TEST(MemoryMappedFile_Read)
     std::filesystem::remove(tempPath);
 }
 
+CPU_TEST(MemoryMappedFile_Rename)
+{
+    const std::vector<uint8_t> data(4096, 0xab);
+    const std::filesystem::path tempPath = std::filesystem::absolute("test_memory_mapped_rename.bin");
+    const std::filesystem::path renamedPath = std::filesystem::absolute("test_memory_mapped_renamed.bin");
+
+    std::ofstream ofs(tempPath, std::ios::binary);
+    ASSERT_TRUE(ofs.good());
+    ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+    ofs.close();
+
+    {
+        // A mapped file can be renamed, the mapping stays valid.
+        MemoryMappedFile file(tempPath);
+        ASSERT_EQ(file.isOpen(), true);
+        std::error_code ec;
+        std::filesystem::rename(tempPath, renamedPath, ec);
+        EXPECT(!ec) << ec.message();
+        EXPECT(std::memcmp(file.getData(), data.data(), data.size()) == 0);
+    }
+
+    // Cleanup.
+    std::filesystem::remove(tempPath);
+    std::filesystem::remove(renamedPath);
+}
+
 } // namespace Falcor
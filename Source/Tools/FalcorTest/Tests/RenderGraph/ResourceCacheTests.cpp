@@ -0,0 +1,218 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceCache.h"
+
+#include <map>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using TransientResource = ResourceCache::TransientResource;
+
+/// Check that an aliasing plan is valid and uses the minimum number of backing resources.
+void checkPlan(CPUUnitTestContext& ctx, const std::vector<TransientResource>& resources, const ResourceCache::AliasingPlan& plan)
+{
+    ASSERT_EQ(plan.backingIndex.size(), resources.size());
+
+    uint64_t naiveSize = 0;
+    std::map<uint32_t, uint64_t> backingSizes;
+    for (size_t i = 0; i < resources.size(); i++)
+    {
+        naiveSize += resources[i].size;
+        ASSERT(plan.backingIndex[i] < plan.backingCount);
+        backingSizes[plan.backingIndex[i]] = resources[i].size;
+
+        for (size_t j = i + 1; j < resources.size(); j++)
+        {
+            if (plan.backingIndex[i] != plan.backingIndex[j])
+                continue;
+            // Resources sharing a backing resource must be compatible and have disjoint lifetimes.
+            EXPECT_EQ(resources[i].descIndex, resources[j].descIndex) << "i=" << i << " j=" << j;
+            bool disjoint =
+                resources[i].lifetime.second < resources[j].lifetime.first || resources[j].lifetime.second < resources[i].lifetime.first;
+            EXPECT(disjoint) << "i=" << i << " j=" << j;
+        }
+    }
+    EXPECT_EQ(backingSizes.size(), plan.backingCount);
+
+    uint64_t aliasedSize = 0;
+    for (const auto& [backing, size] : backingSizes)
+        aliasedSize += size;
+
+    // The number of backing resources per description must equal the maximum number of overlapping lifetimes.
+    // The peak size is the maximum total size of resources alive at the same time.
+    std::map<uint32_t, uint32_t> maxOverlap;
+    uint64_t peakSize = 0;
+    for (const auto& r : resources)
+    {
+        uint32_t t = r.lifetime.first;
+        std::map<uint32_t, uint32_t> overlap;
+        uint64_t liveSize = 0;
+        for (const auto& other : resources)
+        {
+            if (other.lifetime.first <= t && t <= other.lifetime.second)
+            {
+                overlap[other.descIndex]++;
+                liveSize += other.size;
+            }
+        }
+        for (const auto& [desc, count] : overlap)
+            maxOverlap[desc] = std::max(maxOverlap[desc], count);
+        peakSize = std::max(peakSize, liveSize);
+    }
+    uint32_t optimalCount = 0;
+    for (const auto& [desc, count] : maxOverlap)
+        optimalCount += count;
+
+    EXPECT_EQ(plan.backingCount, optimalCount);
+    EXPECT_EQ(plan.naiveSize, naiveSize);
+    EXPECT_EQ(plan.aliasedSize, aliasedSize);
+    EXPECT_EQ(plan.peakSize, peakSize);
+    EXPECT_LE(plan.peakSize, plan.aliasedSize);
+    EXPECT_LE(plan.aliasedSize, plan.naiveSize);
+}
+} // namespace
+
+CPU_TEST(ResourceCache_PlanAliasingEmpty)
+{
+    auto plan = ResourceCache::planAliasing({});
+    EXPECT_EQ(plan.backingCount, 0);
+    EXPECT_EQ(plan.naiveSize, 0);
+    EXPECT_EQ(plan.aliasedSize, 0);
+    EXPECT_EQ(plan.peakSize, 0);
+}
+
+CPU_TEST(ResourceCache_PlanAliasingChain)
+{
+    // Linear chain of passes where each pass reads the output of the previous pass:
+    // pass i writes resource i with lifetime [i, i+1]. Two resources per description suffice.
+    const uint64_t kSize = 3840 * 2160 * 16;
+    std::vector<TransientResource> resources;
+    for (uint32_t i = 0; i < 10; i++)
+        resources.push_back({0, {i, i + 1}, kSize});
+
+    auto plan = ResourceCache::planAliasing(resources);
+    checkPlan(ctx, resources, plan);
+    EXPECT_EQ(plan.backingCount, 2);
+    EXPECT_EQ(plan.naiveSize, 10 * kSize);
+    EXPECT_EQ(plan.aliasedSize, 2 * kSize);
+    EXPECT_EQ(plan.peakSize, 2 * kSize);
+    for (uint32_t i = 0; i < 10; i++)
+        EXPECT_EQ(plan.backingIndex[i], i % 2);
+
+    // Resources with a different description are never aliased.
+    for (uint32_t i = 0; i < 10; i++)
+        resources[i].descIndex = i % 3;
+    plan = ResourceCache::planAliasing(resources);
+    checkPlan(ctx, resources, plan);
+    EXPECT_EQ(plan.backingCount, 3);
+}
+
+CPU_TEST(ResourceCache_PlanAliasingOverlap)
+{
+    // Resources used at the same time point must not share a backing resource.
+    std::vector<TransientResource> resources = {
+        {0, {0, 2}, 100},
+        {0, {2, 3}, 100},
+        {0, {3, 3}, 100},
+        {0, {4, 5}, 100},
+        {1, {0, 5}, 10},
+    };
+
+    auto plan = ResourceCache::planAliasing(resources);
+    checkPlan(ctx, resources, plan);
+    EXPECT_EQ(plan.backingCount, 3);
+    EXPECT_NE(plan.backingIndex[0], plan.backingIndex[1]);
+    EXPECT_NE(plan.backingIndex[1], plan.backingIndex[2]);
+    EXPECT_EQ(plan.aliasedSize, 210);
+    EXPECT_EQ(plan.peakSize, 210);
+}
+
+CPU_TEST(ResourceCache_PlanAliasingRandom)
+{
+    // Synthetic graphs with passes writing resources that are read by later passes.
+    std::mt19937 rng(0);
+    for (uint32_t iter = 0; iter < 100; iter++)
+    {
+        uint32_t passCount = 1 + rng() % 40;
+        uint32_t descCount = 1 + rng() % 5;
+        std::vector<TransientResource> resources;
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            uint32_t outputCount = rng() % 4;
+            for (uint32_t o = 0; o < outputCount; o++)
+            {
+                uint32_t descIndex = rng() % descCount;
+                uint32_t lastUse = pass + rng() % (passCount - pass);
+                resources.push_back({descIndex, {pass, lastUse}, (descIndex + 1) * 1024ull});
+            }
+        }
+
+        auto plan = ResourceCache::planAliasing(resources);
+        checkPlan(ctx, resources, plan);
+
+        // The plan must be deterministic.
+        auto plan2 = ResourceCache::planAliasing(resources);
+        EXPECT(plan.backingIndex == plan2.backingIndex);
+    }
+}
+
+GPU_TEST(ResourceCache_AliasingSwitch)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    auto makeField = []()
+    {
+        return RenderPassReflection::Field("output", "", RenderPassReflection::Field::Visibility::Output)
+            .texture2D(64, 64)
+            .format(ResourceFormat::RGBA32Float)
+            .bindFlags(ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
+    };
+
+    EXPECT(!ResourceCache().isAliasingEnabled());
+
+    // Two compatible resources with disjoint lifetimes only share memory when aliasing is enabled.
+    for (bool enabled : {false, true})
+    {
+        ResourceCache cache;
+        cache.setAliasingEnabled(enabled);
+        cache.registerField("PassA.output", makeField(), 0);
+        cache.registerField("PassB.output", makeField(), 2);
+        cache.allocateResources(pDevice, {uint2(64), ResourceFormat::RGBA32Float});
+
+        const auto& pA = cache.getResource("PassA.output");
+        const auto& pB = cache.getResource("PassB.output");
+        ASSERT(pA != nullptr);
+        ASSERT(pB != nullptr);
+        EXPECT_EQ(pA == pB, enabled) << "enabled=" << enabled;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,379 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Scene/Lights/LightCollectionShared.slang"
+#include "Utils/Math/PackedFormats.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using MeshLightTriangle = ILightCollection::MeshLightTriangle;
+
+/// Light collection made of CPU-side emissive triangles. Only provides the data used for building and refitting a light BVH.
+class TestLightCollection : public ILightCollection
+{
+    FALCOR_OBJECT(TestLightCollection)
+public:
+    TestLightCollection(ref<Device> pDevice) : mpDevice(pDevice) {}
+
+    /// Adds a mesh light made of small random triangles around a center point.
+    void addMeshLight(const float3& center, float extent, uint32_t triangleCount, float radiance, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(-extent, extent);
+        MeshLightData meshLight;
+        meshLight.instanceID = (uint32_t)mMeshLights.size();
+        meshLight.triangleOffset = (uint32_t)mTriangles.size();
+        meshLight.triangleCount = triangleCount;
+        meshLight.materialID = 0;
+
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            MeshLightTriangle tri;
+            for (auto& vtx : tri.vtx)
+                vtx.pos = center + float3(u(rng), u(rng), u(rng));
+            tri.lightIdx = meshLight.instanceID;
+            tri.averageRadiance = float3(radiance);
+            updateTriangle(tri);
+            mTriangles.push_back(tri);
+        }
+        mMeshLights.push_back(meshLight);
+    }
+
+    /// Recomputes the normal, area and flux of a triangle after its vertices have changed.
+    static void updateTriangle(MeshLightTriangle& tri)
+    {
+        float3 n = cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+        tri.area = 0.5f * length(n);
+        tri.normal = n / length(n);
+        tri.flux = tri.averageRadiance.x * tri.area;
+    }
+
+    /// Uploads the triangles to the GPU, needs to be called after changing them.
+    void upload()
+    {
+        std::vector<PackedEmissiveTriangle> packed(mTriangles.size());
+        for (size_t i = 0; i < mTriangles.size(); ++i)
+        {
+            const MeshLightTriangle& tri = mTriangles[i];
+            for (uint32_t j = 0; j < 3; ++j)
+                packed[i].posAndTexCoords[j] = float4(tri.vtx[j].pos, 0.f);
+            packed[i].normal = encodeNormal2x16(tri.normal);
+            std::memcpy(&packed[i].area, &tri.area, sizeof(float));
+            packed[i].materialID = 0;
+            packed[i].lightIdx = tri.lightIdx;
+        }
+
+        if (!mpTriangleData || mpTriangleData->getElementCount() != packed.size())
+        {
+            mpTriangleData = mpDevice->createStructuredBuffer(sizeof(PackedEmissiveTriangle), (uint32_t)packed.size(), ResourceBindFlags::ShaderResource);
+        }
+        mpTriangleData->setBlob(packed.data(), 0, packed.size() * sizeof(PackedEmissiveTriangle));
+
+        mStats.meshLightCount = (uint32_t)mMeshLights.size();
+        mStats.triangleCount = (uint32_t)mTriangles.size();
+        mStats.trianglesActive = mStats.trianglesActiveUniform = (uint32_t)mTriangles.size();
+    }
+
+    std::vector<MeshLightTriangle>& getTriangles() { return mTriangles; }
+
+    const ref<Device>& getDevice() const override { return mpDevice; }
+    bool update(RenderContext* pRenderContext, UpdateStatus* pUpdateStatus) override { return false; }
+    void bindShaderData(const ShaderVar& var) const override
+    {
+        var["triangleCount"] = (uint32_t)mTriangles.size();
+        var["activeTriangleCount"] = 0u;
+        var["meshCount"] = (uint32_t)mMeshLights.size();
+        var["triangleData"] = mpTriangleData;
+    }
+    uint32_t getTotalLightCount() const override { return (uint32_t)mTriangles.size(); }
+    const MeshLightStats& getStats(RenderContext* pRenderContext) const override { return mStats; }
+    const std::vector<MeshLightTriangle>& getMeshLightTriangles(RenderContext* pRenderContext) const override { return mTriangles; }
+    const std::vector<MeshLightData>& getMeshLights() const override { return mMeshLights; }
+    const std::vector<uint32_t>& getUpdatedLights() const override { return mUpdatedLights; }
+    void prepareSyncCPUData(RenderContext* pRenderContext) const override {}
+    uint64_t getMemoryUsageInBytes() const override { return mpTriangleData ? mpTriangleData->getSize() : 0; }
+    UpdateFlagsSignal::Interface getUpdateFlagsSignal() override { return mUpdateFlagsSignal.getInterface(); }
+
+private:
+    ref<Device> mpDevice;
+    std::vector<MeshLightTriangle> mTriangles;
+    std::vector<MeshLightData> mMeshLights;
+    std::vector<uint32_t> mUpdatedLights;
+    MeshLightStats mStats;
+    ref<Buffer> mpTriangleData;
+    UpdateFlagsSignal mUpdateFlagsSignal;
+};
+
+/// Gives the tests access to the CPU-side BVH data.
+class TestLightBVH : public LightBVH
+{
+public:
+    using LightBVH::LightBVH;
+
+    const std::vector<PackedNode>& getNodes() const
+    {
+        syncDataToCPU();
+        return mNodes;
+    }
+    const std::vector<uint32_t>& getTriangleIndices() const { return mTriangleIndices; }
+    const std::vector<uint64_t>& getTriangleBitmasks() const { return mTriangleBitmasks; }
+};
+
+bool compareNodes(const std::vector<PackedNode>& a, const std::vector<PackedNode>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(PackedNode)) == 0;
+}
+
+/// Checks that every triangle is reachable exactly once and that its bitmask encodes the path to its leaf.
+/// Returns a description of the first problem found, or an empty string if the BVH is valid.
+std::string validateBVH(const TestLightBVH& bvh, uint32_t triangleCount)
+{
+    const auto& nodes = bvh.getNodes();
+    const auto& triangleIndices = bvh.getTriangleIndices();
+    const auto& bitmasks = bvh.getTriangleBitmasks();
+    if (bitmasks.size() != triangleCount) return fmt::format("Bitmask count {} does not match triangle count {}", bitmasks.size(), triangleCount);
+
+    struct Location
+    {
+        uint32_t nodeIndex;
+        uint32_t depth;
+        uint64_t bitmask;
+    };
+    std::vector<uint32_t> reached(triangleCount, 0);
+    std::vector<Location> stack = {{0, 0, 0}};
+    while (!stack.empty())
+    {
+        const Location location = stack.back();
+        stack.pop_back();
+        if (location.nodeIndex >= nodes.size()) return fmt::format("Node index {} is out of range", location.nodeIndex);
+
+        const PackedNode& node = nodes[location.nodeIndex];
+        if (node.isLeaf())
+        {
+            const LeafNode leaf = node.getLeafNode();
+            if (leaf.triangleCount == 0 || leaf.triangleOffset + leaf.triangleCount > triangleIndices.size())
+                return fmt::format("Leaf node {} has invalid triangle range", location.nodeIndex);
+            for (uint32_t i = 0; i < leaf.triangleCount; ++i)
+            {
+                const uint32_t triangleIndex = triangleIndices[leaf.triangleOffset + i];
+                if (triangleIndex >= triangleCount) return fmt::format("Triangle index {} is out of range", triangleIndex);
+                if (++reached[triangleIndex] > 1) return fmt::format("Triangle {} is reachable more than once", triangleIndex);
+                if (bitmasks[triangleIndex] != location.bitmask)
+                    return fmt::format("Triangle {} has bitmask {:#x}, expected {:#x}", triangleIndex, bitmasks[triangleIndex], location.bitmask);
+            }
+        }
+        else
+        {
+            const InternalNode internal = node.getInternalNode();
+            stack.push_back({location.nodeIndex + 1, location.depth + 1, location.bitmask});
+            stack.push_back({internal.rightChildIdx, location.depth + 1, location.bitmask | (1ull << location.depth)});
+        }
+    }
+
+    for (uint32_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+    {
+        if (reached[triangleIndex] != 1) return fmt::format("Triangle {} is not reachable", triangleIndex);
+    }
+    return {};
+}
+} // namespace
+
+GPU_TEST(LightBVHBuilder_ParallelBuild)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Enough triangles for building subtrees and binning the split axes in parallel.
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    ref<TestLightCollection> pLights = make_ref<TestLightCollection>(pDevice);
+    for (uint32_t i = 0; i < 6000; ++i)
+        pLights->addMeshLight(100.f * float3(u(rng), u(rng), u(rng)), 1.f, 16, 1.f + u(rng), rng);
+    pLights->upload();
+
+    for (auto heuristic : {LightBVHBuilder::SplitHeuristic::BinnedSAOH, LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::Equal})
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+
+        options.useParallelBuild = false;
+        TestLightBVH serial(pDevice, pLights);
+        LightBVHBuilder(options).build(ctx.getRenderContext(), serial);
+
+        options.useParallelBuild = true;
+        TestLightBVH parallel(pDevice, pLights);
+        LightBVHBuilder(options).build(ctx.getRenderContext(), parallel);
+
+        ASSERT(serial.isValid() && parallel.isValid());
+        EXPECT_EQ(parallel.getStats().triangleCount, (uint32_t)pLights->getTriangles().size());
+        EXPECT(compareNodes(parallel.getNodes(), serial.getNodes())) << "heuristic " << (uint32_t)heuristic;
+        EXPECT(parallel.getTriangleIndices() == serial.getTriangleIndices()) << "heuristic " << (uint32_t)heuristic;
+        EXPECT(parallel.getTriangleBitmasks() == serial.getTriangleBitmasks()) << "heuristic " << (uint32_t)heuristic;
+    }
+}
+
+GPU_TEST(LightBVHBuilder_IncrementalRefit)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    ref<TestLightCollection> pLights = make_ref<TestLightCollection>(pDevice);
+    for (uint32_t i = 0; i < 400; ++i)
+        pLights->addMeshLight(100.f * float3(u(rng), u(rng), u(rng)), 1.f, 8, 1.f + u(rng), rng);
+    pLights->upload();
+
+    // Disable the quality checks, so that the updates only refit.
+    LightBVHBuilder::Options options;
+    options.qualityCheckInterval = 1000;
+    LightBVHBuilder builder(options);
+
+    TestLightBVH incremental(pDevice, pLights);
+    TestLightBVH reference(pDevice, pLights);
+    builder.build(pRenderContext, incremental);
+    builder.build(pRenderContext, reference);
+    ASSERT(incremental.isValid() && reference.isValid());
+    EXPECT(compareNodes(incremental.getNodes(), reference.getNodes()));
+
+    // Refit both once on the GPU, so that untouched nodes don't differ from refitted ones by CPU/GPU rounding.
+    incremental.refit(pRenderContext);
+    reference.refit(pRenderContext);
+    const uint32_t nodeCount = incremental.getStats().internalNodeCount + incremental.getStats().leafNodeCount;
+
+    auto& triangles = pLights->getTriangles();
+    for (uint32_t iteration = 0; iteration < 4; ++iteration)
+    {
+        // Move a few mesh lights, and turn one of them around.
+        std::vector<uint32_t> updatedLights;
+        for (uint32_t i = 0; i < 3; ++i)
+            updatedLights.push_back(uint32_t(rng() % 400));
+        const float3 offset = 2.f * float3(u(rng), u(rng), u(rng)) - 1.f;
+        for (auto& tri : triangles)
+        {
+            if (std::find(updatedLights.begin(), updatedLights.end(), tri.lightIdx) == updatedLights.end()) continue;
+            for (auto& vtx : tri.vtx)
+                vtx.pos += offset;
+            if (tri.lightIdx == updatedLights[0])
+                std::swap(tri.vtx[1], tri.vtx[2]);
+            TestLightCollection::updateTriangle(tri);
+        }
+        pLights->upload();
+
+        builder.updateIncremental(pRenderContext, incremental, updatedLights);
+        reference.refit(pRenderContext);
+
+        // Only the paths to the moved lights are refitted, but the bounds, cones and flux of all nodes match the full refit.
+        EXPECT_LT(incremental.getStats().refitNodeCount, nodeCount);
+        EXPECT(compareNodes(incremental.getNodes(), reference.getNodes())) << "iteration " << iteration;
+        EXPECT(incremental.getTriangleIndices() == reference.getTriangleIndices());
+        EXPECT(incremental.getTriangleBitmasks() == reference.getTriangleBitmasks());
+    }
+    EXPECT_EQ(incremental.getStats().incrementalRefitCount, 4u);
+    EXPECT_EQ(incremental.getStats().subtreeRebuildCount, 0u);
+}
+
+GPU_TEST(LightBVHBuilder_SubtreeRebuild)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    // Eight clusters of lights along the x-axis. The lights of the last cluster are tiny triangles on a line with
+    // negligible flux, so scattering them degrades the cluster's subtree without affecting the cost of its ancestors.
+    const uint32_t kClusterCount = 8;
+    const uint32_t kLightsPerCluster = 32;
+    const uint32_t kTrianglesPerLight = 8;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    ref<TestLightCollection> pLights = make_ref<TestLightCollection>(pDevice);
+    for (uint32_t cluster = 0; cluster < kClusterCount; ++cluster)
+    {
+        const float3 clusterCenter = float3(100.f * cluster, 0.f, 0.f);
+        for (uint32_t i = 0; i < kLightsPerCluster; ++i)
+        {
+            if (cluster + 1 < kClusterCount)
+                pLights->addMeshLight(clusterCenter + 10.f * float3(u(rng), u(rng), u(rng)) - 5.f, 0.5f, kTrianglesPerLight, 1.f, rng);
+            else
+                pLights->addMeshLight(clusterCenter + float3(10.f * i / kLightsPerCluster - 5.f, 0.f, 0.f), 0.01f, kTrianglesPerLight, 1e-4f, rng);
+        }
+    }
+    pLights->upload();
+    const uint32_t triangleCount = (uint32_t)pLights->getTriangles().size();
+
+    // Check the quality on every update.
+    LightBVHBuilder::Options options;
+    options.qualityCheckInterval = 1;
+    LightBVHBuilder builder(options);
+
+    TestLightBVH bvh(pDevice, pLights);
+    builder.build(pRenderContext, bvh);
+    ASSERT(bvh.isValid());
+    EXPECT_EQ(validateBVH(bvh, triangleCount), std::string());
+
+    // Scatter the triangles of the last cluster over its whole region.
+    std::vector<uint32_t> updatedLights;
+    for (uint32_t i = 0; i < kLightsPerCluster; ++i)
+        updatedLights.push_back((kClusterCount - 1) * kLightsPerCluster + i);
+    const float3 lastCenter = float3(100.f * (kClusterCount - 1), 0.f, 0.f);
+    for (auto& tri : pLights->getTriangles())
+    {
+        if (tri.lightIdx < updatedLights.front()) continue;
+        const float3 offset = lastCenter + 10.f * float3(u(rng), u(rng), u(rng)) - 5.f - tri.getCenter();
+        for (auto& vtx : tri.vtx)
+            vtx.pos += offset;
+        TestLightCollection::updateTriangle(tri);
+    }
+    pLights->upload();
+
+    builder.updateIncremental(pRenderContext, bvh, updatedLights);
+
+    // The degraded subtree was rebuilt locally rather than the whole BVH.
+    const auto& stats = bvh.getStats();
+    EXPECT_GE(stats.subtreeRebuildCount, 1u);
+    EXPECT_GT(stats.subtreeRebuildTriangleCount, 0u);
+    EXPECT_LE(stats.subtreeRebuildTriangleCount, kLightsPerCluster * kTrianglesPerLight);
+    EXPECT_EQ(stats.triangleCount, triangleCount);
+    EXPECT_EQ(validateBVH(bvh, triangleCount), std::string());
+
+    // Refitting keeps the rebuilt BVH valid, and incremental updates continue to work on it.
+    bvh.refit(pRenderContext);
+    EXPECT_EQ(validateBVH(bvh, triangleCount), std::string());
+    builder.updateIncremental(pRenderContext, bvh, {0});
+    EXPECT_EQ(validateBVH(bvh, triangleCount), std::string());
+}
+} // namespace Falcor
@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<ref<Animation>> createRandomAnimations(size_t count, uint32_t maxKeyframeCount, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    std::vector<ref<Animation>> animations;
+    for (size_t i = 0; i < count; ++i)
+    {
+        ref<Animation> pAnimation = Animation::create("animation", NodeID(i), 10.0);
+        const uint32_t keyframeCount = 1 + rng() % maxKeyframeCount;
+        for (uint32_t j = 0; j < keyframeCount; ++j)
+        {
+            Animation::Keyframe keyframe;
+            keyframe.time = (rng() % 1000) / 100.0;
+            keyframe.translation = float3(u(rng), u(rng), u(rng));
+            keyframe.scaling = float3(1.f + 0.5f * u(rng), 1.f + 0.5f * u(rng), 1.f + 0.5f * u(rng));
+            keyframe.rotation = normalize(quatf(u(rng), u(rng), u(rng), u(rng)));
+            pAnimation->addKeyframe(keyframe);
+        }
+        animations.push_back(pAnimation);
+    }
+    return animations;
+}
+} // namespace
+
+CPU_TEST(Animation_Keyframes)
+{
+    ref<Animation> pAnimation = Animation::create("animation", NodeID(0), 10.0);
+    for (double time : {5.0, 1.0, 9.0, 3.0, 7.0})
+    {
+        Animation::Keyframe keyframe;
+        keyframe.time = time;
+        keyframe.translation = float3((float)time);
+        pAnimation->addKeyframe(keyframe);
+    }
+
+    // Replace an existing keyframe.
+    Animation::Keyframe keyframe;
+    keyframe.time = 3.0;
+    keyframe.translation = float3(-1.f);
+    pAnimation->addKeyframe(keyframe);
+
+    EXPECT_EQ(pAnimation->getKeyframeCount(), size_t(5));
+    auto times = pAnimation->getKeyframeTimes();
+    EXPECT(std::is_sorted(times.begin(), times.end()));
+    EXPECT(pAnimation->doesKeyframeExists(7.0));
+    EXPECT(!pAnimation->doesKeyframeExists(2.0));
+    EXPECT_EQ(pAnimation->getKeyframe(3.0).translation.x, -1.f);
+    EXPECT_EQ(pAnimation->getKeyframe(9.0).translation.x, 9.f);
+    EXPECT_THROW(pAnimation->getKeyframe(2.0));
+
+    // Linear interpolation between keyframes, sampled forwards and backwards.
+    for (double time : {1.0, 2.0, 4.0, 6.5, 8.0, 9.0, 8.5, 2.5, 10.0, 0.0})
+    {
+        float4x4 transform = pAnimation->animate(time);
+        float expected = time <= 1.0 ? 1.f : (time >= 9.0 ? 9.f : (time < 3.0 ? math::lerp(1.f, -1.f, (float)(time - 1.0) / 2.f) : (float)time));
+        if (time > 3.0 && time < 5.0) expected = math::lerp(-1.f, 5.f, (float)(time - 3.0) / 2.f);
+        EXPECT_LE(std::abs(transform[0][3] - expected), 1e-5f) << "time " << time;
+    }
+}
+
+CPU_TEST(Animation_Batch)
+{
+    // Compare batched against single animations for all interpolation modes and behaviors.
+    std::mt19937 rng(0);
+    auto animations = createRandomAnimations(203, 12, rng);
+    for (auto& pAnimation : animations)
+    {
+        pAnimation->setInterpolationMode(rng() % 2 ? Animation::InterpolationMode::Linear : Animation::InterpolationMode::Hermite);
+        pAnimation->setPreInfinityBehavior(Animation::Behavior(rng() % 4));
+        pAnimation->setPostInfinityBehavior(Animation::Behavior(rng() % 4));
+        pAnimation->setEnableWarping(rng() % 3 == 0);
+    }
+
+    std::vector<float4x4> matrices(animations.size());
+    for (uint32_t step = 0; step < 400; ++step)
+    {
+        // Advance monotonically, then jump to random times.
+        double time = step < 300 ? -2.0 + step * 0.05 : (rng() % 2000) / 100.0 - 5.0;
+        Animation::animateBatch(animations, time, matrices);
+        for (size_t i = 0; i < animations.size(); ++i)
+        {
+            // Results may differ in the last bits depending on whether the compiler contracts the scalar path into fused multiply-adds.
+            float4x4 expected = animations[i]->animate(time);
+            for (uint32_t j = 0; j < 16; ++j)
+            {
+                float a = matrices[i].data()[j];
+                float b = expected.data()[j];
+                EXPECT_LE(std::abs(a - b), 1e-5f * std::max(1.f, std::abs(b))) << "animation " << i << " time " << time << " element " << j;
+            }
+        }
+    }
+}
+
+CPU_TEST(Animation_Benchmark, TAGS("benchmark"))
+{
+    const size_t kAnimationCount = 50000;
+    const uint32_t kFrameCount = 100;
+
+    std::mt19937 rng(0);
+    auto animations = createRandomAnimations(kAnimationCount, 64, rng);
+    std::vector<float4x4> matrices(animations.size());
+
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        for (size_t i = 0; i < animations.size(); ++i) matrices[i] = animations[i]->animate(frame / 30.0);
+    }
+    auto t1 = CpuTimer::getCurrentTimePoint();
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        Animation::animateBatch(animations, frame / 30.0, matrices);
+    }
+    auto t2 = CpuTimer::getCurrentTimePoint();
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        Threading::parallelFor(0, animations.size(), 1024, [&](size_t begin, size_t end)
+        {
+            Animation::animateBatch(
+                fstd::span<const ref<Animation>>(animations.data() + begin, end - begin), frame / 30.0,
+                fstd::span<float4x4>(matrices.data() + begin, end - begin)
+            );
+        });
+    }
+    auto t3 = CpuTimer::getCurrentTimePoint();
+
+    auto nodesPerMs = [&](CpuTimer::TimePoint start, CpuTimer::TimePoint end)
+    { return kAnimationCount * kFrameCount / CpuTimer::calcDuration(start, end); };
+    logInfo("Animation benchmark ({} animations):", kAnimationCount);
+    logInfo("  single {:.0f} nodes/ms, batched {:.0f} nodes/ms, parallel batched {:.0f} nodes/ms", nodesPerMs(t0, t1), nodesPerMs(t1, t2), nodesPerMs(t2, t3));
+}
+} // namespace Falcor
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BoundsHierarchy.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+AABB createRandomBounds(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-100.f, 100.f);
+    float3 p(u(rng), u(rng), u(rng));
+    return AABB(p, p + float3(1.f));
+}
+
+AABB computeUnion(const std::vector<AABB>& leaves)
+{
+    AABB result;
+    for (const auto& leaf : leaves) result |= leaf;
+    return result;
+}
+} // namespace
+
+CPU_TEST(BoundsHierarchy_Refit)
+{
+    std::mt19937 rng(0);
+    for (size_t leafCount : {0, 1, 2, 3, 7, 64, 1000})
+    {
+        BoundsHierarchy hierarchy(leafCount);
+        EXPECT_EQ(hierarchy.getLeafCount(), leafCount);
+        EXPECT(!hierarchy.getBounds().valid());
+
+        std::vector<AABB> leaves(leafCount);
+        for (size_t i = 0; i < leafCount; ++i)
+        {
+            leaves[i] = createRandomBounds(rng);
+            hierarchy.setLeaf(i, leaves[i]);
+        }
+        hierarchy.build();
+        EXPECT(hierarchy.getBounds() == computeUnion(leaves)) << "leafCount=" << leafCount;
+
+        for (int iteration = 0; iteration < 20 && leafCount > 0; ++iteration)
+        {
+            // Move a few leaves, setting some of them more than once. Shrinking a leaf must also shrink the bounds.
+            size_t changeCount = 1 + rng() % 4;
+            for (size_t j = 0; j < changeCount; ++j)
+            {
+                size_t i = rng() % leafCount;
+                leaves[i] = (j % 2 == 0) ? createRandomBounds(rng) : AABB(float3(0.f));
+                hierarchy.setLeaf(i, leaves[i]);
+            }
+            hierarchy.refit();
+            EXPECT(hierarchy.getBounds() == computeUnion(leaves)) << "leafCount=" << leafCount << " iteration=" << iteration;
+            for (size_t i = 0; i < leafCount; ++i) EXPECT(hierarchy.getLeaf(i) == leaves[i]);
+        }
+    }
+}
+
+CPU_TEST(BoundsHierarchy_Benchmark, TAGS("benchmark"))
+{
+    const size_t kLeafCount = 1 << 20;
+    const size_t kChangeCount = 100;
+
+    std::mt19937 rng(0);
+    BoundsHierarchy hierarchy(kLeafCount);
+    std::vector<AABB> leaves(kLeafCount);
+    for (size_t i = 0; i < kLeafCount; ++i)
+    {
+        leaves[i] = createRandomBounds(rng);
+        hierarchy.setLeaf(i, leaves[i]);
+    }
+    hierarchy.build();
+
+    std::vector<size_t> changes(kChangeCount);
+    for (auto& i : changes) i = rng() % kLeafCount;
+
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    for (size_t i : changes) leaves[i] = createRandomBounds(rng);
+    AABB bounds = computeUnion(leaves);
+    auto t1 = CpuTimer::getCurrentTimePoint();
+    for (size_t i : changes) hierarchy.setLeaf(i, leaves[i]);
+    hierarchy.refit();
+    auto t2 = CpuTimer::getCurrentTimePoint();
+    EXPECT(hierarchy.getBounds() == bounds);
+
+    logInfo(
+        "BoundsHierarchy benchmark ({} leaves, {} changed): full union {:.3f} ms, refit {:.3f} ms", kLeafCount, kChangeCount,
+        CpuTimer::calcDuration(t0, t1), CpuTimer::calcDuration(t1, t2)
+    );
+}
+} // namespace Falcor
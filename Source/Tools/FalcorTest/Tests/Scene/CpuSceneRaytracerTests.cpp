@@ -0,0 +1,478 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/CpuRaytracing/CpuSceneRaytracer.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/TriangleMesh.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Core/Program/RtBindingTable.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Math/MatrixMath.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Raytracer = CpuSceneRaytracer;
+
+const char kShaderFile[] = "Tests/Scene/CpuSceneRaytracerTests.rt.slang";
+
+float3 randomFloat3(std::mt19937& rng, float lo, float hi)
+{
+    std::uniform_real_distribution<float> u(lo, hi);
+    return float3(u(rng), u(rng), u(rng));
+}
+
+float3 randomDirection(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    float z = 1.f - 2.f * u(rng);
+    float r = std::sqrt(std::max(0.f, 1.f - z * z));
+    float phi = 2.f * 3.14159265f * u(rng);
+    return float3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+Raytracer::GeometryDesc createRandomGeometry(std::mt19937& rng, uint32_t triangleCount, bool indexed)
+{
+    Raytracer::GeometryDesc geometry;
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        float3 center = randomFloat3(rng, -1.f, 1.f);
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            if (indexed) geometry.indices.push_back((uint32_t)geometry.positions.size());
+            geometry.positions.push_back(center + randomFloat3(rng, -0.1f, 0.1f));
+        }
+    }
+    return geometry;
+}
+
+Raytracer::GeometryDesc createGeometry(const TriangleMesh& mesh)
+{
+    Raytracer::GeometryDesc geometry;
+    for (const auto& vertex : mesh.getVertices()) geometry.positions.push_back(vertex.position);
+    geometry.indices = mesh.getIndices();
+    return geometry;
+}
+
+/** Brute force closest hit for validation.
+*/
+bool traceReference(const Raytracer::Desc& desc, const Ray& ray, Raytracer::Hit& hit)
+{
+    hit = Raytracer::Hit();
+    float tMax = ray.tMax;
+    for (uint32_t instanceIndex = 0; instanceIndex < (uint32_t)desc.instances.size(); ++instanceIndex)
+    {
+        const auto& instance = desc.instances[instanceIndex];
+        float4x4 worldToObject = inverse(instance.transform);
+        float3 origin = transformPoint(worldToObject, ray.origin);
+        float3 dir = transformVector(worldToObject, ray.dir);
+
+        const auto& blas = desc.blases[instance.blasIndex];
+        for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)blas.geometries.size(); ++geometryIndex)
+        {
+            const auto& geometry = blas.geometries[geometryIndex];
+            for (uint32_t triangle = 0; triangle < geometry.getTriangleCount(); ++triangle)
+            {
+                float3 v[3];
+                for (uint32_t j = 0; j < 3; ++j)
+                    v[j] = geometry.positions[geometry.indices.empty() ? 3 * triangle + j : geometry.indices[3 * triangle + j]];
+
+                float3 e1 = v[1] - v[0];
+                float3 e2 = v[2] - v[0];
+                float3 p = cross(dir, e2);
+                float det = dot(e1, p);
+                if (det == 0.f)
+                    continue;
+                float3 s = origin - v[0];
+                float u = dot(s, p) / det;
+                float3 q = cross(s, e1);
+                float w = dot(dir, q) / det;
+                float t = dot(e2, q) / det;
+                if (u < 0.f || w < 0.f || u + w > 1.f || t <= ray.tMin || t >= tMax)
+                    continue;
+
+                tMax = t;
+                hit.type = HitType::Triangle;
+                hit.t = t;
+                hit.instanceID = instance.instanceID + geometryIndex;
+                hit.primitiveIndex = triangle;
+                hit.barycentrics = float2(u, w);
+                hit.instanceIndex = instanceIndex;
+                hit.geometryIndex = geometryIndex;
+            }
+        }
+    }
+    return hit.isValid();
+}
+
+/** Create rays from a pinhole camera looking at the center of the bounds (coherent),
+    or with random origins inside the bounds and random directions (incoherent).
+*/
+std::vector<Ray> createRays(const AABB& bounds, uint32_t count, bool coherent, std::mt19937& rng)
+{
+    std::vector<Ray> rays(count);
+    const float3 center = bounds.center();
+    const float radius = bounds.radius();
+    if (coherent)
+    {
+        const uint32_t width = (uint32_t)std::sqrt((float)count);
+        const float3 eye = center + float3(0.f, 0.f, 2.5f * radius);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float x = ((i % width) + 0.5f) / width * 2.f - 1.f;
+            float y = ((i / width) % width + 0.5f) / width * 2.f - 1.f;
+            rays[i] = Ray(eye, normalize(float3(0.5f * x, 0.5f * y, -1.f)));
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float3 origin = bounds.minPoint + randomFloat3(rng, 0.f, 1.f) * bounds.extent();
+            rays[i] = Ray(origin, randomDirection(rng));
+        }
+    }
+    return rays;
+}
+/** Build a scene with static and instanced triangle meshes under various transforms.
+*/
+ref<Scene> buildScene(ref<Device> pDevice)
+{
+    Settings settings;
+    SceneBuilder builder(pDevice, settings);
+
+    auto pMaterial = StandardMaterial::create(pDevice, "Material");
+    MeshID cubeID = builder.addTriangleMesh(TriangleMesh::createCube(), pMaterial);
+    MeshID sphereID = builder.addTriangleMesh(TriangleMesh::createSphere(), pMaterial);
+    MeshID instancedCubeID = builder.addTriangleMesh(TriangleMesh::createCube(float3(0.5f, 1.f, 1.5f)), pMaterial);
+
+    const std::pair<MeshID, float4x4> instances[] = {
+        {cubeID, mul(math::matrixFromTranslation(float3(-3.f, 0.f, 0.f)), math::matrixFromRotation(0.5f, normalize(float3(1.f, 2.f, 3.f))))},
+        {sphereID, mul(math::matrixFromTranslation(float3(0.f, 0.f, 0.f)), math::matrixFromScaling(float3(1.5f, 1.f, 0.75f)))},
+        {instancedCubeID, math::matrixFromTranslation(float3(3.f, 0.f, 0.f))},
+        {instancedCubeID, mul(math::matrixFromTranslation(float3(0.f, 3.f, 0.f)), math::matrixFromRotation(1.f, float3(0.f, 1.f, 0.f)))},
+    };
+    for (size_t i = 0; i < std::size(instances); ++i)
+    {
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i), instances[i].second, float4x4::identity()});
+        builder.addMeshInstance(nodeID, instances[i].first);
+    }
+
+    return builder.getScene();
+}
+
+/** Trace rays with Scene::raytrace() and return the packed hits and hit distances.
+*/
+void traceGPU(GPUUnitTestContext& ctx, const ref<Scene>& pScene, const std::vector<Ray>& rays, std::vector<uint4>& hits, std::vector<float>& hitT)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    ProgramDesc desc;
+    desc.addShaderModules(pScene->getShaderModules());
+    desc.addShaderLibrary(kShaderFile);
+    desc.addTypeConformances(pScene->getTypeConformances());
+    desc.setMaxPayloadSize(4);
+    desc.setMaxAttributeSize(pScene->getRaytracingMaxAttributeSize());
+    desc.setMaxTraceRecursionDepth(1);
+
+    ref<RtBindingTable> sbt = RtBindingTable::create(1, 1, pScene->getGeometryCount());
+    sbt->setRayGen(desc.addRayGen("rayGen"));
+    sbt->setMiss(0, desc.addMiss("miss"));
+    sbt->setHitGroup(0, pScene->getGeometryIDs(Scene::GeometryType::TriangleMesh), desc.addHitGroup("closestHit"));
+
+    ref<Program> pProgram = Program::create(pDevice, desc, pScene->getSceneDefines());
+    ref<RtProgramVars> pVars = RtProgramVars::create(pDevice, pProgram, sbt);
+
+    const uint32_t rayCount = (uint32_t)rays.size();
+    auto var = pVars->getRootVar();
+    var["gRays"] = pDevice->createStructuredBuffer(var["gRays"], rayCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, rays.data());
+    ref<Buffer> pHits = pDevice->createStructuredBuffer(var["gHits"], rayCount);
+    ref<Buffer> pHitT = pDevice->createStructuredBuffer(var["gHitT"], rayCount);
+    var["gHits"] = pHits;
+    var["gHitT"] = pHitT;
+
+    pScene->raytrace(ctx.getRenderContext(), pProgram.get(), pVars, uint3(rayCount, 1, 1));
+
+    hits = pHits->getElements<uint4>();
+    hitT = pHitT->getElements<float>();
+}
+
+/** Check if a hit is close to a triangle edge, where the GPU and CPU may disagree on the hit triangle.
+*/
+bool isNearEdge(float2 barycentrics)
+{
+    return std::min({barycentrics.x, barycentrics.y, 1.f - barycentrics.x - barycentrics.y}) < 1e-3f;
+}
+} // namespace
+
+CPU_TEST(CpuSceneRaytracer_BruteForce)
+{
+    std::mt19937 rng(0);
+
+    // Two BLASes with indexed and non-indexed geometries, instanced with various transforms.
+    Raytracer::Desc desc;
+    desc.blases.resize(2);
+    desc.blases[0].geometries.push_back(createRandomGeometry(rng, 500, true));
+    desc.blases[0].geometries.push_back(createRandomGeometry(rng, 300, false));
+    desc.blases[1].geometries.push_back(createRandomGeometry(rng, 1000, true));
+
+    uint32_t instanceID = 0;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        Raytracer::InstanceDesc instance;
+        instance.blasIndex = i % 2;
+        instance.instanceID = instanceID;
+        float4x4 rotation = math::matrixFromRotation(0.5f * i, normalize(float3(1.f, 2.f, 3.f)));
+        float4x4 scale = math::matrixFromScaling(float3(1.f + 0.2f * i, 1.f, 1.f - 0.1f * i));
+        instance.transform = mul(math::matrixFromTranslation(randomFloat3(rng, -2.f, 2.f)), mul(rotation, scale));
+        if (i == 0)
+            instance.transform = float4x4::identity();
+        desc.instances.push_back(instance);
+        instanceID += (uint32_t)desc.blases[instance.blasIndex].geometries.size();
+    }
+
+    ref<Raytracer> pRaytracer = Raytracer::create(desc);
+    EXPECT_EQ(pRaytracer->getStats().triangleCount, 1800u);
+    EXPECT_EQ(pRaytracer->getStats().instanceCount, 6u);
+
+    std::vector<Ray> rays = createRays(pRaytracer->getBounds(), 2000, false, rng);
+    std::vector<Ray> coherentRays = createRays(pRaytracer->getBounds(), 2000, true, rng);
+    rays.insert(rays.end(), coherentRays.begin(), coherentRays.end());
+
+    std::vector<Raytracer::Hit> hits;
+    pRaytracer->traceClosestHits(rays, hits);
+    std::vector<uint8_t> occluded;
+    pRaytracer->traceAnyHits(rays, occluded);
+
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        Raytracer::Hit ref;
+        bool refHit = traceReference(desc, rays[i], ref);
+        EXPECT_EQ(hits[i].isValid(), refHit) << "ray " << i;
+        EXPECT_EQ(occluded[i] != 0, refHit) << "ray " << i;
+        if (!refHit || !hits[i].isValid())
+            continue;
+
+        hitCount++;
+        EXPECT_EQ(hits[i].instanceID, ref.instanceID) << "ray " << i;
+        EXPECT_EQ(hits[i].primitiveIndex, ref.primitiveIndex) << "ray " << i;
+        EXPECT_EQ(hits[i].instanceIndex, ref.instanceIndex) << "ray " << i;
+        EXPECT_LE(std::abs(hits[i].t - ref.t), 1e-4f * ref.t) << "ray " << i;
+        EXPECT_LE(std::abs(hits[i].barycentrics.x - ref.barycentrics.x), 1e-3f) << "ray " << i;
+        EXPECT_LE(std::abs(hits[i].barycentrics.y - ref.barycentrics.y), 1e-3f) << "ray " << i;
+    }
+    EXPECT_GT(hitCount, 0u);
+
+    // The ray interval is respected.
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        if (!hits[i].isValid())
+            continue;
+        Ray shortRay = rays[i];
+        shortRay.tMax = 0.99f * hits[i].t;
+        Raytracer::Hit hit;
+        Raytracer::Hit ref;
+        EXPECT_EQ(pRaytracer->traceClosestHit(shortRay, hit), traceReference(desc, shortRay, ref)) << "ray " << i;
+    }
+}
+
+GPU_TEST(CpuSceneRaytracer_MatchesGPU)
+{
+    if (!ctx.getDevice()->isFeatureSupported(Device::SupportedFeatures::Raytracing))
+        ctx.skip("Raytracing is not supported");
+
+    ref<Scene> pScene = buildScene(ctx.getDevice());
+    pScene->update(ctx.getRenderContext(), 0.0);
+
+    // The description covers all geometry instances of the scene.
+    Raytracer::Desc desc = Raytracer::createDesc(*pScene);
+    uint32_t geometryInstanceCount = 0;
+    for (const auto& instance : desc.instances)
+        geometryInstanceCount += (uint32_t)desc.blases[instance.blasIndex].geometries.size();
+    EXPECT_EQ(geometryInstanceCount, pScene->getGeometryInstanceCount());
+
+    ref<Raytracer> pRaytracer = Raytracer::create(*pScene);
+    ref<Raytracer> pRaytracerFromDesc = Raytracer::create(desc);
+
+    // Rays from outside the scene towards random points inside its bounds.
+    std::mt19937 rng(2);
+    const AABB bounds = pRaytracer->getBounds();
+    const float radius = bounds.radius();
+    std::vector<Ray> rays(4096);
+    for (auto& ray : rays)
+    {
+        float3 target = bounds.minPoint + randomFloat3(rng, 0.f, 1.f) * bounds.extent();
+        float3 origin = bounds.center() + 2.f * radius * randomDirection(rng);
+        ray = Ray(origin, normalize(target - origin));
+    }
+
+    std::vector<Raytracer::Hit> hits;
+    pRaytracer->traceClosestHits(rays, hits);
+    std::vector<Raytracer::Hit> hitsFromDesc;
+    pRaytracerFromDesc->traceClosestHits(rays, hitsFromDesc);
+
+    std::vector<uint4> gpuHits;
+    std::vector<float> gpuHitT;
+    traceGPU(ctx, pScene, rays, gpuHits, gpuHitT);
+
+    const HitInfo& hitInfo = pScene->getHitInfo();
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        const Raytracer::Hit& hit = hits[i];
+        EXPECT_EQ(hitsFromDesc[i].isValid(), hit.isValid()) << "ray " << i;
+        EXPECT_EQ(hitsFromDesc[i].instanceID, hit.instanceID) << "ray " << i;
+        EXPECT_EQ(hitsFromDesc[i].primitiveIndex, hit.primitiveIndex) << "ray " << i;
+
+        // The scene uses uncompressed hit info, which stores the barycentrics as floats.
+        const uint4 gpuHit = gpuHits[i];
+        const bool gpuValid = gpuHitT[i] < std::numeric_limits<float>::max();
+        const float2 gpuBarycentrics(asfloat(gpuHit[2]), asfloat(gpuHit[3]));
+
+        // Skip rays grazing triangle edges, where either side may report the neighboring triangle or a miss.
+        if ((hit.isValid() && isNearEdge(hit.barycentrics)) || (gpuValid && isNearEdge(gpuBarycentrics)))
+            continue;
+
+        EXPECT_EQ(hit.isValid(), gpuValid) << "ray " << i;
+        if (!hit.isValid() || !gpuValid)
+        {
+            EXPECT(all(gpuHit == uint4(0u))) << "ray " << i;
+            continue;
+        }
+
+        hitCount++;
+        EXPECT_LE(std::abs(hit.t - gpuHitT[i]), 1e-4f * gpuHitT[i]) << "ray " << i;
+        EXPECT_LE(std::abs(hit.barycentrics.x - gpuBarycentrics.x), 1e-4f) << "ray " << i;
+        EXPECT_LE(std::abs(hit.barycentrics.y - gpuBarycentrics.y), 1e-4f) << "ray " << i;
+
+        // The header with hit type, instance ID and primitive index matches exactly.
+        const uint4 packed = hitInfo.packTriangleHit(hit.instanceID, hit.primitiveIndex, gpuBarycentrics);
+        EXPECT(all(packed == gpuHit)) << "ray " << i << ": instance " << hit.instanceID << ", primitive " << hit.primitiveIndex;
+    }
+    EXPECT_GT(hitCount, (uint32_t)rays.size() / 4);
+}
+
+CPU_TEST(CpuSceneRaytracer_MeshImport)
+{
+    // Import meshes without a device and check that rays towards the center hit the surface.
+    for (const char* path : {"data/framework/meshes/cube.obj", "data/framework/meshes/sphere.fbx"})
+    {
+        ref<TriangleMesh> pMesh = TriangleMesh::createFromFile(getRuntimeDirectory() / path);
+        ASSERT(pMesh != nullptr);
+
+        Raytracer::Desc desc;
+        desc.blases.resize(1);
+        desc.blases[0].geometries.push_back(createGeometry(*pMesh));
+        desc.instances.resize(1);
+        ref<Raytracer> pRaytracer = Raytracer::create(desc);
+
+        const AABB bounds = pRaytracer->getBounds();
+        EXPECT(bounds.valid());
+        EXPECT_EQ(pRaytracer->getStats().triangleCount, pMesh->getIndices().size() / 3);
+
+        std::mt19937 rng(1);
+        const float radius = bounds.radius();
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            float3 dir = randomDirection(rng);
+            Ray ray(bounds.center() - 2.f * radius * dir, dir);
+            Raytracer::Hit hit;
+            EXPECT(pRaytracer->traceClosestHit(ray, hit)) << path;
+            EXPECT(pRaytracer->traceAnyHit(ray)) << path;
+            float3 p = ray.origin + hit.t * ray.dir;
+            EXPECT(all(p >= bounds.minPoint - 1e-3f * radius) && all(p <= bounds.maxPoint + 1e-3f * radius)) << path;
+        }
+    }
+}
+
+CPU_TEST(CpuSceneRaytracer_Benchmark, TAGS("benchmark"))
+{
+    // Benchmark a grid of instanced spheres, or the mesh given by FALCOR_CPU_RT_BENCHMARK_MESH.
+    Raytracer::Desc desc;
+    desc.blases.resize(1);
+    if (auto meshPath = getEnvironmentVariable("FALCOR_CPU_RT_BENCHMARK_MESH"))
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        ref<TriangleMesh> pMesh = TriangleMesh::createFromFile(*meshPath);
+        ASSERT(pMesh != nullptr);
+        logInfo("Imported '{}' in {:.1f} ms.", *meshPath, CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint()));
+        desc.blases[0].geometries.push_back(createGeometry(*pMesh));
+        desc.instances.resize(1);
+    }
+    else
+    {
+        desc.blases[0].geometries.push_back(createGeometry(*TriangleMesh::createSphere(0.5f, 128, 64)));
+        const uint32_t kGridSize = 16;
+        for (uint32_t i = 0; i < kGridSize * kGridSize * kGridSize; ++i)
+        {
+            Raytracer::InstanceDesc instance;
+            instance.instanceID = i;
+            instance.transform = math::matrixFromTranslation(float3(i % kGridSize, (i / kGridSize) % kGridSize, i / (kGridSize * kGridSize)) * 1.5f);
+            desc.instances.push_back(instance);
+        }
+    }
+
+    ref<Raytracer> pRaytracer = Raytracer::create(desc);
+    const auto& stats = pRaytracer->getStats();
+    logInfo(
+        "CpuSceneRaytracer: {} instances, {} triangles, {} nodes, max depth {}, {:.1f} MB, build {:.1f} ms",
+        stats.instanceCount, stats.triangleCount, stats.nodeCount, stats.maxDepth, stats.memoryInBytes / (1024.0 * 1024.0), stats.buildTime * 1e3
+    );
+
+    const uint32_t kRayCount = 1024 * 1024;
+    std::mt19937 rng(0);
+    for (bool coherent : {true, false})
+    {
+        std::vector<Ray> rays = createRays(pRaytracer->getBounds(), kRayCount, coherent, rng);
+        std::vector<Raytracer::Hit> hits;
+        std::vector<uint8_t> occluded;
+
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        pRaytracer->traceClosestHits(rays, hits);
+        auto t1 = CpuTimer::getCurrentTimePoint();
+        pRaytracer->traceAnyHits(rays, occluded);
+        auto t2 = CpuTimer::getCurrentTimePoint();
+
+        size_t hitCount = std::count_if(hits.begin(), hits.end(), [](const Raytracer::Hit& hit) { return hit.isValid(); });
+        size_t occludedCount = std::count(occluded.begin(), occluded.end(), uint8_t(1));
+        EXPECT_EQ(hitCount, occludedCount);
+        logInfo(
+            "  {} rays: closest hit {:.2f} Mrays/s, any hit {:.2f} Mrays/s, {:.1f}% hit",
+            coherent ? "coherent  " : "incoherent",
+            kRayCount / (CpuTimer::calcDuration(t0, t1) * 1e3),
+            kRayCount / (CpuTimer::calcDuration(t1, t2) * 1e3),
+            100.0 * hitCount / kRayCount
+        );
+    }
+}
+} // namespace Falcor
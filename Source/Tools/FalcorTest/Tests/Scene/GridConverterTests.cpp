@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/Grid.h"
+#include "Scene/Volume/GridConverter.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+template<typename Converter>
+void testConverterPaths(GPUUnitTestContext& ctx, const ref<Grid>& pGrid)
+{
+    const nanovdb::FloatGrid* pFloatGrid = pGrid->getGridHandle().grid<float>();
+
+    Converter reference(pFloatGrid, false, false);
+    reference.convertToHost();
+    EXPECT_GT(reference.getNonEmptyCount(), 0u);
+
+    Converter converter(pFloatGrid, true, true);
+    converter.convertToHost();
+    EXPECT_EQ(converter.getNonEmptyCount(), reference.getNonEmptyCount());
+    EXPECT(converter.getRangeData() == reference.getRangeData());
+    EXPECT(converter.getPtrData() == reference.getPtrData());
+    EXPECT(converter.getAtlasData() == reference.getAtlasData());
+}
+} // namespace
+
+CPU_TEST(BC4Encode_SIMD)
+{
+#if BC4_ENCODE_SSE2
+    const bool hasAVX2 = HasAVX2();
+    if (!hasAVX2)
+        logWarning("BC4Encode_SIMD: AVX2 is not supported, only testing the SSE2 variant.");
+#endif
+    std::mt19937 rng(0);
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        // Mix random, narrow range, constant and saturated tiles to cover all endpoint cases.
+        uint8_t tile[16];
+        const int base = rng() % 256;
+        const int span = (rng() % 32) + 1;
+        for (uint32_t j = 0; j < 16; ++j)
+        {
+            switch (i % 4)
+            {
+            case 0: tile[j] = uint8_t(rng() % 256); break;
+            case 1: tile[j] = uint8_t(std::min(255, base + int(rng() % span))); break;
+            case 2: tile[j] = uint8_t(rng() % 3 == 0 ? 0 : (rng() % 2 == 0 ? 255 : base)); break;
+            default: tile[j] = uint8_t(base); break;
+            }
+        }
+
+        uint64_t expected, block;
+        CompressAlphaDxt5Scalar(tile, &expected);
+        CompressAlphaDxt5(tile, &block);
+        EXPECT_EQ(block, expected) << "tile " << i;
+
+        // Test all variants supported by the cpu, not only the one selected by dispatch.
+#if BC4_ENCODE_SSE2
+        CompressAlphaDxt5SSE2(tile, &block);
+        EXPECT_EQ(block, expected) << "tile " << i << " (SSE2)";
+        if (hasAVX2)
+        {
+            CompressAlphaDxt5AVX2(tile, &block);
+            EXPECT_EQ(block, expected) << "tile " << i << " (AVX2)";
+        }
+#endif
+    }
+}
+
+GPU_TEST(GridConverter_Parallel)
+{
+    // The parallel/SIMD conversion must match the serial/scalar conversion exactly.
+    ref<Grid> pSphere = Grid::createSphere(ctx.getDevice(), 1.f, 0.02f, 0.5f);
+    testConverterPaths<NanoVDBConverterBC4>(ctx, pSphere);
+    testConverterPaths<NanoVDBConverterUNORM8>(ctx, pSphere);
+    testConverterPaths<NanoVDBConverterUNORM16>(ctx, pSphere);
+
+    ref<Grid> pBox = Grid::createBox(ctx.getDevice(), 1.f, 2.f, 0.5f, 0.02f, 0.25f);
+    testConverterPaths<NanoVDBConverterBC4>(ctx, pBox);
+}
+
+GPU_TEST(GridConverter_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kIterations = 3;
+
+    struct Path
+    {
+        const char* name;
+        bool parallel;
+        bool useSimd;
+    };
+    const Path kPaths[] = {
+        {"serial scalar", false, false},
+        {"serial SIMD", false, true},
+        {"parallel scalar", true, false},
+        {"parallel SIMD", true, true},
+    };
+
+    auto benchmark = [&](const char* gridName, const ref<Grid>& pGrid)
+    {
+        const nanovdb::FloatGrid* pFloatGrid = pGrid->getGridHandle().grid<float>();
+        logInfo("NanoVDBToBricksConverter benchmark on {} ({} workers):", gridName, Threading::getWorkerCount());
+        for (const auto& path : kPaths)
+        {
+            double time = 0.0;
+            uint64_t voxelCount = 0;
+            for (uint32_t i = 0; i < kIterations; ++i)
+            {
+                NanoVDBConverterBC4 converter(pFloatGrid, path.parallel, path.useSimd);
+                auto start = CpuTimer::getCurrentTimePoint();
+                converter.convertToHost();
+                time += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+                voxelCount = converter.getVoxelCount();
+            }
+            time /= kIterations;
+            logInfo("  {:<16} {:8.1f} ms, {:.1f} Mvoxels/s", path.name, time, voxelCount / (time * 1e-3) * 1e-6);
+        }
+    };
+
+    benchmark("sphere", Grid::createSphere(ctx.getDevice(), 1.f, 0.005f, 0.5f));
+    benchmark("box", Grid::createBox(ctx.getDevice(), 2.f, 2.f, 1.f, 0.005f, 0.25f));
+}
+} // namespace Falcor
@@ -0,0 +1,263 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include "Scene/Volume/GridSequenceStream.h"
+#include "Scene/Volume/GridVolume.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Threading.h"
+
+#include <nanovdb/util/IO.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kFrameCount = 6;
+
+/// Temporary sequence of sphere grids with increasing radius, so that each frame has a distinct voxel count.
+struct GridSequenceFiles
+{
+    std::vector<std::filesystem::path> paths;
+    std::vector<uint64_t> voxelCounts;
+    std::string gridname;
+
+    GridSequenceFiles(ref<Device> pDevice)
+    {
+        for (uint32_t i = 0; i < kFrameCount; ++i)
+        {
+            auto pGrid = Grid::createSphere(pDevice, 1.f + 0.25f * i, 0.1f);
+            gridname = pGrid->getGridHandle().grid<float>()->gridName();
+            auto path = getTempFilePath().replace_extension(".nvdb");
+            nanovdb::io::writeGrid(path.string(), pGrid->getGridHandle());
+            paths.push_back(path);
+            voxelCounts.push_back(pGrid->getVoxelCount());
+        }
+    }
+
+    ~GridSequenceFiles()
+    {
+        for (const auto& path : paths)
+            std::filesystem::remove(path);
+    }
+};
+} // namespace
+
+GPU_TEST(GridSequenceStream_Requests)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    GridSequenceFiles files(pDevice);
+
+    GridSequenceStream::Options options;
+    options.windowSize = 3;
+    options.prefetchCount = 1;
+    ref<GridSequenceStream> pStream = GridSequenceStream::create(pDevice, files.paths, files.gridname, options);
+    EXPECT_EQ(pStream->getFrameCount(), kFrameCount);
+
+    // First request loads the frame and prefetches the next one. The load may complete before the
+    // request checks for it, in which case it is counted as a hit rather than a miss.
+    ref<Grid> pGrid0 = pStream->getGrid(0);
+    ASSERT(pGrid0 != nullptr);
+    EXPECT_EQ(pGrid0->getVoxelCount(), files.voxelCounts[0]);
+    auto stats = pStream->getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 1u);
+    EXPECT_EQ(stats.prefetches, 1u);
+    const uint64_t misses = stats.misses;
+
+    // Requesting a resident frame returns the same grid without reloading.
+    EXPECT(pStream->getGrid(0) == pGrid0);
+    EXPECT_EQ(pStream->getStats().hits + misses, 2u);
+
+    // Once the prefetch has completed, the next frame is a hit.
+    Threading::finish();
+    ref<Grid> pGrid1 = pStream->getGrid(1);
+    ASSERT(pGrid1 != nullptr);
+    EXPECT_EQ(pGrid1->getVoxelCount(), files.voxelCounts[1]);
+    stats = pStream->getStats();
+    EXPECT_EQ(stats.misses, misses);
+    EXPECT_EQ(stats.hits + misses, 3u);
+    EXPECT_EQ(stats.prefetches, 2u);
+    EXPECT_EQ(stats.evictions, 0u);
+
+    // Frames 0-3 exceed the window of 3, the least recently used frame 0 is evicted.
+    Threading::finish();
+    EXPECT_EQ(pStream->getGrid(2)->getVoxelCount(), files.voxelCounts[2]);
+    Threading::finish();
+    stats = pStream->getStats();
+    EXPECT_EQ(stats.misses, misses);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.residentFrameCount, 3u);
+    EXPECT(pStream->getGrid(1) == pGrid1);
+
+    // The evicted frame has to be reloaded, which creates a new grid.
+    ref<Grid> pReloaded0 = pStream->getGrid(0);
+    EXPECT(pReloaded0 != pGrid0);
+    EXPECT_EQ(pReloaded0->getVoxelCount(), files.voxelCounts[0]);
+
+    // Play backwards through the whole sequence, the window is never exceeded.
+    pStream->resetStats();
+    for (uint32_t i = 0; i < 2 * kFrameCount; ++i)
+    {
+        uint32_t frame = (kFrameCount - i % kFrameCount) % kFrameCount;
+        EXPECT_EQ(pStream->getGrid(frame, -1)->getVoxelCount(), files.voxelCounts[frame]);
+        Threading::finish();
+        EXPECT_LE(pStream->getStats().residentFrameCount, options.windowSize);
+    }
+    stats = pStream->getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 2 * kFrameCount);
+    EXPECT_GT(stats.evictions, 0u);
+
+    // A tiny memory budget only keeps the requested and prefetched frames.
+    options.memoryBudget = 1;
+    pStream->setOptions(options);
+    EXPECT_LE(pStream->getStats().residentFrameCount, 1u + options.prefetchCount);
+}
+
+GPU_TEST(GridSequenceStream_LoadError)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    GridSequenceFiles files(pDevice);
+
+    // Replace frame 1 with a file that is not a valid grid file.
+    const std::filesystem::path validPath = getTempFilePath().replace_extension(".nvdb");
+    std::filesystem::rename(files.paths[1], validPath);
+    {
+        std::ofstream file(files.paths[1], std::ios::binary);
+        file << "not a grid file";
+    }
+
+    GridSequenceStream::Options options;
+    options.windowSize = 3;
+    options.prefetchCount = 1;
+    ref<GridSequenceStream> pStream = GridSequenceStream::create(pDevice, files.paths, files.gridname, options);
+
+    // The failing prefetch of frame 1 does not count against the window, frames 0, 2 and 3 stay resident.
+    EXPECT(pStream->getGrid(0) != nullptr);
+    Threading::finish();
+    EXPECT_EQ(pStream->getStats().residentFrameCount, 1u);
+    EXPECT_EQ(pStream->getGrid(2)->getVoxelCount(), files.voxelCounts[2]);
+    Threading::finish();
+    EXPECT_EQ(pStream->getStats().residentFrameCount, 3u);
+    EXPECT_EQ(pStream->getStats().evictions, 0u);
+
+    // The error of the prefetch is reported to the requester of the frame.
+    EXPECT_THROW(pStream->getGrid(1));
+
+    // The next request reloads the frame.
+    std::filesystem::remove(files.paths[1]);
+    std::filesystem::rename(validPath, files.paths[1]);
+    ref<Grid> pGrid1 = pStream->getGrid(1);
+    ASSERT(pGrid1 != nullptr);
+    EXPECT_EQ(pGrid1->getVoxelCount(), files.voxelCounts[1]);
+}
+
+GPU_TEST(GridSequenceStream_SetGridFrame)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    GridSequenceFiles files(pDevice);
+
+    GridSequenceStream::Options options;
+    options.windowSize = 2;
+    options.prefetchCount = 1;
+    ref<GridVolume> pGridVolume = GridVolume::create(pDevice, "volume");
+    EXPECT_EQ(pGridVolume->loadGridSequenceStream(GridVolume::GridSlot::Density, files.paths, files.gridname, options), kFrameCount);
+    EXPECT_EQ(pGridVolume->getGridFrameCount(), kFrameCount);
+
+    const auto& pStream = pGridVolume->getGridSequenceStream(GridVolume::GridSlot::Density);
+    ASSERT(pStream != nullptr);
+
+    for (uint32_t frame : {3u, 4u, 2u, 0u, 5u})
+    {
+        pGridVolume->setGridFrame(frame);
+        const auto& pGrid = pGridVolume->getDensityGrid();
+        ASSERT(pGrid != nullptr);
+        EXPECT_EQ(pGrid->getVoxelCount(), files.voxelCounts[frame]);
+
+        // Only the current frame's grid is referenced by the volume.
+        uint32_t gridCount = 0;
+        for (const auto& pSequenceGrid : pGridVolume->getGridSequence(GridVolume::GridSlot::Density))
+            gridCount += pSequenceGrid ? 1 : 0;
+        EXPECT_EQ(gridCount, 1u);
+
+        Threading::finish();
+        EXPECT_LE(pStream->getStats().residentFrameCount, options.windowSize);
+    }
+}
+
+GPU_TEST(GridSequenceStream_SceneCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    GridSequenceFiles files(pDevice);
+
+    GridSequenceStream::Options options;
+    options.windowSize = 4;
+    options.prefetchCount = 2;
+    ref<GridVolume> pGridVolume = GridVolume::create(pDevice, "volume");
+    pGridVolume->loadGridSequenceStream(GridVolume::GridSlot::Density, files.paths, files.gridname, options);
+    pGridVolume->setGridFrame(2);
+
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+    sceneData.gridVolumes.push_back(pGridVolume);
+    sceneData.grids.push_back(pGridVolume->getDensityGrid());
+
+    auto path = getTempFilePath();
+    SceneCache::writeCache(sceneData, path);
+    {
+        Scene::SceneData loaded = SceneCache::readCache(pDevice, path);
+        ASSERT_EQ(loaded.gridVolumes.size(), 1u);
+        const auto& pLoadedVolume = loaded.gridVolumes[0];
+        EXPECT_EQ(pLoadedVolume->getGridFrame(), 2u);
+        EXPECT_EQ(pLoadedVolume->getGridFrameCount(), kFrameCount);
+        EXPECT_EQ(pLoadedVolume->getDensityGrid()->getVoxelCount(), files.voxelCounts[2]);
+
+        // The stream is recreated from its source files.
+        const auto& pStream = pLoadedVolume->getGridSequenceStream(GridVolume::GridSlot::Density);
+        ASSERT(pStream != nullptr);
+        EXPECT(pStream->getPaths() == files.paths);
+        EXPECT_EQ(pStream->getGridname(), files.gridname);
+        EXPECT_EQ(pStream->getOptions().windowSize, options.windowSize);
+        EXPECT_EQ(pStream->getOptions().prefetchCount, options.prefetchCount);
+
+        pLoadedVolume->setGridFrame(3);
+        EXPECT_EQ(pLoadedVolume->getDensityGrid()->getVoxelCount(), files.voxelCounts[3]);
+    }
+
+    // The legacy format cannot represent streamed sequences.
+    auto legacyPath = getTempFilePath();
+    EXPECT_THROW(SceneCache::writeLegacyCache(sceneData, legacyPath));
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(legacyPath);
+}
+} // namespace Falcor
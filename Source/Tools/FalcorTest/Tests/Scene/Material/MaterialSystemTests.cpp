@@ -0,0 +1,214 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/Material/PBRT/PBRTDiffuseMaterial.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Create a standard material with one of 'variantCount' different parameter sets.
+ref<StandardMaterial> createVariant(ref<Device> pDevice, uint32_t index, uint32_t variantCount)
+{
+    uint32_t variant = index % variantCount;
+    auto pMaterial = StandardMaterial::create(pDevice, fmt::format("Material{}", index));
+    pMaterial->setBaseColor(float4(float(variant % 256) / 255.f, float(variant / 256 % 256) / 255.f, float(variant / 65536) / 255.f, 1.f));
+    pMaterial->setRoughness(variant % 2 ? 0.5f : 0.25f);
+    return pMaterial;
+}
+
+/// Reference implementation comparing each material against all unique materials.
+std::vector<MaterialID> findDuplicatesBruteForce(const MaterialSystem& materials)
+{
+    std::vector<ref<Material>> uniqueMaterials;
+    std::vector<MaterialID> idMap(materials.getMaterialCount());
+    for (MaterialID id{0}; id.get() < materials.getMaterialCount(); ++id)
+    {
+        const auto& pMaterial = materials.getMaterial(id);
+        auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&](const auto& m) { return m->isEqual(pMaterial); });
+        if (it == uniqueMaterials.end())
+        {
+            idMap[id.get()] = MaterialID{uniqueMaterials.size()};
+            uniqueMaterials.push_back(pMaterial);
+        }
+        else
+        {
+            idMap[id.get()] = MaterialID{(size_t)std::distance(uniqueMaterials.begin(), it)};
+        }
+    }
+    return idMap;
+}
+} // namespace
+
+GPU_TEST(MaterialSystem_ComputeHash)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Equal materials have equal hashes, independent of the name.
+    auto pA = createVariant(pDevice, 0, 4);
+    auto pB = createVariant(pDevice, 4, 4);
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+
+    // The hash is stable.
+    EXPECT_EQ(pA->computeHash(), pA->computeHash());
+
+    // Changing a parameter changes the hash.
+    pB->setRoughness(0.75f);
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_NE(pA->computeHash(), pB->computeHash());
+
+    // Positive and negative zero compare equal, so they must hash equal.
+    pB = createVariant(pDevice, 4, 4);
+    pB->setEmissiveColor(float3(1.f));
+    pB->setEmissiveColor(float3(-0.f));
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+
+    // Materials of different types are not equal.
+    auto pDiffuse = PBRTDiffuseMaterial::create(pDevice, "Diffuse");
+    auto pStandard = StandardMaterial::create(pDevice, "Standard");
+    EXPECT(!pDiffuse->isEqual(pStandard));
+    EXPECT_NE(pDiffuse->computeHash(), pStandard->computeHash());
+}
+
+GPU_TEST(MaterialSystem_RemoveDuplicateMaterials)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const uint32_t kMaterialCount = 1000;
+    const uint32_t kVariantCount = 37;
+
+    MaterialSystem materials(pDevice);
+    std::mt19937 rng(0);
+    for (uint32_t i = 0; i < kMaterialCount; ++i)
+    {
+        materials.addMaterial(createVariant(pDevice, rng(), kVariantCount));
+        if (i % 10 == 0)
+            materials.addMaterial(PBRTDiffuseMaterial::create(pDevice, fmt::format("Diffuse{}", i)));
+    }
+
+    // Adding the same material again returns the existing ID.
+    EXPECT_EQ(materials.addMaterial(materials.getMaterial(MaterialID{5})), MaterialID{5});
+
+    std::vector<MaterialID> expected = findDuplicatesBruteForce(materials);
+    uint32_t materialCount = materials.getMaterialCount();
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materials.removeDuplicateMaterials(idMap);
+
+    // All variants plus the single diffuse material remain.
+    EXPECT_EQ(materials.getMaterialCount(), kVariantCount + 1);
+    EXPECT_EQ(removed, materialCount - materials.getMaterialCount());
+    ASSERT_EQ(idMap.size(), expected.size());
+    for (size_t i = 0; i < idMap.size(); ++i)
+        EXPECT_EQ(idMap[i], expected[i]) << "i = " << i;
+
+    // Material lookup is updated to the new IDs.
+    for (MaterialID id{0}; id.get() < materials.getMaterialCount(); ++id)
+        EXPECT_EQ(materials.addMaterial(materials.getMaterial(id)), id);
+    EXPECT_EQ(materials.getMaterialCount(), kVariantCount + 1);
+}
+
+GPU_TEST(MaterialSystem_ReplaceMaterialDuplicates)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    MaterialSystem materials(pDevice);
+    std::vector<ref<Material>> pMaterials;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        pMaterials.push_back(createVariant(pDevice, i, 4));
+        EXPECT_EQ(materials.addMaterial(pMaterials.back()), MaterialID{i});
+    }
+    const auto& pA = pMaterials[0];
+
+    // Replacing materials can add the same material multiple times, lookup returns the first occurrence.
+    materials.replaceMaterial(MaterialID{3}, pA);
+    materials.replaceMaterial(MaterialID{1}, pA);
+    EXPECT_EQ(materials.addMaterial(pA), MaterialID{0});
+
+    // Removing an occurrence falls back to the next one.
+    materials.removeMaterial(MaterialID{0});
+    EXPECT_EQ(materials.addMaterial(pA), MaterialID{1});
+    materials.replaceMaterial(MaterialID{1}, pMaterials[1]);
+    EXPECT_EQ(materials.addMaterial(pMaterials[1]), MaterialID{1});
+    EXPECT_EQ(materials.addMaterial(pA), MaterialID{3});
+
+    // Replacing the last occurrence removes the material.
+    materials.replaceMaterial(pA, pMaterials[3]);
+    EXPECT(materials.getMaterial(MaterialID{3}) == pMaterials[3]);
+    EXPECT_EQ(materials.getMaterialCount(), 4u);
+    EXPECT_EQ(materials.addMaterial(pA), MaterialID{4});
+}
+
+GPU_TEST(MaterialSystem_RemoveDuplicateMaterialsBenchmark, TAGS("benchmark"))
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Every fourth material is unique. The brute-force reference is quadratic and only run for small counts.
+    const uint32_t kMaxBruteForceCount = 10000;
+
+    logInfo("MaterialSystem::removeDuplicateMaterials() benchmark:");
+    for (uint32_t materialCount = 1000; materialCount <= 1000000; materialCount *= 10)
+    {
+        uint32_t variantCount = materialCount / 4;
+
+        MaterialSystem materials(pDevice);
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < materialCount; ++i)
+            materials.addMaterial(createVariant(pDevice, i, variantCount));
+        double addTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+        double bruteForceTime = 0.0;
+        if (materialCount <= kMaxBruteForceCount)
+        {
+            t0 = CpuTimer::getCurrentTimePoint();
+            findDuplicatesBruteForce(materials);
+            bruteForceTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        }
+
+        std::vector<MaterialID> idMap;
+        t0 = CpuTimer::getCurrentTimePoint();
+        size_t removed = materials.removeDuplicateMaterials(idMap);
+        double hashedTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        EXPECT_EQ(removed, materialCount - variantCount);
+
+        if (materialCount <= kMaxBruteForceCount)
+            logInfo(
+                "  {} materials: add {:.2f} ms, brute force {:.2f} ms, hashed {:.2f} ms", materialCount, addTime, bruteForceTime, hashedTime
+            );
+        else
+            logInfo("  {} materials: add {:.2f} ms, hashed {:.2f} ms", materialCount, addTime, hashedTime);
+    }
+}
+} // namespace Falcor
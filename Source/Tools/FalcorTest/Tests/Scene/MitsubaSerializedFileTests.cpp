@@ -0,0 +1,325 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "MitsubaImporter/SerializedFile.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint16_t kFileFormatHeader = 0x041C;
+
+struct TestMesh
+{
+    std::string name;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    std::vector<float3> colors;
+    std::vector<uint32_t> indices;
+    bool faceNormals = false;
+};
+
+template<typename T>
+void append(std::vector<uint8_t>& data, const T& value)
+{
+    size_t offset = data.size();
+    data.resize(offset + sizeof(T));
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+void appendVectors(std::vector<uint8_t>& data, const std::vector<T>& values, bool doublePrecision)
+{
+    for (const auto& v : values)
+    {
+        for (int i = 0; i < T::length(); ++i)
+        {
+            if (doublePrecision)
+                append(data, (double)v[i]);
+            else
+                append(data, v[i]);
+        }
+    }
+}
+
+/// Encode a mesh in the Mitsuba serialized format (header followed by the zlib-compressed mesh data).
+std::vector<uint8_t> encodeMesh(const TestMesh& mesh, uint16_t version, bool doublePrecision)
+{
+    uint32_t flags = doublePrecision ? 0x2000 : 0x1000;
+    flags |= mesh.normals.empty() ? 0 : 0x0001;
+    flags |= mesh.texCrds.empty() ? 0 : 0x0002;
+    flags |= mesh.colors.empty() ? 0 : 0x0008;
+    flags |= mesh.faceNormals ? 0x0010 : 0;
+
+    std::vector<uint8_t> raw;
+    append(raw, flags);
+    if (version == 4)
+        raw.insert(raw.end(), mesh.name.c_str(), mesh.name.c_str() + mesh.name.size() + 1);
+    append(raw, (uint64_t)mesh.positions.size());
+    append(raw, (uint64_t)(mesh.indices.size() / 3));
+    appendVectors(raw, mesh.positions, doublePrecision);
+    appendVectors(raw, mesh.normals, doublePrecision);
+    appendVectors(raw, mesh.texCrds, doublePrecision);
+    appendVectors(raw, mesh.colors, doublePrecision);
+    for (uint32_t index : mesh.indices)
+        append(raw, index);
+
+    std::vector<uint8_t> data;
+    append(data, kFileFormatHeader);
+    append(data, version);
+    uLongf compressedSize = compressBound((uLong)raw.size());
+    size_t offset = data.size();
+    data.resize(offset + compressedSize);
+    FALCOR_CHECK(compress(data.data() + offset, &compressedSize, raw.data(), (uLong)raw.size()) == Z_OK, "Failed to compress mesh.");
+    data.resize(offset + compressedSize);
+    return data;
+}
+
+/// Encoded serialized file, the dictionary can be modified before writing.
+struct SerializedData
+{
+    uint16_t version;
+    std::vector<uint8_t> meshData;
+    std::vector<uint64_t> offsets;
+
+    SerializedData(const std::vector<TestMesh>& meshes, uint16_t version, bool doublePrecision) : version(version)
+    {
+        for (const auto& mesh : meshes)
+        {
+            offsets.push_back(meshData.size());
+            auto data = encodeMesh(mesh, version, doublePrecision);
+            meshData.insert(meshData.end(), data.begin(), data.end());
+        }
+    }
+
+    std::vector<uint8_t> encode(uint32_t meshCount) const
+    {
+        std::vector<uint8_t> data = meshData;
+        for (uint64_t offset : offsets)
+        {
+            if (version == 4)
+                append(data, offset);
+            else
+                append(data, (uint32_t)offset);
+        }
+        append(data, meshCount);
+        return data;
+    }
+
+    std::vector<uint8_t> encode() const { return encode((uint32_t)offsets.size()); }
+};
+
+/// Temporary file that is deleted when going out of scope.
+struct TempFile
+{
+    std::filesystem::path path = getTempFilePath();
+
+    TempFile(const std::vector<uint8_t>& data)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    ~TempFile() { std::filesystem::remove(path); }
+};
+
+std::vector<TestMesh> createTestMeshes()
+{
+    std::vector<TestMesh> meshes(3);
+
+    // Quad with normals and texture coordinates. 0.1 is not exactly representable, which checks double to float conversion.
+    meshes[0].name = "quad";
+    meshes[0].positions = {float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.1f), float3(1.f, 1.f, -2.5f)};
+    meshes[0].normals = {float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.6f, 0.8f), float3(0.f, -0.6f, 0.8f)};
+    meshes[0].texCrds = {float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f), float2(1.f, 0.1f)};
+    meshes[0].indices = {0, 1, 2, 2, 1, 3};
+
+    // Triangle with vertex colors (which are skipped) and face normals.
+    meshes[1].name = "colored";
+    meshes[1].positions = {float3(-1.f, 0.f, 0.f), float3(0.f, 2.f, 0.f), float3(0.f, 0.f, 3.f)};
+    meshes[1].texCrds = {float2(0.25f), float2(0.5f), float2(0.75f)};
+    meshes[1].colors = {float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), float3(0.f, 0.f, 1.f)};
+    meshes[1].indices = {2, 1, 0};
+    meshes[1].faceNormals = true;
+
+    // Positions only, with an empty name.
+    meshes[2].positions = {float3(5.f), float3(6.f), float3(7.f)};
+    meshes[2].indices = {0, 1, 2};
+
+    return meshes;
+}
+
+template<typename T>
+bool equalVectors(const std::vector<T>& a, const std::vector<T>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (any(a[i] != b[i]))
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+CPU_TEST(MitsubaSerializedFile_Versions)
+{
+    const auto meshes = createTestMeshes();
+
+    for (uint16_t version : {3, 4})
+    {
+        for (bool doublePrecision : {false, true})
+        {
+            TempFile file(SerializedData(meshes, version, doublePrecision).encode());
+            Mitsuba::SerializedFile serialized(file.path);
+            ASSERT_EQ(serialized.getMeshCount(), meshes.size());
+
+            for (uint32_t i = 0; i < meshes.size(); ++i)
+            {
+                const auto& expected = meshes[i];
+                auto mesh = serialized.readMesh(i);
+
+                // Version 3 files do not store mesh names.
+                EXPECT_EQ(mesh.name, version == 4 ? expected.name : "") << "version=" << version << " mesh=" << i;
+                EXPECT(equalVectors(mesh.positions, expected.positions)) << "version=" << version << " mesh=" << i;
+                EXPECT(equalVectors(mesh.normals, expected.normals)) << "version=" << version << " mesh=" << i;
+                EXPECT(equalVectors(mesh.texCrds, expected.texCrds)) << "version=" << version << " mesh=" << i;
+                EXPECT(mesh.indices == expected.indices) << "version=" << version << " mesh=" << i;
+                EXPECT_EQ(mesh.faceNormals, expected.faceNormals) << "version=" << version << " mesh=" << i;
+            }
+        }
+    }
+}
+
+CPU_TEST(MitsubaSerializedFile_ShapeIndex)
+{
+    TempFile file(SerializedData(createTestMeshes(), 4, false).encode());
+    Mitsuba::SerializedFile serialized(file.path);
+    ASSERT_EQ(serialized.getMeshCount(), 3u);
+
+    EXPECT_THROW_AS(serialized.readMesh(3), RuntimeError);
+    EXPECT_THROW_AS(serialized.readMesh(std::numeric_limits<uint32_t>::max()), RuntimeError);
+
+    // Meshes can be read in any order after a failed read.
+    EXPECT_EQ(serialized.readMesh(2).positions.size(), 3u);
+    EXPECT_EQ(serialized.readMesh(0).name, "quad");
+}
+
+CPU_TEST(MitsubaSerializedFile_InvalidDictionary)
+{
+    const auto meshes = createTestMeshes();
+
+    for (uint16_t version : {3, 4})
+    {
+        const SerializedData valid(meshes, version, false);
+        const size_t entrySize = version == 4 ? sizeof(uint64_t) : sizeof(uint32_t);
+
+        auto expectOpenFails = [&](const std::vector<uint8_t>& data)
+        {
+            TempFile file(data);
+            EXPECT_THROW_AS(Mitsuba::SerializedFile{file.path}, RuntimeError);
+        };
+
+        // File too small to contain a header and mesh count.
+        expectOpenFails({0x1c, 0x04, uint8_t(version), 0x00});
+
+        // Mesh count of zero, or more meshes than fit in the file.
+        expectOpenFails(valid.encode(0));
+        expectOpenFails(valid.encode(std::numeric_limits<uint32_t>::max()));
+        expectOpenFails(valid.encode((uint32_t)(valid.encode().size() / entrySize + 1)));
+
+        // Truncated dictionary, the mesh count is read from part of an offset.
+        auto truncated = valid.encode();
+        truncated.resize(truncated.size() - sizeof(uint32_t));
+        expectOpenFails(truncated);
+
+        // Offsets past the dictionary, decreasing offsets and offsets too close to fit a mesh header.
+        SerializedData corrupt = valid;
+        corrupt.offsets[2] = corrupt.meshData.size() + 1;
+        expectOpenFails(corrupt.encode());
+        corrupt = valid;
+        corrupt.offsets[2] = corrupt.offsets[1] - 1;
+        expectOpenFails(corrupt.encode());
+        corrupt = valid;
+        corrupt.offsets[1] = corrupt.offsets[0] + 2;
+        expectOpenFails(corrupt.encode());
+
+        // Large 64-bit offsets must not wrap around.
+        if (version == 4)
+        {
+            corrupt = valid;
+            corrupt.offsets[1] = std::numeric_limits<uint64_t>::max() - 1;
+            expectOpenFails(corrupt.encode());
+        }
+
+        // Offsets that are ordered but do not point to the start of a mesh are detected when reading the mesh.
+        {
+            corrupt = valid;
+            corrupt.offsets[1] += 1;
+            TempFile file(corrupt.encode());
+            Mitsuba::SerializedFile serialized(file.path);
+            EXPECT_THROW_AS(serialized.readMesh(1), RuntimeError);
+            EXPECT_EQ(serialized.readMesh(0).positions.size(), 4u);
+            EXPECT_EQ(serialized.readMesh(2).positions.size(), 3u);
+        }
+
+        // Corrupt zlib stream header.
+        {
+            corrupt = valid;
+            corrupt.meshData[corrupt.offsets[1] + 4] ^= 0xff;
+            TempFile file(corrupt.encode());
+            Mitsuba::SerializedFile serialized(file.path);
+            EXPECT_THROW_AS(serialized.readMesh(1), RuntimeError);
+            EXPECT_EQ(serialized.readMesh(0).positions.size(), 4u);
+        }
+
+        // Truncated compressed data of the last mesh.
+        {
+            corrupt = valid;
+            corrupt.meshData.resize(corrupt.meshData.size() - 8);
+            TempFile file(corrupt.encode());
+            Mitsuba::SerializedFile serialized(file.path);
+            EXPECT_THROW_AS(serialized.readMesh(2), RuntimeError);
+            EXPECT_EQ(serialized.readMesh(1).positions.size(), 3u);
+        }
+    }
+}
+} // namespace Falcor
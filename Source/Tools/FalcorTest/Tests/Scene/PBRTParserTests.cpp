@@ -0,0 +1,230 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "PBRTImporter/Builder.h"
+#include "PBRTImporter/Parser.h"
+#include "Core/Platform/OS.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Parser target recording the directives it receives.
+class RecordingTarget : public pbrt::ParserTarget
+{
+public:
+    std::vector<std::string> directives;
+
+    void onScale(pbrt::Float sx, pbrt::Float sy, pbrt::Float sz, pbrt::FileLoc loc) override { record("Scale {} {} {}", sx, sy, sz); }
+    void onShape(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Shape {}", name); }
+    void onOption(const std::string& name, const std::string& value, pbrt::FileLoc loc) override { record("Option {}", name); }
+    void onIdentity(pbrt::FileLoc loc) override { record("Identity"); }
+    void onTranslate(pbrt::Float dx, pbrt::Float dy, pbrt::Float dz, pbrt::FileLoc loc) override { record("Translate {} {} {}", dx, dy, dz); }
+    void onRotate(pbrt::Float angle, pbrt::Float ax, pbrt::Float ay, pbrt::Float az, pbrt::FileLoc loc) override { record("Rotate"); }
+    void onLookAt(
+        pbrt::Float ex,
+        pbrt::Float ey,
+        pbrt::Float ez,
+        pbrt::Float lx,
+        pbrt::Float ly,
+        pbrt::Float lz,
+        pbrt::Float ux,
+        pbrt::Float uy,
+        pbrt::Float uz,
+        pbrt::FileLoc loc
+    ) override
+    {
+        record("LookAt");
+    }
+    void onConcatTransform(pbrt::Float transform[16], pbrt::FileLoc loc) override { record("ConcatTransform"); }
+    void onTransform(pbrt::Float transform[16], pbrt::FileLoc loc) override { record("Transform"); }
+    void onCoordinateSystem(const std::string& name, pbrt::FileLoc loc) override { record("CoordinateSystem {}", name); }
+    void onCoordSysTransform(const std::string& name, pbrt::FileLoc loc) override { record("CoordSysTransform {}", name); }
+    void onActiveTransformAll(pbrt::FileLoc loc) override { record("ActiveTransformAll"); }
+    void onActiveTransformEndTime(pbrt::FileLoc loc) override { record("ActiveTransformEndTime"); }
+    void onActiveTransformStartTime(pbrt::FileLoc loc) override { record("ActiveTransformStartTime"); }
+    void onTransformTimes(pbrt::Float start, pbrt::Float end, pbrt::FileLoc loc) override { record("TransformTimes"); }
+    void onColorSpace(const std::string& name, pbrt::FileLoc loc) override { record("ColorSpace {}", name); }
+    void onPixelFilter(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("PixelFilter {}", name); }
+    void onFilm(const std::string& type, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Film {}", type); }
+    void onAccelerator(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Accelerator {}", name); }
+    void onIntegrator(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Integrator {}", name); }
+    void onCamera(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Camera {}", name); }
+    void onMakeNamedMedium(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override
+    {
+        record("MakeNamedMedium {}", name);
+    }
+    void onMediumInterface(const std::string& insideName, const std::string& outsideName, pbrt::FileLoc loc) override
+    {
+        record("MediumInterface {} {}", insideName, outsideName);
+    }
+    void onSampler(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Sampler {}", name); }
+    void onWorldBegin(pbrt::FileLoc loc) override { record("WorldBegin"); }
+    void onAttributeBegin(pbrt::FileLoc loc) override { record("AttributeBegin"); }
+    void onAttributeEnd(pbrt::FileLoc loc) override { record("AttributeEnd"); }
+    void onAttribute(const std::string& target, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Attribute {}", target); }
+    void onTexture(
+        const std::string& name,
+        const std::string& type,
+        const std::string& texname,
+        pbrt::ParsedParameterVector params,
+        pbrt::FileLoc loc
+    ) override
+    {
+        record("Texture {}", name);
+    }
+    void onMaterial(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("Material {}", name); }
+    void onMakeNamedMaterial(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override
+    {
+        record("MakeNamedMaterial {}", name);
+    }
+    void onNamedMaterial(const std::string& name, pbrt::FileLoc loc) override { record("NamedMaterial {}", name); }
+    void onLightSource(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override { record("LightSource {}", name); }
+    void onAreaLightSource(const std::string& name, pbrt::ParsedParameterVector params, pbrt::FileLoc loc) override
+    {
+        record("AreaLightSource {}", name);
+    }
+    void onReverseOrientation(pbrt::FileLoc loc) override { record("ReverseOrientation"); }
+    void onObjectBegin(const std::string& name, pbrt::FileLoc loc) override { record("ObjectBegin {}", name); }
+    void onObjectEnd(pbrt::FileLoc loc) override { record("ObjectEnd"); }
+    void onObjectInstance(const std::string& name, pbrt::FileLoc loc) override { record("ObjectInstance {}", name); }
+    void onImportBegin(pbrt::FileLoc loc) override { record("ImportBegin"); }
+    void onImportEnd(pbrt::FileLoc loc) override { record("ImportEnd"); }
+    void onEndOfFiles() override { record("EndOfFiles"); }
+
+private:
+    template<typename... Args>
+    void record(fmt::format_string<Args...> format, Args&&... args)
+    {
+        directives.push_back(fmt::format(format, std::forward<Args>(args)...));
+    }
+};
+
+/// Temporary directory with scene description files, referenced by absolute paths from parsed strings.
+struct SceneFiles
+{
+    std::filesystem::path directory = getTempFilePath();
+
+    SceneFiles() { std::filesystem::create_directories(directory); }
+    ~SceneFiles() { std::filesystem::remove_all(directory); }
+
+    void write(const std::string& name, const std::string& content) { std::ofstream(directory / name, std::ios::binary) << content; }
+
+    std::string import(const std::string& name) const { return fmt::format("Import \"{}\"\n", (directory / name).generic_string()); }
+};
+} // namespace
+
+CPU_TEST(PBRTParser_ImportOrder)
+{
+    SceneFiles files;
+
+    // A large file, so that the following import usually finishes parsing first, and a file with a nested import.
+    std::string large;
+    for (uint32_t i = 0; i < 5000; ++i)
+        large += fmt::format("Shape \"sphere\" \"float radius\" [ {} ]\n", i);
+    files.write("large.pbrt", large);
+    files.write("nested.pbrt", "Translate 1 0 0\nImport \"inner.pbrt\"\nShape \"disk\"\n");
+    files.write("inner.pbrt", "Shape \"cylinder\"\n");
+
+    const std::string scene = "WorldBegin\n" + files.import("large.pbrt") + "Shape \"bilinearmesh\"\n" + files.import("nested.pbrt") +
+                              "Shape \"trianglemesh\"\n";
+
+    // Directives are forwarded in the order of the scene description, with imported files in ImportBegin/ImportEnd.
+    std::vector<std::string> expected = {"WorldBegin", "ImportBegin"};
+    expected.insert(expected.end(), 5000, "Shape sphere");
+    for (const char* directive :
+         {"ImportEnd",
+          "Shape bilinearmesh",
+          "ImportBegin",
+          "Translate 1 0 0",
+          "ImportBegin",
+          "Shape cylinder",
+          "ImportEnd",
+          "Shape disk",
+          "ImportEnd",
+          "Shape trianglemesh",
+          "EndOfFiles"})
+        expected.push_back(directive);
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        RecordingTarget target;
+        pbrt::ParseStatistics stats;
+        pbrt::parseString(target, scene, &stats);
+        EXPECT(target.directives == expected) << "iteration " << i;
+        EXPECT_EQ(stats.files.size(), 4);
+    }
+}
+
+CPU_TEST(PBRTParser_ImportGraphicsState)
+{
+    SceneFiles files;
+    files.write("part.pbrt", "Translate 5 0 0\nReverseOrientation\nShape \"sphere\"\n");
+
+    // Changes to the graphics state in an imported file don't affect the importing file.
+    pbrt::BasicScene scene(files.directory);
+    pbrt::BasicSceneBuilder builder(scene);
+    pbrt::parseString(builder, "WorldBegin\nTranslate 0 2 0\n" + files.import("part.pbrt") + "Shape \"disk\"\n");
+
+    const auto& shapes = scene.getShapes();
+    ASSERT_EQ(shapes.size(), 2);
+    EXPECT_EQ(shapes[0].name, "sphere");
+    EXPECT_EQ(shapes[0].transform[0][3], 5.f);
+    EXPECT_EQ(shapes[0].transform[1][3], 2.f);
+    EXPECT(shapes[0].reverseOrientation);
+    EXPECT_EQ(shapes[1].name, "disk");
+    EXPECT_EQ(shapes[1].transform[0][3], 0.f);
+    EXPECT_EQ(shapes[1].transform[1][3], 2.f);
+    EXPECT(!shapes[1].reverseOrientation);
+}
+
+CPU_TEST(PBRTParser_ImportErrors)
+{
+    SceneFiles files;
+    files.write("valid.pbrt", "Shape \"sphere\"\n");
+    files.write("invalid.pbrt", "Shape \"sphere\" \"float radius\" [ 1\n");
+    files.write("nested.pbrt", files.import("invalid.pbrt"));
+
+    // Errors in imported files, including nested imports, propagate to the caller.
+    for (const char* name : {"invalid.pbrt", "nested.pbrt", "missing.pbrt"})
+    {
+        RecordingTarget target;
+        EXPECT_THROW(pbrt::parseString(target, "WorldBegin\n" + files.import(name) + files.import("valid.pbrt")));
+    }
+
+    // The builder rejects unbalanced blocks in imported files.
+    files.write("unbalanced.pbrt", "AttributeBegin\nShape \"sphere\"\n");
+    pbrt::BasicScene scene(files.directory);
+    pbrt::BasicSceneBuilder builder(scene);
+    EXPECT_THROW(pbrt::parseString(builder, "WorldBegin\n" + files.import("unbalanced.pbrt")));
+}
+} // namespace Falcor
@@ -0,0 +1,404 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/PlyReader.h"
+#include "Scene/TriangleMesh.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const char kAsciiPly[] = "ply\n"
+                         "format ascii 1.0\n"
+                         "comment test mesh\n"
+                         "element vertex 5\n"
+                         "property float x\n"
+                         "property float y\n"
+                         "property float z\n"
+                         "property float nx\n"
+                         "property float ny\n"
+                         "property float nz\n"
+                         "property float u\n"
+                         "property float v\n"
+                         "element face 3\n"
+                         "property list uchar int vertex_indices\n"
+                         "end_header\n"
+                         "0 0 0 0 0 1 0 0\n"
+                         "1 0 0 0 0 1 1 0\n"
+                         "1 1 0 0 0 1 1 1\n"
+                         "0 1 0 0 0 1 0 1\n"
+                         "2 2 -1.5e1 0 0 1 0.5 0.25\n"
+                         "4 0 1 2 3\n"
+                         "3 1 4 2\n"
+                         "2 0 1\n";
+
+/// Writes binary PLY data with a given byte order.
+struct BinaryWriter
+{
+    bool bigEndian;
+    std::string data;
+
+    template<typename T>
+    void write(T value)
+    {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        if (bigEndian)
+            std::reverse(bytes, bytes + sizeof(T));
+        data.append(bytes, sizeof(T));
+    }
+};
+
+/// Creates a binary PLY with mixed property types, an unused property, an unused element and quads.
+std::string createBinaryPly(bool bigEndian)
+{
+    BinaryWriter writer{bigEndian};
+    writer.data = std::string("ply\r\nformat ") + (bigEndian ? "binary_big_endian" : "binary_little_endian") +
+                  " 1.0\r\n"
+                  "element vertex 4\r\n"
+                  "property double x\r\n"
+                  "property float y\r\n"
+                  "property short z\r\n"
+                  "property uchar red\r\n"
+                  "property list uchar float extra\r\n"
+                  "element material 1\r\n"
+                  "property float roughness\r\n"
+                  "element face 2\r\n"
+                  "property int face_index\r\n"
+                  "property list ushort uint vertex_index\r\n"
+                  "end_header\r\n";
+    for (int i = 0; i < 4; ++i)
+    {
+        writer.write<double>(i + 0.5);
+        writer.write<float>(-float(i));
+        writer.write<int16_t>(int16_t(i * 100));
+        writer.write<uint8_t>(255);
+        writer.write<uint8_t>(uint8_t(i));
+        for (int j = 0; j < i; ++j)
+            writer.write<float>(1.f);
+    }
+    writer.write<float>(0.5f);
+    writer.write<int32_t>(0);
+    writer.write<uint16_t>(4);
+    for (uint32_t index : {0u, 1u, 2u, 3u})
+        writer.write<uint32_t>(index);
+    writer.write<int32_t>(1);
+    writer.write<uint16_t>(3);
+    for (uint32_t index : {3u, 2u, 1u})
+        writer.write<uint32_t>(index);
+    return writer.data;
+}
+
+/// Wraps data in a zlib stream using uncompressed deflate blocks.
+std::string createZlibStream(const std::string& data)
+{
+    std::string stream = {char(0x78), char(0x01)};
+    size_t pos = 0;
+    do
+    {
+        uint16_t size = uint16_t(std::min(data.size() - pos, size_t(65535)));
+        bool last = pos + size == data.size();
+        stream.push_back(last ? 1 : 0);
+        stream.push_back(char(size & 0xff));
+        stream.push_back(char(size >> 8));
+        stream.push_back(char(~size & 0xff));
+        stream.push_back(char((~size >> 8) & 0xff));
+        stream.append(data, pos, size);
+        pos += size;
+    } while (pos < data.size());
+
+    uint32_t a = 1, b = 0;
+    for (char c : data)
+    {
+        a = (a + uint8_t(c)) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        stream.push_back(char((adler >> shift) & 0xff));
+    return stream;
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& data)
+{
+    std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+}
+
+/// Creates a binary PLY of a grid with (n+1)^2 vertices and 2n^2 triangles.
+std::string createGridPly(uint32_t n)
+{
+    BinaryWriter writer{false};
+    const uint32_t vertexCount = (n + 1) * (n + 1);
+    writer.data = fmt::format(
+        "ply\nformat binary_little_endian 1.0\n"
+        "element vertex {}\nproperty float x\nproperty float y\nproperty float z\n"
+        "property float nx\nproperty float ny\nproperty float nz\nproperty float u\nproperty float v\n"
+        "element face {}\nproperty list uchar int vertex_indices\nend_header\n",
+        vertexCount,
+        2 * n * n
+    );
+    for (uint32_t y = 0; y <= n; ++y)
+    {
+        for (uint32_t x = 0; x <= n; ++x)
+        {
+            for (float v : {float(x), float(y), 0.f, 0.f, 0.f, 1.f, float(x) / n, float(y) / n})
+                writer.write<float>(v);
+        }
+    }
+    for (uint32_t y = 0; y < n; ++y)
+    {
+        for (uint32_t x = 0; x < n; ++x)
+        {
+            uint32_t i = y * (n + 1) + x;
+            writer.write<uint8_t>(3);
+            for (uint32_t index : {i, i + 1, i + n + 2})
+                writer.write<int32_t>(int32_t(index));
+            writer.write<uint8_t>(3);
+            for (uint32_t index : {i, i + n + 2, i + n + 1})
+                writer.write<int32_t>(int32_t(index));
+        }
+    }
+    return writer.data;
+}
+} // namespace
+
+CPU_TEST(PlyReader_Ascii)
+{
+    PlyReader::Mesh mesh = PlyReader::read(kAsciiPly, sizeof(kAsciiPly) - 1);
+    EXPECT(mesh.hasNormals);
+    EXPECT(mesh.hasTexCoords);
+    ASSERT_EQ(mesh.vertices.size(), 5);
+    EXPECT(all(mesh.vertices[2].position == float3(1.f, 1.f, 0.f)));
+    EXPECT(all(mesh.vertices[4].position == float3(2.f, 2.f, -15.f)));
+    EXPECT(all(mesh.vertices[4].normal == float3(0.f, 0.f, 1.f)));
+    EXPECT(all(mesh.vertices[4].texCoord == float2(0.5f, 0.25f)));
+
+    // The quad is triangulated as a fan, the face with two vertices is skipped.
+    const TriangleMesh::IndexList expectedIndices = {0, 1, 2, 0, 2, 3, 1, 4, 2};
+    EXPECT(mesh.indices == expectedIndices);
+}
+
+CPU_TEST(PlyReader_Binary)
+{
+    for (bool bigEndian : {false, true})
+    {
+        std::string data = createBinaryPly(bigEndian);
+        PlyReader::Mesh mesh = PlyReader::read(data.data(), data.size());
+        EXPECT(!mesh.hasNormals);
+        EXPECT(!mesh.hasTexCoords);
+        ASSERT_EQ(mesh.vertices.size(), 4);
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            EXPECT(all(mesh.vertices[i].position == float3(i + 0.5f, -float(i), i * 100.f))) << "bigEndian=" << bigEndian;
+            EXPECT(all(mesh.vertices[i].normal == float3(0.f)));
+        }
+        const TriangleMesh::IndexList expectedIndices = {0, 1, 2, 0, 2, 3, 3, 2, 1};
+        EXPECT(mesh.indices == expectedIndices) << "bigEndian=" << bigEndian;
+    }
+
+    // Common layout with float32 vertices and triangles with 32-bit indices.
+    const uint32_t n = 3;
+    std::string data = createGridPly(n);
+    PlyReader::Mesh mesh = PlyReader::read(data.data(), data.size());
+    EXPECT(mesh.hasNormals);
+    EXPECT(mesh.hasTexCoords);
+    ASSERT_EQ(mesh.vertices.size(), (n + 1) * (n + 1));
+    ASSERT_EQ(mesh.indices.size(), 6 * n * n);
+    EXPECT(all(mesh.vertices[n + 2].position == float3(1.f, 1.f, 0.f)));
+    EXPECT(all(mesh.vertices[n + 2].normal == float3(0.f, 0.f, 1.f)));
+    EXPECT(all(mesh.vertices[n + 2].texCoord == float2(1.f / n, 1.f / n)));
+    for (uint32_t i = 0; i < n * n; ++i)
+    {
+        uint32_t v = (i / n) * (n + 1) + i % n;
+        const uint32_t expected[6] = {v, v + 1, v + n + 2, v, v + n + 2, v + n + 1};
+        for (uint32_t j = 0; j < 6; ++j)
+            EXPECT_EQ(mesh.indices[i * 6 + j], expected[j]) << "face=" << i;
+    }
+}
+
+CPU_TEST(PlyReader_File)
+{
+    const std::filesystem::path plyPath = std::filesystem::absolute("test_ply_reader.ply");
+    const std::filesystem::path gzPath = std::filesystem::absolute("test_ply_reader.ply.gz");
+    std::string data = createBinaryPly(false);
+    writeFile(plyPath, data);
+    writeFile(gzPath, createZlibStream(data));
+
+    for (const auto& path : {plyPath, gzPath})
+    {
+        PlyReader::Mesh mesh = PlyReader::readFile(path);
+        EXPECT_EQ(mesh.vertices.size(), 4) << path;
+        EXPECT_EQ(mesh.indices.size(), 9) << path;
+    }
+
+    // TriangleMesh generates facet normals and flips texture coordinates like the ASSIMP import.
+    writeFile(plyPath, kAsciiPly);
+    ref<TriangleMesh> pMesh = TriangleMesh::createFromFile(plyPath);
+    ASSERT(pMesh != nullptr);
+    EXPECT_EQ(pMesh->getVertices().size(), 5);
+    EXPECT(all(pMesh->getVertices()[4].texCoord == float2(0.5f, 0.75f)));
+
+    writeFile(plyPath, data);
+    pMesh = TriangleMesh::createFromFile(plyPath);
+    ASSERT(pMesh != nullptr);
+    ASSERT_EQ(pMesh->getVertices().size(), 9);
+    for (const auto& vertex : pMesh->getVertices())
+        EXPECT(all(math::abs(vertex.normal) <= float3(1.f)) && math::abs(length(vertex.normal) - 1.f) < 1e-5f);
+
+    std::filesystem::remove(plyPath);
+    std::filesystem::remove(gzPath);
+}
+
+CPU_TEST(PlyReader_SmoothNormals)
+{
+    // A large triangle in the xy-plane and a small triangle in the yz-plane meet at the origin,
+    // where the small triangle uses a separate vertex at the same position.
+    const char kPly[] = "ply\n"
+                        "format ascii 1.0\n"
+                        "element vertex 6\n"
+                        "property float x\n"
+                        "property float y\n"
+                        "property float z\n"
+                        "element face 2\n"
+                        "property list uchar int vertex_indices\n"
+                        "end_header\n"
+                        "0 0 0\n"
+                        "10 0 0\n"
+                        "0 10 0\n"
+                        "0 0 0\n"
+                        "0 1 0\n"
+                        "0 0 1\n"
+                        "3 0 1 2\n"
+                        "3 3 4 5\n";
+    const std::filesystem::path plyPath = std::filesystem::absolute("test_ply_reader_smooth.ply");
+    writeFile(plyPath, kPly);
+
+    // Like ASSIMP, vertices at the same position average the unit normals of their triangles, regardless of triangle area.
+    ref<TriangleMesh> pMesh = TriangleMesh::createFromFile(plyPath, TriangleMesh::ImportFlags::GenSmoothNormals);
+    ASSERT(pMesh != nullptr);
+    const auto& vertices = pMesh->getVertices();
+    ASSERT_EQ(vertices.size(), 6);
+    const float3 kExpected[6] = {
+        normalize(float3(1.f, 0.f, 1.f)),
+        float3(0.f, 0.f, 1.f),
+        float3(0.f, 0.f, 1.f),
+        normalize(float3(1.f, 0.f, 1.f)),
+        float3(1.f, 0.f, 0.f),
+        float3(1.f, 0.f, 0.f),
+    };
+    for (size_t i = 0; i < 6; ++i)
+        EXPECT_LE(length(vertices[i].normal - kExpected[i]), 1e-6f) << "vertex=" << i;
+
+    std::filesystem::remove(plyPath);
+}
+
+CPU_TEST(PlyReader_Errors)
+{
+    auto read = [](const std::string& data) { PlyReader::read(data.data(), data.size()); };
+
+    EXPECT_THROW(read("plx\nformat ascii 1.0\nend_header\n"));
+    EXPECT_THROW(read("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\n"));
+    EXPECT_THROW(read("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nend_header\n1\n"));
+    EXPECT_THROW(read("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\nend_header\n1 2\n"));
+    EXPECT_THROW(read(
+        "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\n"
+        "element face 1\nproperty list uchar int vertex_indices\nend_header\n0 0 0\n3 0 0 1\n"
+    ));
+
+    std::string binary = createBinaryPly(false);
+    EXPECT_THROW(read(binary.substr(0, binary.size() - 1)));
+
+    // Elements without properties have no data and are skipped regardless of their count.
+    const std::string data =
+        "ply\nformat ascii 1.0\nelement empty 18446744073709551615\nelement vertex 1\nproperty float x\nproperty float y\n"
+        "property float z\nend_header\n1 2 3\n";
+    PlyReader::Mesh mesh = PlyReader::read(data.data(), data.size());
+    ASSERT_EQ(mesh.vertices.size(), 1);
+    EXPECT(all(mesh.vertices[0].position == float3(1.f, 2.f, 3.f)));
+}
+
+CPU_TEST(PlyReader_Benchmark, TAGS("benchmark"))
+{
+    // Many small files (as in large pbrt-v4 scenes) and a single large file.
+    struct Config
+    {
+        const char* name;
+        uint32_t fileCount;
+        uint32_t gridSize;
+    };
+    const Config kConfigs[] = {{"256 files, 2K triangles each", 256, 32}, {"1 file, 2M triangles", 1, 1024}};
+
+    logInfo("PlyReader benchmark ({} workers):", Threading::getWorkerCount());
+    for (const auto& config : kConfigs)
+    {
+        std::vector<std::filesystem::path> paths;
+        std::string data = createGridPly(config.gridSize);
+        for (uint32_t i = 0; i < config.fileCount; ++i)
+        {
+            paths.push_back(std::filesystem::absolute(fmt::format("test_ply_benchmark_{}.ply", i)));
+            writeFile(paths.back(), data);
+        }
+
+        auto load = [&](TriangleMesh::ImportFlags flags, bool parallel)
+        {
+            std::vector<ref<TriangleMesh>> meshes(paths.size());
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            auto loadRange = [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    meshes[i] = TriangleMesh::createFromFile(paths[i], flags);
+            };
+            if (parallel)
+                Threading::parallelFor(0, paths.size(), 1, loadRange);
+            else
+                loadRange(0, paths.size());
+            double duration = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+            for (const auto& pMesh : meshes)
+                EXPECT(pMesh && pMesh->getIndices().size() == 6 * config.gridSize * config.gridSize);
+            return duration;
+        };
+
+        double assimp = load(TriangleMesh::ImportFlags::UseAssimp, false);
+        double native = load(TriangleMesh::ImportFlags::None, false);
+        double nativeParallel = load(TriangleMesh::ImportFlags::None, true);
+        logInfo(
+            "  {}: assimp {:.2f} ms, native {:.2f} ms, native parallel {:.2f} ms", config.name, assimp, native, nativeParallel
+        );
+
+        for (const auto& path : paths)
+            std::filesystem::remove(path);
+    }
+}
+} // namespace Falcor
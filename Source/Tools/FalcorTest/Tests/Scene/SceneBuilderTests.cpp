@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+namespace
+{
+/// Build a scene with three copies of a cube (the last one using an equal but distinct material) and a sphere.
+ref<Scene> buildScene(ref<Device> pDevice, SceneBuilder::Flags flags)
+{
+    Settings settings;
+    SceneBuilder builder(pDevice, settings, flags);
+
+    auto pCube = TriangleMesh::createCube();
+    auto pSphere = TriangleMesh::createSphere();
+    auto pMaterial = StandardMaterial::create(pDevice, "Material");
+    auto pMaterialCopy = StandardMaterial::create(pDevice, "MaterialCopy");
+
+    std::vector<MeshID> meshIDs = {
+        builder.addTriangleMesh(pCube, pMaterial),
+        builder.addTriangleMesh(pCube, pMaterial),
+        builder.addTriangleMesh(pCube, pMaterialCopy),
+        builder.addTriangleMesh(pSphere, pMaterial),
+    };
+    for (size_t i = 0; i < meshIDs.size(); ++i)
+    {
+        float4x4 transform = math::matrixFromTranslation(float3(2.f * i, 0.f, 0.f));
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i), transform, float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshIDs[i]);
+    }
+
+    return builder.getScene();
+}
+
+/// Vertex data of a triangle mesh in the layout referenced by SceneBuilder::Mesh.
+struct MeshData
+{
+    SceneBuilder::Mesh mesh;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+
+    MeshData(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial)
+    {
+        for (const auto& v : pTriangleMesh->getVertices())
+        {
+            positions.push_back(v.position);
+            normals.push_back(v.normal);
+            texCrds.push_back(v.texCoord);
+        }
+
+        const auto& indices = pTriangleMesh->getIndices();
+        mesh.name = pTriangleMesh->getName();
+        mesh.faceCount = (uint32_t)(indices.size() / 3);
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.texCrds = {texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+    }
+};
+
+/// Build a scene with one instance of each mesh. Meshes are either queued with addTriangleMesh() and processed
+/// in parallel when the scene is built, or processed immediately on the calling thread with addMesh().
+ref<Scene> buildMeshScene(ref<Device> pDevice, const std::vector<ref<TriangleMesh>>& meshes, bool deferred)
+{
+    Settings settings;
+    SceneBuilder builder(pDevice, settings);
+    auto pMaterial = StandardMaterial::create(pDevice, "Material");
+
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        MeshID meshID = deferred ? builder.addTriangleMesh(meshes[i], pMaterial) : builder.addMesh(MeshData(meshes[i], pMaterial).mesh);
+        EXPECT_EQ(meshID.get(), i);
+        float4x4 transform = math::matrixFromTranslation(float3(2.f * i, 0.f, 0.f));
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i), transform, float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshID);
+    }
+
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_InstanceDuplicateMeshes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // By default, every mesh is kept.
+    auto pScene = buildScene(pDevice, SceneBuilder::Flags::Default);
+    EXPECT_EQ(pScene->getMeshCount(), 4);
+    EXPECT_EQ(pScene->getGeometryInstanceCount(), 4);
+
+    // All cubes are instances of a single mesh.
+    pScene = buildScene(pDevice, SceneBuilder::Flags::InstanceDuplicateMeshes);
+    EXPECT_EQ(pScene->getMeshCount(), 2);
+    EXPECT_EQ(pScene->getGeometryInstanceCount(), 4);
+
+    // The cube with a different material is kept if materials are not merged.
+    pScene = buildScene(pDevice, SceneBuilder::Flags::InstanceDuplicateMeshes | SceneBuilder::Flags::DontMergeMaterials);
+    EXPECT_EQ(pScene->getMeshCount(), 3);
+    EXPECT_EQ(pScene->getGeometryInstanceCount(), 4);
+}
+
+GPU_TEST(SceneBuilder_DeterministicMeshIDs)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Meshes of different sizes so that they finish processing in a different order than they were added.
+    std::vector<ref<TriangleMesh>> meshes;
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        auto pMesh = TriangleMesh::createSphere(0.5f, 4 + (i * 13) % 61, 3 + (i * 7) % 29);
+        pMesh->setName(fmt::format("Mesh{}", i));
+        meshes.push_back(pMesh);
+    }
+
+    auto pSerialScene = buildMeshScene(pDevice, meshes, false);
+    for (uint32_t run = 0; run < 2; ++run)
+    {
+        auto pScene = buildMeshScene(pDevice, meshes, true);
+        ASSERT_EQ(pScene->getMeshCount(), pSerialScene->getMeshCount());
+        for (uint32_t i = 0; i < pScene->getMeshCount(); ++i)
+        {
+            const auto& mesh = pScene->getMesh(MeshID(i));
+            const auto& serialMesh = pSerialScene->getMesh(MeshID(i));
+            EXPECT_EQ(pScene->getMeshName(i), pSerialScene->getMeshName(i));
+            EXPECT_EQ(mesh.vertexCount, serialMesh.vertexCount);
+            EXPECT_EQ(mesh.indexCount, serialMesh.indexCount);
+            EXPECT_EQ(mesh.vbOffset, serialMesh.vbOffset);
+            EXPECT_EQ(mesh.ibOffset, serialMesh.ibOffset);
+        }
+    }
+}
+
+GPU_TEST(SceneBuilder_WeldVertices)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    Settings settings;
+    SceneBuilder builder(pDevice, settings);
+    auto pMaterial = StandardMaterial::create(pDevice, "Material");
+
+    // Two triangles sharing the edge (1, 2), with face-varying normals.
+    const uint32_t indices[] = {0, 1, 2, 2, 1, 3};
+    const float3 positions[] = {float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), float3(1.f, 1.f, 0.f)};
+    const float4 tangents[] = {float4(1.f, 0.f, 0.f, 1.f), float4(1.f, 0.f, 0.f, 1.f), float4(1.f, 0.f, 0.f, 1.f), float4(1.f, 0.f, 0.f, 1.f)};
+    const float2 texCrds[] = {float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f), float2(1.f, 1.f)};
+
+    // Returns the number of vertices after welding when the normals of the second triangle at the shared corners are perturbed.
+    auto weld = [&](float offset)
+    {
+        std::vector<float3> normals(6, float3(0.f, 0.f, 1.f));
+        normals[3].x += offset;
+        normals[4].y += offset;
+
+        SceneBuilder::Mesh mesh;
+        mesh.name = "Quad";
+        mesh.faceCount = 2;
+        mesh.vertexCount = 4;
+        mesh.indexCount = 6;
+        mesh.pIndices = indices;
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.useOriginalTangentSpace = true;
+        mesh.positions = {positions, SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.tangents = {tangents, SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.texCrds = {texCrds, SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::FaceVarying};
+        return builder.processMesh(mesh).staticData.size();
+    };
+
+    // Identical vertices are merged.
+    EXPECT_EQ(weld(0.f), 4);
+    // Attributes other than the position are merged within a threshold of 1e-6.
+    EXPECT_EQ(weld(5e-7f), 4);
+    // Vertices with larger differences are kept.
+    EXPECT_EQ(weld(1e-3f), 6);
+}
+} // namespace Falcor
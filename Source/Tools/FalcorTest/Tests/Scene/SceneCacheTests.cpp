@@ -0,0 +1,249 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+Scene::SceneData createSceneData(ref<Device> pDevice, size_t vertexCount, uint32_t bufferCount)
+{
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+    sceneData.meshIndexData.setName("meshIndexData");
+    sceneData.meshStaticData.setName("meshStaticData");
+    sceneData.meshIndexData.setBufferCount(bufferCount);
+    sceneData.meshStaticData.setBufferCount(bufferCount);
+
+    std::mt19937 rng(123);
+    std::vector<uint32_t> indices(vertexCount * 3);
+    for (auto& index : indices)
+        index = rng() % vertexCount;
+    std::vector<PackedStaticVertexData> vertices(vertexCount);
+    std::vector<uint32_t> words(sizeof(PackedStaticVertexData) / sizeof(uint32_t));
+    for (auto& vertex : vertices)
+    {
+        for (auto& word : words)
+            word = rng() % 1024;
+        std::memcpy(&vertex, words.data(), sizeof(vertex));
+    }
+
+    sceneData.meshIndexData.insert(indices.begin(), indices.end());
+    sceneData.meshStaticData.insert(vertices.begin(), vertices.end());
+    return sceneData;
+}
+
+template<typename T, bool TByteBuffer>
+bool compareSplitBuffers(const SplitBuffer<T, TByteBuffer>& a, const SplitBuffer<T, TByteBuffer>& b)
+{
+    if (a.getCpuBufferCount() != b.getCpuBufferCount())
+        return false;
+    for (size_t i = 0; i < a.getCpuBufferCount(); ++i)
+    {
+        auto dataA = a.getCpuData(i);
+        auto dataB = b.getCpuData(i);
+        if (dataA.size() != dataB.size() || std::memcmp(dataA.data(), dataB.data(), dataA.size_bytes()) != 0)
+            return false;
+    }
+    return true;
+}
+
+/// Touch all split buffer data, as uploading it to the GPU would.
+template<typename T, bool TByteBuffer>
+uint32_t checksum(const SplitBuffer<T, TByteBuffer>& buffer)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < buffer.getCpuBufferCount(); ++i)
+    {
+        auto data = buffer.getCpuData(i);
+        const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(data.data());
+        for (size_t j = 0; j < data.size_bytes(); j += 64)
+            sum += pBytes[j];
+    }
+    return sum;
+}
+} // namespace
+
+GPU_TEST(SceneCache_Roundtrip)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    Scene::SceneData sceneData = createSceneData(pDevice, 10000, 2);
+    sceneData.meshDrawCount = 42;
+
+    auto path = getTempFilePath();
+    auto copyPath = getTempFilePath();
+    auto legacyPath = getTempFilePath();
+
+    // Sectioned format, split buffers reference the memory mapping.
+    SceneCache::writeCache(sceneData, path);
+    {
+        Scene::SceneData loaded = SceneCache::readCache(pDevice, path);
+        EXPECT_EQ(loaded.meshDrawCount, 42u);
+        EXPECT(loaded.meshIndexData.hasExternalCpuData());
+        EXPECT(loaded.meshStaticData.hasExternalCpuData());
+        EXPECT(compareSplitBuffers(loaded.meshIndexData, sceneData.meshIndexData));
+        EXPECT(compareSplitBuffers(loaded.meshStaticData, sceneData.meshStaticData));
+        EXPECT_EQ(loaded.meshStaticData.getByteSize(), sceneData.meshStaticData.getByteSize());
+
+        // Writing a cache from mapped data must work.
+        SceneCache::writeCache(loaded, copyPath);
+        Scene::SceneData copy = SceneCache::readCache(pDevice, copyPath);
+        EXPECT(compareSplitBuffers(copy.meshIndexData, sceneData.meshIndexData));
+        EXPECT(compareSplitBuffers(copy.meshStaticData, sceneData.meshStaticData));
+    }
+
+    // All compression modes roundtrip, compressed buffers are decompressed into memory.
+    for (auto compression : {SceneCache::Compression::None, SceneCache::Compression::LZ4, SceneCache::Compression::LZ4HC})
+    {
+        for (bool compressBuffers : {false, true})
+        {
+            SceneCache::writeCache(sceneData, copyPath, compression, compressBuffers);
+            Scene::SceneData loaded = SceneCache::readCache(pDevice, copyPath);
+            EXPECT_EQ(loaded.meshDrawCount, 42u);
+            EXPECT(compareSplitBuffers(loaded.meshIndexData, sceneData.meshIndexData));
+            EXPECT(compareSplitBuffers(loaded.meshStaticData, sceneData.meshStaticData));
+        }
+    }
+
+    // Legacy format is still readable.
+    SceneCache::writeLegacyCache(sceneData, legacyPath);
+    {
+        Scene::SceneData loaded = SceneCache::readCache(pDevice, legacyPath);
+        EXPECT_EQ(loaded.meshDrawCount, 42u);
+        EXPECT(!loaded.meshStaticData.hasExternalCpuData());
+        EXPECT(compareSplitBuffers(loaded.meshIndexData, sceneData.meshIndexData));
+        EXPECT(compareSplitBuffers(loaded.meshStaticData, sceneData.meshStaticData));
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(copyPath);
+    std::filesystem::remove(legacyPath);
+}
+
+GPU_TEST(SceneCache_OverwriteMapped)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    Scene::SceneData sceneData = createSceneData(pDevice, 1000, 2);
+    sceneData.meshDrawCount = 1;
+
+    auto path = getTempFilePath();
+    SceneCache::writeCache(sceneData, path);
+    {
+        // Overwrite the cache while the loaded scene data still references its memory mapping.
+        Scene::SceneData loaded = SceneCache::readCache(pDevice, path);
+        EXPECT(loaded.meshStaticData.hasExternalCpuData());
+        sceneData.meshDrawCount = 2;
+        SceneCache::writeCache(sceneData, path);
+
+        EXPECT_EQ(SceneCache::readCache(pDevice, path).meshDrawCount, 2u);
+        EXPECT_EQ(loaded.meshDrawCount, 1u);
+        EXPECT(compareSplitBuffers(loaded.meshStaticData, sceneData.meshStaticData));
+    }
+
+    // The replaced cache is removed by the next write once it is no longer mapped.
+    SceneCache::writeCache(sceneData, path);
+    const std::string stalePrefix = path.filename().string() + ".";
+    uint32_t staleCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::absolute(path).parent_path()))
+        staleCount += entry.path().filename().string().rfind(stalePrefix, 0) == 0 ? 1 : 0;
+    EXPECT_EQ(staleCount, 0u);
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(SceneCache_Benchmark, TAGS("benchmark"))
+{
+    // Note: The first load after writing is served from the OS file cache. For truly cold numbers,
+    // flush the file cache between writing and loading (not possible portably from within the test).
+    const size_t kVertexCount = 8 * 1024 * 1024;
+    const uint32_t kWarmIterations = 3;
+
+    ref<Device> pDevice = ctx.getDevice();
+    Scene::SceneData sceneData = createSceneData(pDevice, kVertexCount, 1);
+    const uint32_t expectedChecksum = checksum(sceneData.meshIndexData) + checksum(sceneData.meshStaticData);
+    const double sizeMB = (sceneData.meshIndexData.getByteSize() + sceneData.meshStaticData.getByteSize()) / (1024.0 * 1024.0);
+
+    auto path = getTempFilePath();
+    auto legacyPath = getTempFilePath();
+
+    // Write times for the different compression options.
+    for (auto compression : {SceneCache::Compression::None, SceneCache::Compression::LZ4, SceneCache::Compression::LZ4HC})
+    {
+        auto start = CpuTimer::getCurrentTimePoint();
+        SceneCache::writeCache(sceneData, path, compression, true);
+        auto end = CpuTimer::getCurrentTimePoint();
+        logInfo(
+            "SceneCache write with {} compression: {:.1f} ms, {:.1f} MB",
+            compression,
+            CpuTimer::calcDuration(start, end),
+            std::filesystem::file_size(path) / (1024.0 * 1024.0)
+        );
+    }
+
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    SceneCache::writeCache(sceneData, path);
+    auto t1 = CpuTimer::getCurrentTimePoint();
+    SceneCache::writeLegacyCache(sceneData, legacyPath);
+    auto t2 = CpuTimer::getCurrentTimePoint();
+
+    // Measure loading including touching all data, returns time for the first and the average of the warm loads.
+    auto measureLoad = [&](const std::filesystem::path& cachePath)
+    {
+        double first = 0.0;
+        double warm = 0.0;
+        for (uint32_t i = 0; i < kWarmIterations + 1; ++i)
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            Scene::SceneData loaded = SceneCache::readCache(pDevice, cachePath);
+            EXPECT_EQ(checksum(loaded.meshIndexData) + checksum(loaded.meshStaticData), expectedChecksum);
+            auto end = CpuTimer::getCurrentTimePoint();
+            (i == 0 ? first : warm) += CpuTimer::calcDuration(start, end);
+        }
+        return std::make_pair(first, warm / kWarmIterations);
+    };
+
+    auto [mappedFirst, mappedWarm] = measureLoad(path);
+    auto [legacyFirst, legacyWarm] = measureLoad(legacyPath);
+
+    logInfo("SceneCache benchmark ({:.1f} MB of vertex/index data):", sizeMB);
+    logInfo("  write:      sectioned {:.1f} ms, legacy {:.1f} ms", CpuTimer::calcDuration(t0, t1), CpuTimer::calcDuration(t1, t2));
+    logInfo("  first load: sectioned {:.1f} ms, legacy {:.1f} ms", mappedFirst, legacyFirst);
+    logInfo("  warm load:  sectioned {:.1f} ms, legacy {:.1f} ms", mappedWarm, legacyWarm);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(legacyPath);
+}
+} // namespace Falcor
@@ -0,0 +1,258 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/TransformHierarchy.h"
+#include "Utils/Math/MatrixMath.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+float4x4 createRandomTransform(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    float4x4 T = math::matrixFromTranslation(float3(u(rng), u(rng), u(rng)));
+    float4x4 R = math::matrixFromRotation(3.f * u(rng), normalize(float3(u(rng), u(rng), u(rng)) + float3(0.01f)));
+    float4x4 S = math::matrixFromScaling(float3(1.f + 0.2f * u(rng), 1.f + 0.2f * u(rng), 1.f + 0.2f * u(rng)));
+    return mul(mul(T, R), S);
+}
+
+/** Create a random forest with parents stored after some of their children.
+*/
+std::vector<NodeID> createRandomForest(uint32_t nodeCount, std::mt19937& rng)
+{
+    // Build a forest where parents precede children, then shuffle the node order.
+    std::vector<uint32_t> parents(nodeCount, TransformHierarchy::kInvalidNode);
+    for (uint32_t i = 1; i < nodeCount; ++i)
+    {
+        if (rng() % 8 != 0) parents[i] = rng() % i;
+    }
+    std::vector<uint32_t> permutation(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i) permutation[i] = i;
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+
+    std::vector<NodeID> result(nodeCount, NodeID::Invalid());
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        if (parents[i] != TransformHierarchy::kInvalidNode) result[permutation[i]] = NodeID(permutation[parents[i]]);
+    }
+    return result;
+}
+
+/** Create a hierarchy of the given depth where each node has the given number of children.
+    Parents precede their children as in scene graphs created by SceneBuilder.
+*/
+std::vector<NodeID> createTree(uint32_t depth, uint32_t childCount)
+{
+    std::vector<NodeID> parents = {NodeID::Invalid()};
+    size_t levelBegin = 0;
+    for (uint32_t level = 1; level < depth; ++level)
+    {
+        size_t levelEnd = parents.size();
+        for (size_t i = levelBegin; i < levelEnd; ++i)
+        {
+            for (uint32_t j = 0; j < childCount; ++j) parents.push_back(NodeID(i));
+        }
+        levelBegin = levelEnd;
+    }
+    return parents;
+}
+
+float4x4 computeGlobalMatrix(const std::vector<NodeID>& parents, const std::vector<float4x4>& localMatrices, uint32_t node)
+{
+    float4x4 global = localMatrices[node];
+    for (NodeID parent = parents[node]; parent != NodeID::Invalid(); parent = parents[parent.get()])
+    {
+        global = mul(localMatrices[parent.get()], global);
+    }
+    return global;
+}
+
+float maxDifference(const float4x4& a, const float4x4& b)
+{
+    float result = 0.f;
+    for (uint32_t i = 0; i < 16; ++i) result = std::max(result, std::abs(a.data()[i] - b.data()[i]));
+    return result;
+}
+
+/** Serial update in node order, as done before the level layout was introduced. Requires parents to precede children.
+*/
+void updateSerial(
+    const std::vector<NodeID>& parents,
+    const std::vector<float4x4>& localMatrices,
+    std::vector<uint8_t>& changed,
+    std::vector<float4x4>& globalMatrices,
+    std::vector<float4x4>& invTransposeGlobalMatrices
+)
+{
+    for (size_t i = 0; i < parents.size(); ++i)
+    {
+        if (parents[i] != NodeID::Invalid()) changed[i] = changed[i] || changed[parents[i].get()];
+        if (!changed[i]) continue;
+        globalMatrices[i] = parents[i] != NodeID::Invalid() ? mul(globalMatrices[parents[i].get()], localMatrices[i]) : localMatrices[i];
+        invTransposeGlobalMatrices[i] = transpose(inverse(globalMatrices[i]));
+    }
+}
+} // namespace
+
+CPU_TEST(TransformHierarchy_Levels)
+{
+    // 3 -> 1 -> 0, 3 -> 2, 4.
+    std::vector<NodeID> parents = {NodeID(1), NodeID(3), NodeID(3), NodeID::Invalid(), NodeID::Invalid()};
+    TransformHierarchy hierarchy(parents);
+    EXPECT_EQ(hierarchy.getNodeCount(), size_t(5));
+    EXPECT_EQ(hierarchy.getLevelCount(), 3u);
+    EXPECT_EQ(hierarchy.getLevel(0), 2u);
+    EXPECT_EQ(hierarchy.getLevel(1), 1u);
+    EXPECT_EQ(hierarchy.getLevel(2), 1u);
+    EXPECT_EQ(hierarchy.getLevel(3), 0u);
+    EXPECT_EQ(hierarchy.getLevel(4), 0u);
+
+    // Cycles are rejected.
+    EXPECT_THROW(TransformHierarchy({NodeID(1), NodeID(2), NodeID(0)}));
+}
+
+CPU_TEST(TransformHierarchy_Update)
+{
+    std::mt19937 rng(0);
+    const uint32_t kNodeCount = 5000;
+    std::vector<NodeID> parents = createRandomForest(kNodeCount, rng);
+    TransformHierarchy hierarchy(parents);
+
+    std::vector<float4x4> localMatrices(kNodeCount);
+    for (auto& m : localMatrices) m = createRandomTransform(rng);
+    // Include a projective transform to exercise the general path.
+    localMatrices[rng() % kNodeCount][3] = float4(0.1f, 0.f, 0.f, 1.f);
+
+    std::vector<uint8_t> changed(kNodeCount, 0);
+    std::vector<float4x4> globalMatrices(kNodeCount);
+    std::vector<float4x4> invTransposeGlobalMatrices(kNodeCount);
+
+    auto check = [&]()
+    {
+        for (uint32_t i = 0; i < kNodeCount; ++i)
+        {
+            float4x4 expected = computeGlobalMatrix(parents, localMatrices, i);
+            EXPECT_LE(maxDifference(globalMatrices[i], expected), 1e-3f) << "node " << i;
+            EXPECT_LE(maxDifference(invTransposeGlobalMatrices[i], transpose(inverse(globalMatrices[i]))), 1e-3f) << "node " << i;
+        }
+    };
+
+    hierarchy.update(localMatrices, changed, true, globalMatrices, invTransposeGlobalMatrices);
+    EXPECT_EQ(hierarchy.getUpdatedNodes().size(), size_t(kNodeCount));
+    check();
+
+    // Incremental updates flag and update exactly the subtrees of the changed nodes.
+    for (uint32_t iteration = 0; iteration < 10; ++iteration)
+    {
+        std::fill(changed.begin(), changed.end(), 0);
+        std::vector<uint8_t> expectedChanged(kNodeCount, 0);
+        for (uint32_t j = 0; j < 20; ++j)
+        {
+            uint32_t node = rng() % kNodeCount;
+            localMatrices[node] = createRandomTransform(rng);
+            changed[node] = 1;
+        }
+        for (uint32_t i = 0; i < kNodeCount; ++i)
+        {
+            for (NodeID node{i}; node != NodeID::Invalid(); node = parents[node.get()])
+            {
+                if (changed[node.get()]) expectedChanged[i] = 1;
+            }
+        }
+
+        hierarchy.update(localMatrices, changed, false, globalMatrices, invTransposeGlobalMatrices);
+        EXPECT(changed == expectedChanged);
+        EXPECT_EQ(hierarchy.getUpdatedNodes().size(), (size_t)std::count(expectedChanged.begin(), expectedChanged.end(), uint8_t(1)));
+        for (uint32_t node : hierarchy.getUpdatedNodes())
+        {
+            if (parents[node] != NodeID::Invalid()) EXPECT_LT(hierarchy.getLevel(parents[node].get()), hierarchy.getLevel(node));
+        }
+        check();
+    }
+}
+
+CPU_TEST(TransformHierarchy_Benchmark, TAGS("benchmark"))
+{
+    struct Config
+    {
+        const char* name;
+        uint32_t depth;
+        uint32_t childCount;
+    };
+    const Config kConfigs[] = {
+        {"wide (2 levels, 1M children)", 2, 1 << 20},
+        {"deep (20 levels, binary)", 20, 2},
+        {"bushy (6 levels, 16 children)", 6, 16},
+    };
+
+    std::mt19937 rng(0);
+    logInfo("TransformHierarchy benchmark ({} workers):", Threading::getWorkerCount());
+    for (const auto& config : kConfigs)
+    {
+        std::vector<NodeID> parents = createTree(config.depth, config.childCount);
+        const size_t nodeCount = parents.size();
+        TransformHierarchy hierarchy(parents);
+
+        std::vector<float4x4> localMatrices(nodeCount);
+        for (auto& m : localMatrices) m = createRandomTransform(rng);
+        std::vector<uint8_t> changed(nodeCount, 1);
+        std::vector<float4x4> globalMatrices(nodeCount);
+        std::vector<float4x4> invTransposeGlobalMatrices(nodeCount);
+
+        // Full update.
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        updateSerial(parents, localMatrices, changed, globalMatrices, invTransposeGlobalMatrices);
+        auto t1 = CpuTimer::getCurrentTimePoint();
+        hierarchy.update(localMatrices, changed, true, globalMatrices, invTransposeGlobalMatrices);
+        auto t2 = CpuTimer::getCurrentTimePoint();
+
+        // Incremental update with 0.1% of the nodes changed.
+        std::vector<uint8_t> dirty(nodeCount, 0);
+        for (size_t i = 0; i < nodeCount / 1000 + 1; ++i) dirty[rng() % nodeCount] = 1;
+        changed = dirty;
+        auto t3 = CpuTimer::getCurrentTimePoint();
+        updateSerial(parents, localMatrices, changed, globalMatrices, invTransposeGlobalMatrices);
+        auto t4 = CpuTimer::getCurrentTimePoint();
+        changed = dirty;
+        hierarchy.update(localMatrices, changed, false, globalMatrices, invTransposeGlobalMatrices);
+        auto t5 = CpuTimer::getCurrentTimePoint();
+
+        logInfo("  {}: {} nodes", config.name, nodeCount);
+        logInfo(
+            "    full update: serial {:.2f} ms, levels {:.2f} ms; incremental ({} nodes): serial {:.2f} ms, levels {:.2f} ms",
+            CpuTimer::calcDuration(t0, t1), CpuTimer::calcDuration(t1, t2), hierarchy.getUpdatedNodes().size(),
+            CpuTimer::calcDuration(t3, t4), CpuTimer::calcDuration(t4, t5)
+        );
+    }
+}
+} // namespace Falcor
@@ -28,8 +28,42 @@
 #include "Testing/UnitTest.h"
 #include "Utils/BufferAllocator.h"
 
+#include <random>
+
 namespace Falcor
 {
+namespace
+{
+/// Reference for BufferAllocator::getDirtyRanges() computed from per-byte dirty flags.
+std::vector<BufferAllocator::Range> computeExpectedRanges(const std::vector<bool>& dirty, const BufferAllocator::UploadOptions& options)
+{
+    const size_t size = dirty.size();
+    std::vector<BufferAllocator::Range> ranges;
+    size_t dirtyBytes = 0;
+    for (size_t page = 0; page * options.pageSize < size; ++page)
+    {
+        const size_t start = page * options.pageSize;
+        const size_t end = std::min(start + options.pageSize, size);
+        if (std::find(dirty.begin() + start, dirty.begin() + end, true) == dirty.begin() + end)
+            continue;
+
+        if (!ranges.empty() && start - ranges.back().end <= options.mergeDistance)
+        {
+            dirtyBytes += end - ranges.back().end;
+            ranges.back().end = end;
+        }
+        else
+        {
+            dirtyBytes += end - start;
+            ranges.emplace_back(start, end);
+        }
+    }
+    if (ranges.size() > 1 && (double)dirtyBytes > (double)options.fullUploadRatio * (double)size)
+        ranges = {BufferAllocator::Range(0, size)};
+    return ranges;
+}
+} // namespace
+
 struct S
 {
     float a;
@@ -313,4 +347,109 @@ GPU_TEST(BufferAllocatorStructAlign)
     }
 }
 
+CPU_TEST(BufferAllocatorDirtyRanges)
+{
+    std::mt19937 rng(0);
+    for (uint32_t iteration = 0; iteration < 200; ++iteration)
+    {
+        BufferAllocator buf(0, 0, 0);
+        BufferAllocator::UploadOptions options;
+        options.pageSize = size_t(1) << (rng() % 10 + 4);
+        options.mergeDistance = (rng() % 4) * options.pageSize + rng() % 2 * (rng() % options.pageSize);
+        options.fullUploadRatio = (rng() % 5) * 0.25f;
+        buf.setUploadOptions(options);
+
+        // Allocate without writing, so that only the explicitly modified memory is dirty.
+        const size_t size = 1 + rng() % 100000;
+        buf.allocate(size);
+        EXPECT(buf.getDirtyRanges().empty());
+
+        std::vector<bool> dirty(size, false);
+        const uint32_t editCount = rng() % 20;
+        for (uint32_t i = 0; i < editCount; ++i)
+        {
+            size_t offset = rng() % size;
+            size_t byteSize = 1 + rng() % std::min<size_t>(size - offset, rng() % 2 ? 16 : 10000);
+            buf.modified(offset, byteSize);
+            std::fill(dirty.begin() + offset, dirty.begin() + offset + byteSize, true);
+        }
+
+        std::vector<BufferAllocator::Range> ranges = buf.getDirtyRanges();
+        EXPECT(ranges == computeExpectedRanges(dirty, options)) << "iteration " << iteration;
+
+        // All modified bytes are covered by the sorted, disjoint ranges.
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            EXPECT_LT(ranges[i].start, ranges[i].end);
+            EXPECT_LE(ranges[i].end, size);
+            if (i > 0)
+                EXPECT_GT(ranges[i].start, ranges[i - 1].end + options.mergeDistance);
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (!dirty[i])
+                continue;
+            bool covered = std::any_of(ranges.begin(), ranges.end(), [&](const auto& r) { return i >= r.start && i < r.end; });
+            EXPECT(covered) << "byte " << i;
+            if (!covered)
+                break;
+        }
+
+        // Changing the options keeps the dirty memory dirty.
+        options.pageSize = 16;
+        options.mergeDistance = 0;
+        options.fullUploadRatio = 1.f;
+        buf.setUploadOptions(options);
+        std::vector<bool> newDirty(size, false);
+        for (const auto& range : ranges)
+            std::fill(newDirty.begin() + range.start, newDirty.begin() + range.end, true);
+        EXPECT(buf.getDirtyRanges() == computeExpectedRanges(newDirty, options)) << "iteration " << iteration;
+    }
+}
+
+GPU_TEST(BufferAllocatorPartialUpload)
+{
+    const size_t kSize = 1 << 20;
+    BufferAllocator buf(0, 0, 0);
+    std::vector<uint8_t> data(kSize);
+    std::mt19937 rng(0);
+    for (auto& v : data)
+        v = uint8_t(rng());
+    buf.allocate(kSize);
+    buf.setBlob(data.data(), 0, kSize);
+
+    // The first access uploads the entire buffer.
+    ref<Buffer> pBuffer = buf.getGPUBuffer(ctx.getDevice());
+    EXPECT_EQ(buf.getUploadStats().fullUploadCount, uint64_t(1));
+    EXPECT_EQ(buf.getUploadStats().uploadedBytes, uint64_t(kSize));
+    EXPECT(buf.getDirtyRanges().empty());
+
+    // Modifying both ends of the buffer only uploads the two modified pages.
+    buf.resetUploadStats();
+    buf.set<uint32_t>(0, 0x12345678);
+    buf.set<uint32_t>(kSize - 4, 0x9abcdef0);
+    pBuffer = buf.getGPUBuffer(ctx.getDevice());
+    const size_t pageSize = buf.getUploadOptions().pageSize;
+    EXPECT_EQ(buf.getUploadStats().rangeCount, uint64_t(2));
+    EXPECT_EQ(buf.getUploadStats().uploadedBytes, uint64_t(2 * pageSize));
+
+    // Random edits.
+    for (uint32_t iteration = 0; iteration < 10; ++iteration)
+    {
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            size_t offset = rng() % (kSize - 64);
+            uint8_t* ptr = buf.getStartPointer() + offset;
+            for (size_t j = 0; j < 64; ++j)
+                ptr[j] = uint8_t(rng());
+            buf.modified(offset, 64);
+        }
+        pBuffer = buf.getGPUBuffer(ctx.getDevice());
+
+        std::vector<uint8_t> gpuData = pBuffer->getElements<uint8_t>(0, kSize);
+        EXPECT(std::memcmp(gpuData.data(), buf.getStartPointer(), kSize) == 0) << "iteration " << iteration;
+    }
+    EXPECT_LT(buf.getUploadStats().uploadedBytes, uint64_t(10 * kSize / 2));
+}
+
 } // namespace Falcor
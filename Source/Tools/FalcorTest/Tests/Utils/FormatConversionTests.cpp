@@ -0,0 +1,393 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Math/FormatConversion.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <fstd/bit.h> // TODO C++20: Replace with <bit>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+uint8_t linearToSrgb8Reference(float v)
+{
+    if (!(v > 0.f))
+        return 0;
+    if (v >= 1.f)
+        return 255;
+    double s = v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow((double)v, 1.0 / 2.4) - 0.055;
+    return uint8_t(std::floor(s * 255.0 + 0.5));
+}
+
+float srgb8ToLinearReference(uint8_t v)
+{
+    double s = v / 255.0;
+    return float(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+}
+
+template<typename SrcT>
+void testIntToNormalizedFloat32(CPUUnitTestContext& ctx, const std::vector<SrcT>& values)
+{
+    std::vector<float> result(values.size());
+    convertIntToNormalizedFloat32(values.data(), result.data(), values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        float expected = float(values[i]) / float(std::numeric_limits<SrcT>::max());
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(result[i]), fstd::bit_cast<uint32_t>(expected)) << "value=" << int64_t(values[i]);
+    }
+}
+} // namespace
+
+CPU_TEST(FormatConversion_Float16ToFloat32)
+{
+    // Test all float16 values. The count is not a multiple of the SIMD width to exercise the tail.
+    std::vector<uint16_t> src(65536 + 3);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = uint16_t(i);
+    std::vector<float> dst(src.size());
+    convertFloat16ToFloat32(src.data(), dst.data(), src.size());
+
+    // Signaling NaNs may be returned as quiet NaNs (F16C sets the quiet bit), but sign and payload are preserved.
+    const uint32_t kQuietBit = 0x00400000;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        uint32_t expected = fstd::bit_cast<uint32_t>(math::float16ToFloat32(src[i]));
+        uint32_t result = fstd::bit_cast<uint32_t>(dst[i]);
+        if (std::isnan(fstd::bit_cast<float>(expected)))
+            EXPECT_EQ(result | kQuietBit, expected | kQuietBit) << "bits=" << src[i];
+        else
+            EXPECT_EQ(result, expected) << "bits=" << src[i];
+    }
+}
+
+CPU_TEST(FormatConversion_Float32ToFloat16)
+{
+    std::vector<float> src = {
+        0.f,
+        -0.f,
+        1.f,
+        -1.f,
+        65504.f,
+        65519.f,
+        65520.f,
+        -65520.f,
+        1e10f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+        fstd::bit_cast<float>(0x7f800001u), // Signaling NaN
+        fstd::bit_cast<float>(0x38800000u), // Smallest float16 normal
+        fstd::bit_cast<float>(0x387fffffu), // Largest float16 denormal
+        fstd::bit_cast<float>(0x33000000u), // Rounds to smallest float16 denormal
+        fstd::bit_cast<float>(0x32ffffffu), // Rounds to zero
+        std::numeric_limits<float>::denorm_min(),
+        1.f + 1.f / 2048.f, // Tie
+        1.f + 3.f / 2048.f, // Tie
+    };
+
+    // Random bit patterns cover all classes of values, random values in range cover rounding.
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(-70000.f, 70000.f);
+    for (size_t i = 0; i < 100000; ++i)
+        src.push_back(fstd::bit_cast<float>(uint32_t(rng())));
+    for (size_t i = 0; i < 100000; ++i)
+        src.push_back(dist(rng));
+    for (uint32_t h = 0; h < 0x7c00; ++h)
+        src.push_back(math::float16ToFloat32(uint16_t(h)));
+    src.push_back(1.f);
+
+    std::vector<uint16_t> dst(src.size());
+    convertFloat32ToFloat16(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], math::float32ToFloat16(src[i])) << "value=" << src[i] << " bits=" << fstd::bit_cast<uint32_t>(src[i]);
+}
+
+CPU_TEST(FormatConversion_IntToNormalizedFloat32)
+{
+    std::mt19937 rng(0);
+
+    std::vector<uint16_t> u16;
+    std::vector<int16_t> i16;
+    for (int32_t i = 0; i < 65536 + 5; ++i)
+    {
+        u16.push_back(uint16_t(i));
+        i16.push_back(int16_t(uint16_t(i)));
+    }
+    testIntToNormalizedFloat32(ctx, u16);
+    testIntToNormalizedFloat32(ctx, i16);
+
+    std::vector<uint32_t> u32 = {0, 1, 0xffff, 0x10000, 0x7fffffff, 0x80000000, 0xffffff7f, 0xffffff80, 0xfffffffe, 0xffffffff};
+    std::vector<int32_t> i32 = {
+        0, 1, -1, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min() + 1};
+    for (size_t i = 0; i < 100001; ++i)
+    {
+        u32.push_back(uint32_t(rng()));
+        i32.push_back(int32_t(uint32_t(rng())));
+    }
+    testIntToNormalizedFloat32(ctx, u32);
+    testIntToNormalizedFloat32(ctx, i32);
+}
+
+CPU_TEST(FormatConversion_Expand)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+    for (size_t pixelCount : {0, 1, 3, 4, 5, 37})
+    {
+        // Float expansion to RGBA.
+        for (uint32_t channelCount = 1; channelCount <= 4; ++channelCount)
+        {
+            std::vector<float> src(pixelCount * channelCount);
+            for (auto& v : src)
+                v = dist(rng);
+            std::vector<float> dst(pixelCount * 4, -1.f);
+            expandToRGBA32Float(src.data(), channelCount, dst.data(), pixelCount);
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    float expected = c < channelCount ? src[i * channelCount + c] : (c == 3 ? 1.f : 0.f);
+                    EXPECT_EQ(dst[i * 4 + c], expected) << "pixel=" << i << " channel=" << c << " channelCount=" << channelCount;
+                }
+            }
+        }
+
+        // Float RGBA to RGB.
+        {
+            std::vector<float> src(pixelCount * 4);
+            for (auto& v : src)
+                v = dist(rng);
+            std::vector<float> dst(pixelCount * 3);
+            convertRGBA32FloatToRGB32Float(src.data(), dst.data(), pixelCount);
+            for (size_t i = 0; i < pixelCount; ++i)
+                for (uint32_t c = 0; c < 3; ++c)
+                    EXPECT_EQ(dst[i * 3 + c], src[i * 4 + c]) << "pixel=" << i << " channel=" << c;
+        }
+    }
+
+    for (size_t pixelCount = 0; pixelCount < 40; ++pixelCount)
+    {
+        // 8-bit RGB to RGBA.
+        std::vector<uint8_t> src(pixelCount * 3);
+        for (auto& v : src)
+            v = uint8_t(rng());
+        std::vector<uint8_t> dst(pixelCount * 4);
+        expandRGB8ToRGBA8(src.data(), dst.data(), pixelCount, 0x80);
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            EXPECT_EQ(dst[i * 4 + 0], src[i * 3 + 0]);
+            EXPECT_EQ(dst[i * 4 + 1], src[i * 3 + 1]);
+            EXPECT_EQ(dst[i * 4 + 2], src[i * 3 + 2]);
+            EXPECT_EQ(dst[i * 4 + 3], 0x80);
+        }
+
+        // 8-bit RGBA to BGRA, out-of-place and in-place.
+        std::vector<uint8_t> rgba(pixelCount * 4);
+        for (auto& v : rgba)
+            v = uint8_t(rng());
+        for (bool forceOpaque : {false, true})
+        {
+            std::vector<uint8_t> bgra(pixelCount * 4);
+            swizzleRGBA8ToBGRA8(rgba.data(), bgra.data(), pixelCount, forceOpaque);
+            std::vector<uint8_t> inPlace = rgba;
+            swizzleRGBA8ToBGRA8(inPlace.data(), inPlace.data(), pixelCount, forceOpaque);
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                EXPECT_EQ(bgra[i * 4 + 0], rgba[i * 4 + 2]);
+                EXPECT_EQ(bgra[i * 4 + 1], rgba[i * 4 + 1]);
+                EXPECT_EQ(bgra[i * 4 + 2], rgba[i * 4 + 0]);
+                EXPECT_EQ(bgra[i * 4 + 3], forceOpaque ? 0xff : rgba[i * 4 + 3]);
+            }
+            EXPECT(inPlace == bgra);
+        }
+    }
+}
+
+CPU_TEST(FormatConversion_Srgb)
+{
+    // Decode all 8-bit values.
+    std::vector<uint8_t> codes(256);
+    for (uint32_t i = 0; i < 256; ++i)
+        codes[i] = uint8_t(i);
+    std::vector<float> linear(256);
+    convertSrgb8ToFloat32(codes.data(), linear.data(), codes.size());
+    for (uint32_t i = 0; i < 256; ++i)
+        EXPECT_EQ(linear[i], srgb8ToLinearReference(uint8_t(i))) << "code=" << i;
+
+    // Encode values around all rounding boundaries, special values and a dense sweep of [0,1].
+    std::vector<float> src = {
+        -1.f, -0.f, 0.f, 1.f, 2.f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(), 1e-30f};
+    for (uint32_t i = 1; i < 256; ++i)
+    {
+        float t = srgb8ToLinearReference(uint8_t(i)) - 0.5f * (srgb8ToLinearReference(uint8_t(i)) - srgb8ToLinearReference(uint8_t(i - 1)));
+        for (int j = 0; j < 64; ++j)
+        {
+            src.push_back(t);
+            src.push_back(std::nextafter(src.back(), 0.f));
+            t = std::nextafter(t, 1.f);
+        }
+    }
+    for (uint32_t i = 0; i <= 1000000; ++i)
+        src.push_back(float(i) / 1000000.f);
+
+    std::vector<uint8_t> dst(src.size());
+    convertFloat32ToSrgb8(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], linearToSrgb8Reference(src[i])) << "value=" << src[i];
+}
+
+CPU_TEST(FormatConversion_Benchmark, TAGS("benchmark"))
+{
+    struct Resolution
+    {
+        const char* name;
+        size_t width;
+        size_t height;
+    };
+    const Resolution kResolutions[] = {{"4K", 3840, 2160}, {"8K", 7680, 4320}};
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(0.f, 2.f);
+    logInfo("FormatConversion benchmark (old scalar loop vs. bulk kernel):");
+    for (const auto& res : kResolutions)
+    {
+        const size_t pixelCount = res.width * res.height;
+        std::vector<float> rgba(pixelCount * 4);
+        for (auto& v : rgba)
+            v = dist(rng);
+        std::vector<float> rgb(pixelCount * 3);
+        for (auto& v : rgb)
+            v = dist(rng);
+        std::vector<uint16_t> half(pixelCount * 4);
+        std::vector<uint8_t> rgb8(pixelCount * 3);
+        for (auto& v : rgb8)
+            v = uint8_t(rng());
+        std::vector<uint8_t> rgba8(pixelCount * 4);
+        std::vector<float> floatDst(pixelCount * 4);
+
+        auto measure = [](auto&& func)
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            func();
+            return CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        };
+
+        logInfo("  {} ({}x{}):", res.name, res.width, res.height);
+
+        double scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < rgba.size(); ++i)
+                    half[i] = float16_t(rgba[i]).toBits();
+            }
+        );
+        double simd = measure([&]() { convertFloat32ToFloat16(rgba.data(), half.data(), rgba.size()); });
+        logInfo("    RGBA32Float -> RGBA16Float: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < half.size(); ++i)
+                    floatDst[i] = float(float16_t::fromBits(half[i]));
+            }
+        );
+        simd = measure([&]() { convertFloat16ToFloat32(half.data(), floatDst.data(), half.size()); });
+        logInfo("    RGBA16Float -> RGBA32Float: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < half.size(); ++i)
+                    floatDst[i] = float(half[i]) / float(std::numeric_limits<uint16_t>::max());
+            }
+        );
+        simd = measure([&]() { convertIntToNormalizedFloat32(half.data(), floatDst.data(), half.size()); });
+        logInfo("    RGBA16Unorm -> RGBA32Float: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    floatDst[i * 4 + 0] = rgb[i * 3 + 0];
+                    floatDst[i * 4 + 1] = rgb[i * 3 + 1];
+                    floatDst[i * 4 + 2] = rgb[i * 3 + 2];
+                    floatDst[i * 4 + 3] = 1.f;
+                }
+            }
+        );
+        simd = measure([&]() { expandToRGBA32Float(rgb.data(), 3, floatDst.data(), pixelCount); });
+        logInfo("    RGB32Float -> RGBA32Float: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    rgba8[i * 4 + 0] = rgb8[i * 3 + 0];
+                    rgba8[i * 4 + 1] = rgb8[i * 3 + 1];
+                    rgba8[i * 4 + 2] = rgb8[i * 3 + 2];
+                    rgba8[i * 4 + 3] = 0xff;
+                }
+            }
+        );
+        simd = measure([&]() { expandRGB8ToRGBA8(rgb8.data(), rgba8.data(), pixelCount); });
+        logInfo("    RGB8 -> RGBA8: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    std::swap(rgba8[i * 4 + 0], rgba8[i * 4 + 2]);
+                    rgba8[i * 4 + 3] = 0xff;
+                }
+            }
+        );
+        simd = measure([&]() { swizzleRGBA8ToBGRA8(rgba8.data(), rgba8.data(), pixelCount, true); });
+        logInfo("    RGBA8 -> BGRA8: {:.2f} ms / {:.2f} ms", scalar, simd);
+
+        scalar = measure(
+            [&]()
+            {
+                for (size_t i = 0; i < rgba.size(); ++i)
+                    rgba8[i] = linearToSrgb8Reference(rgba[i]);
+            }
+        );
+        simd = measure([&]() { convertFloat32ToSrgb8(rgba.data(), rgba8.data(), rgba.size()); });
+        logInfo("    RGBA32Float -> RGBA8UnormSrgb: {:.2f} ms / {:.2f} ms", scalar, simd);
+    }
+}
+} // namespace Falcor
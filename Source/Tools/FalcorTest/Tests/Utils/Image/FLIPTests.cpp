@@ -0,0 +1,388 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/FLIP.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const float kPi = 3.14159265358979323846f;
+
+/// Generate a test image with smooth gradients, edges and noise. Values are in [0, scale].
+std::vector<float> generateImage(uint32_t width, uint32_t height, uint32_t seed, float scale)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(0.f, 0.15f);
+    std::vector<float> image(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float* p = &image[(size_t(y) * width + x) * 4];
+            float u = float(x) / width;
+            float v = float(y) / height;
+            float edge = ((x / 7 + y / 5) & 1) ? 0.3f : 0.f;
+            p[0] = std::min(1.f, 0.6f * u + edge + noise(rng)) * scale;
+            p[1] = std::min(1.f, 0.6f * v + noise(rng)) * scale;
+            p[2] = std::min(1.f, 0.5f * (1.f - u) + edge + noise(rng)) * scale;
+            p[3] = 1.f;
+        }
+    }
+    return image;
+}
+
+/// Perturb an image, keeping values non-negative.
+std::vector<float> perturbImage(const std::vector<float>& image, uint32_t seed, float amount)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-amount, amount);
+    std::vector<float> result(image);
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        if (i % 4 != 3)
+            result[i] = std::max(0.f, result[i] + noise(rng));
+    }
+    return result;
+}
+
+/**
+ * Direct port of FLIPPass.cs.slang evaluating the non-separable 2D filters per pixel.
+ * Only supports the ACES tone mapper. Used as reference for the optimized implementation.
+ */
+class ReferenceFLIP
+{
+public:
+    ReferenceFLIP(const float* pReference, const float* pTest, uint32_t width, uint32_t height, const FLIP::Options& options)
+        : mpReference(pReference), mpTest(pTest), mWidth(width), mHeight(height), mOptions(options)
+    {
+        mPixelsPerDegree = options.monitorDistanceMeters * (options.monitorWidthPixels / options.monitorWidthMeters) * (kPi / 180.f);
+        mMaxDistance = std::pow(hyAB(hunt(linearRGBToCIELab(float3(0.f, 1.f, 0.f))), hunt(linearRGBToCIELab(float3(0.f, 0.f, 1.f)))), 0.7f);
+    }
+
+    float hdrFLIP(uint32_t x, uint32_t y, const FLIP::ExposureParameters& exposure) const
+    {
+        float delta = (exposure.stopExposure - exposure.startExposure) / (exposure.numExposures - 1.f);
+        float hdrflip = 0.f;
+        for (uint32_t i = 0; i < exposure.numExposures; i++)
+            hdrflip = std::max(hdrflip, ldrFLIP(x, y, exposure.startExposure + i * delta));
+        return hdrflip;
+    }
+
+    float ldrFLIP(uint32_t px, uint32_t py, float exposure = 0.f) const
+    {
+        const float dx = 1.f / mPixelsPerDegree;
+        const float4 abValuesA = {1.0f, 0.0f, 0.0047f, 1.0e-5f};
+        const float4 abValuesRG = {1.0f, 0.0f, 0.0053f, 1.0e-5f};
+        const float4 abValuesBY = {34.1f, 13.5f, 0.04f, 0.025f};
+
+        float sigmaFeatures = 0.5f * 0.082f * mPixelsPerDegree;
+        float sigmaFeaturesSquared = sigmaFeatures * sigmaFeatures;
+        int radius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * kPi * kPi)) * mPixelsPerDegree));
+
+        float positiveKernelSum = 0.f, negativeKernelSum = 0.f, edgeKernelSum = 0.f;
+        for (int y = -radius; y <= radius; y++)
+        {
+            for (int x = -radius; x <= radius; x++)
+            {
+                float g = std::exp(-(x * x + y * y) / (2.f * sigmaFeaturesSquared));
+                float pointWeight = (x * x / sigmaFeaturesSquared - 1.f) * g;
+                positiveKernelSum += pointWeight >= 0.f ? pointWeight : 0.f;
+                negativeKernelSum += pointWeight < 0.f ? -pointWeight : 0.f;
+                float edgeWeight = -x * g;
+                edgeKernelSum += edgeWeight >= 0.f ? edgeWeight : 0.f;
+            }
+        }
+
+        float3 csfKernelSum(0.f), referenceColorSum(0.f), testColorSum(0.f);
+        float2 referenceEdgeGradient(0.f), referencePointGradient(0.f), testEdgeGradient(0.f), testPointGradient(0.f);
+        for (int y = -radius; y <= radius; y++)
+        {
+            for (int x = -radius; x <= radius; x++)
+            {
+                int nx = std::clamp(int(px) + x, 0, int(mWidth) - 1);
+                int ny = std::clamp(int(py) + y, 0, int(mHeight) - 1);
+                float3 referenceColor = getPixel(mpReference, nx, ny, exposure);
+                float3 testColor = getPixel(mpTest, nx, ny, exposure);
+
+                float2 p = float2(float(x), float(y)) * dx;
+                float dist2 = -(p.x * p.x + p.y * p.y) * kPi * kPi;
+                float3 colorWeight(calculateWeight(dist2, abValuesA), calculateWeight(dist2, abValuesRG), calculateWeight(dist2, abValuesBY));
+                csfKernelSum += colorWeight;
+                referenceColorSum += colorWeight * referenceColor;
+                testColorSum += colorWeight * testColor;
+
+                float g = std::exp(-(x * x + y * y) / (2.f * sigmaFeaturesSquared));
+                float2 pointWeight = (float2(float(x * x), float(y * y)) / sigmaFeaturesSquared - 1.f) * g;
+                float2 pointNormalization = float2(
+                    1.f / (pointWeight.x >= 0.f ? positiveKernelSum : negativeKernelSum),
+                    1.f / (pointWeight.y >= 0.f ? positiveKernelSum : negativeKernelSum)
+                );
+                float2 edgeWeight = -float2(float(x), float(y)) * g;
+                float edgeNormalization = 1.f / edgeKernelSum;
+
+                float referenceLuminance = (referenceColor.x + 16.f) / 116.f;
+                referencePointGradient += referenceLuminance * pointWeight * pointNormalization;
+                referenceEdgeGradient += referenceLuminance * edgeWeight * edgeNormalization;
+                float testLuminance = (testColor.x + 16.f) / 116.f;
+                testPointGradient += testLuminance * pointWeight * pointNormalization;
+                testEdgeGradient += testLuminance * edgeWeight * edgeNormalization;
+            }
+        }
+
+        float3 spatialFilteredReference = clamp01(YCxCzToLinearRGB(referenceColorSum / csfKernelSum));
+        float3 spatialFilteredTest = clamp01(YCxCzToLinearRGB(testColorSum / csfKernelSum));
+        float colorDiff = hyAB(hunt(linearRGBToCIELab(spatialFilteredReference)), hunt(linearRGBToCIELab(spatialFilteredTest)));
+
+        float edgeDifference = std::abs(length(referenceEdgeGradient) - length(testEdgeGradient));
+        float pointDifference = std::abs(length(referencePointGradient) - length(testPointGradient));
+        float featureDiff = std::pow(std::max(pointDifference, edgeDifference) * 0.707106781f, 0.5f);
+
+        float error = std::pow(colorDiff, 0.7f);
+        float perceptualCutoff = 0.4f * mMaxDistance;
+        if (error < perceptualCutoff)
+            error *= 0.95f / perceptualCutoff;
+        else
+            error = 0.95f + ((error - perceptualCutoff) / (mMaxDistance - perceptualCutoff)) * (1.f - 0.95f);
+        return std::pow(error, 1.f - featureDiff);
+    }
+
+private:
+    static float length(float2 v) { return std::sqrt(v.x * v.x + v.y * v.y); }
+    static float3 clamp01(float3 c) { return float3(std::clamp(c.x, 0.f, 1.f), std::clamp(c.y, 0.f, 1.f), std::clamp(c.z, 0.f, 1.f)); }
+    static float3 hunt(float3 c) { return float3(c.x, 0.01f * c.x * c.y, 0.01f * c.x * c.z); }
+    static float hyAB(float3 a, float3 b)
+    {
+        float3 d = a - b;
+        return std::abs(d.x) + std::sqrt(d.y * d.y + d.z * d.z);
+    }
+    static float calculateWeight(float dist2, float4 ab)
+    {
+        float b1Inv = 1.f / ab.z;
+        float b2Inv = 1.f / ab.w;
+        return ab.x * std::sqrt(kPi * b1Inv) * std::exp(b1Inv * dist2) + ab.y * std::sqrt(kPi * b2Inv) * std::exp(b2Inv * dist2);
+    }
+
+    float3 getPixel(const float* pImage, int x, int y, float exposure) const
+    {
+        const float* p = pImage + (size_t(y) * mWidth + x) * 4;
+        float3 c(p[0], p[1], p[2]);
+        if (mOptions.isHDR)
+        {
+            c = float3(std::max(c.x, 0.f), std::max(c.y, 0.f), std::max(c.z, 0.f)) * std::pow(2.f, exposure);
+            // ACES tone mapper.
+            float3 mapped;
+            for (int i = 0; i < 3; ++i)
+            {
+                float nom = 0.6f * 0.6f * 2.51f * c[i] * c[i] + 0.6f * 0.03f * c[i];
+                float denom = 0.6f * 0.6f * 2.43f * c[i] * c[i] + 0.6f * 0.59f * c[i] + 0.14f;
+                mapped[i] = std::clamp(nom / denom, 0.f, 1.f);
+            }
+            c = mapped;
+        }
+        else
+        {
+            c = clamp01(c);
+        }
+        return linearRGBToYCxCz(c);
+    }
+
+    const float* mpReference;
+    const float* mpTest;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    FLIP::Options mOptions;
+    float mPixelsPerDegree;
+    float mMaxDistance;
+};
+
+void testAgainstReference(CPUUnitTestContext& ctx, uint32_t width, uint32_t height, const FLIP::Options& options, float scale)
+{
+    auto reference = generateImage(width, height, 1, scale);
+    auto test = perturbImage(reference, 2, 0.2f * scale);
+
+    std::vector<float> errorMap(size_t(width) * height);
+    FLIP::Result result = FLIP::compute(reference.data(), test.data(), width, height, 4, options, errorMap.data());
+
+    ReferenceFLIP ref(reference.data(), test.data(), width, height, options);
+    double sum = 0.0;
+    float maxDiff = 0.f;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float expected = options.isHDR ? ref.hdrFLIP(x, y, result.exposure) : ref.ldrFLIP(x, y);
+            float actual = errorMap[size_t(y) * width + x];
+            maxDiff = std::max(maxDiff, std::abs(actual - expected));
+            sum += actual;
+        }
+    }
+    EXPECT_LE(maxDiff, 1e-4f) << "isHDR=" << options.isHDR;
+    EXPECT_EQ(result.mean, float(sum / (double(width) * height)));
+    EXPECT_EQ(result.min, *std::min_element(errorMap.begin(), errorMap.end()));
+    EXPECT_EQ(result.max, *std::max_element(errorMap.begin(), errorMap.end()));
+    EXPECT_GT(result.mean, 0.f);
+}
+} // namespace
+
+CPU_TEST(FLIP_IdenticalImages)
+{
+    const uint32_t width = 33, height = 17;
+    auto image = generateImage(width, height, 1, 4.f);
+
+    for (bool isHDR : {false, true})
+    {
+        FLIP::Options options;
+        options.isHDR = isHDR;
+        std::vector<float> errorMap(size_t(width) * height, -1.f);
+        FLIP::Result result = FLIP::compute(image.data(), image.data(), width, height, 4, options, errorMap.data());
+        EXPECT_EQ(result.mean, 0.f);
+        EXPECT_EQ(result.max, 0.f);
+        for (float value : errorMap)
+            EXPECT_EQ(value, 0.f);
+    }
+}
+
+CPU_TEST(FLIP_ChannelCount)
+{
+    const uint32_t width = 20, height = 12;
+    auto reference = generateImage(width, height, 1, 1.f);
+    auto test = perturbImage(reference, 2, 0.2f);
+
+    auto toRGB = [](const std::vector<float>& rgba)
+    {
+        std::vector<float> rgb;
+        for (size_t i = 0; i < rgba.size(); ++i)
+            if (i % 4 != 3)
+                rgb.push_back(rgba[i]);
+        return rgb;
+    };
+
+    FLIP::Options options;
+    FLIP::Result rgba = FLIP::compute(reference.data(), test.data(), width, height, 4, options);
+    FLIP::Result rgb = FLIP::compute(toRGB(reference).data(), toRGB(test).data(), width, height, 3, options);
+    EXPECT_EQ(rgba.mean, rgb.mean);
+    EXPECT_EQ(rgba.max, rgb.max);
+
+    EXPECT_THROW(FLIP::compute(reference.data(), test.data(), width, height, 2, options));
+}
+
+CPU_TEST(FLIP_ExposureParameters)
+{
+    // Image with luminance 1 in the first half and 4 in the second half (even pixel count).
+    const uint32_t width = 4, height = 2;
+    std::vector<float> image(width * height * 3);
+    for (uint32_t i = 0; i < width * height; ++i)
+        std::fill_n(&image[i * 3], 3, i < 4 ? 1.f : 4.f);
+
+    // For the Reinhard tone mapper, the input mapped to 0.85 is 0.85 / 0.15.
+    FLIP::ExposureParameters params = FLIP::computeExposureParameters(image.data(), width, height, 3, FLIP::ToneMapper::Reinhard);
+    const float xMax = 0.85f / 0.15f;
+    EXPECT_LE(std::abs(params.startExposure - std::log2(xMax / 4.f)), 1e-5f);
+    EXPECT_LE(std::abs(params.stopExposure - std::log2(xMax / 2.5f)), 1e-5f);
+    EXPECT_EQ(params.numExposures, 2);
+
+    // Custom exposure parameters are returned unchanged.
+    FLIP::Options options;
+    options.isHDR = true;
+    options.useCustomExposureParameters = true;
+    options.exposure = {-3.f, 2.f, 6};
+    FLIP::Result result = FLIP::compute(image.data(), image.data(), width, height, 3, options);
+    EXPECT_EQ(result.exposure.startExposure, -3.f);
+    EXPECT_EQ(result.exposure.stopExposure, 2.f);
+    EXPECT_EQ(result.exposure.numExposures, 6);
+}
+
+CPU_TEST(FLIP_MatchesReference)
+{
+    FLIP::Options options;
+    testAgainstReference(ctx, 41, 29, options, 1.f);
+
+    // Lower pixels per degree result in smaller filters and more pixels affected by the image borders.
+    options.monitorWidthPixels = 1280;
+    testAgainstReference(ctx, 23, 9, options, 1.f);
+
+    options = {};
+    options.isHDR = true;
+    testAgainstReference(ctx, 37, 21, options, 8.f);
+}
+
+CPU_TEST(FLIP_ThreadCount)
+{
+    const uint32_t width = 96, height = 80;
+    auto reference = generateImage(width, height, 1, 8.f);
+    auto test = perturbImage(reference, 2, 1.f);
+
+    // The result does not depend on the number of threads.
+    for (bool isHDR : {false, true})
+    {
+        FLIP::Options options;
+        options.isHDR = isHDR;
+        std::vector<float> expected(size_t(width) * height);
+        FLIP::Result expectedResult = FLIP::compute(reference.data(), test.data(), width, height, 4, options, expected.data());
+
+        for (uint32_t threadCount : {1u, 2u, 3u})
+        {
+            options.threadCount = threadCount;
+            std::vector<float> errorMap(size_t(width) * height);
+            FLIP::Result result = FLIP::compute(reference.data(), test.data(), width, height, 4, options, errorMap.data());
+            EXPECT_EQ(result.mean, expectedResult.mean) << "isHDR=" << isHDR << " threadCount=" << threadCount;
+            EXPECT(errorMap == expected) << "isHDR=" << isHDR << " threadCount=" << threadCount;
+        }
+    }
+}
+
+CPU_TEST(FLIP_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t width = 3840, height = 2160;
+    auto reference = generateImage(width, height, 1, 1.f);
+    auto test = perturbImage(reference, 2, 0.1f);
+    std::vector<float> errorMap(size_t(width) * height);
+
+    logInfo("FLIP benchmark ({}x{}, {} threads):", width, height, Threading::getWorkerCount() + 1);
+    for (bool isHDR : {false, true})
+    {
+        FLIP::Options options;
+        options.isHDR = isHDR;
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        FLIP::Result result = FLIP::compute(reference.data(), test.data(), width, height, 4, options, errorMap.data());
+        double time = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logInfo(
+            "  {}: {:.2f} ms ({} exposures), mean {:.4f}", isHDR ? "HDR-FLIP" : "LDR-FLIP", time, isHDR ? result.exposure.numExposures : 1, result.mean
+        );
+    }
+}
+} // namespace Falcor
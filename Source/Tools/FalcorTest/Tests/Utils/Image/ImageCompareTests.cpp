@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "ImageCompare/ErrorMetrics.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Not a multiple of the block size or the lane count, so that partial blocks and lanes are covered.
+const uint32_t kWidth = 301;
+const uint32_t kHeight = 131;
+
+std::vector<float> generateImage(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.f, 2.f);
+    std::vector<float> image(size_t(kWidth) * kHeight * 4);
+    for (float& value : image)
+        value = dist(rng);
+    return image;
+}
+
+/// Compare the blocked computation against a naive running sum.
+template<typename Metric>
+void testMetric(CPUUnitTestContext& ctx, const char* name)
+{
+    const size_t pixelCount = size_t(kWidth) * kHeight;
+    auto a = generateImage(1);
+    auto b = generateImage(2);
+
+    for (bool alpha : {false, true})
+    {
+        const size_t channelCount = alpha ? 4 : 3;
+        Metric metric;
+        double naiveSum = 0.0;
+        std::vector<float> expectedErrorMap(pixelCount);
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            double error = metric(&a[i * 4], &b[i * 4], channelCount);
+            expectedErrorMap[i] = float(error);
+            naiveSum += error;
+        }
+        const double expected = naiveSum / pixelCount;
+
+        std::vector<float> errorMap(pixelCount);
+        double error = ImageCompare::computeError<Metric>(a.data(), b.data(), pixelCount, alpha, errorMap.data(), 1);
+        EXPECT_LE(std::abs(error - expected), 1e-12 * expected) << name << " alpha=" << alpha;
+        EXPECT(errorMap == expectedErrorMap) << name << " alpha=" << alpha;
+
+        // The result does not depend on the number of threads.
+        for (uint32_t threadCount : {2u, 3u, 8u})
+        {
+            std::fill(errorMap.begin(), errorMap.end(), 0.f);
+            double threadedError = ImageCompare::computeError<Metric>(a.data(), b.data(), pixelCount, alpha, errorMap.data(), threadCount);
+            EXPECT_EQ(threadedError, error) << name << " alpha=" << alpha << " threadCount=" << threadCount;
+            EXPECT(errorMap == expectedErrorMap) << name << " alpha=" << alpha << " threadCount=" << threadCount;
+        }
+    }
+}
+} // namespace
+
+CPU_TEST(ImageCompare_KnownError)
+{
+    // Images with a constant difference of 0.25 in the color channels and 0.5 in the alpha channel.
+    const size_t pixelCount = size_t(kWidth) * kHeight;
+    std::vector<float> a(pixelCount * 4);
+    std::vector<float> b(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount * 4; ++i)
+    {
+        a[i] = 0.5f;
+        b[i] = i % 4 == 3 ? 0.f : 0.25f;
+    }
+
+    for (uint32_t threadCount : {1u, 4u})
+    {
+        EXPECT_EQ(ImageCompare::computeError<ImageCompare::MSE>(a.data(), b.data(), pixelCount, false, nullptr, threadCount), 0.0625);
+        EXPECT_EQ(ImageCompare::computeError<ImageCompare::MSE>(a.data(), b.data(), pixelCount, true, nullptr, threadCount), 0.109375);
+    }
+
+    // Identical images have no error.
+    EXPECT_EQ(ImageCompare::computeError<ImageCompare::MAPE>(a.data(), a.data(), pixelCount, true, nullptr, 4), 0.0);
+}
+
+CPU_TEST(ImageCompare_Metrics)
+{
+    testMetric<ImageCompare::MSE>(ctx, "MSE");
+    testMetric<ImageCompare::RMSE>(ctx, "RMSE");
+    testMetric<ImageCompare::MAE>(ctx, "MAE");
+    testMetric<ImageCompare::MAPE>(ctx, "MAPE");
+}
+} // namespace Falcor
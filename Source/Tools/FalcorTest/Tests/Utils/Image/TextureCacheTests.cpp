@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+#include "Core/Platform/OS.h"
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream(path, std::ios::binary) << content;
+}
+} // namespace
+
+CPU_TEST(TextureCache_CompressionMode)
+{
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RGBA8Unorm, 256, 128) == ImageIO::CompressionMode::BC7);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::BGRX8Unorm, 256, 128) == ImageIO::CompressionMode::BC7);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RG8Unorm, 256, 128) == ImageIO::CompressionMode::BC5);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::R8Unorm, 256, 128) == ImageIO::CompressionMode::BC4);
+
+    // Unaligned sizes, HDR, integer and already compressed data are stored as is.
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RGBA8Unorm, 254, 128) == ImageIO::CompressionMode::None);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RGBA32Float, 256, 128) == ImageIO::CompressionMode::None);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RGBA16Float, 256, 128) == ImageIO::CompressionMode::None);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::RGBA8Uint, 256, 128) == ImageIO::CompressionMode::None);
+    EXPECT(TextureCache::getCompressionMode(ResourceFormat::BC1Unorm, 256, 128) == ImageIO::CompressionMode::None);
+}
+
+CPU_TEST(TextureCache_Key)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    {
+        TextureCache::Options options;
+        options.directory = directory;
+        TextureCache cache(options);
+        EXPECT(std::filesystem::is_directory(directory));
+
+        writeFile(directory / "a.png", "content a");
+        writeFile(directory / "b.png", "content a");
+        writeFile(directory / "c.png", "content c");
+
+        // The key depends on the content and the options, not on the path.
+        auto keyA = cache.computeKey(directory / "a.png", true, Bitmap::ImportFlags::None);
+        auto keyB = cache.computeKey(directory / "b.png", true, Bitmap::ImportFlags::None);
+        auto keyC = cache.computeKey(directory / "c.png", true, Bitmap::ImportFlags::None);
+        ASSERT(keyA && keyB && keyC);
+        EXPECT(*keyA == *keyB);
+        EXPECT(*keyA != *keyC);
+        EXPECT(*keyA != *cache.computeKey(directory / "a.png", false, Bitmap::ImportFlags::None));
+        EXPECT(*keyA != *cache.computeKey(directory / "a.png", true, Bitmap::ImportFlags::ConvertToFloat16));
+        EXPECT(!cache.computeKey(directory / "missing.png", true, Bitmap::ImportFlags::None));
+
+        EXPECT_EQ(cache.getEntryPath(*keyA), directory / (SHA1::toString(*keyA) + ".dds"));
+    }
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(TextureCache_Eviction)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    std::filesystem::create_directories(directory);
+
+    // Create entries with increasing modification times, i.e. the first entry is the least recently used.
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (int i = 0; i < 4; ++i)
+    {
+        auto path = directory / fmt::format("entry{}.dds", i);
+        writeFile(path, std::string(100, 'x'));
+        std::filesystem::last_write_time(path, now + std::chrono::seconds(i - 10));
+    }
+    writeFile(directory / "other.txt", std::string(1000, 'x'));
+
+    {
+        TextureCache::Options options;
+        options.directory = directory;
+        options.maxSizeInBytes = 250;
+        TextureCache cache(options);
+
+        // Only the entries are counted, and the two oldest are evicted.
+        TextureCache::Stats stats = cache.getStats();
+        EXPECT_EQ(stats.entryCount, 2);
+        EXPECT_EQ(stats.sizeInBytes, 200);
+        EXPECT_EQ(stats.evictionCount, 2);
+        EXPECT(!std::filesystem::exists(directory / "entry0.dds"));
+        EXPECT(!std::filesystem::exists(directory / "entry1.dds"));
+        EXPECT(std::filesystem::exists(directory / "entry2.dds"));
+        EXPECT(std::filesystem::exists(directory / "entry3.dds"));
+        EXPECT(std::filesystem::exists(directory / "other.txt"));
+
+        // Entries whose file can't be removed are kept, and their size is still counted.
+        std::filesystem::remove(directory / "entry3.dds");
+        std::filesystem::create_directory(directory / "entry3.dds");
+        writeFile(directory / "entry3.dds" / "file", "x");
+        cache.clear();
+        stats = cache.getStats();
+        EXPECT_EQ(stats.entryCount, 1);
+        EXPECT_EQ(stats.sizeInBytes, 100);
+        EXPECT(!std::filesystem::exists(directory / "entry2.dds"));
+
+        std::filesystem::remove_all(directory / "entry3.dds");
+        cache.clear();
+        stats = cache.getStats();
+        EXPECT_EQ(stats.entryCount, 0);
+        EXPECT_EQ(stats.sizeInBytes, 0);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(TextureCache_Load)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::filesystem::path directory = getTempFilePath();
+    const std::filesystem::path imagePath = getTempFilePath().replace_extension(".png");
+
+    const uint32_t kSize = 64;
+    std::vector<uint8_t> pixels(kSize * kSize * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = (uint8_t)(i * 7);
+    Bitmap::saveImage(
+        imagePath, kSize, kSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, pixels.data()
+    );
+
+    {
+        TextureCache::Options options;
+        options.directory = directory;
+        TextureCache cache(options);
+
+        // The first load adds the texture to the cache, the second load reads the cache entry.
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            ref<Texture> pTexture = cache.loadTexture(pDevice, imagePath, true, true, ResourceBindFlags::ShaderResource, Bitmap::ImportFlags::None);
+            ASSERT(pTexture != nullptr);
+            EXPECT_EQ(pTexture->getWidth(), kSize);
+            EXPECT_EQ(pTexture->getHeight(), kSize);
+            EXPECT_EQ(pTexture->getMipCount(), 7);
+            EXPECT(pTexture->getFormat() == ResourceFormat::BC7UnormSrgb);
+            EXPECT_EQ(pTexture->getSourcePath(), imagePath);
+
+            TextureCache::Stats stats = cache.getStats();
+            EXPECT_EQ(stats.missCount, 1);
+            EXPECT_EQ(stats.hitCount, i);
+            EXPECT_EQ(stats.entryCount, 1);
+        }
+
+        // Textures with other bind flags than ShaderResource are not cached.
+        EXPECT(cache.loadTexture(pDevice, imagePath, true, true, ResourceBindFlags::UnorderedAccess, Bitmap::ImportFlags::None) == nullptr);
+    }
+
+    {
+        // A cache that is too small still returns the texture, but doesn't keep the entry.
+        TextureCache::Options options;
+        options.directory = directory;
+        options.maxSizeInBytes = 0;
+        TextureCache cache(options);
+        EXPECT_EQ(cache.getStats().entryCount, 0);
+
+        ref<Texture> pTexture = cache.loadTexture(pDevice, imagePath, false, false, ResourceBindFlags::ShaderResource, Bitmap::ImportFlags::None);
+        ASSERT(pTexture != nullptr);
+        EXPECT_EQ(pTexture->getMipCount(), 1);
+        EXPECT(pTexture->getFormat() == ResourceFormat::BC7Unorm);
+        EXPECT_EQ(cache.getStats().entryCount, 0);
+    }
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(imagePath);
+}
+} // namespace Falcor
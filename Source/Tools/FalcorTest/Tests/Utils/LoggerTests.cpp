@@ -0,0 +1,289 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Disables logger outputs and restores the logger settings on destruction.
+struct ScopedLoggerSettings
+{
+    Logger::Level verbosity = Logger::getVerbosity();
+    Logger::OutputFlags outputs = Logger::getOutputs();
+    Logger::OverflowPolicy overflowPolicy = Logger::getOverflowPolicy();
+    uint32_t rateLimit = Logger::getRateLimit();
+    bool asyncEnabled = Logger::isAsyncEnabled();
+
+    ScopedLoggerSettings()
+    {
+        Logger::flush();
+        Logger::setVerbosity(Logger::Level::Info);
+        Logger::setOutputs(Logger::OutputFlags::None);
+    }
+
+    ~ScopedLoggerSettings()
+    {
+        Logger::flush();
+        Logger::setVerbosity(verbosity);
+        Logger::setOutputs(outputs);
+        Logger::setOverflowPolicy(overflowPolicy);
+        Logger::setRateLimit(rateLimit);
+        Logger::setAsyncEnabled(asyncEnabled);
+    }
+};
+
+/// Captures the console output of the logger. If requested, the first write blocks until released, which stalls the writer thread.
+class ConsoleCapture : public std::streambuf
+{
+public:
+    ConsoleCapture(bool blockFirstWrite) : mBlock(blockFirstWrite)
+    {
+        Logger::flush();
+        mpCout = std::cout.rdbuf(this);
+        mpCerr = std::cerr.rdbuf(this);
+    }
+
+    ~ConsoleCapture()
+    {
+        release();
+        Logger::flush();
+        std::cout.rdbuf(mpCout);
+        std::cerr.rdbuf(mpCerr);
+    }
+
+    /// Wait until a write is blocked.
+    bool waitUntilBlocked()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCond.wait_for(lock, std::chrono::seconds(10), [this]() { return mBlocked; });
+    }
+
+    /// Let the blocked write and all further writes through.
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBlock = false;
+        mCond.notify_all();
+    }
+
+    /// Count the occurrences of a string in the captured output.
+    size_t count(const std::string& str)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t count = 0;
+        for (size_t pos = mText.find(str); pos != std::string::npos; pos = mText.find(str, pos + str.size()))
+            ++count;
+        return count;
+    }
+
+    std::string getText()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mText;
+    }
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mBlock)
+        {
+            mBlocked = true;
+            mCond.notify_all();
+            mCond.wait(lock, [this]() { return !mBlock; });
+        }
+        mText.append(s, (size_t)n);
+        return n;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (c != traits_type::eof())
+        {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return c;
+    }
+
+private:
+    std::streambuf* mpCout = nullptr;
+    std::streambuf* mpCerr = nullptr;
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    bool mBlock = false;
+    bool mBlocked = false;
+    std::string mText;
+};
+} // namespace
+
+CPU_TEST(Logger_ConcurrentBlocking)
+{
+    ScopedLoggerSettings settings;
+    Logger::setOverflowPolicy(Logger::OverflowPolicy::Block);
+    Logger::setRateLimit(0);
+
+    const uint64_t droppedCount = Logger::getDroppedMessageCount();
+    Threading::parallelFor(
+        0,
+        64,
+        1,
+        [](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                for (uint32_t j = 0; j < 1000; ++j)
+                    logInfo("Logger test message {} {}", i, j);
+        }
+    );
+    Logger::flush();
+
+    // Blocking policy must not drop any messages.
+    EXPECT_EQ(Logger::getDroppedMessageCount(), droppedCount);
+}
+
+CPU_TEST(Logger_RateLimit)
+{
+    ScopedLoggerSettings settings;
+    Logger::setRateLimit(10);
+
+    const uint64_t suppressedCount = Logger::getSuppressedMessageCount();
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("Rate limited logger test message {}", i);
+
+    // At most two windows of 10 messages are reported if the loop straddles a window boundary.
+    EXPECT_GE(Logger::getSuppressedMessageCount() - suppressedCount, uint64_t(80));
+
+    // Raw string messages have no call site and are not rate limited.
+    const uint64_t suppressedCountRaw = Logger::getSuppressedMessageCount();
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("Raw logger test message");
+    EXPECT_EQ(Logger::getSuppressedMessageCount(), suppressedCountRaw);
+}
+
+CPU_TEST(Logger_DropWhenFull)
+{
+    ScopedLoggerSettings settings;
+    Logger::setAsyncEnabled(true);
+    Logger::setRateLimit(0);
+    Logger::setOutputs(Logger::OutputFlags::Console);
+
+    const uint64_t droppedCount = Logger::getDroppedMessageCount();
+    {
+        // Stall the writer thread on its first message, so that the queue fills up.
+        ConsoleCapture capture(true);
+        logInfo("Logger blocking message");
+        ASSERT(capture.waitUntilBlocked());
+
+        Logger::setOverflowPolicy(Logger::OverflowPolicy::Drop);
+        const uint64_t kMessageCount = 10000;
+        for (uint64_t i = 0; i < kMessageCount; ++i)
+            logInfo("Logger drop test message {}", i);
+
+        // Messages beyond the queue capacity are dropped and counted without blocking.
+        const uint64_t dropped = Logger::getDroppedMessageCount() - droppedCount;
+        EXPECT_GT(dropped, uint64_t(0));
+        EXPECT_LT(dropped, kMessageCount);
+
+        // All messages that were not dropped are written, followed by a report of the dropped count.
+        capture.release();
+        Logger::flush();
+        EXPECT_EQ(capture.count("Logger blocking message"), size_t(1));
+        EXPECT_EQ(capture.count("Logger drop test message") + dropped, kMessageCount);
+        EXPECT_EQ(capture.count(fmt::format("{} log messages were dropped", dropped)), size_t(1));
+    }
+}
+
+CPU_TEST(Logger_FatalFlushes)
+{
+    ScopedLoggerSettings settings;
+    Logger::setAsyncEnabled(true);
+    Logger::setOverflowPolicy(Logger::OverflowPolicy::Block);
+    Logger::setRateLimit(0);
+    Logger::setOutputs(Logger::OutputFlags::Console);
+
+    ConsoleCapture capture(false);
+    const size_t kMessageCount = 1000;
+    for (size_t i = 0; i < kMessageCount; ++i)
+        logInfo("Logger pending message {}", i);
+    logFatal("Logger fatal message");
+
+    // No flush: the pending messages and the fatal message itself are written before logFatal() returns.
+    const std::string text = capture.getText();
+    EXPECT_EQ(capture.count("Logger pending message"), kMessageCount);
+    const std::string fatal = "(Fatal) Logger fatal message\n";
+    EXPECT(text.size() >= fatal.size() && text.compare(text.size() - fatal.size(), fatal.size(), fatal) == 0);
+}
+
+CPU_TEST(Logger_StopWhileLogging)
+{
+    ScopedLoggerSettings settings;
+    Logger::setOverflowPolicy(Logger::OverflowPolicy::Block);
+    Logger::setRateLimit(0);
+    Logger::setOutputs(Logger::OutputFlags::Console);
+
+    ConsoleCapture capture(false);
+    const size_t kThreadCount = 4;
+    const size_t kMessageCount = 2000;
+    for (uint32_t iteration = 0; iteration < 20; ++iteration)
+    {
+        Logger::setAsyncEnabled(true);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreadCount; ++t)
+        {
+            threads.emplace_back(
+                [t, kMessageCount]()
+                {
+                    for (size_t i = 0; i < kMessageCount; ++i)
+                        logInfo("Logger stop test message {} {}", t, i);
+                }
+            );
+        }
+
+        // Stop the writer while the threads are logging. The writer is not restarted, so all messages must be written
+        // by the time the threads finish, either by the final drain or synchronously.
+        std::this_thread::sleep_for(std::chrono::microseconds(100 * iteration));
+        Logger::setAsyncEnabled(false);
+        for (auto& thread : threads)
+            thread.join();
+
+        EXPECT_EQ(capture.count("Logger stop test message"), (iteration + 1) * kThreadCount * kMessageCount) << "iteration " << iteration;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/Profiler.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Profiler_InternName)
+{
+    Profiler::EventName a = Profiler::internName("ProfilerTest");
+    Profiler::EventName b = Profiler::internName(std::string("ProfilerTest"));
+    Profiler::EventName c = Profiler::internName("ProfilerTestOther");
+    EXPECT(a == b);
+    EXPECT(a != c);
+    EXPECT_EQ(a.str(), "ProfilerTest");
+    EXPECT_EQ(c.str(), "ProfilerTestOther");
+}
+
+GPU_TEST(Profiler_ChromeTrace)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    Profiler* pProfiler = pRenderContext->getProfiler();
+    const bool wasEnabled = pProfiler->isEnabled();
+
+    const Profiler::EventName outerName = Profiler::internName("ProfilerTestOuter");
+    const Profiler::EventName innerName = Profiler::internName("ProfilerTestInner");
+    const Profiler::EventName workerName = Profiler::internName("ProfilerTestWorker");
+    const uint32_t kFrameCount = 3;
+    const uint32_t kWorkerCount = 4;
+
+    pProfiler->startCapture();
+    for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+    {
+        pProfiler->startEvent(pRenderContext, outerName, Profiler::Flags::Internal);
+        pProfiler->startEvent(pRenderContext, innerName, Profiler::Flags::Internal);
+        pProfiler->endEvent(pRenderContext, innerName, Profiler::Flags::Internal);
+        pProfiler->endEvent(pRenderContext, outerName, Profiler::Flags::Internal);
+        pProfiler->endFrame(pRenderContext);
+    }
+
+    // Record CPU events from worker threads.
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kWorkerCount; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                ScopedCpuProfilerEvent event(workerName);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto pCapture = pProfiler->endCapture();
+    pProfiler->setEnabled(wasEnabled);
+    ASSERT(pCapture != nullptr);
+    EXPECT_EQ(pCapture->getDroppedEventCount(), size_t(0));
+
+    uint32_t outerCount = 0;
+    uint32_t innerCount = 0;
+    std::set<uint32_t> workerThreads;
+    for (const auto& event : pCapture->getTraceEvents())
+    {
+        EXPECT_GE(event.duration, 0.0);
+        if (event.name == outerName)
+            ++outerCount;
+        if (event.name == innerName)
+            ++innerCount;
+        if (event.name == workerName)
+        {
+            EXPECT_GE(event.duration, 1.0);
+            workerThreads.insert(event.threadIndex);
+        }
+    }
+    EXPECT_EQ(outerCount, kFrameCount);
+    EXPECT_EQ(innerCount, kFrameCount);
+    EXPECT_EQ(workerThreads.size(), kWorkerCount);
+
+    // The export must be valid JSON with one complete event per occurrence.
+    nlohmann::json trace = nlohmann::json::parse(pCapture->toChromeTraceString());
+    ASSERT(trace.contains("traceEvents"));
+    uint32_t completeCount = 0;
+    for (const auto& event : trace["traceEvents"])
+    {
+        if (event["ph"] == "X" && event["name"].get<std::string>().rfind("ProfilerTest", 0) == 0)
+            ++completeCount;
+    }
+    EXPECT_EQ(completeCount, 2 * kFrameCount + kWorkerCount);
+}
+
+GPU_TEST(Profiler_CpuEventBufferRecycling)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    Profiler* pProfiler = pRenderContext->getProfiler();
+    const bool wasEnabled = pProfiler->isEnabled();
+    const Profiler::EventName name = Profiler::internName("ProfilerTestShortLived");
+
+    // Record events from many short-lived threads, one after another.
+    auto runThreads = [&](uint32_t threadCount)
+    {
+        pProfiler->startCapture();
+        for (uint32_t i = 0; i < threadCount; ++i)
+            std::thread([&]() { ScopedCpuProfilerEvent event(name); }).join();
+        auto pCapture = pProfiler->endCapture();
+        pProfiler->setEnabled(wasEnabled);
+
+        size_t eventCount = 0;
+        for (const auto& event : pCapture->getTraceEvents())
+            eventCount += event.name == name ? 1 : 0;
+        return eventCount;
+    };
+
+    // The events of exited threads are still collected, while their buffers are reused.
+    EXPECT_EQ(runThreads(16), size_t(16));
+    const size_t bufferCount = Profiler::getCpuEventBufferCount();
+    EXPECT_EQ(runThreads(64), size_t(64));
+    EXPECT_EQ(Profiler::getCpuEventBufferCount(), bufferCount);
+}
+} // namespace Falcor
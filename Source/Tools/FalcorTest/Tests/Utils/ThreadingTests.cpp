@@ -0,0 +1,211 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Threading_DispatchTask)
+{
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 1000; ++i)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter.fetch_add(1); }));
+    for (auto& task : tasks)
+        task.finish();
+    EXPECT_EQ(counter.load(), 1000u);
+    for (const auto& task : tasks)
+        EXPECT(!task.isRunning());
+
+    // Empty handles are never running.
+    Threading::Task empty;
+    EXPECT(!empty.isValid());
+    EXPECT(!empty.isRunning());
+    empty.finish();
+}
+
+CPU_TEST(Threading_IsRunning)
+{
+    std::atomic<bool> release{false};
+    Threading::Task task = Threading::dispatchTask(
+        [&release]()
+        {
+            while (!release.load())
+                std::this_thread::yield();
+        }
+    );
+    EXPECT(task.isRunning());
+    release = true;
+    task.finish();
+    EXPECT(!task.isRunning());
+}
+
+CPU_TEST(Threading_Continuation)
+{
+    std::vector<uint32_t> order;
+    Threading::Task task = Threading::dispatchTask([&order]() { order.push_back(0); });
+    Threading::Task last = task;
+    for (uint32_t i = 1; i < 10; ++i)
+        last = last.then([&order, i]() { order.push_back(i); });
+    last.finish();
+
+    ASSERT_EQ(order.size(), 10u);
+    for (uint32_t i = 0; i < 10; ++i)
+        EXPECT_EQ(order[i], i);
+
+    // Continuation on a finished task is dispatched right away.
+    bool ran = false;
+    task.then([&ran]() { ran = true; }).finish();
+    EXPECT(ran);
+}
+
+CPU_TEST(Threading_NestedWait)
+{
+    // Tasks waiting on tasks must not deadlock, even with more tasks than workers.
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 4 * Threading::getWorkerCount(); ++i)
+    {
+        tasks.push_back(Threading::dispatchTask(
+            [&counter]()
+            {
+                std::vector<Threading::Task> children;
+                for (uint32_t j = 0; j < 8; ++j)
+                    children.push_back(Threading::dispatchTask([&counter]() { counter.fetch_add(1); }));
+                for (auto& child : children)
+                    child.finish();
+            }
+        ));
+    }
+    for (auto& task : tasks)
+        task.finish();
+    EXPECT_EQ(counter.load(), 32u * Threading::getWorkerCount());
+}
+
+CPU_TEST(Threading_Exception)
+{
+    Threading::Task task = Threading::dispatchTask([]() { throw RuntimeError("Task failed"); });
+    EXPECT_THROW_AS(task.finish(), RuntimeError);
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    const size_t kCount = 100000;
+    for (size_t grainSize : {size_t(0), size_t(1), size_t(7), size_t(1000), kCount * 2})
+    {
+        std::vector<std::atomic<uint32_t>> visits(kCount);
+        Threading::parallelFor(
+            0,
+            kCount,
+            grainSize,
+            [&](size_t begin, size_t end)
+            {
+                if (grainSize > 0)
+                    EXPECT_LE(end - begin, grainSize);
+                for (size_t i = begin; i < end; ++i)
+                    visits[i].fetch_add(1);
+            }
+        );
+        for (size_t i = 0; i < kCount; ++i)
+            EXPECT_EQ_MSG(visits[i].load(), 1u, fmt::format("index {} grainSize {}", i, grainSize));
+    }
+
+    // Nested parallelFor from within worker tasks.
+    std::atomic<size_t> sum{0};
+    Threading::parallelFor(
+        0,
+        64,
+        1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                Threading::parallelFor(0, 100, 10, [&](size_t b, size_t e) { sum.fetch_add(e - b); });
+        }
+    );
+    EXPECT_EQ(sum.load(), 6400u);
+
+    // Empty range is a no-op.
+    Threading::parallelFor(5, 5, 1, [&](size_t, size_t) { EXPECT(false); });
+}
+
+CPU_TEST(Threading_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kLatencyIterations = 1000;
+    const uint32_t kThroughputTasks = 100000;
+    std::atomic<uint32_t> counter{0};
+
+    // Dispatch latency: round trip of dispatching a single task and waiting for it.
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kLatencyIterations; ++i)
+        Threading::dispatchTask([&counter]() { counter.fetch_add(1); }).finish();
+    auto t1 = CpuTimer::getCurrentTimePoint();
+
+    // Baseline: previous implementation, creating and joining one thread per task.
+    for (uint32_t i = 0; i < kLatencyIterations; ++i)
+        std::thread([&counter]() { counter.fetch_add(1); }).join();
+    auto t2 = CpuTimer::getCurrentTimePoint();
+
+    // Throughput: dispatch many small tasks and wait for all of them.
+    for (uint32_t i = 0; i < kThroughputTasks; ++i)
+        Threading::dispatchTask([&counter]() { counter.fetch_add(1); });
+    Threading::finish();
+    auto t3 = CpuTimer::getCurrentTimePoint();
+
+    // Baseline throughput: thread per task with a fixed number of slots (as the previous dispatchTask).
+    const uint32_t kBaselineTasks = kThroughputTasks / 10;
+    {
+        std::vector<std::thread> slots(Threading::kDefaultThreadCount);
+        for (uint32_t i = 0; i < kBaselineTasks; ++i)
+        {
+            std::thread& t = slots[i % slots.size()];
+            if (t.joinable())
+                t.join();
+            t = std::thread([&counter]() { counter.fetch_add(1); });
+        }
+        for (auto& t : slots)
+            if (t.joinable())
+                t.join();
+    }
+    auto t4 = CpuTimer::getCurrentTimePoint();
+
+    EXPECT_EQ(counter.load(), 2 * kLatencyIterations + kThroughputTasks + kBaselineTasks);
+
+    double latencyJobs = CpuTimer::calcDuration(t0, t1) * 1000.0 / kLatencyIterations;
+    double latencyThreads = CpuTimer::calcDuration(t1, t2) * 1000.0 / kLatencyIterations;
+    double throughputJobs = kThroughputTasks / (CpuTimer::calcDuration(t2, t3) * 1e-3);
+    double throughputThreads = kBaselineTasks / (CpuTimer::calcDuration(t3, t4) * 1e-3);
+    logInfo("Threading benchmark ({} workers):", Threading::getWorkerCount());
+    logInfo("  dispatch latency:    job system {:.2f} us, thread per task {:.2f} us", latencyJobs, latencyThreads);
+    logInfo("  dispatch throughput: job system {:.0f} tasks/s, thread per task {:.0f} tasks/s", throughputJobs, throughputThreads);
+}
+} // namespace Falcor
@@ -0,0 +1,206 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * Error metrics of the ImageCompare tool.
+ * This is a header-only library, so that the metrics can be tested by FalcorTest.
+ */
+namespace ImageCompare
+{
+template<typename T>
+T sqr(T x)
+{
+    return x * x;
+}
+
+/// Calls func(index) for all indices in [0, count) using up to threadCount threads.
+inline void parallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t)>& func)
+{
+    threadCount = (uint32_t)std::min<size_t>(threadCount, count);
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            func(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+/// Sums values using pairwise summation, which has a much smaller rounding error than a running sum.
+inline double pairwiseSum(const double* values, size_t count)
+{
+    if (count <= 8)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            sum += values[i];
+        return sum;
+    }
+    size_t half = count / 2;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+}
+
+struct MSE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += sqr(a[i] - b[i]);
+        return error / count;
+    }
+};
+
+struct RMSE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
+        return error / count;
+    }
+};
+
+struct MAE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += std::fabs(sqr(a[i] - b[i]));
+        return error / count;
+    }
+};
+
+struct MAPE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
+        return 100.0 * error / count;
+    }
+};
+
+/// Number of pixels per block. Block sums are computed independently and combined with pairwise summation,
+/// so the result does not depend on the number of threads.
+static constexpr size_t kBlockSize = 16384;
+
+/// Number of independent partial sums per block. This keeps the summation order fixed
+/// while allowing the compiler to vectorize the per-pixel metric.
+static constexpr size_t kLaneCount = 8;
+
+/**
+ * Compute the mean error of two RGBA float images.
+ * @param[in] a First image.
+ * @param[in] b Second image.
+ * @param[in] pixelCount Number of pixels.
+ * @param[out] errorMap Optional per-pixel error (pixelCount values).
+ * @param[in] threadCount Maximum number of threads.
+ * @return Mean error over the first kChannelCount channels of all pixels.
+ */
+template<typename Metric, size_t kChannelCount>
+double computeError(const float* a, const float* b, size_t pixelCount, float* errorMap, uint32_t threadCount)
+{
+    const size_t blockCount = (pixelCount + kBlockSize - 1) / kBlockSize;
+    std::vector<double> blockSums(blockCount);
+
+    parallelFor(
+        blockCount,
+        threadCount,
+        [&](size_t block)
+        {
+            Metric metric;
+            const size_t begin = block * kBlockSize;
+            const size_t end = std::min(pixelCount, begin + kBlockSize);
+            const float* pA = a + begin * 4;
+            const float* pB = b + begin * 4;
+
+            double lanes[kLaneCount] = {};
+            size_t i = begin;
+            for (; i + kLaneCount <= end; i += kLaneCount)
+            {
+                for (size_t lane = 0; lane < kLaneCount; ++lane)
+                {
+                    double error = metric(pA + lane * 4, pB + lane * 4, kChannelCount);
+                    if (errorMap)
+                        errorMap[i + lane] = float(error);
+                    lanes[lane] += error;
+                }
+                pA += kLaneCount * 4;
+                pB += kLaneCount * 4;
+            }
+            for (size_t lane = 0; i < end; ++i, ++lane)
+            {
+                double error = metric(pA, pB, kChannelCount);
+                if (errorMap)
+                    errorMap[i] = float(error);
+                lanes[lane] += error;
+                pA += 4;
+                pB += 4;
+            }
+
+            blockSums[block] = pairwiseSum(lanes, kLaneCount);
+        }
+    );
+
+    return pairwiseSum(blockSums.data(), blockCount) / pixelCount;
+}
+
+/// Compute the mean error of two RGBA float images, including the alpha channel if requested.
+template<typename Metric>
+double computeError(const float* a, const float* b, size_t pixelCount, bool alpha, float* errorMap, uint32_t threadCount)
+{
+    return alpha ? computeError<Metric, 4>(a, b, pixelCount, errorMap, threadCount)
+                 : computeError<Metric, 3>(a, b, pixelCount, errorMap, threadCount);
+}
+} // namespace ImageCompare
@@ -25,10 +25,16 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "ErrorMetrics.h"
+#include "Utils/Image/FLIP.h"
+#include "Utils/Threading.h"
+
 #include <FreeImage.h>
 #include <args.hxx>
+#include <nlohmann/json.hpp>
 
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,16 +42,15 @@
 #include <map>
 #include <functional>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
 
 #include <cmath>
 #include <cstring>
 
-template<typename T>
-T sqr(T x)
-{
-    return x * x;
-}
-
 template<typename T>
 T lerp(T a, T b, T t)
 {
@@ -58,6 +63,12 @@ T clamp(T x, T lo, T hi)
     return std::max(lo, std::min(hi, x));
 }
 
+/// Returns the current time in milliseconds.
+static double getTimeMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 class Image
 {
 public:
@@ -188,82 +199,41 @@ private:
     std::unique_ptr<float[]> mData;
 };
 
-struct MSE
-{
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
-    }
-};
-
-struct RMSE
-{
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
-    }
-};
-
-struct MAE
-{
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
-    }
-};
-
-struct MAPE
+template<typename Metric>
+double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
-    }
-};
+    const size_t pixelCount = size_t(imageA.getWidth()) * imageA.getHeight();
+    return ImageCompare::computeError<Metric>(imageA.getData(), imageB.getData(), pixelCount, alpha, errorMap, threadCount);
+}
 
-template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+/// Compare images with FLIP, using the first image as the reference. The alpha channel is ignored.
+/// FLIP runs on the Falcor thread pool, which is only started when comparing a single image pair.
+template<bool kHDR>
+double compareFLIP(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)
 {
-    Metric metric;
-    double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
-    {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap)
-            *errorMap++ = float(error);
-        sum += error;
-        a += 4;
-        b += 4;
-    }
-    return sum / count;
+    Falcor::FLIP::Options options;
+    options.isHDR = kHDR;
+    options.threadCount = threadCount;
+    auto result = Falcor::FLIP::compute(
+        imageA.getData(), imageB.getData(), imageA.getWidth(), imageA.getHeight(), 4, options, errorMap
+    );
+    return result.mean;
 }
 
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
-    {"mse", "Mean Squared Error", compare<MSE>},
-    {"rmse", "Relative Mean Squared Error", compare<RMSE>},
-    {"mae", "Mean Absolute Error", compare<MAE>},
-    {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"mse", "Mean Squared Error", compare<ImageCompare::MSE>},
+    {"rmse", "Relative Mean Squared Error", compare<ImageCompare::RMSE>},
+    {"mae", "Mean Absolute Error", compare<ImageCompare::MAE>},
+    {"mape", "Mean Absolute Percentage Error", compare<ImageCompare::MAPE>},
+    {"flip", "LDR-FLIP (mean error, first image is the reference)", compareFLIP<false>},
+    {"hdrflip", "HDR-FLIP (mean error, first image is the reference)", compareFLIP<true>},
 };
 
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -298,16 +268,41 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
     return image;
 }
 
-static bool compareImages(
+/// Image extensions considered in batch mode.
+static const std::vector<std::string> kImageExtensions = {".png", ".jpg", ".tga", ".bmp", ".pfm", ".exr"};
+
+/// Suffix of generated heat maps. These are skipped in batch mode.
+static const std::string kHeatMapSuffix = ".error.png";
+
+struct CompareOptions
+{
+    ErrorMetric metric;
+    float threshold = 0.f;
+    bool alpha = false;
+    uint32_t threadCount = 1;
+};
+
+struct CompareResult
+{
+    std::string name;         ///< Image name (path relative to the compared directories in batch mode).
+    bool success = false;     ///< True if the error is within the threshold.
+    double error = 0.0;       ///< Error between the images, or NaN if they could not be compared.
+    std::string message;      ///< Message describing why the images could not be compared.
+    double loadTime = 0.0;    ///< Time to load both images in ms.
+    double compareTime = 0.0; ///< Time to compute the error in ms.
+};
+
+static CompareResult compareImages(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
-    float threshold,
-    bool alpha,
+    const CompareOptions& options,
     const std::filesystem::path& heatMapPath
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
+    CompareResult result;
+    result.error = std::numeric_limits<double>::quiet_NaN();
+
+    auto loadImage = [](const std::filesystem::path& path, std::string& message)
     {
         try
         {
@@ -315,7 +310,7 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            message = "Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").";
             return std::shared_ptr<Image>{};
         }
     };
@@ -332,27 +327,36 @@ static bool compareImages(
         }
     };
 
-    // Load images.
-    auto imageA = loadImage(pathA);
+    // Load images. The second image is decoded concurrently with the first.
+    double startTime = getTimeMs();
+    std::string messageB;
+    auto futureB = std::async(std::launch::async, [&]() { return loadImage(pathB, messageB); });
+    auto imageA = loadImage(pathA, result.message);
+    auto imageB = futureB.get();
+    result.loadTime = getTimeMs() - startTime;
     if (!imageA)
-        return false;
-    auto imageB = loadImage(pathB);
+        return result;
     if (!imageB)
-        return false;
+    {
+        result.message = messageB;
+        return result;
+    }
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    startTime = getTimeMs();
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = options.metric.compare(*imageA, *imageB, options.alpha, errorMap.get(), options.threadCount);
+    result.compareTime = getTimeMs() - startTime;
 
     // Generate heat map.
     if (errorMap)
@@ -361,13 +365,164 @@ static bool compareImages(
         saveImage(*heatMap, heatMapPath);
     }
 
-    std::cout << error << std::endl;
-
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
-        return false;
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= options.threshold;
+    return result;
+}
+
+/// Collect all images in a directory tree. Returns paths relative to the directory.
+static std::vector<std::filesystem::path> collectImages(const std::filesystem::path& dir)
+{
+    std::vector<std::filesystem::path> images;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        std::string filename = entry.path().filename().string();
+        if (filename.size() >= kHeatMapSuffix.size() && filename.compare(filename.size() - kHeatMapSuffix.size(), kHeatMapSuffix.size(), kHeatMapSuffix) == 0)
+            continue;
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+        if (std::find(kImageExtensions.begin(), kImageExtensions.end(), extension) == kImageExtensions.end())
+            continue;
+        images.push_back(entry.path().lexically_relative(dir));
+    }
+    std::sort(images.begin(), images.end());
+    return images;
+}
+
+/// Compare all images in two directory trees. Images are compared concurrently, one image pair per thread.
+static std::vector<CompareResult> compareDirectories(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const CompareOptions& options,
+    const std::filesystem::path& heatMapDir
+)
+{
+    auto imagesA = collectImages(dirA);
+    auto imagesB = collectImages(dirB);
+
+    std::vector<std::filesystem::path> images;
+    std::set_union(imagesA.begin(), imagesA.end(), imagesB.begin(), imagesB.end(), std::back_inserter(images));
+
+    std::vector<CompareResult> results(images.size());
+    CompareOptions imageOptions = options;
+    imageOptions.threadCount = 1;
+
+    ImageCompare::parallelFor(
+        images.size(),
+        options.threadCount,
+        [&](size_t i)
+        {
+            const auto& image = images[i];
+            auto& result = results[i];
+            if (!std::binary_search(imagesA.begin(), imagesA.end(), image) || !std::binary_search(imagesB.begin(), imagesB.end(), image))
+            {
+                result.name = image.generic_string();
+                result.error = std::numeric_limits<double>::quiet_NaN();
+                auto missingDir = std::binary_search(imagesA.begin(), imagesA.end(), image) ? dirB : dirA;
+                result.message = "Image '" + result.name + "' does not exist in '" + missingDir.string() + "'.";
+                return;
+            }
+
+            std::filesystem::path heatMapPath;
+            if (!heatMapDir.empty())
+            {
+                heatMapPath = heatMapDir / (image.string() + kHeatMapSuffix);
+                std::error_code ec;
+                std::filesystem::create_directories(heatMapPath.parent_path(), ec);
+            }
+
+            result = compareImages(dirA / image, dirB / image, imageOptions, heatMapPath);
+            result.name = image.generic_string();
+        }
+    );
+
+    return results;
+}
+
+enum class OutputFormat
+{
+    Text,
+    Json,
+    Csv,
+};
+
+static std::string escapeCsv(const std::string& str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos)
+        return str;
+    std::string escaped = "\"";
+    for (char c : str)
+    {
+        if (c == '"')
+            escaped += '"';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+static void writeResults(
+    std::ostream& stream,
+    OutputFormat format,
+    const std::vector<CompareResult>& results,
+    const CompareOptions& options,
+    bool batch,
+    double totalTime
+)
+{
+    switch (format)
+    {
+    case OutputFormat::Text:
+        // A single comparison only outputs the error, which is what the testing scripts expect.
+        if (!batch)
+        {
+            if (results.front().message.empty())
+                stream << results.front().error << std::endl;
+            break;
+        }
+        for (const auto& result : results)
+            stream << result.name << ": " << result.error << (result.success ? "" : " (failed)") << std::endl;
+        stream << std::count_if(results.begin(), results.end(), [](const CompareResult& r) { return !r.success; }) << " of "
+               << results.size() << " images failed (" << totalTime << " ms)." << std::endl;
+        break;
+
+    case OutputFormat::Json:
+    {
+        nlohmann::json images = nlohmann::json::array();
+        for (const auto& result : results)
+        {
+            nlohmann::json image = {
+                {"name", result.name},
+                {"success", result.success},
+                {"error", result.error},
+                {"load_time_ms", result.loadTime},
+                {"compare_time_ms", result.compareTime},
+            };
+            if (!result.message.empty())
+                image["message"] = result.message;
+            images.push_back(image);
+        }
+        nlohmann::json json = {
+            {"metric", options.metric.name},
+            {"threshold", options.threshold},
+            {"alpha", options.alpha},
+            {"total_time_ms", totalTime},
+            {"images", images},
+        };
+        stream << json.dump(4) << std::endl;
+        break;
+    }
 
-    return error <= threshold;
+    case OutputFormat::Csv:
+        stream << "name,success,error,load_time_ms,compare_time_ms,message" << std::endl;
+        for (const auto& result : results)
+        {
+            stream << escapeCsv(result.name) << "," << (result.success ? 1 : 0) << "," << result.error << "," << result.loadTime << ","
+                   << result.compareTime << "," << escapeCsv(result.message) << std::endl;
+        }
+        break;
+    }
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -388,9 +543,12 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map (output directory in batch mode).", {'e'});
+    args::ValueFlag<std::string> formatFlag(parser, "format", "Output format (text, json or csv).", {'f', "format"});
+    args::ValueFlag<std::string> outputFlag(parser, "filename", "Write output to file instead of stdout.", {'o', "output"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "N", "Number of threads (default: number of hardware threads).", {'j', "threads"});
+    args::Positional<std::string> image1(parser, "image1", "The first image or directory.", args::Options::Required);
+    args::Positional<std::string> image2(parser, "image2", "The second image or directory.", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -441,13 +599,78 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    bool success = compareImages(
-        args::get(image1),
-        args::get(image2),
-        metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
-    );
+    OutputFormat format = OutputFormat::Text;
+    if (formatFlag)
+    {
+        static const std::map<std::string, OutputFormat> formats = {
+            {"text", OutputFormat::Text},
+            {"json", OutputFormat::Json},
+            {"csv", OutputFormat::Csv},
+        };
+        auto it = formats.find(args::get(formatFlag));
+        if (it == formats.end())
+        {
+            std::cerr << "Unknown output format '" << args::get(formatFlag) << "'." << std::endl;
+            return 1;
+        }
+        format = it->second;
+    }
+
+    CompareOptions options;
+    options.metric = metric;
+    options.threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    options.alpha = alphaFlag ? args::get(alphaFlag) : false;
+    options.threadCount = threadsFlag ? args::get(threadsFlag) : std::thread::hardware_concurrency();
+    options.threadCount = std::max(options.threadCount, 1u);
+
+    // Compare two directory trees if both paths are directories.
+    std::filesystem::path pathA = args::get(image1);
+    std::filesystem::path pathB = args::get(image2);
+    std::filesystem::path heatMapPath = heatMapFlag ? args::get(heatMapFlag) : "";
+    bool batch = std::filesystem::is_directory(pathA) && std::filesystem::is_directory(pathB);
+    if (!batch && (std::filesystem::is_directory(pathA) || std::filesystem::is_directory(pathB)))
+    {
+        std::cerr << "Cannot compare an image with a directory." << std::endl;
+        return 1;
+    }
+
+    // Metrics implemented in Falcor use its thread pool. In batch mode, image pairs are compared concurrently instead.
+    bool useThreadPool = !batch && options.threadCount > 1;
+    if (useThreadPool)
+        Falcor::Threading::start(options.threadCount - 1);
+
+    double startTime = getTimeMs();
+    std::vector<CompareResult> results;
+    if (batch)
+        results = compareDirectories(pathA, pathB, options, heatMapPath);
+    else
+        results.push_back(compareImages(pathA, pathB, options, heatMapPath));
+    double totalTime = getTimeMs() - startTime;
+
+    if (useThreadPool)
+        Falcor::Threading::shutdown();
+
+    for (const auto& result : results)
+    {
+        if (!result.message.empty())
+            std::cerr << (batch ? result.name + ": " : "") << result.message << std::endl;
+    }
+
+    if (outputFlag)
+    {
+        std::ofstream stream(args::get(outputFlag));
+        if (!stream)
+        {
+            std::cerr << "Cannot write to '" << args::get(outputFlag) << "'." << std::endl;
+            return 1;
+        }
+        writeResults(stream, format, results, options, batch, totalTime);
+    }
+    else
+    {
+        writeResults(std::cout, format, results, options, batch, totalTime);
+    }
+
+    bool success = std::all_of(results.begin(), results.end(), [](const CompareResult& result) { return result.success; });
     return success ? 0 : 1;
 }
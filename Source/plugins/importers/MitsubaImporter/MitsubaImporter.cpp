@@ -28,6 +28,9 @@
 #include "MitsubaImporter.h"
 #include "Parser.h"
 #include "Tables.h"
+#include "SerializedFile.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/MathHelpers.h"
@@ -37,6 +40,7 @@
 
 #include <pybind11/pybind11.h>
 
+#include <map>
 #include <unordered_map>
 
 namespace Falcor
@@ -78,11 +82,18 @@ Transform transformFromMatrix4x4(const float4x4& m)
     return t;
 }
 
+struct SerializedMeshEntry
+{
+    std::shared_ptr<const SerializedFile::Mesh> pMesh;
+    uint32_t useCount = 0; ///< Number of shapes that have not yet used the mesh.
+};
+
 struct BuilderContext
 {
     SceneBuilder& builder;
     std::unordered_map<std::string, XMLObject>& instances;
     std::unordered_set<std::string> warnings;
+    std::map<std::pair<std::string, uint32_t>, SerializedMeshEntry> serializedMeshes; ///< Decompressed meshes by filename and shape index.
 
     void forEachReference(const XMLObject& inst, Class cls, std::function<void(const XMLObject&)> func)
     {
@@ -114,6 +125,8 @@ struct BuilderContext
 struct ShapeInfo
 {
     ref<TriangleMesh> pMesh;
+    std::shared_ptr<const SerializedFile::Mesh> pSerializedMesh;
+    bool faceNormals = false;
     float4x4 transform;
     ref<Material> pMaterial;
 };
@@ -449,6 +462,122 @@ MediumInfo buildMedium(BuilderContext& ctx, const XMLObject& inst)
     return medium;
 }
 
+std::pair<std::string, uint32_t> getSerializedMeshKey(const XMLObject& inst)
+{
+    auto shapeIndex = inst.props.getInt("shape_index", 0);
+    if (shapeIndex < 0 || shapeIndex > std::numeric_limits<uint32_t>::max())
+        FALCOR_THROW("Invalid 'shape_index' {}.", shapeIndex);
+    return {inst.props.getString("filename"), (uint32_t)shapeIndex};
+}
+
+void loadSerializedMeshes(BuilderContext& ctx, const XMLObject& inst)
+{
+    FALCOR_ASSERT(inst.cls == Class::Scene);
+
+    // Collect the meshes referenced by all 'serialized' shapes and open each file once.
+    std::map<std::string, std::unique_ptr<SerializedFile>> files;
+    for (const auto& [name, id] : inst.props.getNamedReferences())
+    {
+        const auto& child = ctx.instances[id];
+        if (child.cls != Class::Shape || child.type != "serialized")
+            continue;
+
+        auto key = getSerializedMeshKey(child);
+        ctx.serializedMeshes[key].useCount++;
+        if (!files[key.first])
+            files[key.first] = std::make_unique<SerializedFile>(key.first);
+    }
+
+    if (ctx.serializedMeshes.empty())
+        return;
+
+    // Decompress all meshes in parallel.
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    std::vector<decltype(ctx.serializedMeshes)::value_type*> entries;
+    for (auto& entry : ctx.serializedMeshes)
+        entries.push_back(&entry);
+
+    Threading::parallelFor(
+        0,
+        entries.size(),
+        1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto& [filename, shapeIndex] = entries[i]->first;
+                entries[i]->second.pMesh = std::make_shared<SerializedFile::Mesh>(files.at(filename)->readMesh(shapeIndex));
+            }
+        }
+    );
+
+    double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    logInfo("MitsubaImporter: Loaded {} meshes from {} serialized files in {:.3f} s.", entries.size(), files.size(), duration * 1e-3);
+}
+
+MeshID addSerializedMesh(BuilderContext& ctx, const std::string& name, const ShapeInfo& shape)
+{
+    using AttributeFrequency = SceneBuilder::Mesh::AttributeFrequency;
+    const auto& data = *shape.pSerializedMesh;
+    const uint32_t triangleCount = data.getTriangleCount();
+
+    auto getTriangleNormal = [&](uint32_t triangle)
+    {
+        const float3& p0 = data.positions[data.indices[triangle * 3 + 0]];
+        const float3& p1 = data.positions[data.indices[triangle * 3 + 1]];
+        const float3& p2 = data.positions[data.indices[triangle * 3 + 2]];
+        return cross(p1 - p0, p2 - p0);
+    };
+    auto normalizeOrDefault = [](float3 n)
+    {
+        float len = length(n);
+        return len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+    };
+
+    // Generate face normals if requested, or smooth area-weighted vertex normals if the file stores no normals.
+    std::vector<float3> normals;
+    AttributeFrequency normalFrequency = AttributeFrequency::Vertex;
+    if (shape.faceNormals || data.faceNormals)
+    {
+        normals.resize(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+            normals[i] = normalizeOrDefault(getTriangleNormal(i));
+        normalFrequency = AttributeFrequency::Uniform;
+    }
+    else if (data.normals.empty())
+    {
+        normals.resize(data.positions.size(), float3(0.f));
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            float3 n = getTriangleNormal(i);
+            for (uint32_t j = 0; j < 3; ++j)
+                normals[data.indices[i * 3 + j]] += n;
+        }
+        for (auto& n : normals)
+            n = normalizeOrDefault(n);
+    }
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = name;
+    mesh.faceCount = triangleCount;
+    mesh.vertexCount = (uint32_t)data.positions.size();
+    mesh.indexCount = (uint32_t)data.indices.size();
+    mesh.pIndices = data.indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = shape.pMaterial;
+    mesh.positions.pData = data.positions.data();
+    mesh.positions.frequency = AttributeFrequency::Vertex;
+    mesh.normals.pData = normals.empty() ? data.normals.data() : normals.data();
+    mesh.normals.frequency = normalFrequency;
+    if (!data.texCrds.empty())
+    {
+        mesh.texCrds.pData = data.texCrds.data();
+        mesh.texCrds.frequency = AttributeFrequency::Vertex;
+    }
+
+    return ctx.builder.addMesh(mesh);
+}
+
 ShapeInfo buildShape(BuilderContext& ctx, const XMLObject& inst)
 {
     FALCOR_ASSERT(inst.cls == Class::Shape);
@@ -517,6 +646,24 @@ ShapeInfo buildShape(BuilderContext& ctx, const XMLObject& inst)
         shape.pMesh->setName(inst.id);
         shape.transform = toWorld;
     }
+    else if (inst.type == "serialized")
+    {
+        // Meshes are decompressed up front by loadSerializedMeshes(). Each entry is released after its last use.
+        auto key = getSerializedMeshKey(inst);
+        auto it = ctx.serializedMeshes.find(key);
+        if (it != ctx.serializedMeshes.end())
+        {
+            shape.pSerializedMesh = it->second.pMesh;
+            if (--it->second.useCount == 0)
+                ctx.serializedMeshes.erase(it);
+        }
+        else
+        {
+            shape.pSerializedMesh = std::make_shared<SerializedFile::Mesh>(SerializedFile(key.first).readMesh(key.second));
+        }
+        shape.faceNormals = props.getBool("face_normals", false);
+        shape.transform = toWorld;
+    }
     else
     {
         ctx.unsupportedType(inst.type);
@@ -773,11 +920,11 @@ void buildScene(BuilderContext& ctx, const XMLObject& inst)
         {
             auto shape = buildShape(ctx, child);
 
-            if (shape.pMesh && shape.pMaterial)
+            if ((shape.pMesh || shape.pSerializedMesh) && shape.pMaterial)
             {
                 SceneBuilder::Node node{id, shape.transform};
                 auto nodeID = ctx.builder.addNode(node);
-                auto meshID = ctx.builder.addTriangleMesh(shape.pMesh, shape.pMaterial);
+                auto meshID = shape.pMesh ? ctx.builder.addTriangleMesh(shape.pMesh, shape.pMaterial) : addSerializedMesh(ctx, id, shape);
                 ctx.builder.addMeshInstance(nodeID, meshID);
             }
         }
@@ -818,6 +965,7 @@ void MitsubaImporter::importScene(
         auto sceneID = Mitsuba::parseXML(src, ctx, root, Mitsuba::Tag::Invalid, props, argCounter).second;
 
         Mitsuba::BuilderContext builderCtx{builder, ctx.instances};
+        Mitsuba::loadSerializedMeshes(builderCtx, builderCtx.instances[sceneID]);
         Mitsuba::buildScene(builderCtx, builderCtx.instances[sceneID]);
     }
     catch (const RuntimeError& e)
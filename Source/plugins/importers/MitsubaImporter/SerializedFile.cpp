@@ -0,0 +1,234 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SerializedFile.h"
+#include "Core/Error.h"
+#include "Utils/StringFormatters.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+namespace Mitsuba
+{
+namespace
+{
+const uint16_t kFileFormatHeader = 0x041C;
+
+enum MeshFlags : uint32_t
+{
+    HasNormals = 0x0001,
+    HasTexCoords = 0x0002,
+    HasColors = 0x0008,
+    FaceNormals = 0x0010,
+    SinglePrecision = 0x1000,
+    DoublePrecision = 0x2000,
+};
+
+template<typename T>
+T load(const uint8_t* pData)
+{
+    T value;
+    std::memcpy(&value, pData, sizeof(T));
+    return value;
+}
+
+/**
+ * Reads from a zlib stream directly into the destination buffers.
+ */
+class ZlibReader
+{
+public:
+    ZlibReader(const uint8_t* pData, size_t size) : mpInput(pData), mInputSize(size)
+    {
+        if (inflateInit(&mStream) != Z_OK)
+            FALCOR_THROW("inflateInit failed.");
+    }
+
+    ~ZlibReader() { inflateEnd(&mStream); }
+
+    void read(void* pDst, size_t size)
+    {
+        Bytef* pOut = static_cast<Bytef*>(pDst);
+        while (size > 0)
+        {
+            // zlib uses 32-bit sizes, feed the input in chunks.
+            if (mStream.avail_in == 0 && mInputSize > 0)
+            {
+                mStream.next_in = const_cast<Bytef*>(mpInput);
+                mStream.avail_in = (uInt)std::min<size_t>(mInputSize, std::numeric_limits<uInt>::max());
+                mpInput += mStream.avail_in;
+                mInputSize -= mStream.avail_in;
+            }
+
+            uInt chunkSize = (uInt)std::min<size_t>(size, std::numeric_limits<uInt>::max());
+            mStream.next_out = pOut;
+            mStream.avail_out = chunkSize;
+            int ret = inflate(&mStream, Z_NO_FLUSH);
+            size_t produced = chunkSize - mStream.avail_out;
+            pOut += produced;
+            size -= produced;
+
+            if (ret == Z_STREAM_END || (ret == Z_BUF_ERROR && produced == 0))
+                FALCOR_CHECK(size == 0, "Unexpected end of compressed data.");
+            else if (ret != Z_OK && ret != Z_BUF_ERROR)
+                FALCOR_THROW("Failed to decompress data (error: {}).", ret);
+        }
+    }
+
+    template<typename T>
+    T read()
+    {
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+private:
+    z_stream mStream = {};
+    const uint8_t* mpInput;
+    size_t mInputSize;
+};
+
+/// Read an array of vectors stored in single or double precision.
+template<typename T>
+void readVectors(ZlibReader& reader, bool doublePrecision, size_t count, std::vector<T>& values)
+{
+    static_assert(sizeof(T) == T::length() * sizeof(float), "Vector type must be tightly packed");
+    values.resize(count);
+    if (doublePrecision)
+    {
+        std::vector<double> data(count * T::length());
+        reader.read(data.data(), data.size() * sizeof(double));
+        float* pDst = reinterpret_cast<float*>(values.data());
+        for (size_t i = 0; i < data.size(); ++i)
+            pDst[i] = (float)data[i];
+    }
+    else
+    {
+        reader.read(values.data(), values.size() * sizeof(T));
+    }
+}
+} // namespace
+
+SerializedFile::SerializedFile(const std::filesystem::path& path) : mPath(path)
+{
+    if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        FALCOR_THROW("Failed to open serialized file '{}'.", path);
+
+    const uint8_t* pData = static_cast<const uint8_t*>(mFile.getData());
+    const size_t size = mFile.getSize();
+    FALCOR_CHECK(size >= 8, "Serialized file '{}' is too small.", path);
+
+    // All meshes in a file use the same format version.
+    uint16_t format = load<uint16_t>(pData);
+    mVersion = load<uint16_t>(pData + 2);
+    FALCOR_CHECK(format == kFileFormatHeader, "Serialized file '{}' has an invalid header.", path);
+    FALCOR_CHECK(mVersion == 3 || mVersion == 4, "Serialized file '{}' has unsupported version {}.", path, mVersion);
+
+    // The dictionary at the end of the file stores the offset of each mesh (32-bit in version 3, 64-bit in version 4), followed by the mesh count.
+    const uint32_t meshCount = load<uint32_t>(pData + size - sizeof(uint32_t));
+    const size_t entrySize = mVersion == 4 ? sizeof(uint64_t) : sizeof(uint32_t);
+    FALCOR_CHECK(meshCount > 0 && meshCount * entrySize + sizeof(uint32_t) <= size, "Serialized file '{}' has an invalid dictionary.", path);
+    const size_t dictionaryOffset = size - meshCount * entrySize - sizeof(uint32_t);
+
+    mOffsets.resize(meshCount + 1);
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        const uint8_t* pEntry = pData + dictionaryOffset + i * entrySize;
+        mOffsets[i] = mVersion == 4 ? load<uint64_t>(pEntry) : load<uint32_t>(pEntry);
+    }
+    mOffsets[meshCount] = dictionaryOffset;
+
+    // Each mesh is stored as a header followed by the compressed data, up to the start of the next mesh.
+    for (uint32_t i = 0; i < meshCount; ++i)
+        FALCOR_CHECK(mOffsets[i] + 4 > mOffsets[i] && mOffsets[i] + 4 <= mOffsets[i + 1], "Serialized file '{}' has an invalid offset for mesh {}.", path, i);
+}
+
+SerializedFile::Mesh SerializedFile::readMesh(uint32_t index) const
+{
+    FALCOR_CHECK(index < getMeshCount(), "Mesh index {} is out of range in serialized file '{}' ({} meshes).", index, mPath, getMeshCount());
+
+    const uint8_t* pData = static_cast<const uint8_t*>(mFile.getData()) + mOffsets[index];
+    const size_t size = mOffsets[index + 1] - mOffsets[index];
+    FALCOR_CHECK(
+        load<uint16_t>(pData) == kFileFormatHeader && load<uint16_t>(pData + 2) == mVersion,
+        "Mesh {} in serialized file '{}' has an invalid header.",
+        index,
+        mPath
+    );
+
+    Mesh mesh;
+    try
+    {
+        ZlibReader reader(pData + 4, size - 4);
+
+        uint32_t flags = reader.read<uint32_t>();
+        if (mVersion == 4)
+        {
+            for (char c = reader.read<char>(); c != '\0'; c = reader.read<char>())
+                mesh.name.push_back(c);
+        }
+
+        uint64_t vertexCount = reader.read<uint64_t>();
+        uint64_t triangleCount = reader.read<uint64_t>();
+        FALCOR_CHECK(vertexCount <= std::numeric_limits<uint32_t>::max(), "Too many vertices ({}).", vertexCount);
+        FALCOR_CHECK(triangleCount * 3 <= std::numeric_limits<uint32_t>::max(), "Too many triangles ({}).", triangleCount);
+
+        const bool doublePrecision = (flags & DoublePrecision) != 0;
+        readVectors(reader, doublePrecision, vertexCount, mesh.positions);
+        if (flags & HasNormals)
+            readVectors(reader, doublePrecision, vertexCount, mesh.normals);
+        if (flags & HasTexCoords)
+            readVectors(reader, doublePrecision, vertexCount, mesh.texCrds);
+        if (flags & HasColors)
+        {
+            // Vertex colors are not supported, skip them.
+            std::vector<float3> colors;
+            readVectors(reader, doublePrecision, vertexCount, colors);
+        }
+
+        mesh.indices.resize(triangleCount * 3);
+        reader.read(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        for (uint32_t i : mesh.indices)
+            FALCOR_CHECK(i < vertexCount, "Vertex index {} is out of range ({} vertices).", i, vertexCount);
+
+        mesh.faceNormals = (flags & FaceNormals) != 0;
+    }
+    catch (const RuntimeError& e)
+    {
+        FALCOR_THROW("Failed to read mesh {} from serialized file '{}': {}", index, mPath, e.what());
+    }
+
+    return mesh;
+}
+
+} // namespace Mitsuba
+
+} // namespace Falcor
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace Mitsuba
+{
+/**
+ * Reader for Mitsuba 'serialized' mesh files.
+ * A serialized file stores a sequence of individually zlib-compressed meshes, followed by a dictionary
+ * with the file offset of each mesh. The file is memory-mapped and each mesh is decompressed directly
+ * from the mapping, so meshes can be read independently and concurrently.
+ */
+class SerializedFile
+{
+public:
+    struct Mesh
+    {
+        std::string name;
+        std::vector<float3> positions;
+        std::vector<float3> normals; ///< Per-vertex normals, or empty if not stored in the file.
+        std::vector<float2> texCrds; ///< Per-vertex texture coordinates, or empty if not stored in the file.
+        std::vector<uint32_t> indices;
+        bool faceNormals = false; ///< True if the mesh should be rendered with face normals.
+
+        uint32_t getTriangleCount() const { return (uint32_t)(indices.size() / 3); }
+    };
+
+    /**
+     * Open a serialized file and read its mesh dictionary.
+     * Throws an exception if the file cannot be opened or is invalid.
+     * @param path File path.
+     */
+    SerializedFile(const std::filesystem::path& path);
+
+    const std::filesystem::path& getPath() const { return mPath; }
+
+    /// Get the number of meshes in the file.
+    uint32_t getMeshCount() const { return (uint32_t)mOffsets.size() - 1; }
+
+    /**
+     * Decompress a single mesh. This function is thread-safe.
+     * Throws an exception if the index is out of range or the mesh data is invalid.
+     * @param index Mesh index (the 'shape_index' property in Mitsuba).
+     * @return The mesh.
+     */
+    Mesh readMesh(uint32_t index) const;
+
+private:
+    std::filesystem::path mPath;
+    MemoryMappedFile mFile;
+    uint16_t mVersion = 0;
+    std::vector<uint64_t> mOffsets; ///< File offsets of all meshes, followed by the offset of the dictionary.
+};
+
+} // namespace Mitsuba
+
+} // namespace Falcor
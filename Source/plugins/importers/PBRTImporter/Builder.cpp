@@ -286,6 +286,10 @@ void BasicSceneBuilder::onAttributeEnd(FileLoc loc)
     {
         throwError(loc, "Mismatched nesting: open ObjectBegin from {} at AttributeEnd.", mStack.back().loc.toString());
     }
+    else if (mStack.back().type == StackEntry::Type::Import)
+    {
+        throwError(loc, "Unmatched AttributeEnd in file imported at {}.", mStack.back().loc.toString());
+    }
     else
     {
         FALCOR_ASSERT(mStack.back().type == StackEntry::Type::Attribute);
@@ -436,6 +440,10 @@ void BasicSceneBuilder::onObjectEnd(FileLoc loc)
     {
         throwError(loc, "Mismatched nesting: open AttributeBegin from {} at ObjectEnd.", mStack.back().loc.toString());
     }
+    else if (mStack.back().type == StackEntry::Type::Import)
+    {
+        throwError(loc, "Mismatched nesting: open ObjectBegin outside of file imported at {}.", mStack.back().loc.toString());
+    }
     else
     {
         FALCOR_ASSERT(mStack.back().type == StackEntry::Type::Object);
@@ -462,6 +470,31 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onImportBegin(FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    mStack.push_back({StackEntry::Type::Import, loc, mGraphicsState});
+}
+
+void BasicSceneBuilder::onImportEnd(FileLoc loc)
+{
+    FALCOR_ASSERT(!mStack.empty());
+
+    if (mStack.back().type != StackEntry::Type::Import)
+    {
+        throwError(
+            mStack.back().loc,
+            "Missing end to {} in file imported at {}.",
+            mStack.back().type == StackEntry::Type::Object ? "ObjectBegin" : "AttributeBegin",
+            loc.toString()
+        );
+    }
+
+    mGraphicsState = std::move(mStack.back().graphicsState);
+    mStack.pop_back();
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
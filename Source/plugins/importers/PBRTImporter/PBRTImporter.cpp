@@ -68,6 +68,7 @@
 #include "Core/API/Device.h"
 #include "Utils/Settings/Settings.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
@@ -86,6 +87,8 @@
 
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <set>
 #include <unordered_map>
 
 namespace Falcor
@@ -226,6 +229,9 @@ struct BuilderContext
 
     std::map<std::string, InstanceDefinition> instanceDefinitions;
 
+    /// Triangle meshes of 'plymesh' shapes by resolved path, loaded in parallel before the shapes are processed.
+    std::map<std::string, Falcor::ref<Falcor::TriangleMesh>> plyMeshes;
+
     size_t curveCount = 0;
 
     bool usePBRTMaterials = false;
@@ -1593,7 +1599,16 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        // Use the preloaded mesh on first use. Shapes may modify the mesh, so further uses load it again.
+        if (auto it = ctx.plyMeshes.find(path.string()); it != ctx.plyMeshes.end())
+        {
+            shape.pTriangleMesh = std::move(it->second);
+            ctx.plyMeshes.erase(it);
+        }
+        else
+        {
+            shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        }
         if (shape.pTriangleMesh)
             shape.pTriangleMesh->setName(filename);
         shape.transform = entity.transform;
@@ -1791,6 +1806,54 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
     return instanceDefinition;
 }
 
+/**
+ * Load the meshes of all 'plymesh' shapes in parallel.
+ * pbrt-v4 scenes may reference thousands of PLY files, which would otherwise be loaded one by one in createShape().
+ */
+void loadPlyMeshes(BuilderContext& ctx)
+{
+    std::vector<std::string> paths;
+    auto addShape = [&](const ShapeSceneEntity& entity)
+    {
+        if (entity.name == "plymesh")
+            paths.push_back(ctx.resolver(entity.params.getString("filename", "")).string());
+    };
+
+    for (const auto& entity : ctx.scene.getShapes())
+        addShape(entity);
+
+    // Only consider instance definitions that are instantiated.
+    std::set<std::string> instancedNames;
+    for (const auto& entity : ctx.scene.getInstances())
+        instancedNames.insert(entity.name);
+    for (const auto& [name, entity] : ctx.scene.getInstanceDefinitions())
+    {
+        if (instancedNames.count(name))
+        {
+            for (const auto& shapeEntity : entity.shapes)
+                addShape(shapeEntity);
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    std::vector<Falcor::ref<Falcor::TriangleMesh>> meshes(paths.size());
+    Threading::parallelFor(
+        0,
+        paths.size(),
+        1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                meshes[i] = Falcor::TriangleMesh::createFromFile(paths[i]);
+        }
+    );
+
+    for (size_t i = 0; i < paths.size(); ++i)
+        ctx.plyMeshes.emplace(std::move(paths[i]), std::move(meshes[i]));
+}
+
 void buildScene(BuilderContext& ctx)
 {
     // Load float textures.
@@ -1843,6 +1906,7 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
+    loadPlyMeshes(ctx);
     for (const auto& entity : ctx.scene.getShapes())
     {
         auto shape = createShape(ctx, entity);
@@ -36,10 +36,14 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <fast_float/fast_float.h>
 
+#include <array>
 #include <atomic>
+#include <mutex>
 #include <utility>
 #include <charconv>
 
@@ -107,9 +111,14 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
+    // Imported files are tokenized concurrently, guard the shared list of filenames.
+    static std::mutex filenamesMutex;
     auto pFilename = std::make_unique<std::string>(path.string());
     mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    {
+        std::lock_guard<std::mutex> lock(filenamesMutex);
+        getFilenames().push_back(std::move(pFilename));
+    }
 
     mPos = mContents.data();
     mEnd = mPos + mContents.size();
@@ -448,7 +457,234 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+namespace
+{
+/**
+ * Parser target that records all directives and replays them to another target later.
+ * This is used to parse imported files concurrently while still forwarding directives
+ * to the actual target in the order in which they appear in the scene description.
+ */
+class DirectiveRecorder : public ParserTarget
+{
+public:
+    void replay(ParserTarget& target)
+    {
+        for (auto& directive : mDirectives)
+            directive(target);
+        mDirectives.clear();
+    }
+
+    void onScale(Float sx, Float sy, Float sz, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onScale(sx, sy, sz, loc); });
+    }
+    void onShape(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onShape, name, std::move(params), loc);
+    }
+    void onOption(const std::string& name, const std::string& value, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onOption(name, value, loc); });
+    }
+    void onIdentity(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onIdentity(loc); });
+    }
+    void onTranslate(Float dx, Float dy, Float dz, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onTranslate(dx, dy, dz, loc); });
+    }
+    void onRotate(Float angle, Float ax, Float ay, Float az, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onRotate(angle, ax, ay, az, loc); });
+    }
+    void onLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy, Float uz, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onLookAt(ex, ey, ez, lx, ly, lz, ux, uy, uz, loc); });
+    }
+    void onConcatTransform(Float transform[16], FileLoc loc) override
+    {
+        std::array<Float, 16> m;
+        std::copy(transform, transform + 16, m.begin());
+        record([=](ParserTarget& t) mutable { t.onConcatTransform(m.data(), loc); });
+    }
+    void onTransform(Float transform[16], FileLoc loc) override
+    {
+        std::array<Float, 16> m;
+        std::copy(transform, transform + 16, m.begin());
+        record([=](ParserTarget& t) mutable { t.onTransform(m.data(), loc); });
+    }
+    void onCoordinateSystem(const std::string& name, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onCoordinateSystem(name, loc); });
+    }
+    void onCoordSysTransform(const std::string& name, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onCoordSysTransform(name, loc); });
+    }
+    void onActiveTransformAll(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onActiveTransformAll(loc); });
+    }
+    void onActiveTransformEndTime(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onActiveTransformEndTime(loc); });
+    }
+    void onActiveTransformStartTime(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onActiveTransformStartTime(loc); });
+    }
+    void onTransformTimes(Float start, Float end, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onTransformTimes(start, end, loc); });
+    }
+    void onColorSpace(const std::string& n, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onColorSpace(n, loc); });
+    }
+    void onPixelFilter(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onPixelFilter, name, std::move(params), loc);
+    }
+    void onFilm(const std::string& type, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onFilm, type, std::move(params), loc);
+    }
+    void onAccelerator(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onAccelerator, name, std::move(params), loc);
+    }
+    void onIntegrator(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onIntegrator, name, std::move(params), loc);
+    }
+    void onCamera(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onCamera, name, std::move(params), loc);
+    }
+    void onMakeNamedMedium(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onMakeNamedMedium, name, std::move(params), loc);
+    }
+    void onMediumInterface(const std::string& insideName, const std::string& outsideName, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onMediumInterface(insideName, outsideName, loc); });
+    }
+    void onSampler(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onSampler, name, std::move(params), loc);
+    }
+    void onWorldBegin(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onWorldBegin(loc); });
+    }
+    void onAttributeBegin(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onAttributeBegin(loc); });
+    }
+    void onAttributeEnd(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onAttributeEnd(loc); });
+    }
+    void onAttribute(const std::string& target, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onAttribute, target, std::move(params), loc);
+    }
+    void onTexture(const std::string& name, const std::string& type, const std::string& texname, ParsedParameterVector params, FileLoc loc)
+        override
+    {
+        record([=, params = std::move(params)](ParserTarget& t) mutable { t.onTexture(name, type, texname, std::move(params), loc); });
+    }
+    void onMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onMaterial, name, std::move(params), loc);
+    }
+    void onMakeNamedMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onMakeNamedMaterial, name, std::move(params), loc);
+    }
+    void onNamedMaterial(const std::string& name, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onNamedMaterial(name, loc); });
+    }
+    void onLightSource(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onLightSource, name, std::move(params), loc);
+    }
+    void onAreaLightSource(const std::string& name, ParsedParameterVector params, FileLoc loc) override
+    {
+        recordParams(&ParserTarget::onAreaLightSource, name, std::move(params), loc);
+    }
+    void onReverseOrientation(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onReverseOrientation(loc); });
+    }
+    void onObjectBegin(const std::string& name, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onObjectBegin(name, loc); });
+    }
+    void onObjectEnd(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onObjectEnd(loc); });
+    }
+    void onObjectInstance(const std::string& name, FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onObjectInstance(name, loc); });
+    }
+    void onImportBegin(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onImportBegin(loc); });
+    }
+    void onImportEnd(FileLoc loc) override
+    {
+        record([=](ParserTarget& t) { t.onImportEnd(loc); });
+    }
+
+    void onEndOfFiles() override { FALCOR_UNREACHABLE(); }
+
+private:
+    using Directive = std::function<void(ParserTarget&)>;
+    using ParamListEntrypoint = void (ParserTarget::*)(const std::string&, ParsedParameterVector, FileLoc);
+
+    void record(Directive directive) { mDirectives.push_back(std::move(directive)); }
+
+    void recordParams(ParamListEntrypoint apiFunc, const std::string& name, ParsedParameterVector params, FileLoc loc)
+    {
+        record([=, params = std::move(params)](ParserTarget& t) mutable { (t.*apiFunc)(name, std::move(params), loc); });
+    }
+
+    std::vector<Directive> mDirectives;
+};
+
+/**
+ * State shared by all files parsed as part of a single parseFile()/parseString() call.
+ */
+struct ParseContext
+{
+    std::mutex mutex;
+    ParseStatistics stats;
+
+    void addFile(const Tokenizer& tokenizer, CpuTimer::TimePoint startTime, bool imported)
+    {
+        double timeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        double throughput = timeMs > 0.0 ? (tokenizer.getSize() / (1024.0 * 1024.0)) / (timeMs / 1000.0) : 0.0;
+        logInfo(
+            "PBRTImporter: Finished parsing '{}' ({:.1f} kB in {:.1f} ms, {:.1f} MB/s).",
+            tokenizer.getPath().string(),
+            tokenizer.getSize() / 1024.0,
+            timeMs,
+            throughput
+        );
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.files.push_back({tokenizer.getPath(), tokenizer.getSize(), timeMs, imported});
+        stats.totalBytes += tokenizer.getSize();
+    }
+};
+
+} // namespace
+
+static void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, ParseContext& ctx, bool imported)
 {
     static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
@@ -457,7 +693,43 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
     auto searchPath = tokenizer->getPath().parent_path();
 
     std::vector<std::unique_ptr<Tokenizer>> fileStack;
+    std::vector<CpuTimer::TimePoint> fileStartTimes;
     fileStack.push_back(std::move(tokenizer));
+    fileStartTimes.push_back(CpuTimer::getCurrentTimePoint());
+
+    /**
+     * Files referenced by 'Import' are parsed asynchronously into a recorder. All directives
+     * following an import are recorded as well, and the recorded directives are replayed
+     * to the target in order once parsing is complete.
+     */
+    struct PendingImport
+    {
+        FileLoc loc;
+        std::shared_ptr<DirectiveRecorder> pImported;
+        Threading::Task task;
+        std::unique_ptr<DirectiveRecorder> pFollowing;
+    };
+    std::vector<PendingImport> imports;
+    ParserTarget* pTarget = &target;
+
+    // Pending imports reference the parse context, so wait for them if parsing fails.
+    struct ImportGuard
+    {
+        std::vector<PendingImport>& imports;
+        ~ImportGuard()
+        {
+            for (auto& import : imports)
+            {
+                try
+                {
+                    if (import.task.isValid())
+                        import.task.finish();
+                }
+                catch (...)
+                {}
+            }
+        }
+    } importGuard{imports};
 
     std::optional<Token> ungetToken;
 
@@ -483,8 +755,9 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         if (!tok)
         {
             // We've reached EOF in the current file. Anything more to parse?
-            logInfo("PBRTImporter: Finished parsing '{}'.", fileStack.back()->getPath().string());
+            ctx.addFile(*fileStack.back(), fileStartTimes.back(), imported);
             fileStack.pop_back();
+            fileStartTimes.pop_back();
             return nextToken(flags);
         }
         else if (tok->token[0] == '#')
@@ -515,7 +788,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         std::string_view dequoted = dequoteString(t);
         std::string n = toString(dequoted);
         ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
-        (target.*apiFunc)(n, std::move(parameterVector), loc);
+        (pTarget->*apiFunc)(n, std::move(parameterVector), loc);
     };
 
     auto syntaxError = [&](const Token& t)
@@ -539,11 +812,11 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         case 'A':
             if (tok->token == "AttributeBegin")
             {
-                target.onAttributeBegin(tok->loc);
+                pTarget->onAttributeBegin(tok->loc);
             }
             else if (tok->token == "AttributeEnd")
             {
-                target.onAttributeEnd(tok->loc);
+                pTarget->onAttributeEnd(tok->loc);
             }
             else if (tok->token == "Attribute")
             {
@@ -553,11 +826,11 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             {
                 Token a = *nextToken(TokenRequired);
                 if (a.token == "All")
-                    target.onActiveTransformAll(tok->loc);
+                    pTarget->onActiveTransformAll(tok->loc);
                 else if (a.token == "EndTime")
-                    target.onActiveTransformEndTime(tok->loc);
+                    pTarget->onActiveTransformEndTime(tok->loc);
                 else if (a.token == "StartTime")
-                    target.onActiveTransformStartTime(tok->loc);
+                    pTarget->onActiveTransformStartTime(tok->loc);
                 else
                     syntaxError(*tok);
             }
@@ -585,22 +858,22 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                     m[i] = parseFloat(*nextToken(TokenRequired));
                 if (nextToken(TokenRequired)->token != "]")
                     syntaxError(*tok);
-                target.onConcatTransform(m, tok->loc);
+                pTarget->onConcatTransform(m, tok->loc);
             }
             else if (tok->token == "CoordinateSystem")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onCoordinateSystem(toString(n), tok->loc);
+                pTarget->onCoordinateSystem(toString(n), tok->loc);
             }
             else if (tok->token == "CoordSysTransform")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onCoordSysTransform(toString(n), tok->loc);
+                pTarget->onCoordSysTransform(toString(n), tok->loc);
             }
             else if (tok->token == "ColorSpace")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onColorSpace(toString(n), tok->loc);
+                pTarget->onColorSpace(toString(n), tok->loc);
             }
             else if (tok->token == "Camera")
             {
@@ -636,14 +909,31 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
                 logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
                 fileStack.push_back(std::move(includeTokenizer));
+                fileStartTimes.push_back(CpuTimer::getCurrentTimePoint());
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                auto path = searchPath / filename;
+                auto pImported = std::make_shared<DirectiveRecorder>();
+                auto job = [pImported, path, &ctx]()
+                {
+                    parse(*pImported, Tokenizer::createFromFile(path), ctx, true);
+                };
+
+                Threading::Task task;
+                if (Threading::getWorkerCount() > 0)
+                    task = Threading::dispatchTask(job);
+                else
+                    job();
+
+                imports.push_back({tok->loc, std::move(pImported), std::move(task), std::make_unique<DirectiveRecorder>()});
+                pTarget = imports.back().pFollowing.get();
             }
             else if (tok->token == "Identity")
             {
-                target.onIdentity(tok->loc);
+                pTarget->onIdentity(tok->loc);
             }
             else
             {
@@ -661,7 +951,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Float v[9];
                 for (int i = 0; i < 9; ++i)
                     v[i] = parseFloat(*nextToken(TokenRequired));
-                target.onLookAt(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], tok->loc);
+                pTarget->onLookAt(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], tok->loc);
             }
             else
             {
@@ -703,7 +993,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 else
                     names[1] = names[0];
 
-                target.onMediumInterface(names[0], names[1], tok->loc);
+                pTarget->onMediumInterface(names[0], names[1], tok->loc);
             }
             else
             {
@@ -715,7 +1005,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             if (tok->token == "NamedMaterial")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onNamedMaterial(toString(n), tok->loc);
+                pTarget->onNamedMaterial(toString(n), tok->loc);
             }
             else
             {
@@ -727,22 +1017,22 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             if (tok->token == "ObjectBegin")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onObjectBegin(toString(n), tok->loc);
+                pTarget->onObjectBegin(toString(n), tok->loc);
             }
             else if (tok->token == "ObjectEnd")
             {
-                target.onObjectEnd(tok->loc);
+                pTarget->onObjectEnd(tok->loc);
             }
             else if (tok->token == "ObjectInstance")
             {
                 std::string_view n = dequoteString(*nextToken(TokenRequired));
-                target.onObjectInstance(toString(n), tok->loc);
+                pTarget->onObjectInstance(toString(n), tok->loc);
             }
             else if (tok->token == "Option")
             {
                 std::string name = toString(dequoteString(*nextToken(TokenRequired)));
                 std::string value = toString(nextToken(TokenRequired)->token);
-                target.onOption(name, value, tok->loc);
+                pTarget->onOption(name, value, tok->loc);
             }
             else
             {
@@ -764,14 +1054,14 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         case 'R':
             if (tok->token == "ReverseOrientation")
             {
-                target.onReverseOrientation(tok->loc);
+                pTarget->onReverseOrientation(tok->loc);
             }
             else if (tok->token == "Rotate")
             {
                 Float v[4];
                 for (int i = 0; i < 4; ++i)
                     v[i] = parseFloat(*nextToken(TokenRequired));
-                target.onRotate(v[0], v[1], v[2], v[3], tok->loc);
+                pTarget->onRotate(v[0], v[1], v[2], v[3], tok->loc);
             }
             else
             {
@@ -793,7 +1083,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Float v[3];
                 for (int i = 0; i < 3; ++i)
                     v[i] = parseFloat(*nextToken(TokenRequired));
-                target.onScale(v[0], v[1], v[2], tok->loc);
+                pTarget->onScale(v[0], v[1], v[2], tok->loc);
             }
             else
             {
@@ -809,11 +1099,11 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                     logWarning(tok->loc, "TransformBegin/End are deprecated and should be replaced with AttributeBegin/End.");
                     warnedTransformBeginEndDeprecated = true;
                 }
-                target.onAttributeBegin(tok->loc);
+                pTarget->onAttributeBegin(tok->loc);
             }
             else if (tok->token == "TransformEnd")
             {
-                target.onAttributeEnd(tok->loc);
+                pTarget->onAttributeEnd(tok->loc);
             }
             else if (tok->token == "Transform")
             {
@@ -824,21 +1114,21 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                     m[i] = parseFloat(*nextToken(TokenRequired));
                 if (nextToken(TokenRequired)->token != "]")
                     syntaxError(*tok);
-                target.onTransform(m, tok->loc);
+                pTarget->onTransform(m, tok->loc);
             }
             else if (tok->token == "Translate")
             {
                 Float v[3];
                 for (int i = 0; i < 3; ++i)
                     v[i] = parseFloat(*nextToken(TokenRequired));
-                target.onTranslate(v[0], v[1], v[2], tok->loc);
+                pTarget->onTranslate(v[0], v[1], v[2], tok->loc);
             }
             else if (tok->token == "TransformTimes")
             {
                 Float v[2];
                 for (int i = 0; i < 2; ++i)
                     v[i] = parseFloat(*nextToken(TokenRequired));
-                target.onTransformTimes(v[0], v[1], tok->loc);
+                pTarget->onTransformTimes(v[0], v[1], tok->loc);
             }
             else if (tok->token == "Texture")
             {
@@ -851,7 +1141,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 std::string_view dequoted = dequoteString(t);
                 std::string texName = toString(dequoted);
                 ParsedParameterVector params = parseParameters(nextToken, unget);
-                target.onTexture(name, type, texName, std::move(params), tok->loc);
+                pTarget->onTexture(name, type, texName, std::move(params), tok->loc);
             }
             else
             {
@@ -862,7 +1152,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         case 'W':
             if (tok->token == "WorldBegin")
             {
-                target.onWorldBegin(tok->loc);
+                pTarget->onWorldBegin(tok->loc);
             }
             else
             {
@@ -874,19 +1164,50 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             syntaxError(*tok);
         }
     }
+
+    // Wait for imported files and replay all recorded directives in order.
+    for (auto& import : imports)
+    {
+        if (import.task.isValid())
+            import.task.finish();
+        target.onImportBegin(import.loc);
+        import.pImported->replay(target);
+        target.onImportEnd(import.loc);
+        import.pFollowing->replay(target);
+    }
+}
+
+static void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, ParseStatistics* pStats)
+{
+    auto startTime = CpuTimer::getCurrentTimePoint();
+
+    ParseContext ctx;
+    parse(target, std::move(tokenizer), ctx, false);
+
+    ctx.stats.totalTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    logInfo(
+        "PBRTImporter: Parsed {} file(s) ({:.1f} MB) in {:.1f} ms ({:.1f} MB/s).",
+        ctx.stats.files.size(),
+        ctx.stats.totalBytes / (1024.0 * 1024.0),
+        ctx.stats.totalTimeMs,
+        ctx.stats.getThroughput()
+    );
+
+    if (pStats)
+        *pStats = std::move(ctx.stats);
 }
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path)
+void parseFile(ParserTarget& target, const std::filesystem::path& path, ParseStatistics* pStats)
 {
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), pStats);
     target.onEndOfFiles();
 }
 
-void parseString(ParserTarget& target, std::string str)
+void parseString(ParserTarget& target, std::string str, ParseStatistics* pStats)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), pStats);
     target.onEndOfFiles();
 }
 
@@ -40,6 +40,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace Falcor::pbrt
 {
@@ -98,11 +99,55 @@ public:
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+    /**
+     * Called before/after the directives of a file referenced by an 'Import' directive.
+     * Changes to the graphics state made by the imported file are scoped to the file.
+     */
+    virtual void onImportBegin(FileLoc loc) = 0;
+    virtual void onImportEnd(FileLoc loc) = 0;
+
     virtual void onEndOfFiles() = 0;
 };
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path);
-void parseString(ParserTarget& target, std::string str);
+/**
+ * Statistics gathered while parsing a scene description.
+ */
+struct ParseStatistics
+{
+    struct File
+    {
+        std::filesystem::path path; ///< File path.
+        size_t bytes = 0;           ///< File size in bytes (after decompression).
+        double timeMs = 0.0;        ///< Time spent parsing the file in ms (including nested includes).
+        bool imported = false;      ///< True if the file was parsed asynchronously using 'Import'.
+    };
+
+    std::vector<File> files;  ///< Per-file statistics, in the order in which files finished parsing.
+    size_t totalBytes = 0;    ///< Total number of bytes parsed.
+    double totalTimeMs = 0.0; ///< Total wall-clock time in ms.
+
+    /// Get parsing throughput in MB/s.
+    double getThroughput() const { return totalTimeMs > 0.0 ? (totalBytes / (1024.0 * 1024.0)) / (totalTimeMs / 1000.0) : 0.0; }
+};
+
+/**
+ * Parse a scene description file.
+ * Files referenced using the 'Import' directive are parsed concurrently on the global thread pool.
+ * Their directives are recorded and forwarded to the target in the order they appear in the scene
+ * description, so the result does not depend on the order in which files finish parsing.
+ * @param[in] target Parser target receiving the scene description.
+ * @param[in] path File path.
+ * @param[out] pStats If not nullptr, parse statistics are written to this struct.
+ */
+void parseFile(ParserTarget& target, const std::filesystem::path& path, ParseStatistics* pStats = nullptr);
+
+/**
+ * Parse a scene description string.
+ * @param[in] target Parser target receiving the scene description.
+ * @param[in] str Scene description.
+ * @param[out] pStats If not nullptr, parse statistics are written to this struct.
+ */
+void parseString(ParserTarget& target, std::string str, ParseStatistics* pStats = nullptr);
 
 struct Token
 {
@@ -129,6 +174,9 @@ public:
 
     const std::filesystem::path& getPath() const { return mPath; }
 
+    /// Get the size of the parsed contents in bytes.
+    size_t getSize() const { return mContents.size(); }
+
 private:
     /**
      * Static list of filenames to allow file locations (FileLoc::filename) to be valid
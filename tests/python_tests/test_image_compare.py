@@ -0,0 +1,117 @@
+import csv
+import io
+import json
+import shutil
+import struct
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+# The test runner adds the build directory to PATH.
+IMAGE_COMPARE_EXE = shutil.which("ImageCompare")
+
+
+def write_pfm(path: Path, width, height, value):
+    """
+    Write an RGB PFM image with a constant value.
+    """
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path, "wb") as f:
+        f.write(f"PF\n{width} {height}\n-1.0\n".encode("ascii"))
+        f.write(struct.pack(f"<{width * height * 3}f", *([value] * (width * height * 3))))
+
+
+@unittest.skipIf(IMAGE_COMPARE_EXE is None, "ImageCompare executable not found")
+class TestImageCompare(unittest.TestCase):
+    """
+    Checks the output formats of ImageCompare that are parsed by the testing scripts.
+    """
+
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.dir_a = Path(self.temp_dir.name) / "a"
+        self.dir_b = Path(self.temp_dir.name) / "b"
+        # MSE of the 'diff' images is (0.5 - 0.25)^2 = 0.0625.
+        write_pfm(self.dir_a / "diff.pfm", 7, 5, 0.5)
+        write_pfm(self.dir_b / "diff.pfm", 7, 5, 0.25)
+        write_pfm(self.dir_a / "sub" / "same.pfm", 7, 5, 0.5)
+        write_pfm(self.dir_b / "sub" / "same.pfm", 7, 5, 0.5)
+        write_pfm(self.dir_a / "only_a.pfm", 7, 5, 0.5)
+
+    def tearDown(self):
+        self.temp_dir.cleanup()
+
+    def run_image_compare(self, *args):
+        return subprocess.run(
+            [IMAGE_COMPARE_EXE, "-m", "mse", "-t", "0.1"] + [str(arg) for arg in args],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            universal_newlines=True,
+        )
+
+    def test_single_text(self):
+        # run_image_tests.py parses the output of a single comparison as a float.
+        process = self.run_image_compare(self.dir_a / "diff.pfm", self.dir_b / "diff.pfm")
+        self.assertEqual(process.returncode, 0)
+        self.assertEqual(float(process.stdout.strip()), 0.0625)
+
+        process = subprocess.run(
+            [IMAGE_COMPARE_EXE, "-m", "mse", "-t", "0.01", str(self.dir_a / "diff.pfm"), str(self.dir_b / "diff.pfm")],
+            stdout=subprocess.PIPE,
+            universal_newlines=True,
+        )
+        self.assertEqual(process.returncode, 1)
+        self.assertEqual(float(process.stdout.strip()), 0.0625)
+
+    def test_batch_json(self):
+        output = Path(self.temp_dir.name) / "results.json"
+        process = self.run_image_compare("-f", "json", "-o", output, self.dir_a, self.dir_b)
+        self.assertEqual(process.returncode, 1)
+        with open(output) as f:
+            results = json.load(f)
+
+        self.assertEqual(set(results.keys()), {"metric", "threshold", "alpha", "total_time_ms", "images"})
+        self.assertEqual(results["metric"], "mse")
+        self.assertAlmostEqual(results["threshold"], 0.1)
+        self.assertFalse(results["alpha"])
+
+        images = {image["name"]: image for image in results["images"]}
+        self.assertEqual(list(images.keys()), ["diff.pfm", "only_a.pfm", "sub/same.pfm"])
+        for image in images.values():
+            self.assertTrue({"name", "success", "error", "load_time_ms", "compare_time_ms"} <= set(image.keys()))
+
+        self.assertTrue(images["diff.pfm"]["success"])
+        self.assertEqual(images["diff.pfm"]["error"], 0.0625)
+        self.assertNotIn("message", images["diff.pfm"])
+        self.assertTrue(images["sub/same.pfm"]["success"])
+        self.assertEqual(images["sub/same.pfm"]["error"], 0.0)
+
+        # Images missing on one side fail with a message and no error value.
+        self.assertFalse(images["only_a.pfm"]["success"])
+        self.assertIsNone(images["only_a.pfm"]["error"])
+        self.assertIn("does not exist", images["only_a.pfm"]["message"])
+
+    def test_batch_csv(self):
+        process = self.run_image_compare("-f", "csv", self.dir_a, self.dir_b)
+        self.assertEqual(process.returncode, 1)
+        rows = list(csv.reader(io.StringIO(process.stdout)))
+
+        self.assertEqual(rows[0], ["name", "success", "error", "load_time_ms", "compare_time_ms", "message"])
+        rows = {row[0]: row for row in rows[1:]}
+        self.assertEqual(list(rows.keys()), ["diff.pfm", "only_a.pfm", "sub/same.pfm"])
+        for row in rows.values():
+            self.assertEqual(len(row), 6)
+            float(row[3])
+            float(row[4])
+
+        self.assertEqual(rows["diff.pfm"][1:3], ["1", "0.0625"])
+        self.assertEqual(rows["diff.pfm"][5], "")
+        self.assertEqual(rows["sub/same.pfm"][1:3], ["1", "0"])
+        self.assertEqual(rows["only_a.pfm"][1], "0")
+        self.assertEqual(rows["only_a.pfm"][2].lower(), "nan")
+        self.assertIn("does not exist", rows["only_a.pfm"][5])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -13,6 +13,9 @@ DEFAULT_PLATFORMS = ["windows-x86_64", "linux-x86_64"]
 # Default image comparison tolerance.
 DEFAULT_TOLERANCE = 0.0
 
+# Default image comparison metric (see ImageCompare -l for available metrics).
+DEFAULT_METRIC = "mse"
+
 # Default image test timeout.
 DEFAULT_TIMEOUT = 600
 
@@ -138,7 +138,8 @@ class Test:
         self.skip_message = self.header.get('skipped', None)
         self.skipped = self.skip_message != None
 
-        # Get tolerance.
+        # Get image comparison metric and tolerance.
+        self.metric = self.header.get('metric', config.DEFAULT_METRIC)
         self.tolerance = self.header.get('tolerance', config.DEFAULT_TOLERANCE)
 
         # Get timeout.
@@ -282,7 +283,7 @@ class Test:
             result_file = result_dir / image
             error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
 
-            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), str(ref_file), str(result_file)]
+            args = [str(image_compare_exe), '-m', self.metric, '-t', str(self.tolerance), str(ref_file), str(result_file)]
             if error_file:
                 args += ['-e', str(error_file)]
             processes[image] = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
@@ -303,6 +304,7 @@ class Test:
                 'name': str(image),
                 'success': compare_success,
                 'error': compare_error,
+                'metric': self.metric,
                 'tolerance': self.tolerance
             })
 